@@ -25,6 +25,29 @@ IMPLEMENT_NODE(CAccount, CBaseNode);
 static SFString nextAccountChunk(const SFString& fieldIn, const void *dataPtr);
 static SFString nextAccountChunk_custom(const SFString& fieldIn, const void *dataPtr);
 
+//---------------------------------------------------------------------------
+// makeClass chose the seed so that no two of these names share a slot in the table
+enum {
+    FLD_ADDR = 1,
+    FLD_HEADER,
+    FLD_DISPLAYSTRING,
+    FLD_PAGESIZE,
+    FLD_LASTPAGE,
+    FLD_LASTBLOCK,
+    FLD_NVISIBLE,
+    FLD_TRANSACTIONS,
+    FLD_TRANSACTIONSCNT,
+};
+static const char *accountFieldNames[] = {
+    "addr", "header", "displayString", "pageSize", "lastPage", "lastBlock", "nVisible",
+    "transactions", "transactionsCnt",
+};
+static const uint8_t accountFieldSlots[] = {
+    0, 2, 0, 0, 9, 0, 8, 7, 0, 0, 0, 0, 1, 0, 0, 0,
+    0, 0, 0, 0, 3, 0, 0, 5, 4, 0, 0, 0, 0, 0, 0, 6,
+};
+static const CFieldTable accountFieldTable(accountFieldNames, 9, accountFieldSlots, 32, 1);
+
 //---------------------------------------------------------------------------
 void CAccount::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr) const {
     if (!m_showing)
@@ -35,12 +58,10 @@ void CAccount::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr)
         return;
     }
 
-    SFString fmt = fmtIn;
-    if (handleCustomFormat(ctx, fmt, dataPtr))
+    if (handleCustomFormat(ctx, fmtIn, dataPtr))
         return;
 
-    while (!fmt.empty())
-        ctx << getNextChunk(fmt, nextAccountChunk, this);
+    formatChunks(ctx, fmtIn, nextAccountChunk, this);
 }
 
 //---------------------------------------------------------------------------
@@ -59,45 +80,59 @@ bool CAccount::setValueByName(const SFString& fieldName, const SFString& fieldVa
     // EXISTING_CODE
     // EXISTING_CODE
 
-    switch (tolower(fieldName[0])) {
-        case 'a':
-            if ( fieldName % "addr" ) { addr = toAddress(fieldValue); return true; }
-            break;
-        case 'd':
-            if ( fieldName % "displayString" ) { displayString = fieldValue; return true; }
-            break;
-        case 'h':
-            if ( fieldName % "header" ) { header = fieldValue; return true; }
-            break;
-        case 'l':
-            if ( fieldName % "lastPage" ) { lastPage = toUnsigned(fieldValue); return true; }
-            if ( fieldName % "lastBlock" ) { lastBlock = toLong(fieldValue); return true; }
-            break;
-        case 'n':
-            if ( fieldName % "nVisible" ) { nVisible = toUnsigned(fieldValue); return true; }
-            break;
-        case 'p':
-            if ( fieldName % "pageSize" ) { pageSize = toUnsigned(fieldValue); return true; }
-            break;
-        case 't':
-            if ( fieldName % "transactions" ) {
-                char *p = (char *)fieldValue.c_str();
-                while (p && *p) {
-                    CTransaction item;
-                    uint32_t nFields = 0;
-                    p = item.parseJson(p, nFields);
-                    if (nFields)
-                        transactions[transactions.getCount()] = item;
-                }
-                return true;
+    switch (accountFieldTable.find(fieldName)) {
+        case FLD_ADDR: addr = toAddress(fieldValue); return true;
+        case FLD_HEADER: header = fieldValue; return true;
+        case FLD_DISPLAYSTRING: displayString = fieldValue; return true;
+        case FLD_PAGESIZE: pageSize = toUnsigned(fieldValue); return true;
+        case FLD_LASTPAGE: lastPage = toUnsigned(fieldValue); return true;
+        case FLD_LASTBLOCK: lastBlock = toLong(fieldValue); return true;
+        case FLD_NVISIBLE: nVisible = toUnsigned(fieldValue); return true;
+        case FLD_TRANSACTIONS: {
+            char *p = (char *)fieldValue.c_str();
+            while (p && *p) {
+                CTransaction item;
+                uint32_t nFields = 0;
+                p = item.parseJson(p, nFields);
+                if (nFields)
+                    transactions[transactions.getCount()] = item;
             }
-            break;
+            return true;
+        }
         default:
             break;
     }
     return false;
 }
 
+//---------------------------------------------------------------------------------------------------
+bool CAccount::parseTape(CJsonTape& tape, uint32_t node) {
+    if (!tape.isObject(node))
+        return false;
+
+    // Objects are parsed in place from the tape. Anything else goes to setValueByName
+    for (uint32_t key = tape.firstMember(node) ; key != JSON_NOTOKEN ; key = tape.nextMember(node, key)) {
+        uint32_t val = key + 1;
+        string_view_q name = tape.getView(key);
+        switch (accountFieldTable.find(name.data(), name.length())) {
+            case FLD_TRANSACTIONS:
+                if (tape.isArrayOf(val, JSON_OBJECT)) {
+                    for (uint32_t item = tape.firstItem(val) ; item != JSON_NOTOKEN ; item = tape.nextItem(val, item)) {
+                        if (tape.firstMember(item) != JSON_NOTOKEN)
+                            transactions[transactions.getCount()].parseTape(tape, item);
+                    }
+                    continue;
+                }
+                break;
+            default:
+                break;
+        }
+        setValueFromTape(tape, key);
+    }
+    finishParse();
+    return true;
+}
+
 //---------------------------------------------------------------------------------------------------
 void CAccount::finishParse() {
     // EXISTING_CODE
@@ -279,39 +314,26 @@ SFString CAccount::getValueByName(const SFString& fieldName) const {
         return ret;
 
     // Return field values
-    switch (tolower(fieldName[0])) {
-        case 'a':
-            if ( fieldName % "addr" ) return fromAddress(addr);
-            break;
-        case 'd':
-            if ( fieldName % "displayString" ) return displayString;
-            break;
-        case 'h':
-            if ( fieldName % "header" ) return header;
-            break;
-        case 'l':
-            if ( fieldName % "lastPage" ) return asStringU(lastPage);
-            if ( fieldName % "lastBlock" ) return asString(lastBlock);
-            break;
-        case 'n':
-            if ( fieldName % "nVisible" ) return asStringU(nVisible);
-            break;
-        case 'p':
-            if ( fieldName % "pageSize" ) return asStringU(pageSize);
-            break;
-        case 't':
-            if ( fieldName % "transactions" || fieldName % "transactionsCnt" ) {
-                uint32_t cnt = transactions.getCount();
-                if (fieldName.endsWith("Cnt"))
-                    return asStringU(cnt);
-                if (!cnt) return "";
-                SFString retS;
-                for (uint32_t i = 0 ; i < cnt ; i++) {
-                    retS += transactions[i].Format();
-                    retS += ((i < cnt - 1) ? ",\n" : "\n");
-                }
-                return retS;
+    switch (accountFieldTable.find(fieldName)) {
+        case FLD_ADDR: return fromAddress(addr);
+        case FLD_HEADER: return header;
+        case FLD_DISPLAYSTRING: return displayString;
+        case FLD_PAGESIZE: return asStringU(pageSize);
+        case FLD_LASTPAGE: return asStringU(lastPage);
+        case FLD_LASTBLOCK: return asString(lastBlock);
+        case FLD_NVISIBLE: return asStringU(nVisible);
+        case FLD_TRANSACTIONS: {
+            uint32_t cnt = transactions.getCount();
+            if (!cnt) return "";
+            SFString retS;
+            for (uint32_t i = 0 ; i < cnt ; i++) {
+                retS += transactions[i].Format();
+                retS += ((i < cnt - 1) ? ",\n" : "\n");
             }
+            return retS;
+        }
+        case FLD_TRANSACTIONSCNT: return asStringU(transactions.getCount());
+        default:
             break;
     }
 
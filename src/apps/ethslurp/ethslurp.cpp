@@ -80,8 +80,9 @@ bool CSlurperApp::Initialize(COptions& options, SFString& message) {
         return false;
     }
 
-    // Note this may not return if user chooses to exit
-    api.checkKey(toml);
+    // Note this may not return if user chooses to exit. We don't need a key if we're not asking EtherScan.
+    if (!options.local)
+        api.checkKey(toml);
 
     // If we are told to get the address from the rerun address, and the
     // user hasn't supplied one, do so...
@@ -187,104 +188,14 @@ bool CSlurperApp::Slurp(COptions& options, SFString& message) {
     // If the user tells us he/she wants to update the cache, or the cache
     // hasn't been updated in five minutes, then update it
     uint32_t nSeconds = (uint32_t)max((uint64_t)60, toml.getConfigInt("settings", "update_freq", 300));
-    if ((now - fileTime) > nSeconds) {
+    if (options.local || (now - fileTime) > nSeconds) {
         // This is how many records we currently have
         uint32_t origCount  = theAccount.transactions.getCount();
-        uint32_t nNewBlocks = 0;
-
-        if (!isTestMode())
-            cerr << "\tSlurping new transactions from blockchain...\n";
-        uint32_t nextRecord = origCount;
-        uint32_t nRead = 0;
-        uint32_t nRequests = 0;
-
-        // We already have 'page' pages, so start there.
-        uint32_t page = max((uint32_t)theAccount.lastPage, (uint32_t)1);
-
-        // Keep reading until we get less than a full page
-        SFString contents;
-        bool done = false;
-// #define NO_INTERNET
-#ifdef NO_INTERNET
-        done = true;
-#endif
-        while (!done) {
-            SFString url = SFString("https://api.etherscan.io/api?module=account&action=txlist&sort=asc") +
-            "&address=" + theAccount.addr +
-            "&page="    + asString(page) +
-            "&offset="  +
-            asString(options.pageSize) +
-            "&apikey="  + api.getKey();
-
-            // Grab a page of data from the web api
-            SFString thisPage = urlToString(url);
-
-            // See if it's good data, if not, bail
-            message = nextTokenClear(thisPage, '[');
-            if (!message.Contains("{\"status\":\"1\",\"message\":\"OK\"")) {
-                if (message.Contains("{\"status\":\"0\",\"message\":\"No transactions found\",\"result\":"))
-                    message = "No transactions were found for address '" + theAccount.addr + "'.";
-                return options.fromFile;
-            }
-            contents += thisPage;
-
-            uint64_t nRecords = countOf('}', thisPage) - 1;
-            nRead += nRecords;
-            if (!isTestMode())
-                cerr << "\tDownloaded " << nRead << " potentially new transactions.\r";
-
-            // If we got a full page, there are more to come
-            done = (nRecords < options.pageSize);
-            if (!done)
-                page++;
-
-            // Etherscan.io doesn't want more than five pages per second, so sleep for a second
-            if (++nRequests == 4) {
-                qbSleep(1.0);
-                nRequests = 0;
-            }
-
-            // Make sure we don't spin forever
-            if (nRead >= options.maxTransactions)
-                done = true;
-        }
-
-        uint32_t minBlock = 0, maxBlock = 0;
-        findBlockRange(contents, minBlock, maxBlock);
-#ifndef NO_INTERNET
-        if (!isTestMode())
-            cerr << "\n\tDownload contains blocks from " << minBlock << " to " << maxBlock << "\n";
-#endif
-
-        // Keep track of which last full page we've read
-        theAccount.lastPage = page;
-        theAccount.pageSize = options.pageSize;
-
-        // pre allocate the array (probably wrong input here--Grow takes max needed size, not addition size needed)
-        theAccount.transactions.Grow(nRead);
 
         int64_t lastBlock = 0;  // DO NOT CHANGE! MAKES A BUG IF YOU MAKE IT UNSIGNED NOLINT
-        char *p = cleanUpJson((char *)(contents.c_str()));  // NOLINT
-        while (p && *p) {
-            CTransaction trans;
-            uint32_t nFields = 0;
-            p = trans.parseJson(p, nFields);
-            if (nFields) {
-                int64_t transBlock = (int64_t)trans.blockNumber;  // NOLINT
-                if (transBlock > theAccount.lastBlock) {  // add the new transaction if it's in a new block
-                    theAccount.transactions[nextRecord++] = trans;
-                    lastBlock = transBlock;
-                    if (!(++nNewBlocks % REP_FREQ) && !isTestMode()) {
-                        cerr << "\tFound new transaction at block " << transBlock << ". Importing...\r";
-                        cerr.flush();
-                    }
-                }
-            }
-        }
-        if (!isTestMode() && nNewBlocks) {
-            cerr << "\tFound new transaction at block " << lastBlock << ". Importing...\n";
-            cerr.flush();
-        }
+        bool ret = (options.local ? slurpFromCache(options, message, lastBlock) : slurpFromEtherscan(options, message, lastBlock));
+        if (!ret)
+            return options.fromFile;
 
         theAccount.lastBlock = max(theAccount.lastBlock, lastBlock);
         // Write the data if we got new data
@@ -314,6 +225,287 @@ bool CSlurperApp::Slurp(COptions& options, SFString& message) {
     return (options.fromFile || theAccount.transactions.getCount() > 0);
 }
 
+//--------------------------------------------------------------------------------
+bool CSlurperApp::slurpFromEtherscan(COptions& options, SFString& message, int64_t& lastBlock) {
+
+    if (!isTestMode())
+        cerr << "\tSlurping new transactions from blockchain...\n";
+    uint32_t nextRecord = theAccount.transactions.getCount();
+    uint32_t nNewBlocks = 0;
+    uint32_t nRead = 0;
+    uint32_t nRequests = 0;
+
+    // We already have 'page' pages, so start there.
+    uint32_t page = max((uint32_t)theAccount.lastPage, (uint32_t)1);
+
+    // Keep reading until we get less than a full page
+    SFString contents;
+    bool done = false;
+// #define NO_INTERNET
+#ifdef NO_INTERNET
+    done = true;
+#endif
+    while (!done) {
+        SFString url = SFString("https://api.etherscan.io/api?module=account&action=txlist&sort=asc") +
+        "&address=" + theAccount.addr +
+        "&page="    + asString(page) +
+        "&offset="  +
+        asString(options.pageSize) +
+        "&apikey="  + api.getKey();
+
+        // Grab a page of data from the web api
+        SFString thisPage = urlToString(url);
+
+        // See if it's good data, if not, bail
+        message = nextTokenClear(thisPage, '[');
+        if (!message.Contains("{\"status\":\"1\",\"message\":\"OK\"")) {
+            if (message.Contains("{\"status\":\"0\",\"message\":\"No transactions found\",\"result\":"))
+                message = "No transactions were found for address '" + theAccount.addr + "'.";
+            return false;
+        }
+        contents += thisPage;
+
+        uint64_t nRecords = countOf('}', thisPage) - 1;
+        nRead += nRecords;
+        if (!isTestMode())
+            cerr << "\tDownloaded " << nRead << " potentially new transactions.\r";
+
+        // If we got a full page, there are more to come
+        done = (nRecords < options.pageSize);
+        if (!done)
+            page++;
+
+        // Etherscan.io doesn't want more than five pages per second, so sleep for a second
+        if (++nRequests == 4) {
+            qbSleep(1.0);
+            nRequests = 0;
+        }
+
+        // Make sure we don't spin forever
+        if (nRead >= options.maxTransactions)
+            done = true;
+    }
+
+    uint32_t minBlock = 0, maxBlock = 0;
+    findBlockRange(contents, minBlock, maxBlock);
+#ifndef NO_INTERNET
+    if (!isTestMode())
+        cerr << "\n\tDownload contains blocks from " << minBlock << " to " << maxBlock << "\n";
+#endif
+
+    // Keep track of which last full page we've read
+    theAccount.lastPage = page;
+    theAccount.pageSize = options.pageSize;
+
+    // pre allocate room for the existing transactions plus everything we downloaded
+    theAccount.transactions.reserve(nextRecord + nRead);
+
+    char *p = cleanUpJson((char *)(contents.c_str()));  // NOLINT
+    while (p && *p) {
+        CTransaction trans;
+        uint32_t nFields = 0;
+        p = trans.parseJson(p, nFields);
+        if (nFields) {
+            int64_t transBlock = (int64_t)trans.blockNumber;  // NOLINT
+            if (transBlock > theAccount.lastBlock) {  // add the new transaction if it's in a new block
+                theAccount.transactions[nextRecord++] = trans;
+                lastBlock = transBlock;
+                if (!(++nNewBlocks % REP_FREQ) && !isTestMode()) {
+                    cerr << "\tFound new transaction at block " << transBlock << ". Importing...\r";
+                    cerr.flush();
+                }
+            }
+        }
+    }
+    if (!isTestMode() && nNewBlocks) {
+        cerr << "\tFound new transaction at block " << lastBlock << ". Importing...\n";
+        cerr.flush();
+    }
+    return true;
+}
+
+//--------------------------------------------------------------------------------
+// Collects what slurpFromCache needs while it visits the candidate blocks
+class CLocalSlurp {
+public:
+    CAccount        *account;
+    CAddressField    addr;         // the account's address, for comparing with the transactions'
+    CAppearanceList  appearances;  // from the appearance index in block order
+    uint64_t         cursor;       // the first appearance not yet visited
+    blknum_t         bloomStart;   // blocks from here on were found with the blooms
+    SFUintArray      blocks;       // every candidate block in order
+    CBloom2048       bloom;
+    blknum_t         lastVisited;
+    uint32_t         nNew;
+    uint32_t         maxTransactions;
+    CLocalSlurp(CAccount *acct) : account(acct), addr(acct->addr), cursor(0), bloomStart(NOPOS), lastVisited(0), nNew(0), maxTransactions(0) { }
+};
+
+//--------------------------------------------------------------------------------
+bool addAppearance(blknum_t bn, blknum_t tx, void *data) {
+    CLocalSlurp *slurp = reinterpret_cast<CLocalSlurp*>(data);
+    if (tx == NOPOS)  // the miner, which etherscan does not report either
+        return true;
+    if (!slurp->blocks.getCount() || slurp->blocks[slurp->blocks.getCount()-1] != bn)
+        slurp->blocks.addValue(bn);
+    slurp->appearances.push_back(CAppearance(bn, tx));
+    return true;
+}
+
+//--------------------------------------------------------------------------------
+bool addBloomHit(const CBloomRecord& record, void *data) {
+    CLocalSlurp *slurp = reinterpret_cast<CLocalSlurp*>(data);
+    if (isBloomHit(slurp->bloom, record.bloom)) {
+        if (!slurp->blocks.getCount() || slurp->blocks[slurp->blocks.getCount()-1] != record.blockNum)
+            slurp->blocks.addValue(record.blockNum);
+    }
+    return true;
+}
+
+//--------------------------------------------------------------------------------
+// Copies the transaction and the calls inside of it (its traces other than the first, which is
+// the transaction itself) that involve the account
+void addTransaction(CLocalSlurp *slurp, const CBlock& block, const CTransaction& trans) {
+    CAccount *account = slurp->account;
+
+    if (trans.from == slurp->addr || trans.to == slurp->addr || trans.receipt.contractAddress == slurp->addr) {
+        CTransaction *copy = &account->transactions[account->transactions.getCount()];
+        *copy = trans;
+        copy->pBlock = NULL;
+        copy->timestamp = block.timestamp;
+        slurp->nNew++;
+    }
+
+    CTraceArray traces;
+    getTraces(traces, trans);
+    for (uint32_t t = 1 ; t < traces.getCount() ; t++) {
+        const CTrace *trace = &traces[t];
+        const CAddressField& to = (trace->type == "create" ? trace->result.address : trace->action.to);
+        if (trace->action.from == slurp->addr || to == slurp->addr) {
+            CTransaction *internal = &account->transactions[account->transactions.getCount()];
+            internal->hash             = trans.hash;
+            internal->blockHash        = trans.blockHash;
+            internal->blockNumber      = trans.blockNumber;
+            internal->transactionIndex = trans.transactionIndex;
+            internal->timestamp        = block.timestamp;
+            internal->from             = trace->action.from;
+            internal->to               = to;
+            internal->value            = trace->action.value;
+            internal->gas              = trace->action.gas;
+            internal->gasPrice         = trans.gasPrice;
+            internal->input            = trace->action.input;
+            internal->isError          = trace->isError();
+            internal->isInternal       = true;
+            internal->receipt.gasUsed  = trace->result.gasUsed;
+            slurp->nNew++;
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------
+// Marks which of a block's transactions mention the account. The miner belongs to no transaction
+// (its 'tx' is NOPOS), so it is skipped.
+class CMentions {
+public:
+    const CAddressField *addr;
+    std::vector<bool>    mentioned;
+    CMentions(const CAddressField *a, uint32_t nTrans) : addr(a), mentioned(nTrans, false) { }
+};
+
+//--------------------------------------------------------------------------------
+bool addMention(blknum_t bn, blknum_t tx, blknum_t tc, const SFAddress& addr, void *data) {
+    CMentions *mentions = reinterpret_cast<CMentions*>(data);
+    if (tx < mentions->mentioned.size() && *mentions->addr == addr)
+        mentions->mentioned[tx] = true;
+    return true;
+}
+
+//--------------------------------------------------------------------------------
+// Traces are only needed for the transactions we keep, so forEveryAddress doesn't ask for them
+bool noTraces(const CTransaction *trans, void *data) {
+    return true;
+}
+
+//--------------------------------------------------------------------------------
+bool visitLocalBlock(CBlock& block, void *data) {
+    CLocalSlurp *slurp = reinterpret_cast<CLocalSlurp*>(data);
+
+    if (block.blockNumber >= slurp->bloomStart) {
+        // The blooms only tell us the account may be in the block, so we look for the
+        // transactions that mention it, as the appearance index does when built without traces
+        CMentions mentions(&slurp->addr, block.transactions.getCount());
+        block.forEveryAddress(addMention, noTraces, &mentions);
+        for (uint32_t i = 0 ; i < block.transactions.getCount() ; i++)
+            if (mentions.mentioned[i])
+                addTransaction(slurp, block, block.transactions[i]);
+
+    } else {
+        while (slurp->cursor < slurp->appearances.size() && slurp->appearances[slurp->cursor].blockNum == block.blockNumber) {
+            blknum_t tx = slurp->appearances[slurp->cursor++].transIndex;
+            if (tx < block.transactions.getCount())
+                addTransaction(slurp, block, block.transactions[(uint32_t)tx]);
+        }
+    }
+
+    if (!isTestMode() && !(block.blockNumber % REP_FREQ)) {
+        cerr << "\tSearching block " << block.blockNumber << ". Found " << slurp->nNew << " new transactions.\r";
+        cerr.flush();
+    }
+
+    // Stop between blocks so the ones we've visited are complete
+    slurp->lastVisited = block.blockNumber;
+    return (slurp->nNew < slurp->maxTransactions);
+}
+
+//--------------------------------------------------------------------------------
+// Builds the transaction list from the local block cache instead of EtherScan. The appearance
+// index (see makeAppearanceIndex) tells us which transactions the account appears in. Blocks
+// newer than the index (or all blocks if there is no index) are found with the bloom index,
+// which only narrows the search to blocks, so it is slower.
+bool CSlurperApp::slurpFromCache(COptions& options, SFString& message, int64_t& lastBlock) {
+
+    if (!isTestMode())
+        cerr << "\tSlurping new transactions from the local cache...\n";
+
+    CLocalSlurp slurp(&theAccount);
+    slurp.maxTransactions = options.maxTransactions;
+    blknum_t start = (blknum_t)(theAccount.lastBlock + 1);
+    int64_t scanned = theAccount.lastBlock;  // the last block the indexes cover, signed as lastBlock is  NOLINT
+
+    blknum_t lastIndexed = getLastAppearanceBlock();
+    if (lastIndexed != NOPOS) {
+        forEveryAppearance(theAccount.addr, start, lastIndexed, addAppearance, &slurp);
+        start = max(start, lastIndexed + 1);
+        scanned = max(scanned, (int64_t)lastIndexed);  // NOLINT
+    }
+
+    if (getBloomIndex()->isValid()) {
+        slurp.bloomStart = start;
+        slurp.bloom = makeBloom(theAccount.addr);
+        forEveryBloomInIndex(addBloomHit, &slurp, start, NOPOS);
+        scanned = max(scanned, (int64_t)getBloomIndex()->lastBlock());  // NOLINT
+
+    } else if (lastIndexed == NOPOS) {
+        message = "There is no local index. Run makeAppearanceIndex (or makeBloomIndex) first.";
+        return false;
+    }
+
+    // Unless we stop early, the next run starts after the last block the indexes cover
+    lastBlock = scanned;
+    if (!slurp.blocks.getCount())
+        return true;
+
+    if (!isTestMode())
+        cerr << "\tReading " << slurp.blocks.getCount() << " candidate blocks...\n";
+    forEveryBlockInListParallel(visitLocalBlock, &slurp, slurp.blocks);
+    if (!isTestMode())
+        cerr << "\n";
+
+    if (slurp.nNew >= slurp.maxTransactions)
+        lastBlock = (int64_t)slurp.lastVisited;  // NOLINT
+    return true;
+}
+
 //--------------------------------------------------------------------------------
 bool CSlurperApp::Filter(COptions& options, SFString& message) {
     message = "";
@@ -497,7 +689,10 @@ void CSlurperApp::buildDisplayStrings(COptions& options) {
             exit(0);
         }
         if (field->isHidden() && force) ((CFieldData*)field)->setHidden(false);  // NOLINT
-        if (!field->isHidden()) {
+        // Reading blocks from the cache un-hides the receipt, so we leave it out here whatever
+        // its field says
+        bool hidden = field->isHidden() || (fieldName == "receipt" && !force);
+        if (!hidden) {
             SFString resolved = fieldName;
             if (options.exportFormat != "json")
                 resolved = toml.getConfigStr("field_str", fieldName, fieldName);
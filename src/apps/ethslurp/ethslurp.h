@@ -35,6 +35,8 @@ public:
     bool Display(COptions& options, SFString& message);
 
 private:
+    bool slurpFromEtherscan(COptions& options, SFString& message, int64_t& lastBlock);
+    bool slurpFromCache(COptions& options, SFString& message, int64_t& lastBlock);
     void buildDisplayStrings(COptions& options);
     SFString getFormatString(COptions& options, const SFString& name, bool ignoreBlank);
 };
@@ -33,6 +33,7 @@ CParams params[] = {
     CParams("@--reverse",       "display results sorted in reverse chronological order (chronological by default)"),
     CParams("@--acct_id:<val>", "for 'cache' mode, use this as the :acct_id for the cache (0 otherwise)"),
     CParams("@--cache",         "write the data to a local QuickBlocks cache"),
+    CParams("@--local",         "build the transaction list from the local block cache instead of EtherScan"),
     CParams("@--name:<str>",    "name this address"),
     CParams("",                 "Fetches data off the Ethereum blockchain for an arbitrary account or smart "
                                 "contract. Optionally formats the output to your specification. Note: --income "
@@ -91,6 +92,9 @@ bool COptions::parseArguments(SFString& command) {
         } else if (arg.startsWith("--cache")) {
             cache = true;
 
+        } else if (arg == "--local") {
+            local = true;
+
         } else if (arg.startsWith("-b:") || arg.startsWith("--blocks:")) {
 
             if (firstDate != earliestDate || lastDate != latestDate)
@@ -234,6 +238,7 @@ void COptions::Init(void) {
     archiveFile = "";
     wantsArchive = false;
     cache = false;
+    local = false;
     acct_id = 0;
     addr = "";
 
@@ -35,6 +35,7 @@ public:
     SFString archiveFile;
     bool wantsArchive;
     bool cache;
+    bool local;
     uint32_t acct_id;
     FILE *output;  // for use when -a is on
 
@@ -17,7 +17,10 @@
 extern void     generateCode  (const COptions& options, CToml& toml, const SFString& dataFile, const SFString& ns);
 extern SFString getCaseCode   (const SFString& fieldCase, const SFString& ex);
 extern SFString getCaseSetCode(const SFString& fieldCase);
+extern bool     getFieldTable (const SFString& fieldCase, const SFString& baseLower, SFString& tableOut);
 extern SFString short3        (const SFString& in);
+extern SFString fieldID       (const SFString& field);
+extern SFString caseBody      (const SFString& code);
 extern SFString checkType     (const SFString& typeIn);
 extern SFString convertTypes  (const SFString& inStr);
 
@@ -100,6 +103,8 @@ SFString convertTypes(const SFString& inStr) {
     // Note: Watch out for trailing spaces. They are here to make sure it
     // matches only the types and not the field names.
     SFString outStr = inStr
+        .Substitute("address20 ", "CAddressField ")
+        .Substitute("hash32 ",    "CHashField " )
         .Substitute("address ",   "SFAddress "  )
         .Substitute("bytes32 ",   "SFString "   )
         .Substitute("bytes ",     "SFString "   )
@@ -135,6 +140,7 @@ SFString convertTypes(const SFString& inStr) {
 //------------------------------------------------------------------------------------------------------------
 extern const char* STR_COMMENT_LINE;
 extern const char* STR_CLASSFILE;
+extern const char* STR_FIELD_TABLE;
 extern const char* STR_CASE_CODE_ARRAY;
 extern const char* STR_CASE_SET_CODE_ARRAY;
 extern const char* STR_CASE_CODE_STRINGARRAY;
@@ -151,6 +157,10 @@ extern const char* STR_GETSTR_CODE;
 extern const char* STR_GETSTR_CODE_FIELD;
 extern const char* STR_GETOBJ_HEAD;
 extern const char* STR_GETSTR_HEAD;
+extern const char* STR_PARSETAPE_HEAD;
+extern const char* STR_PARSETAPE_CODE;
+extern const char* STR_PARSETAPE_CODE_OBJECT;
+extern const char* STR_PARSETAPE_CODE_ARRAY;
 extern const char* STR_UPGRADE_CODE;
 
 SFString tab = SFString("\t");
@@ -175,7 +185,7 @@ void generateCode(const COptions& options, CToml& toml, const SFString& dataFile
 
     //------------------------------------------------------------------------------------------------
     SFString fieldDec, fieldSet,  fieldClear,  fieldCopy, fieldGetObj, fieldGetStr, fieldArchiveRead;
-    SFString fieldArchiveWrite,   fieldReg,    fieldCase, fieldSubCls, headerIncs;
+    SFString fieldArchiveWrite,   fieldReg,    fieldCase, fieldSubCls, headerIncs, fieldTape;
 
     //------------------------------------------------------------------------------------------------
     while (!hIncludes.empty()) {
@@ -240,6 +250,8 @@ void generateCode(const COptions& options, CToml& toml, const SFString& dataFile
         } else if (fld->type == "addr")      { setFmt = "\t[{NAME}] = [{DEFS}];\n"; regType = "T_ADDRESS";
         } else if (fld->type == "address")   { setFmt = "\t[{NAME}] = [{DEFS}];\n"; regType = "T_ADDRESS";
         } else if (fld->type == "hash")      { setFmt = "\t[{NAME}] = [{DEFS}];\n"; regType = "T_HASH";
+        } else if (fld->type == "address20") { setFmt = "\t[{NAME}].setEmpty();\n"; regType = "T_ADDRESS";
+        } else if (fld->type == "hash32")    { setFmt = "\t[{NAME}].setEmpty();\n"; regType = "T_HASH";
         } else if (fld->type == "bytes32")   { setFmt = "\t[{NAME}] = [{DEFS}];\n"; regType = "T_TEXT";
         } else if (fld->type == "bytes")     { setFmt = "\t[{NAME}] = [{DEFS}];\n"; regType = "T_TEXT";
         } else if (fld->type == "int8")      { setFmt = "\t[{NAME}] = [{DEF}];\n";  regType = "T_NUMBER";
@@ -301,6 +313,10 @@ void generateCode(const COptions& options, CToml& toml, const SFString& dataFile
                     fieldGetObj.Replace("[index]", "");
                 }
                 fieldGetObj.ReplaceAll("[{FIELD}]", fld->name);
+
+                fieldTape += (fld->type.Contains("Array") ? STR_PARSETAPE_CODE_ARRAY : STR_PARSETAPE_CODE_OBJECT);
+                fieldTape.ReplaceAll("[{ID}]",    fieldID(fld->name));
+                fieldTape.ReplaceAll("[{FIELD}]", fld->name);
             }
         }
 
@@ -346,6 +362,9 @@ SFString ptrWriteFmt =
     bool hasObjGetter = !fieldGetObj.empty();
     if (hasObjGetter)
         fieldGetObj = SFString(STR_GETOBJ_CODE).Substitute("[{FIELDS}]", fieldGetObj);
+    // Classes with object fields parse them straight from the tape. The rest use CBaseNode's parseTape
+    if (hasObjGetter)
+        fieldTape = SFString(STR_PARSETAPE_CODE).Substitute("[{FIELDS}]", fieldTape);
     bool hasStrGetter = !fieldGetStr.empty();
     if (hasStrGetter)
         fieldGetStr = SFString(STR_GETSTR_CODE).Substitute("[{FIELDS}]", fieldGetStr);
@@ -357,6 +376,11 @@ SFString ptrWriteFmt =
     //------------------------------------------------------------------------------------------------
     SFString caseSetCodeStr = getCaseSetCode(fieldCase);
     SFString subClsCodeStr  = fieldSubCls;
+    SFString fieldTableStr;
+    if (!getFieldTable(fieldCase, baseLower, fieldTableStr)) {
+        cerr << "Could not build the field table for " << className << ". Are two fields named the same? Quitting...\n";
+        return;
+    }
 
     //------------------------------------------------------------------------------------------------
     SFString sorts[4] = { baseLower.substr(0,2)+"_Name", "", baseLower+"ID", "" };
@@ -368,7 +392,7 @@ SFString ptrWriteFmt =
     //------------------------------------------------------------------------------------------------
     SFString headerFile = dataFile.Substitute(".txt", ".h").Substitute("./classDefinitions/", "./");
     SFString headSource = asciiFileToString(configPath("makeClass/blank.h"));
-    headSource.ReplaceAll("[{GET_OBJ}]",      (hasObjGetter ? SFString(STR_GETOBJ_HEAD)+(hasStrGetter?"":"\n") : ""));
+    headSource.ReplaceAll("[{GET_OBJ}]",      (hasObjGetter ? SFString(STR_PARSETAPE_HEAD)+STR_GETOBJ_HEAD+(hasStrGetter?"":"\n") : ""));
     headSource.ReplaceAll("[{GET_STR}]",      (hasStrGetter ? SFString(STR_GETSTR_HEAD)+"\n" : ""));
     headSource.ReplaceAll("[FIELD_COPY]",     fieldCopy);
     headSource.ReplaceAll("[FIELD_DEC]",      fieldDec);
@@ -413,8 +437,10 @@ SFString ptrWriteFmt =
     srcSource.ReplaceAll("[{OPERATORS}]",       operatorC);
     srcSource.ReplaceAll("[REGISTER_FIELDS]",   fieldReg);
     srcSource.ReplaceAll("[{FIELD_CASE}]",      fieldStr);
+    srcSource.ReplaceAll("[{FIELD_TABLE}]",     fieldTableStr);
     srcSource.ReplaceAll("[OTHER_INCS]",        otherIncs);
     srcSource.ReplaceAll("[FIELD_SETCASE]",     caseSetCodeStr);
+    srcSource.ReplaceAll("[{PARSE_TAPE}]",      fieldTape);
     srcSource.ReplaceAll("[{SUBCLASSFLDS}]",    subClsCodeStr);
     srcSource.ReplaceAll("[{PARENT_SER1}]",     parSer);
     srcSource.ReplaceAll("[{PARENT_SER2}]",     parSer.Substitute("Serialize", "SerializeC"));
@@ -454,109 +480,101 @@ SFString ptrWriteFmt =
 SFString getCaseCode(const SFString& fieldCase, const SFString& ex) {
     SFString baseTab = (tab+tab+ex);
     SFString caseCode;
-    for (char ch = '_' ; ch < 'z' + 1 ; ch++) {
-        if (fieldCase.ContainsI("+"+SFString(ch))) {
-            caseCode += baseTab + "case '" + ch + "':\n";
-            SFString fields = fieldCase;
-            while (!fields.empty()) {
-                SFString isObj = nextTokenClear(fields, '|');
-                SFString type  = nextTokenClear(isObj, '+');
-                SFString field = nextTokenClear(isObj, '-');
-                SFString isPtr = nextTokenClear(isObj, '~');
-                bool     isPointer = atoi((const char*)isPtr);
-                bool     isObject = atoi((const char*)isObj);
-
-                if (tolower(field[0]) == ch) {
-                    caseCode += baseTab + tab + "if ( fieldName % \"" + field + "\"";
-                    if (type.Contains("Array"))
-                        caseCode += " || fieldName % \"" + field + "Cnt\"";
-                    caseCode += " )";
-                    if (type.Contains("List") || isPointer) {
-                        SFString ptrCase = PTR_GET_CASE;
-                        ptrCase.ReplaceAll("[{NAME}]", field);
-                        ptrCase.ReplaceAll("[{TYPE}]", type);
-                        caseCode += ptrCase;
-
-                    } else if (type == "time") {
-                        caseCode += " return [{PTR}]" + field + ".Format(FMT_JSON);";
-
-                    } else if (type == "bbool" || type == "bool") {
-                        caseCode += " return asString([{PTR}]" + field + ");";
-
-                    } else if (type == "bloom") {
-                        caseCode += " return bloom2Bytes([{PTR}]" + field + ");";
-
-                    } else if (type == "wei") {
-                        caseCode += " return fromWei([{PTR}]" + field + ");";
-
-                    } else if (type == "gas") {
-                        caseCode += " return fromGas([{PTR}]" + field + ");";
-
-                    } else if (type == "timestamp") {
-                        caseCode += " return fromTimestamp([{PTR}]" + field + ");";
-
-                    } else if (type == "addr" || type == "address") {
-                        caseCode += " return fromAddress([{PTR}]" + field + ");";
-
-                    } else if (type == "hash") {
-                        caseCode += " return fromHash([{PTR}]" + field + ");";
-
-                    } else if (type == "bytes" || type == "bytes32") {
-                        caseCode += " return [{PTR}]" + field + ";";
-
-                    } else if (type == "uint8" || type == "uint16" || type == "uint32" || type == "uint64") {
-                        caseCode += " return asStringU([{PTR}]" + field + ");";
-
-                    } else if (type == "blknum") {
-                        caseCode += " return asStringU([{PTR}]" + field + ");";
-
-                    } else if (type == "uint256") {
-                        caseCode += " return asStringBN([{PTR}]" + field + ");";
-
-                    } else if (type == "int8" || type == "int16" || type == "int32" || type == "int64") {
-                        caseCode += " return asString([{PTR}]" + field + ");";
-
-                    } else if (type == "int256") {
-                        caseCode += " return asStringBN([{PTR}]" + field + ");";
-
-                    } else if (type == "double") {
-                        caseCode += " return fmtFloat([{PTR}]" + field + ");";
-
-                    } else if (type.Contains("SFStringArray") || type.Contains("SFAddressArray")) {
-                        SFString str = STR_CASE_CODE_STRINGARRAY;
-                        str.ReplaceAll("[{FIELD}]", field);
-                        caseCode += str;
-
-                    } else if (type.Contains("SFBigUintArray") || type.Contains("SFTopicArray")) {
-                        SFString str = STR_CASE_CODE_STRINGARRAY;
-                        // hack for getCount clause
-                        str.Replace("[{FIELD}]", field);
-                        // hack for the array access
-                        str.Replace("[{FIELD}][i]", "fromTopic("+field+"[i])");
-                        caseCode += str;
-
-                    } else if (type.Contains("Array")) {
-                        SFString str = STR_CASE_CODE_ARRAY;
-                        if (type.Contains("SFUint") || type.Contains("SFBlock"))
-                            str.ReplaceAll("[{PTR}][{FIELD}][i].Format()", "asStringU([{PTR}][{FIELD}][i])");
-                        str.ReplaceAll("[{FIELD}]", field);
-                        caseCode += str;
-
-                    } else if (isObject) {
-                        caseCode += " { expContext().noFrst=true; return [{PTR}]" + field + ".Format(); }";
+    SFString fields = fieldCase;
+    while (!fields.empty()) {
+        SFString isObj = nextTokenClear(fields, '|');
+        SFString type  = nextTokenClear(isObj, '+');
+        SFString field = nextTokenClear(isObj, '-');
+        SFString isPtr = nextTokenClear(isObj, '~');
+        bool     isPointer = atoi((const char*)isPtr);
+        bool     isObject = atoi((const char*)isObj);
 
-                    } else {
-                        caseCode += " return [{PTR}]" + field + ";";
-                    }
+        SFString code;
+        if (type.Contains("List") || isPointer) {
+            SFString ptrCase = PTR_GET_CASE;
+            ptrCase.ReplaceAll("[{NAME}]", field);
+            ptrCase.ReplaceAll("[{TYPE}]", type);
+            code = ptrCase;
 
-                    caseCode += "\n";
-                }
-            }
-            caseCode += baseTab + tab + "break;\n";
+        } else if (type == "time") {
+            code = " return [{PTR}]" + field + ".Format(FMT_JSON);";
+
+        } else if (type == "bbool" || type == "bool") {
+            code = " return asString([{PTR}]" + field + ");";
+
+        } else if (type == "bloom") {
+            code = " return bloom2Bytes([{PTR}]" + field + ");";
+
+        } else if (type == "wei") {
+            code = " return fromWei([{PTR}]" + field + ");";
+
+        } else if (type == "gas") {
+            code = " return fromGas([{PTR}]" + field + ");";
+
+        } else if (type == "timestamp") {
+            code = " return fromTimestamp([{PTR}]" + field + ");";
+
+        } else if (type == "addr" || type == "address" || type == "address20") {
+            code = " return fromAddress([{PTR}]" + field + ");";
+
+        } else if (type == "hash" || type == "hash32") {
+            code = " return fromHash([{PTR}]" + field + ");";
+
+        } else if (type == "bytes" || type == "bytes32") {
+            code = " return [{PTR}]" + field + ";";
+
+        } else if (type == "uint8" || type == "uint16" || type == "uint32" || type == "uint64") {
+            code = " return asStringU([{PTR}]" + field + ");";
+
+        } else if (type == "blknum") {
+            code = " return asStringU([{PTR}]" + field + ");";
+
+        } else if (type == "uint256") {
+            code = " return asStringBN([{PTR}]" + field + ");";
+
+        } else if (type == "int8" || type == "int16" || type == "int32" || type == "int64") {
+            code = " return asString([{PTR}]" + field + ");";
+
+        } else if (type == "int256") {
+            code = " return asStringBN([{PTR}]" + field + ");";
+
+        } else if (type == "double") {
+            code = " return fmtFloat([{PTR}]" + field + ");";
+
+        } else if (type.Contains("SFStringArray") || type.Contains("SFAddressArray")) {
+            SFString str = STR_CASE_CODE_STRINGARRAY;
+            str.ReplaceAll("[{FIELD}]", field);
+            code = str;
+
+        } else if (type.Contains("SFBigUintArray") || type.Contains("SFTopicArray")) {
+            SFString str = STR_CASE_CODE_STRINGARRAY;
+            // hack for getCount clause
+            str.Replace("[{FIELD}]", field);
+            // hack for the array access
+            str.Replace("[{FIELD}][i]", "fromTopic("+field+"[i])");
+            code = str;
+
+        } else if (type.Contains("Array")) {
+            SFString str = STR_CASE_CODE_ARRAY;
+            if (type.Contains("SFUint") || type.Contains("SFBlock"))
+                str.ReplaceAll("[{PTR}][{FIELD}][i].Format()", "asStringU([{PTR}][{FIELD}][i])");
+            str.ReplaceAll("[{FIELD}]", field);
+            code = str;
+
+        } else if (isObject) {
+            code = " expContext().noFrst=true; return [{PTR}]" + field + ".Format();";
+
+        } else {
+            code = " return [{PTR}]" + field + ";";
         }
+
+        code.ReplaceAll("[BTAB]", baseTab);
+        caseCode += baseTab + "case " + fieldID(field) + ":" + caseBody(code) + "\n";
+        if (type.Contains("Array"))
+            caseCode += baseTab + "case " + fieldID(field + "Cnt") + ": return asStringU([{PTR}]" + field + ".getCount());\n";
     }
-    caseCode.ReplaceAll("[BTAB]", baseTab);
-    caseCode = "// Return field values\n\tswitch (tolower(fieldName[0])) {\n" + caseCode + "\t}\n";
+    caseCode = "// Return field values\n\tswitch ([{LONG}]FieldTable.find(fieldName)) {\n" + caseCode +
+                    "\t\tdefault:\n\t\t\tbreak;\n\t}\n";
     return caseCode;
 }
 
@@ -573,114 +591,185 @@ SFString strArraySet =
 SFString getCaseSetCode(const SFString& fieldCase) {
     SFString baseTab = (tab+tab);
     SFString caseCode;
-    for (char ch = '_' ; ch < 'z' + 1 ; ch++) {
-        if (fieldCase.ContainsI("+"+SFString(ch))) {
-            caseCode += baseTab + "case '" + ch + "':\n";
-            SFString fields = fieldCase;
-            while (!fields.empty()) {
-                SFString isObj = nextTokenClear(fields, '|');
-                SFString type  = nextTokenClear(isObj, '+');
-                SFString field = nextTokenClear(isObj, '-');
-                SFString isPtr = nextTokenClear(isObj, '~');
-                bool     isPointer = atoi((const char*)isPtr);
-                bool     isObject = atoi((const char*)isObj);
+    SFString fields = fieldCase;
+    while (!fields.empty()) {
+        SFString isObj = nextTokenClear(fields, '|');
+        SFString type  = nextTokenClear(isObj, '+');
+        SFString field = nextTokenClear(isObj, '-');
+        SFString isPtr = nextTokenClear(isObj, '~');
+        bool     isPointer = atoi((const char*)isPtr);
+        bool     isObject = atoi((const char*)isObj);
 
-                if (tolower(field[0]) == ch) {
-                    caseCode += baseTab + tab + "if ( fieldName % \"" + field + "\" )";
-                    if (type.Contains("List") || isPointer) {
-                        SFString ptrCase = PTR_SET_CASE;
-                        ptrCase.ReplaceAll("[{NAME}]", field);
-                        ptrCase.ReplaceAll("[{TYPE}]", type);
-                        caseCode += ptrCase;
+        SFString code;
+        if (type.Contains("List") || isPointer) {
+            SFString ptrCase = PTR_SET_CASE;
+            ptrCase.ReplaceAll("[{NAME}]", field);
+            ptrCase.ReplaceAll("[{TYPE}]", type);
+            code = ptrCase;
 
-                    } else if (type == "time") {
-                        caseCode += " { " + field + " = parseDate(fieldValue); return true; }";
+        } else if (type == "time") {
+            code = " " + field + " = parseDate(fieldValue); return true;";
 
-                    } else if (type == "bbool" || type == "bool") {
-                        caseCode +=  " { " + field + " = toBool(fieldValue); return true; }";
+        } else if (type == "bbool" || type == "bool") {
+            code = " " + field + " = toBool(fieldValue); return true;";
 
-                    } else if (type == "bloom") {
-                        caseCode +=  " { " + field + " = toBloom(fieldValue); return true; }";
+        } else if (type == "bloom") {
+            code = " " + field + " = toBloom(fieldValue); return true;";
 
-                    } else if (type == "wei") {
-                        caseCode +=  " { " + field + " = toWei(fieldValue); return true; }";
+        } else if (type == "wei") {
+            code = " " + field + " = toWei(fieldValue); return true;";
 
-                    } else if (type == "gas") {
-                        caseCode +=  " { " + field + " = toGas(fieldValue); return true; }";
+        } else if (type == "gas") {
+            code = " " + field + " = toGas(fieldValue); return true;";
 
-                    } else if (type == "timestamp") {
-                        caseCode +=  " { " + field + " = toTimestamp(fieldValue); return true; }";
+        } else if (type == "timestamp") {
+            code = " " + field + " = toTimestamp(fieldValue); return true;";
 
-                    } else if (type == "addr" || type == "address") {
-                        caseCode += " { " + field + " = toAddress(fieldValue); return true; }";
+        } else if (type == "addr" || type == "address" || type == "address20") {
+            code = " " + field + " = toAddress(fieldValue); return true;";
 
-                    } else if (type == "hash") {
-                        caseCode += " { " + field + " = toHash(fieldValue); return true; }";
+        } else if (type == "hash" || type == "hash32") {
+            code = " " + field + " = toHash(fieldValue); return true;";
 
-                    } else if (type.Contains("bytes")) {
-                        caseCode += " { " + field + " = toLower(fieldValue); return true; }";
+        } else if (type.Contains("bytes")) {
+            code = " " + field + " = toLower(fieldValue); return true;";
 
-                    } else if (type == "int8" || type == "int16" || type == "int32") {
-                        caseCode +=  " { " + field + " = toLong32(fieldValue); return true; }";
+        } else if (type == "int8" || type == "int16" || type == "int32") {
+            code = " " + field + " = toLong32(fieldValue); return true;";
 
-                    } else if (type == "int64") {
-                        caseCode +=  " { " + field + " = toLong(fieldValue); return true; }";
+        } else if (type == "int64") {
+            code = " " + field + " = toLong(fieldValue); return true;";
 
-                    } else if (type == "int256") {
-                        caseCode +=  " { " + field + " = toLong(fieldValue); return true; }";
+        } else if (type == "int256") {
+            code = " " + field + " = toLong(fieldValue); return true;";
 
-                    } else if (type == "uint8" || type == "uint16" || type == "uint32") {
-                        caseCode +=  " { " + field + " = toLong32u(fieldValue); return true; }";
+        } else if (type == "uint8" || type == "uint16" || type == "uint32") {
+            code = " " + field + " = toLong32u(fieldValue); return true;";
 
-                    } else if (type == "uint64") {
-                        caseCode +=  " { " + field + " = toUnsigned(fieldValue); return true; }";
+        } else if (type == "uint64") {
+            code = " " + field + " = toUnsigned(fieldValue); return true;";
 
-                    } else if (type == "uint256") {
-                        caseCode +=  " { " + field + " = toWei(fieldValue); return true; }";
+        } else if (type == "uint256") {
+            code = " " + field + " = toWei(fieldValue); return true;";
 
-                    } else if (type == "blknum") {
-                        caseCode +=  " { " + field + " = toUnsigned(fieldValue); return true; }";
+        } else if (type == "blknum") {
+            code = " " + field + " = toUnsigned(fieldValue); return true;";
 
-                    } else if (type == "double") {
-                        caseCode +=  " { " + field + " = toDouble(fieldValue); return true; }";
+        } else if (type == "double") {
+            code = " " + field + " = toDouble(fieldValue); return true;";
 
-                    } else if (type.Contains("SFStringArray") || type.Contains("SFBlockArray")) {
-                        SFString str = strArraySet;
-                        str.ReplaceAll("[{NAME}]", field);
-                        if (type.Contains("SFBlockArray"))
-                            str.ReplaceAll("nextTokenClear(str,',')", "toUnsigned(nextTokenClear(str,','))");
-                        caseCode += str;
+        } else if (type.Contains("SFStringArray") || type.Contains("SFBlockArray")) {
+            SFString str = strArraySet;
+            str.ReplaceAll("[{NAME}]", field);
+            if (type.Contains("SFBlockArray"))
+                str.ReplaceAll("nextTokenClear(str,',')", "toUnsigned(nextTokenClear(str,','))");
+            code = str;
 
-                    } else if (type.Contains("SFAddressArray") || type.Contains("SFBigUintArray") || type.Contains("SFTopicArray")) {
-                        SFString str = strArraySet;
-                        str.ReplaceAll("[{NAME}]", field);
-                        str.ReplaceAll("nextTokenClear(str,',')", "to[{TYPE}](nextTokenClear(str,','))");
-                        str.ReplaceAll("[{TYPE}]", type.substr(2).Substitute("Array", ""));
-                        caseCode += str;
+        } else if (type.Contains("SFAddressArray") || type.Contains("SFBigUintArray") || type.Contains("SFTopicArray")) {
+            SFString str = strArraySet;
+            str.ReplaceAll("[{NAME}]", field);
+            str.ReplaceAll("nextTokenClear(str,',')", "to[{TYPE}](nextTokenClear(str,','))");
+            str.ReplaceAll("[{TYPE}]", type.substr(2).Substitute("Array", ""));
+            code = str;
 
-                    } else if (type.Contains("Array")) {
-                        SFString str = STR_CASE_SET_CODE_ARRAY;
-                        str.ReplaceAll("[{NAME}]", field);
-                        str.ReplaceAll("[{TYPE}]", type.Substitute("Array", ""));
-                        caseCode += str;
+        } else if (type.Contains("Array")) {
+            SFString str = STR_CASE_SET_CODE_ARRAY;
+            str.ReplaceAll("[{NAME}]", field);
+            str.ReplaceAll("[{TYPE}]", type.Substitute("Array", ""));
+            code = str;
 
-                    } else if (isObject) {
-                        caseCode +=  " { /* " + field + " = fieldValue; */ return false; }";
+        } else if (isObject) {
+            code = " /* " + field + " = fieldValue; */ return false;";
 
-                    } else {
-                        caseCode +=  " { " + field + " = fieldValue; return true; }";
-                    }
-
-                    caseCode += "\n";
-                }
-            }
-            caseCode += baseTab + tab + "break;\n";
+        } else {
+            code = " " + field + " = fieldValue; return true;";
         }
+
+        caseCode += baseTab + "case " + fieldID(field) + ":" + caseBody(code) + "\n";
     }
 
     return caseCode + "\t\tdefault:\n\t\t\tbreak;\n";
 }
 
+//------------------------------------------------------------------------------------------------
+// The names of every field (followed by the counts of the array fields) in the order of their IDs
+void getFieldNames(const SFString& fieldCase, SFStringArray& names) {
+    SFString fields = fieldCase, counts;
+    while (!fields.empty()) {
+        SFString isObj = nextTokenClear(fields, '|');
+        SFString type  = nextTokenClear(isObj, '+');
+        SFString field = nextTokenClear(isObj, '-');
+        names[names.getCount()] = field;
+        if (type.Contains("Array"))
+            counts += (field + "Cnt|");
+    }
+    while (!counts.empty())
+        names[names.getCount()] = nextTokenClear(counts, '|');
+}
+
+//------------------------------------------------------------------------------------------------
+bool getFieldTable(const SFString& fieldCase, const SFString& baseLower, SFString& tableOut) {
+
+    SFStringArray names;
+    getFieldNames(fieldCase, names);
+
+    uint32_t seed = 0;
+    SFUintArray slots;
+    if (!CFieldTable::build(names, seed, slots))
+        return false;
+
+    SFString ids, strs, slotStr, line = "\t";
+    for (uint32_t i = 0 ; i < names.getCount() ; i++) {
+        ids += "\t" + fieldID(names[i]) + (i == 0 ? " = 1" : "") + ",\n";
+        SFString item = "\"" + names[i] + "\",";
+        if (line.length() + item.length() > 96) {
+            strs += StripTrailing(line, ' ') + "\n";
+            line = "\t";
+        }
+        line += item + " ";
+    }
+    strs += (names.getCount() ? StripTrailing(line, ' ') : "\tNULL") + "\n";
+
+    line = "\t";
+    for (uint32_t i = 0 ; i < slots.getCount() ; i++) {
+        if (i && !(i % 16)) {
+            slotStr += StripTrailing(line, ' ') + "\n";
+            line = "\t";
+        }
+        line += asStringU(slots[i]) + ", ";
+    }
+    slotStr += StripTrailing(line, ' ') + "\n";
+
+    tableOut = STR_FIELD_TABLE;
+    tableOut.Replace("[{IDS}]", ids.empty() ? "" : "enum {\n" + ids + "};\n");
+    tableOut.Replace("[{NAMES}]", strs);
+    tableOut.Replace("[{SLOTS}]", slotStr);
+    tableOut.Replace("[{NNAMES}]", asStringU(names.getCount()));
+    tableOut.Replace("[{NSLOTS}]", asStringU(slots.getCount()));
+    tableOut.Replace("[{SEED}]", asStringU(seed));
+    tableOut.ReplaceAll("[{LONG}]", baseLower);
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------
+SFString fieldID(const SFString& field) {
+    return "FLD_" + toUpper(field);
+}
+
+//------------------------------------------------------------------------------------------------
+// The case code was written for 'if' statements. Drop the braces from single statements and
+// bring the rest back one tab to sit under the 'case'.
+SFString caseBody(const SFString& code) {
+    if (!code.Contains("\n") && code.startsWith(" { ") && code.endsWith(" }"))
+        return " " + code.substr(3, code.length() - 5);
+    SFString ret, lines = code;
+    while (!lines.empty()) {
+        SFString line = nextTokenClear(lines, '\n');
+        ret += (ret.empty() ? line : "\n" + (line.startsWith('\t') ? line.substr(1) : line));
+    }
+    return ret;
+}
+
 //------------------------------------------------------------------------------------------------------------
 const char* STR_CLASSFILE =
 "class:\t\t[CLASS_NAME]\n"
@@ -705,8 +794,6 @@ const char* STR_CASE_SET_CODE_ARRAY =
 const char* STR_CASE_CODE_ARRAY =
 " {\n"
 "[BTAB]\t\tuint32_t cnt = [{PTR}][{FIELD}].getCount();\n"
-"[BTAB]\t\tif (fieldName.endsWith(\"Cnt\"))\n"
-"[BTAB]\t\t\treturn asStringU(cnt);\n"
 "[BTAB]\t\tif (!cnt) return \"\";\n"
 "[BTAB]\t\tSFString retS;\n"
 "[BTAB]\t\tfor (uint32_t i = 0 ; i < cnt ; i++) {\n"
@@ -720,8 +807,6 @@ const char* STR_CASE_CODE_ARRAY =
 const char* STR_CASE_CODE_STRINGARRAY =
 " {\n"
 "[BTAB]\t\tuint32_t cnt = [{PTR}][{FIELD}].getCount();\n"
-"[BTAB]\t\tif (fieldName.endsWith(\"Cnt\"))\n"
-"[BTAB]\t\t\treturn asStringU(cnt);\n"
 "[BTAB]\t\tif (!cnt) return \"\";\n"
 "[BTAB]\t\tSFString retS;\n"
 "[BTAB]\t\tfor (uint32_t i = 0 ; i < cnt ; i++) {\n"
@@ -731,6 +816,20 @@ const char* STR_CASE_CODE_STRINGARRAY =
 "[BTAB]\t\treturn retS;\n"
 "[BTAB]\t}";
 
+//------------------------------------------------------------------------------------------------------------
+const char* STR_FIELD_TABLE =
+"//---------------------------------------------------------------------------\n"
+"// makeClass chose the seed so that no two of these names share a slot in the table\n"
+"[{IDS}]"
+"static const char *[{LONG}]FieldNames[] = {\n"
+"[{NAMES}]"
+"};\n"
+"static const uint8_t [{LONG}]FieldSlots[] = {\n"
+"[{SLOTS}]"
+"};\n"
+"static const CFieldTable [{LONG}]FieldTable([{LONG}]FieldNames, [{NNAMES}], [{LONG}]FieldSlots, [{NSLOTS}], [{SEED}]);\n"
+"\n";
+
 //------------------------------------------------------------------------------------------------------------
 const char* STR_COMMENT_LINE =
 "//---------------------------------------------------------------------------\n";
@@ -805,6 +904,54 @@ const char *STR_GETOBJ_CODE =
 "[{FIELDS}]\treturn NULL;\n"
 "}\n\n";
 
+//------------------------------------------------------------------------------------------------------------
+const char *STR_PARSETAPE_HEAD =
+"\tbool parseTape(CJsonTape& tape, uint32_t node) override;\n";
+
+//------------------------------------------------------------------------------------------------------------
+const char *STR_PARSETAPE_CODE_OBJECT =
+"\t\t\tcase [{ID}]:\n"
+"\t\t\t\tif (tape.isObject(val)) {\n"
+"\t\t\t\t\t[{FIELD}].parseTape(tape, val);\n"
+"\t\t\t\t\tcontinue;\n"
+"\t\t\t\t}\n"
+"\t\t\t\tbreak;\n";
+
+//------------------------------------------------------------------------------------------------------------
+const char *STR_PARSETAPE_CODE_ARRAY =
+"\t\t\tcase [{ID}]:\n"
+"\t\t\t\tif (tape.isArrayOf(val, JSON_OBJECT)) {\n"
+"\t\t\t\t\tfor (uint32_t item = tape.firstItem(val) ; item != JSON_NOTOKEN ; item = tape.nextItem(val, item)) {\n"
+"\t\t\t\t\t\tif (tape.firstMember(item) != JSON_NOTOKEN)\n"
+"\t\t\t\t\t\t\t[{FIELD}][[{FIELD}].getCount()].parseTape(tape, item);\n"
+"\t\t\t\t\t}\n"
+"\t\t\t\t\tcontinue;\n"
+"\t\t\t\t}\n"
+"\t\t\t\tbreak;\n";
+
+//------------------------------------------------------------------------------------------------------------
+const char *STR_PARSETAPE_CODE =
+"//---------------------------------------------------------------------------------------------------\n"
+"bool [{CLASS_NAME}]::parseTape(CJsonTape& tape, uint32_t node) {\n"
+"\tif (!tape.isObject(node))\n"
+"\t\treturn false;\n"
+"\n"
+"\t// Objects are parsed in place from the tape. Anything else goes to setValueByName\n"
+"\tfor (uint32_t key = tape.firstMember(node) ; key != JSON_NOTOKEN ; key = tape.nextMember(node, key)) {\n"
+"\t\tuint32_t val = key + 1;\n"
+"\t\tstring_view_q name = tape.getView(key);\n"
+"\t\tswitch ([{LONG}]FieldTable.find(name.data(), name.length())) {\n"
+"[{FIELDS}]"
+"\t\t\tdefault:\n"
+"\t\t\t\tbreak;\n"
+"\t\t}\n"
+"\t\tsetValueFromTape(tape, key);\n"
+"\t}\n"
+"\tfinishParse();\n"
+"\treturn true;\n"
+"}\n"
+"\n";
+
 //------------------------------------------------------------------------------------------------------------
 const char *STR_GETSTR_HEAD =
 "\tconst SFString getStringAt(const SFString& name, uint32_t i) const override;\n";
@@ -845,6 +992,7 @@ SFString checkType(const SFString& typeIn) {
         "double",  "gas",    "hash",  "int256",    "int32",
         "int64",   "string", "time",  "timestamp", "uint256",
         "uint32",  "uint64", "uint8", "wei",       "blknum",
+        "address20", "hash32",
     };
     uint32_t cnt = sizeof(keywords) / sizeof(SFString);
     for (uint32_t i=0;i<cnt;i++) {
@@ -24,6 +24,7 @@ IMPLEMENT_NODE([{CLASS_NAME}], [{BASE_CLASS}]);
 [{SCOPE}] SFString next[{PROPER}]Chunk(const SFString& fieldIn, const void *dataPtr);
 static SFString next[{PROPER}]Chunk_custom(const SFString& fieldIn, const void *dataPtr);
 
+[{FIELD_TABLE}]
 //---------------------------------------------------------------------------
 void [{CLASS_NAME}]::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr) const {
     if (!m_showing)
@@ -34,12 +35,10 @@ void [{CLASS_NAME}]::Format(CExportContext& ctx, const SFString& fmtIn, void *da
         return;
     }
 
-    SFString fmt = fmtIn;
-    if (handleCustomFormat(ctx, fmt, dataPtr))
+    if (handleCustomFormat(ctx, fmtIn, dataPtr))
         return;
 
-    while (!fmt.empty())
-        ctx << getNextChunk(fmt, next[{PROPER}]Chunk, this);
+    formatChunks(ctx, fmtIn, next[{PROPER}]Chunk, this);
 }
 
 //---------------------------------------------------------------------------
@@ -59,12 +58,12 @@ bool [{CLASS_NAME}]::setValueByName(const SFString& fieldName, const SFString& f
     // EXISTING_CODE
 
 [{PARENT_SET}]
-    switch (tolower(fieldName[0])) {
+    switch ([{LONG}]FieldTable.find(fieldName)) {
 [FIELD_SETCASE]    }
     return false;
 }
 
-//---------------------------------------------------------------------------------------------------
+[{PARSE_TAPE}]//---------------------------------------------------------------------------------------------------
 void [{CLASS_NAME}]::finishParse() {
     // EXISTING_CODE
     // EXISTING_CODE
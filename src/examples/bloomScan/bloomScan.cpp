@@ -14,6 +14,7 @@
 #include "options.h"
 
 extern bool visitBloom(const SFString& path, void *data);
+extern bool visitIndexedBloom(const CBloomRecord& record, void *data);
 //--------------------------------------------------------------
 int main(int argc, const char *argv[]) {
 
@@ -21,12 +22,35 @@ int main(int argc, const char *argv[]) {
 
     COptions opt;
     if (opt.parseArguments(argc, argv)) {
-        forEveryBloomFile( visitBloom, &opt, opt.start, opt.nBlocks, opt.skip );
+        // The bloom index is much faster to scan. Use the bloom files only if it hasn't been built
+        if (getBloomIndex()->isValid())
+            forEveryBloomInIndex( visitIndexedBloom, &opt, opt.start, opt.nBlocks, opt.skip );
+        else
+            forEveryBloomFile( visitBloom, &opt, opt.start, opt.nBlocks, opt.skip );
     }
 
     return 0;
 }
 
+extern bool displayBloom(blknum_t bn, const CBloom2048& bloom, void *data);
+//-----------------------------------------------------------------------
+bool visitIndexedBloom(const CBloomRecord& record, void *data) {
+    // A block's records are consecutive, so we join them until we reach its last one
+    static CBloom2048 bloom;
+    if (record.which == 0)
+        bloom = 0;
+    bloom |= record.bloom;
+    if (record.which < record.nBlooms - 1)
+        return true;
+
+    COptions *options = (COptions*)data;
+    if (options->asData)
+        cout << record.blockNum << "," << record.nBlooms << "," << bitsTwiddled(bloom) << "\n";
+    else
+        displayBloom(record.blockNum, bloom, data);
+    return true;
+}
+
 //-----------------------------------------------------------------------
 bool visitBloom(const SFString& path, void *data) {
 
@@ -34,12 +58,11 @@ bool visitBloom(const SFString& path, void *data) {
         forAllFiles(path + "*", visitBloom, data);
 
     } else {
-extern bool displayBloom(blknum_t bn, const SFBloom& bloom, void *data);
         if (path.endsWith(".bin")) {
-            SFBloom bloom;
+            CBloom2048 bloom;
+            SFBloomArray blooms;
             SFArchive archive(READING_ARCHIVE);
             if (archive.Lock(path, binaryReadOnly, LOCK_NOWAIT)) {
-                SFBloomArray blooms;
                 archive >> blooms;
                 archive.Release();
                 for (uint32_t i = 0 ; i < blooms.getCount() ; i++) {
@@ -48,7 +71,7 @@ extern bool displayBloom(blknum_t bn, const SFBloom& bloom, void *data);
             }
             COptions *options = (COptions*)data;
             if (options->asData)
-                cout << bnFromPath(path) << "," << fileSize(path) << "," << bitsTwiddled(bloom) << "\n";
+                cout << bnFromPath(path) << "," << blooms.getCount() << "," << bitsTwiddled(bloom) << "\n";
             else
                 displayBloom(bnFromPath(path), bloom, data);
         }
@@ -57,7 +80,7 @@ extern bool displayBloom(blknum_t bn, const SFBloom& bloom, void *data);
 }
 
 //-------------------------------------------------------------
-bool displayBloom(blknum_t bn, const SFBloom& bloom, void *data) {
+bool displayBloom(blknum_t bn, const CBloom2048& bloom, void *data) {
     SFString s = bloom2Bytes(bloom);
     COptions *opt = (COptions*)data;
     if (opt->mode == "short") {
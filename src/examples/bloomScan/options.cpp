@@ -19,7 +19,7 @@ CParams params[] = {
     CParams( "~begin",       "block to start with"),
     CParams( "~end",         "block to end on"),
     CParams( "-mode:<mode>", "if not present, display in 'short' mode, otherwise 'full' mode"),
-    CParams( "-data",        "show results as data instead of displaying bloom filters"),
+    CParams( "-data",        "show results as data (block, number of blooms, bits set) instead of displaying bloom filters"),
     CParams( "~@skip",       "optional skip step (default 100)"),
     CParams( "",             "Scans blocks looking for saturated bloomFilters.\n"),
 };
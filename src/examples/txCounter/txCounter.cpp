@@ -16,6 +16,7 @@
 #include <iostream>
 #include <iomanip>
 char sep = '\t';
+extern bool countBlock(const CMiniBlock& block, const CMiniTrans *trans, void *data);
 
 //-------------------------------------------------------------------------
 class CCounter {
@@ -28,7 +29,7 @@ public:
     CCounter(void) :
         startBlock(0), nFull(0), nEmpty(0), nTrans(0), nTraces(0)
         {}
-    void countOne(const CBlock& block);
+    void countOne(const CMiniBlock& block);
     void loadFromFile(void) {
         SFString contents = asciiFileToString("./data/countsByWeek.txt");
         SFString last;
@@ -68,25 +69,22 @@ int main(int argc, char *argv[])
 
     CCounter counter;
     counter.loadFromFile();
+    // The mini-blocks have everything we count, and they're memory mapped, so there's nothing to
+    // read or parse. Only non-empty blocks are in the database.
     blknum_t latest = getLatestBlockFromCache();
-    for (blknum_t i = counter.startBlock-1 ; i < latest ; i++) {
-        SFString fileName = getBinaryFilename(i);
-        if (fileExists(fileName)) {
-            CBlock block;
-            readFromBinary(block, fileName);
-            counter.countOne(block);
-        } else {
-            if (verbose) {
-                cerr << "scanning: " << fileName << "\r";
-                cerr.flush();
-            }
-        }
-    }
+    forEveryMiniBlockInMemory(countBlock, &counter, counter.startBlock-1, latest - counter.startBlock + 1);
     return 0;
 }
 
 //-------------------------------------------------------------------------
-void CCounter::countOne(const CBlock &block) {
+bool countBlock(const CMiniBlock& block, const CMiniTrans *trans, void *data) {
+    CCounter *counter = reinterpret_cast<CCounter*>(data);
+    counter->countOne(block);
+    return true;
+}
+
+//-------------------------------------------------------------------------
+void CCounter::countOne(const CMiniBlock& block) {
 
 #ifdef SUBTOTAL_EVERY_X_BLOCKS
     static blknum_t last = startBlock;
@@ -101,7 +99,7 @@ void CCounter::countOne(const CBlock &block) {
 #endif
 #endif
 
-    uint64_t tCount = block.transactions.getCount();
+    uint64_t tCount = block.nTrans;
     nFull++;
     nEmpty = (block.blockNumber - nFull);
     nTrans += tCount;
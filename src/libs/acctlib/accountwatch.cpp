@@ -26,6 +26,26 @@ IMPLEMENT_NODE(CAccountWatch, CBaseNode);
 static SFString nextAccountwatchChunk(const SFString& fieldIn, const void *dataPtr);
 static SFString nextAccountwatchChunk_custom(const SFString& fieldIn, const void *dataPtr);
 
+//---------------------------------------------------------------------------
+// makeClass chose the seed so that no two of these names share a slot in the table
+enum {
+    FLD_ADDRESS = 1,
+    FLD_NAME,
+    FLD_COLOR,
+    FLD_FIRSTBLOCK,
+    FLD_LASTBLOCK,
+    FLD_DEEPSCAN,
+    FLD_QBIS,
+    FLD_NODEBAL,
+};
+static const char *accountwatchFieldNames[] = {
+    "address", "name", "color", "firstBlock", "lastBlock", "deepScan", "qbis", "nodeBal",
+};
+static const uint8_t accountwatchFieldSlots[] = {
+    0, 1, 3, 7, 0, 0, 0, 8, 0, 2, 4, 6, 0, 0, 0, 5,
+};
+static const CFieldTable accountwatchFieldTable(accountwatchFieldNames, 8, accountwatchFieldSlots, 16, 1);
+
 //---------------------------------------------------------------------------
 void CAccountWatch::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr) const {
     if (!m_showing)
@@ -36,12 +56,10 @@ void CAccountWatch::Format(CExportContext& ctx, const SFString& fmtIn, void *dat
         return;
     }
 
-    SFString fmt = fmtIn;
-    if (handleCustomFormat(ctx, fmt, dataPtr))
+    if (handleCustomFormat(ctx, fmtIn, dataPtr))
         return;
 
-    while (!fmt.empty())
-        ctx << getNextChunk(fmt, nextAccountwatchChunk, this);
+    formatChunks(ctx, fmtIn, nextAccountwatchChunk, this);
 }
 
 //---------------------------------------------------------------------------
@@ -70,35 +88,46 @@ bool CAccountWatch::setValueByName(const SFString& fieldName, const SFString& fi
     }
     // EXISTING_CODE
 
-    switch (tolower(fieldName[0])) {
-        case 'a':
-            if ( fieldName % "address" ) { address = toAddress(fieldValue); return true; }
-            break;
-        case 'c':
-            if ( fieldName % "color" ) { color = fieldValue; return true; }
-            break;
-        case 'd':
-            if ( fieldName % "deepScan" ) { deepScan = toBool(fieldValue); return true; }
-            break;
-        case 'f':
-            if ( fieldName % "firstBlock" ) { firstBlock = toUnsigned(fieldValue); return true; }
-            break;
-        case 'l':
-            if ( fieldName % "lastBlock" ) { lastBlock = toUnsigned(fieldValue); return true; }
-            break;
-        case 'n':
-            if ( fieldName % "name" ) { name = fieldValue; return true; }
-            if ( fieldName % "nodeBal" ) { nodeBal = toWei(fieldValue); return true; }
-            break;
-        case 'q':
-            if ( fieldName % "qbis" ) { /* qbis = fieldValue; */ return false; }
-            break;
+    switch (accountwatchFieldTable.find(fieldName)) {
+        case FLD_ADDRESS: address = toAddress(fieldValue); return true;
+        case FLD_NAME: name = fieldValue; return true;
+        case FLD_COLOR: color = fieldValue; return true;
+        case FLD_FIRSTBLOCK: firstBlock = toUnsigned(fieldValue); return true;
+        case FLD_LASTBLOCK: lastBlock = toUnsigned(fieldValue); return true;
+        case FLD_DEEPSCAN: deepScan = toBool(fieldValue); return true;
+        case FLD_QBIS: /* qbis = fieldValue; */ return false;
+        case FLD_NODEBAL: nodeBal = toWei(fieldValue); return true;
         default:
             break;
     }
     return false;
 }
 
+//---------------------------------------------------------------------------------------------------
+bool CAccountWatch::parseTape(CJsonTape& tape, uint32_t node) {
+    if (!tape.isObject(node))
+        return false;
+
+    // Objects are parsed in place from the tape. Anything else goes to setValueByName
+    for (uint32_t key = tape.firstMember(node) ; key != JSON_NOTOKEN ; key = tape.nextMember(node, key)) {
+        uint32_t val = key + 1;
+        string_view_q name = tape.getView(key);
+        switch (accountwatchFieldTable.find(name.data(), name.length())) {
+            case FLD_QBIS:
+                if (tape.isObject(val)) {
+                    qbis.parseTape(tape, val);
+                    continue;
+                }
+                break;
+            default:
+                break;
+        }
+        setValueFromTape(tape, key);
+    }
+    finishParse();
+    return true;
+}
+
 //---------------------------------------------------------------------------------------------------
 void CAccountWatch::finishParse() {
     // EXISTING_CODE
@@ -225,28 +254,16 @@ SFString CAccountWatch::getValueByName(const SFString& fieldName) const {
         return ret;
 
     // Return field values
-    switch (tolower(fieldName[0])) {
-        case 'a':
-            if ( fieldName % "address" ) return fromAddress(address);
-            break;
-        case 'c':
-            if ( fieldName % "color" ) return color;
-            break;
-        case 'd':
-            if ( fieldName % "deepScan" ) return asString(deepScan);
-            break;
-        case 'f':
-            if ( fieldName % "firstBlock" ) return asStringU(firstBlock);
-            break;
-        case 'l':
-            if ( fieldName % "lastBlock" ) return asStringU(lastBlock);
-            break;
-        case 'n':
-            if ( fieldName % "name" ) return name;
-            if ( fieldName % "nodeBal" ) return fromWei(nodeBal);
-            break;
-        case 'q':
-            if ( fieldName % "qbis" ) { expContext().noFrst=true; return qbis.Format(); }
+    switch (accountwatchFieldTable.find(fieldName)) {
+        case FLD_ADDRESS: return fromAddress(address);
+        case FLD_NAME: return name;
+        case FLD_COLOR: return color;
+        case FLD_FIRSTBLOCK: return asStringU(firstBlock);
+        case FLD_LASTBLOCK: return asStringU(lastBlock);
+        case FLD_DEEPSCAN: return asString(deepScan);
+        case FLD_QBIS: expContext().noFrst=true; return qbis.Format();
+        case FLD_NODEBAL: return fromWei(nodeBal);
+        default:
             break;
     }
 
@@ -57,6 +57,7 @@ public:
 
     DECLARE_NODE(CAccountWatch);
 
+    bool parseTape(CJsonTape& tape, uint32_t node) override;
     const CBaseNode *getObjectAt(const SFString& fieldName, uint32_t index) const override;
 
     // EXISTING_CODE
@@ -64,7 +65,7 @@ public:
     : address(toLower(_addr)), name(_name), color(_color), firstBlock(fB), lastBlock(lB) {}
     SFString displayName(bool expand, bool terse, uint32_t w1=20, uint32_t w2=8) const { return displayName(expand, true,terse,w1,w2); }
     SFString displayName(bool expand, bool useColor, bool terse, uint32_t w1=20, uint32_t w2=8) const;
-    SFBloom bloom;
+    CBloom2048 bloom;
     bool inBlock;
     CBalanceHistoryArray balanceHistory;
     // EXISTING_CODE
@@ -25,6 +25,20 @@ IMPLEMENT_NODE(CAcctCacheItem, CBaseNode);
 static SFString nextAcctcacheitemChunk(const SFString& fieldIn, const void *dataPtr);
 static SFString nextAcctcacheitemChunk_custom(const SFString& fieldIn, const void *dataPtr);
 
+//---------------------------------------------------------------------------
+// makeClass chose the seed so that no two of these names share a slot in the table
+enum {
+    FLD_BLOCKNUM = 1,
+    FLD_TRANSINDEX,
+};
+static const char *acctcacheitemFieldNames[] = {
+    "blockNum", "transIndex",
+};
+static const uint8_t acctcacheitemFieldSlots[] = {
+    0, 1, 2, 0,
+};
+static const CFieldTable acctcacheitemFieldTable(acctcacheitemFieldNames, 2, acctcacheitemFieldSlots, 4, 1);
+
 //---------------------------------------------------------------------------
 void CAcctCacheItem::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr) const {
 
@@ -38,12 +52,10 @@ void CAcctCacheItem::Format(CExportContext& ctx, const SFString& fmtIn, void *da
         return;
     }
 
-    SFString fmt = fmtIn;
-    if (handleCustomFormat(ctx, fmt, dataPtr))
+    if (handleCustomFormat(ctx, fmtIn, dataPtr))
         return;
 
-    while (!fmt.empty())
-        ctx << getNextChunk(fmt, nextAcctcacheitemChunk, this);
+    formatChunks(ctx, fmtIn, nextAcctcacheitemChunk, this);
 }
 
 //---------------------------------------------------------------------------
@@ -62,13 +74,9 @@ bool CAcctCacheItem::setValueByName(const SFString& fieldName, const SFString& f
     // EXISTING_CODE
     // EXISTING_CODE
 
-    switch (tolower(fieldName[0])) {
-        case 'b':
-            if ( fieldName % "blockNum" ) { blockNum = toUnsigned(fieldValue); return true; }
-            break;
-        case 't':
-            if ( fieldName % "transIndex" ) { transIndex = toUnsigned(fieldValue); return true; }
-            break;
+    switch (acctcacheitemFieldTable.find(fieldName)) {
+        case FLD_BLOCKNUM: blockNum = toUnsigned(fieldValue); return true;
+        case FLD_TRANSINDEX: transIndex = toUnsigned(fieldValue); return true;
         default:
             break;
     }
@@ -182,12 +190,10 @@ SFString CAcctCacheItem::getValueByName(const SFString& fieldName) const {
         return ret;
 
     // Return field values
-    switch (tolower(fieldName[0])) {
-        case 'b':
-            if ( fieldName % "blockNum" ) return asStringU(blockNum);
-            break;
-        case 't':
-            if ( fieldName % "transIndex" ) return asStringU(transIndex);
+    switch (acctcacheitemFieldTable.find(fieldName)) {
+        case FLD_BLOCKNUM: return asStringU(blockNum);
+        case FLD_TRANSINDEX: return asStringU(transIndex);
+        default:
             break;
     }
 
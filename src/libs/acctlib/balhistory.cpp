@@ -26,6 +26,21 @@ IMPLEMENT_NODE(CBalHistory, CBaseNode);
 static SFString nextBalhistoryChunk(const SFString& fieldIn, const void *dataPtr);
 static SFString nextBalhistoryChunk_custom(const SFString& fieldIn, const void *dataPtr);
 
+//---------------------------------------------------------------------------
+// makeClass chose the seed so that no two of these names share a slot in the table
+enum {
+    FLD_RECORDID = 1,
+    FLD_TIMESTAMP,
+    FLD_BALANCE,
+};
+static const char *balhistoryFieldNames[] = {
+    "recordID", "timestamp", "balance",
+};
+static const uint8_t balhistoryFieldSlots[] = {
+    0, 0, 1, 0, 2, 0, 0, 3,
+};
+static const CFieldTable balhistoryFieldTable(balhistoryFieldNames, 3, balhistoryFieldSlots, 8, 0);
+
 //---------------------------------------------------------------------------
 void CBalHistory::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr) const {
 
@@ -39,12 +54,10 @@ void CBalHistory::Format(CExportContext& ctx, const SFString& fmtIn, void *dataP
         return;
     }
 
-    SFString fmt = fmtIn;
-    if (handleCustomFormat(ctx, fmt, dataPtr))
+    if (handleCustomFormat(ctx, fmtIn, dataPtr))
         return;
 
-    while (!fmt.empty())
-        ctx << getNextChunk(fmt, nextBalhistoryChunk, this);
+    formatChunks(ctx, fmtIn, nextBalhistoryChunk, this);
 }
 
 //---------------------------------------------------------------------------
@@ -63,16 +76,10 @@ bool CBalHistory::setValueByName(const SFString& fieldName, const SFString& fiel
     // EXISTING_CODE
     // EXISTING_CODE
 
-    switch (tolower(fieldName[0])) {
-        case 'b':
-            if ( fieldName % "balance" ) { balance = toLong(fieldValue); return true; }
-            break;
-        case 'r':
-            if ( fieldName % "recordID" ) { recordID = fieldValue; return true; }
-            break;
-        case 't':
-            if ( fieldName % "timestamp" ) { timestamp = toTimestamp(fieldValue); return true; }
-            break;
+    switch (balhistoryFieldTable.find(fieldName)) {
+        case FLD_RECORDID: recordID = fieldValue; return true;
+        case FLD_TIMESTAMP: timestamp = toTimestamp(fieldValue); return true;
+        case FLD_BALANCE: balance = toLong(fieldValue); return true;
         default:
             break;
     }
@@ -201,15 +208,11 @@ SFString CBalHistory::getValueByName(const SFString& fieldName) const {
         return ret;
 
     // Return field values
-    switch (tolower(fieldName[0])) {
-        case 'b':
-            if ( fieldName % "balance" ) return asStringBN(balance);
-            break;
-        case 'r':
-            if ( fieldName % "recordID" ) return recordID;
-            break;
-        case 't':
-            if ( fieldName % "timestamp" ) return fromTimestamp(timestamp);
+    switch (balhistoryFieldTable.find(fieldName)) {
+        case FLD_RECORDID: return recordID;
+        case FLD_TIMESTAMP: return fromTimestamp(timestamp);
+        case FLD_BALANCE: return asStringBN(balance);
+        default:
             break;
     }
 
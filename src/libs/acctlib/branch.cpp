@@ -26,6 +26,19 @@ IMPLEMENT_NODE(CBranch, CTreeNode);
 static SFString nextBranchChunk(const SFString& fieldIn, const void *dataPtr);
 static SFString nextBranchChunk_custom(const SFString& fieldIn, const void *dataPtr);
 
+//---------------------------------------------------------------------------
+// makeClass chose the seed so that no two of these names share a slot in the table
+enum {
+    FLD_BRANCHVALUE = 1,
+};
+static const char *branchFieldNames[] = {
+    "branchValue",
+};
+static const uint8_t branchFieldSlots[] = {
+    0, 1,
+};
+static const CFieldTable branchFieldTable(branchFieldNames, 1, branchFieldSlots, 2, 0);
+
 //---------------------------------------------------------------------------
 void CBranch::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr) const {
     if (!m_showing)
@@ -36,12 +49,10 @@ void CBranch::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr)
         return;
     }
 
-    SFString fmt = fmtIn;
-    if (handleCustomFormat(ctx, fmt, dataPtr))
+    if (handleCustomFormat(ctx, fmtIn, dataPtr))
         return;
 
-    while (!fmt.empty())
-        ctx << getNextChunk(fmt, nextBranchChunk, this);
+    formatChunks(ctx, fmtIn, nextBranchChunk, this);
 }
 
 //---------------------------------------------------------------------------
@@ -63,10 +74,8 @@ bool CBranch::setValueByName(const SFString& fieldName, const SFString& fieldVal
     if (CTreeNode::setValueByName(fieldName, fieldValue))
         return true;
 
-    switch (tolower(fieldName[0])) {
-        case 'b':
-            if ( fieldName % "branchValue" ) { branchValue = fieldValue; return true; }
-            break;
+    switch (branchFieldTable.find(fieldName)) {
+        case FLD_BRANCHVALUE: branchValue = fieldValue; return true;
         default:
             break;
     }
@@ -214,9 +223,9 @@ SFString CBranch::getValueByName(const SFString& fieldName) const {
         return ret;
 
     // Return field values
-    switch (tolower(fieldName[0])) {
-        case 'b':
-            if ( fieldName % "branchValue" ) return branchValue;
+    switch (branchFieldTable.find(fieldName)) {
+        case FLD_BRANCHVALUE: return branchValue;
+        default:
             break;
     }
 
@@ -26,6 +26,24 @@ IMPLEMENT_NODE(CIncomeStatement, CBaseNode);
 static SFString nextIncomestatementChunk(const SFString& fieldIn, const void *dataPtr);
 static SFString nextIncomestatementChunk_custom(const SFString& fieldIn, const void *dataPtr);
 
+//---------------------------------------------------------------------------
+// makeClass chose the seed so that no two of these names share a slot in the table
+enum {
+    FLD_BEGBAL = 1,
+    FLD_INFLOW,
+    FLD_OUTFLOW,
+    FLD_GASCOST,
+    FLD_ENDBAL,
+    FLD_BLOCKNUM,
+};
+static const char *incomestatementFieldNames[] = {
+    "begBal", "inflow", "outflow", "gasCost", "endBal", "blockNum",
+};
+static const uint8_t incomestatementFieldSlots[] = {
+    0, 2, 0, 6, 0, 0, 0, 0, 0, 5, 0, 0, 1, 3, 0, 4,
+};
+static const CFieldTable incomestatementFieldTable(incomestatementFieldNames, 6, incomestatementFieldSlots, 16, 0);
+
 //---------------------------------------------------------------------------
 void CIncomeStatement::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr) const {
     if (!m_showing)
@@ -36,12 +54,10 @@ void CIncomeStatement::Format(CExportContext& ctx, const SFString& fmtIn, void *
         return;
     }
 
-    SFString fmt = fmtIn;
-    if (handleCustomFormat(ctx, fmt, dataPtr))
+    if (handleCustomFormat(ctx, fmtIn, dataPtr))
         return;
 
-    while (!fmt.empty())
-        ctx << getNextChunk(fmt, nextIncomestatementChunk, this);
+    formatChunks(ctx, fmtIn, nextIncomestatementChunk, this);
 }
 
 //---------------------------------------------------------------------------
@@ -60,23 +76,13 @@ bool CIncomeStatement::setValueByName(const SFString& fieldName, const SFString&
     // EXISTING_CODE
     // EXISTING_CODE
 
-    switch (tolower(fieldName[0])) {
-        case 'b':
-            if ( fieldName % "begBal" ) { begBal = toLong(fieldValue); return true; }
-            if ( fieldName % "blockNum" ) { blockNum = toUnsigned(fieldValue); return true; }
-            break;
-        case 'e':
-            if ( fieldName % "endBal" ) { endBal = toLong(fieldValue); return true; }
-            break;
-        case 'g':
-            if ( fieldName % "gasCost" ) { gasCost = toLong(fieldValue); return true; }
-            break;
-        case 'i':
-            if ( fieldName % "inflow" ) { inflow = toLong(fieldValue); return true; }
-            break;
-        case 'o':
-            if ( fieldName % "outflow" ) { outflow = toLong(fieldValue); return true; }
-            break;
+    switch (incomestatementFieldTable.find(fieldName)) {
+        case FLD_BEGBAL: begBal = toLong(fieldValue); return true;
+        case FLD_INFLOW: inflow = toLong(fieldValue); return true;
+        case FLD_OUTFLOW: outflow = toLong(fieldValue); return true;
+        case FLD_GASCOST: gasCost = toLong(fieldValue); return true;
+        case FLD_ENDBAL: endBal = toLong(fieldValue); return true;
+        case FLD_BLOCKNUM: blockNum = toUnsigned(fieldValue); return true;
         default:
             break;
     }
@@ -214,22 +220,14 @@ SFString CIncomeStatement::getValueByName(const SFString& fieldName) const {
         return ret;
 
     // Return field values
-    switch (tolower(fieldName[0])) {
-        case 'b':
-            if ( fieldName % "begBal" ) return asStringBN(begBal);
-            if ( fieldName % "blockNum" ) return asStringU(blockNum);
-            break;
-        case 'e':
-            if ( fieldName % "endBal" ) return asStringBN(endBal);
-            break;
-        case 'g':
-            if ( fieldName % "gasCost" ) return asStringBN(gasCost);
-            break;
-        case 'i':
-            if ( fieldName % "inflow" ) return asStringBN(inflow);
-            break;
-        case 'o':
-            if ( fieldName % "outflow" ) return asStringBN(outflow);
+    switch (incomestatementFieldTable.find(fieldName)) {
+        case FLD_BEGBAL: return asStringBN(begBal);
+        case FLD_INFLOW: return asStringBN(inflow);
+        case FLD_OUTFLOW: return asStringBN(outflow);
+        case FLD_GASCOST: return asStringBN(gasCost);
+        case FLD_ENDBAL: return asStringBN(endBal);
+        case FLD_BLOCKNUM: return asStringU(blockNum);
+        default:
             break;
     }
 
@@ -26,6 +26,19 @@ IMPLEMENT_NODE(CInfix, CTreeNode);
 static SFString nextInfixChunk(const SFString& fieldIn, const void *dataPtr);
 static SFString nextInfixChunk_custom(const SFString& fieldIn, const void *dataPtr);
 
+//---------------------------------------------------------------------------
+// makeClass chose the seed so that no two of these names share a slot in the table
+enum {
+    FLD_NEXT = 1,
+};
+static const char *infixFieldNames[] = {
+    "next",
+};
+static const uint8_t infixFieldSlots[] = {
+    0, 1,
+};
+static const CFieldTable infixFieldTable(infixFieldNames, 1, infixFieldSlots, 2, 0);
+
 //---------------------------------------------------------------------------
 void CInfix::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr) const {
     if (!m_showing)
@@ -36,12 +49,10 @@ void CInfix::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr) c
         return;
     }
 
-    SFString fmt = fmtIn;
-    if (handleCustomFormat(ctx, fmt, dataPtr))
+    if (handleCustomFormat(ctx, fmtIn, dataPtr))
         return;
 
-    while (!fmt.empty())
-        ctx << getNextChunk(fmt, nextInfixChunk, this);
+    formatChunks(ctx, fmtIn, nextInfixChunk, this);
 }
 
 //---------------------------------------------------------------------------
@@ -63,20 +74,18 @@ bool CInfix::setValueByName(const SFString& fieldName, const SFString& fieldValu
     if (CTreeNode::setValueByName(fieldName, fieldValue))
         return true;
 
-    switch (tolower(fieldName[0])) {
-        case 'n':
-            if ( fieldName % "next" ) {
-                Clear();
-                next = new CTreeNode;
-                if (next) {
-                    char *p = cleanUpJson((char *)fieldValue.c_str());
-                    uint32_t nFields = 0;
-                    next->parseJson(p, nFields);
-                    return true;
-                }
-                return false;
+    switch (infixFieldTable.find(fieldName)) {
+        case FLD_NEXT: {
+            Clear();
+            next = new CTreeNode;
+            if (next) {
+                char *p = cleanUpJson((char *)fieldValue.c_str());
+                uint32_t nFields = 0;
+                next->parseJson(p, nFields);
+                return true;
             }
-            break;
+            return false;
+        }
         default:
             break;
     }
@@ -203,13 +212,13 @@ SFString CInfix::getValueByName(const SFString& fieldName) const {
         return ret;
 
     // Return field values
-    switch (tolower(fieldName[0])) {
-        case 'n':
-            if ( fieldName % "next" ) {
-                if (next)
-                    return next->Format();
-                return "";
-            }
+    switch (infixFieldTable.find(fieldName)) {
+        case FLD_NEXT: {
+            if (next)
+                return next->Format();
+            return "";
+        }
+        default:
             break;
     }
 
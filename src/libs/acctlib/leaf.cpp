@@ -26,6 +26,21 @@ IMPLEMENT_NODE(CLeaf, CTreeNode);
 static SFString nextLeafChunk(const SFString& fieldIn, const void *dataPtr);
 static SFString nextLeafChunk_custom(const SFString& fieldIn, const void *dataPtr);
 
+//---------------------------------------------------------------------------
+// makeClass chose the seed so that no two of these names share a slot in the table
+enum {
+    FLD_BLOCKS = 1,
+    FLD_COUNTER,
+    FLD_BLOCKSCNT,
+};
+static const char *leafFieldNames[] = {
+    "blocks", "counter", "blocksCnt",
+};
+static const uint8_t leafFieldSlots[] = {
+    0, 2, 0, 0, 0, 3, 0, 1,
+};
+static const CFieldTable leafFieldTable(leafFieldNames, 3, leafFieldSlots, 8, 1);
+
 //---------------------------------------------------------------------------
 void CLeaf::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr) const {
     if (!m_showing)
@@ -36,12 +51,10 @@ void CLeaf::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr) co
         return;
     }
 
-    SFString fmt = fmtIn;
-    if (handleCustomFormat(ctx, fmt, dataPtr))
+    if (handleCustomFormat(ctx, fmtIn, dataPtr))
         return;
 
-    while (!fmt.empty())
-        ctx << getNextChunk(fmt, nextLeafChunk, this);
+    formatChunks(ctx, fmtIn, nextLeafChunk, this);
 }
 
 //---------------------------------------------------------------------------
@@ -63,19 +76,15 @@ bool CLeaf::setValueByName(const SFString& fieldName, const SFString& fieldValue
     if (CTreeNode::setValueByName(fieldName, fieldValue))
         return true;
 
-    switch (tolower(fieldName[0])) {
-        case 'b':
-            if ( fieldName % "blocks" ) {
-                SFString str = fieldValue;
-                while (!str.empty()) {
-                    blocks[blocks.getCount()] = toUnsigned(nextTokenClear(str,','));
-                }
-                return true;
+    switch (leafFieldTable.find(fieldName)) {
+        case FLD_BLOCKS: {
+            SFString str = fieldValue;
+            while (!str.empty()) {
+                blocks[blocks.getCount()] = toUnsigned(nextTokenClear(str,','));
             }
-            break;
-        case 'c':
-            if ( fieldName % "counter" ) { counter = toLong32u(fieldValue); return true; }
-            break;
+            return true;
+        }
+        case FLD_COUNTER: counter = toLong32u(fieldValue); return true;
         default:
             break;
     }
@@ -190,23 +199,20 @@ SFString CLeaf::getValueByName(const SFString& fieldName) const {
         return ret;
 
     // Return field values
-    switch (tolower(fieldName[0])) {
-        case 'b':
-            if ( fieldName % "blocks" || fieldName % "blocksCnt" ) {
-                uint32_t cnt = blocks.getCount();
-                if (fieldName.endsWith("Cnt"))
-                    return asStringU(cnt);
-                if (!cnt) return "";
-                SFString retS;
-                for (uint32_t i = 0 ; i < cnt ; i++) {
-                    retS += asStringU(blocks[i]);
-                    retS += ((i < cnt - 1) ? ",\n" : "\n");
-                }
-                return retS;
+    switch (leafFieldTable.find(fieldName)) {
+        case FLD_BLOCKS: {
+            uint32_t cnt = blocks.getCount();
+            if (!cnt) return "";
+            SFString retS;
+            for (uint32_t i = 0 ; i < cnt ; i++) {
+                retS += asStringU(blocks[i]);
+                retS += ((i < cnt - 1) ? ",\n" : "\n");
             }
-            break;
-        case 'c':
-            if ( fieldName % "counter" ) return asStringU(counter);
+            return retS;
+        }
+        case FLD_BLOCKSCNT: return asStringU(blocks.getCount());
+        case FLD_COUNTER: return asStringU(counter);
+        default:
             break;
     }
 
@@ -26,6 +26,20 @@ IMPLEMENT_NODE(CTreeNode, CBaseNode);
 extern SFString nextTreenodeChunk(const SFString& fieldIn, const void *dataPtr);
 static SFString nextTreenodeChunk_custom(const SFString& fieldIn, const void *dataPtr);
 
+//---------------------------------------------------------------------------
+// makeClass chose the seed so that no two of these names share a slot in the table
+enum {
+    FLD_INDEX = 1,
+    FLD_PREFIXS,
+};
+static const char *treenodeFieldNames[] = {
+    "index", "prefixS",
+};
+static const uint8_t treenodeFieldSlots[] = {
+    0, 0, 1, 2,
+};
+static const CFieldTable treenodeFieldTable(treenodeFieldNames, 2, treenodeFieldSlots, 4, 0);
+
 //---------------------------------------------------------------------------
 void CTreeNode::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr) const {
     if (!m_showing)
@@ -36,12 +50,10 @@ void CTreeNode::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr
         return;
     }
 
-    SFString fmt = fmtIn;
-    if (handleCustomFormat(ctx, fmt, dataPtr))
+    if (handleCustomFormat(ctx, fmtIn, dataPtr))
         return;
 
-    while (!fmt.empty())
-        ctx << getNextChunk(fmt, nextTreenodeChunk, this);
+    formatChunks(ctx, fmtIn, nextTreenodeChunk, this);
 }
 
 //---------------------------------------------------------------------------
@@ -60,13 +72,9 @@ bool CTreeNode::setValueByName(const SFString& fieldName, const SFString& fieldV
     // EXISTING_CODE
     // EXISTING_CODE
 
-    switch (tolower(fieldName[0])) {
-        case 'i':
-            if ( fieldName % "index" ) { index = toUnsigned(fieldValue); return true; }
-            break;
-        case 'p':
-            if ( fieldName % "prefixS" ) { prefixS = fieldValue; return true; }
-            break;
+    switch (treenodeFieldTable.find(fieldName)) {
+        case FLD_INDEX: index = toUnsigned(fieldValue); return true;
+        case FLD_PREFIXS: prefixS = fieldValue; return true;
         default:
             break;
     }
@@ -180,12 +188,10 @@ SFString CTreeNode::getValueByName(const SFString& fieldName) const {
         return ret;
 
     // Return field values
-    switch (tolower(fieldName[0])) {
-        case 'i':
-            if ( fieldName % "index" ) return asStringU(index);
-            break;
-        case 'p':
-            if ( fieldName % "prefixS" ) return prefixS;
+    switch (treenodeFieldTable.find(fieldName)) {
+        case FLD_INDEX: return asStringU(index);
+        case FLD_PREFIXS: return prefixS;
+        default:
             break;
     }
 
@@ -25,6 +25,19 @@ IMPLEMENT_NODE(CTreeRoot, CBaseNode);
 static SFString nextTreerootChunk(const SFString& fieldIn, const void *dataPtr);
 static SFString nextTreerootChunk_custom(const SFString& fieldIn, const void *dataPtr);
 
+//---------------------------------------------------------------------------
+// makeClass chose the seed so that no two of these names share a slot in the table
+enum {
+    FLD_ROOT = 1,
+};
+static const char *treerootFieldNames[] = {
+    "root",
+};
+static const uint8_t treerootFieldSlots[] = {
+    0, 1,
+};
+static const CFieldTable treerootFieldTable(treerootFieldNames, 1, treerootFieldSlots, 2, 0);
+
 //---------------------------------------------------------------------------
 void CTreeRoot::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr) const {
     if (!m_showing)
@@ -35,12 +48,10 @@ void CTreeRoot::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr
         return;
     }
 
-    SFString fmt = fmtIn;
-    if (handleCustomFormat(ctx, fmt, dataPtr))
+    if (handleCustomFormat(ctx, fmtIn, dataPtr))
         return;
 
-    while (!fmt.empty())
-        ctx << getNextChunk(fmt, nextTreerootChunk, this);
+    formatChunks(ctx, fmtIn, nextTreerootChunk, this);
 }
 
 //---------------------------------------------------------------------------
@@ -59,20 +70,18 @@ bool CTreeRoot::setValueByName(const SFString& fieldName, const SFString& fieldV
     // EXISTING_CODE
     // EXISTING_CODE
 
-    switch (tolower(fieldName[0])) {
-        case 'r':
-            if ( fieldName % "root" ) {
-                Clear();
-                root = new CTreeNode;
-                if (root) {
-                    char *p = cleanUpJson((char *)fieldValue.c_str());
-                    uint32_t nFields = 0;
-                    root->parseJson(p, nFields);
-                    return true;
-                }
-                return false;
+    switch (treerootFieldTable.find(fieldName)) {
+        case FLD_ROOT: {
+            Clear();
+            root = new CTreeNode;
+            if (root) {
+                char *p = cleanUpJson((char *)fieldValue.c_str());
+                uint32_t nFields = 0;
+                root->parseJson(p, nFields);
+                return true;
             }
-            break;
+            return false;
+        }
         default:
             break;
     }
@@ -198,13 +207,13 @@ SFString CTreeRoot::getValueByName(const SFString& fieldName) const {
         return ret;
 
     // Return field values
-    switch (tolower(fieldName[0])) {
-        case 'r':
-            if ( fieldName % "root" ) {
-                if (root)
-                    return root->Format();
-                return "";
-            }
+    switch (treerootFieldTable.find(fieldName)) {
+        case FLD_ROOT: {
+            if (root)
+                return root->Format();
+            return "";
+        }
+        default:
             break;
     }
 
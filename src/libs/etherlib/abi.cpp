@@ -26,6 +26,22 @@ IMPLEMENT_NODE(CAbi, CBaseNode);
 static SFString nextAbiChunk(const SFString& fieldIn, const void *dataPtr);
 static SFString nextAbiChunk_custom(const SFString& fieldIn, const void *dataPtr);
 
+//---------------------------------------------------------------------------
+// makeClass chose the seed so that no two of these names share a slot in the table
+enum {
+    FLD_ABIBYNAME = 1,
+    FLD_ABIBYENCODING,
+    FLD_ABIBYNAMECNT,
+    FLD_ABIBYENCODINGCNT,
+};
+static const char *abiFieldNames[] = {
+    "abiByName", "abiByEncoding", "abiByNameCnt", "abiByEncodingCnt",
+};
+static const uint8_t abiFieldSlots[] = {
+    2, 4, 0, 0, 3, 0, 0, 1,
+};
+static const CFieldTable abiFieldTable(abiFieldNames, 4, abiFieldSlots, 8, 1);
+
 //---------------------------------------------------------------------------
 void CAbi::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr) const {
     if (!m_showing)
@@ -36,12 +52,10 @@ void CAbi::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr) con
         return;
     }
 
-    SFString fmt = fmtIn;
-    if (handleCustomFormat(ctx, fmt, dataPtr))
+    if (handleCustomFormat(ctx, fmtIn, dataPtr))
         return;
 
-    while (!fmt.empty())
-        ctx << getNextChunk(fmt, nextAbiChunk, this);
+    formatChunks(ctx, fmtIn, nextAbiChunk, this);
 }
 
 //---------------------------------------------------------------------------
@@ -60,37 +74,72 @@ bool CAbi::setValueByName(const SFString& fieldName, const SFString& fieldValue)
     // EXISTING_CODE
     // EXISTING_CODE
 
-    switch (tolower(fieldName[0])) {
-        case 'a':
-            if ( fieldName % "abiByName" ) {
-                char *p = (char *)fieldValue.c_str();
-                while (p && *p) {
-                    CFunction item;
-                    uint32_t nFields = 0;
-                    p = item.parseJson(p, nFields);
-                    if (nFields)
-                        abiByName[abiByName.getCount()] = item;
-                }
-                return true;
+    switch (abiFieldTable.find(fieldName)) {
+        case FLD_ABIBYNAME: {
+            char *p = (char *)fieldValue.c_str();
+            while (p && *p) {
+                CFunction item;
+                uint32_t nFields = 0;
+                p = item.parseJson(p, nFields);
+                if (nFields)
+                    abiByName[abiByName.getCount()] = item;
             }
-            if ( fieldName % "abiByEncoding" ) {
-                char *p = (char *)fieldValue.c_str();
-                while (p && *p) {
-                    CFunction item;
-                    uint32_t nFields = 0;
-                    p = item.parseJson(p, nFields);
-                    if (nFields)
-                        abiByEncoding[abiByEncoding.getCount()] = item;
-                }
-                return true;
+            return true;
+        }
+        case FLD_ABIBYENCODING: {
+            char *p = (char *)fieldValue.c_str();
+            while (p && *p) {
+                CFunction item;
+                uint32_t nFields = 0;
+                p = item.parseJson(p, nFields);
+                if (nFields)
+                    abiByEncoding[abiByEncoding.getCount()] = item;
             }
-            break;
+            return true;
+        }
         default:
             break;
     }
     return false;
 }
 
+//---------------------------------------------------------------------------------------------------
+bool CAbi::parseTape(CJsonTape& tape, uint32_t node) {
+    if (!tape.isObject(node))
+        return false;
+
+    // Objects are parsed in place from the tape. Anything else goes to setValueByName
+    for (uint32_t key = tape.firstMember(node) ; key != JSON_NOTOKEN ; key = tape.nextMember(node, key)) {
+        uint32_t val = key + 1;
+        string_view_q name = tape.getView(key);
+        switch (abiFieldTable.find(name.data(), name.length())) {
+            case FLD_ABIBYNAME:
+                if (tape.isArrayOf(val, JSON_OBJECT)) {
+                    for (uint32_t item = tape.firstItem(val) ; item != JSON_NOTOKEN ; item = tape.nextItem(val, item)) {
+                        if (tape.firstMember(item) != JSON_NOTOKEN)
+                            abiByName[abiByName.getCount()].parseTape(tape, item);
+                    }
+                    continue;
+                }
+                break;
+            case FLD_ABIBYENCODING:
+                if (tape.isArrayOf(val, JSON_OBJECT)) {
+                    for (uint32_t item = tape.firstItem(val) ; item != JSON_NOTOKEN ; item = tape.nextItem(val, item)) {
+                        if (tape.firstMember(item) != JSON_NOTOKEN)
+                            abiByEncoding[abiByEncoding.getCount()].parseTape(tape, item);
+                    }
+                    continue;
+                }
+                break;
+            default:
+                break;
+        }
+        setValueFromTape(tape, key);
+    }
+    finishParse();
+    return true;
+}
+
 //---------------------------------------------------------------------------------------------------
 void CAbi::finishParse() {
     // EXISTING_CODE
@@ -198,32 +247,30 @@ SFString CAbi::getValueByName(const SFString& fieldName) const {
         return ret;
 
     // Return field values
-    switch (tolower(fieldName[0])) {
-        case 'a':
-            if ( fieldName % "abiByName" || fieldName % "abiByNameCnt" ) {
-                uint32_t cnt = abiByName.getCount();
-                if (fieldName.endsWith("Cnt"))
-                    return asStringU(cnt);
-                if (!cnt) return "";
-                SFString retS;
-                for (uint32_t i = 0 ; i < cnt ; i++) {
-                    retS += abiByName[i].Format();
-                    retS += ((i < cnt - 1) ? ",\n" : "\n");
-                }
-                return retS;
+    switch (abiFieldTable.find(fieldName)) {
+        case FLD_ABIBYNAME: {
+            uint32_t cnt = abiByName.getCount();
+            if (!cnt) return "";
+            SFString retS;
+            for (uint32_t i = 0 ; i < cnt ; i++) {
+                retS += abiByName[i].Format();
+                retS += ((i < cnt - 1) ? ",\n" : "\n");
             }
-            if ( fieldName % "abiByEncoding" || fieldName % "abiByEncodingCnt" ) {
-                uint32_t cnt = abiByEncoding.getCount();
-                if (fieldName.endsWith("Cnt"))
-                    return asStringU(cnt);
-                if (!cnt) return "";
-                SFString retS;
-                for (uint32_t i = 0 ; i < cnt ; i++) {
-                    retS += abiByEncoding[i].Format();
-                    retS += ((i < cnt - 1) ? ",\n" : "\n");
-                }
-                return retS;
+            return retS;
+        }
+        case FLD_ABIBYNAMECNT: return asStringU(abiByName.getCount());
+        case FLD_ABIBYENCODING: {
+            uint32_t cnt = abiByEncoding.getCount();
+            if (!cnt) return "";
+            SFString retS;
+            for (uint32_t i = 0 ; i < cnt ; i++) {
+                retS += abiByEncoding[i].Format();
+                retS += ((i < cnt - 1) ? ",\n" : "\n");
             }
+            return retS;
+        }
+        case FLD_ABIBYENCODINGCNT: return asStringU(abiByEncoding.getCount());
+        default:
             break;
     }
 
@@ -43,6 +43,7 @@ public:
 
     DECLARE_NODE(CAbi);
 
+    bool parseTape(CJsonTape& tape, uint32_t node) override;
     const CBaseNode *getObjectAt(const SFString& fieldName, uint32_t index) const override;
 
     // EXISTING_CODE
@@ -26,6 +26,28 @@ IMPLEMENT_NODE(CABIRecord, CBaseNode);
 extern SFString nextAbirecordChunk(const SFString& fieldIn, const void *dataPtr);
 static SFString nextAbirecordChunk_custom(const SFString& fieldIn, const void *dataPtr);
 
+//---------------------------------------------------------------------------
+// makeClass chose the seed so that no two of these names share a slot in the table
+enum {
+    FLD_NAME = 1,
+    FLD_TYPE,
+    FLD_CONSTANT,
+    FLD_INPUTCNT,
+    FLD_OUTPUT0,
+    FLD_ABIITEM,
+    FLD_COUNT,
+    FLD_HASH,
+    FLD_SIGNATURE,
+};
+static const char *abirecordFieldNames[] = {
+    "name", "type", "constant", "inputcnt", "output0", "abiitem", "count", "hash", "signature",
+};
+static const uint8_t abirecordFieldSlots[] = {
+    0, 0, 0, 0, 0, 5, 0, 1, 0, 0, 0, 0, 0, 4, 0, 0,
+    0, 0, 7, 0, 6, 0, 3, 0, 2, 0, 9, 0, 0, 0, 8, 0,
+};
+static const CFieldTable abirecordFieldTable(abirecordFieldNames, 9, abirecordFieldSlots, 32, 6);
+
 //---------------------------------------------------------------------------
 void CABIRecord::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr) const {
     if (!m_showing)
@@ -36,12 +58,10 @@ void CABIRecord::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPt
         return;
     }
 
-    SFString fmt = fmtIn;
-    if (handleCustomFormat(ctx, fmt, dataPtr))
+    if (handleCustomFormat(ctx, fmtIn, dataPtr))
         return;
 
-    while (!fmt.empty())
-        ctx << getNextChunk(fmt, nextAbirecordChunk, this);
+    formatChunks(ctx, fmtIn, nextAbirecordChunk, this);
 }
 
 //---------------------------------------------------------------------------
@@ -60,32 +80,16 @@ bool CABIRecord::setValueByName(const SFString& fieldName, const SFString& field
     // EXISTING_CODE
     // EXISTING_CODE
 
-    switch (tolower(fieldName[0])) {
-        case 'a':
-            if ( fieldName % "abiitem" ) { abiitem = fieldValue; return true; }
-            break;
-        case 'c':
-            if ( fieldName % "constant" ) { constant = toBool(fieldValue); return true; }
-            if ( fieldName % "count" ) { count = toUnsigned(fieldValue); return true; }
-            break;
-        case 'h':
-            if ( fieldName % "hash" ) { hash = fieldValue; return true; }
-            break;
-        case 'i':
-            if ( fieldName % "inputcnt" ) { inputcnt = toUnsigned(fieldValue); return true; }
-            break;
-        case 'n':
-            if ( fieldName % "name" ) { name = fieldValue; return true; }
-            break;
-        case 'o':
-            if ( fieldName % "output0" ) { output0 = fieldValue; return true; }
-            break;
-        case 's':
-            if ( fieldName % "signature" ) { signature = fieldValue; return true; }
-            break;
-        case 't':
-            if ( fieldName % "type" ) { type = fieldValue; return true; }
-            break;
+    switch (abirecordFieldTable.find(fieldName)) {
+        case FLD_NAME: name = fieldValue; return true;
+        case FLD_TYPE: type = fieldValue; return true;
+        case FLD_CONSTANT: constant = toBool(fieldValue); return true;
+        case FLD_INPUTCNT: inputcnt = toUnsigned(fieldValue); return true;
+        case FLD_OUTPUT0: output0 = fieldValue; return true;
+        case FLD_ABIITEM: abiitem = fieldValue; return true;
+        case FLD_COUNT: count = toUnsigned(fieldValue); return true;
+        case FLD_HASH: hash = fieldValue; return true;
+        case FLD_SIGNATURE: signature = fieldValue; return true;
         default:
             break;
     }
@@ -232,31 +236,17 @@ SFString CABIRecord::getValueByName(const SFString& fieldName) const {
         return ret;
 
     // Return field values
-    switch (tolower(fieldName[0])) {
-        case 'a':
-            if ( fieldName % "abiitem" ) return abiitem;
-            break;
-        case 'c':
-            if ( fieldName % "constant" ) return asString(constant);
-            if ( fieldName % "count" ) return asStringU(count);
-            break;
-        case 'h':
-            if ( fieldName % "hash" ) return hash;
-            break;
-        case 'i':
-            if ( fieldName % "inputcnt" ) return asStringU(inputcnt);
-            break;
-        case 'n':
-            if ( fieldName % "name" ) return name;
-            break;
-        case 'o':
-            if ( fieldName % "output0" ) return output0;
-            break;
-        case 's':
-            if ( fieldName % "signature" ) return signature;
-            break;
-        case 't':
-            if ( fieldName % "type" ) return type;
+    switch (abirecordFieldTable.find(fieldName)) {
+        case FLD_NAME: return name;
+        case FLD_TYPE: return type;
+        case FLD_CONSTANT: return asString(constant);
+        case FLD_INPUTCNT: return asStringU(inputcnt);
+        case FLD_OUTPUT0: return output0;
+        case FLD_ABIITEM: return abiitem;
+        case FLD_COUNT: return asStringU(count);
+        case FLD_HASH: return hash;
+        case FLD_SIGNATURE: return signature;
+        default:
             break;
     }
 
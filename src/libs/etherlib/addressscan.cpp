@@ -0,0 +1,117 @@
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include "addressscan.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define SCAN_X86 1
+#endif
+
+namespace qblocks {
+
+    //-------------------------------------------------------------------------
+    // Bit 'i' of a word's zero mask is set if byte 'i' of the word is zero
+    #define LEADING_BYTES  0x00000FFFu  // must all be zero
+    #define HIGH_BYTES     0x0007F000u  // must not all be zero
+    #define TRAILING_BYTES 0xF0000000u  // must not all be zero
+
+    //-------------------------------------------------------------------------
+    static inline bool isAddrMask(uint32_t zeros) {
+        return ((zeros & LEADING_BYTES) == LEADING_BYTES &&
+                (zeros & HIGH_BYTES) != HIGH_BYTES &&
+                (zeros & TRAILING_BYTES) != TRAILING_BYTES);
+    }
+
+#ifdef SCAN_X86
+    //-------------------------------------------------------------------------
+    static inline uint32_t zeroMask(const uint8_t *word) {
+        __m128i zero = _mm_setzero_si128();
+        __m128i lo = _mm_loadu_si128((const __m128i*)word);
+        __m128i hi = _mm_loadu_si128((const __m128i*)(word + 16));
+        return (uint32_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(lo, zero)) |
+               (uint32_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(hi, zero)) << 16;
+    }
+
+    //-------------------------------------------------------------------------
+    // Turns 16 hex digits into their values. Returns false if any of them is not a hex digit.
+    static inline bool hexNibbles(const char *str, __m128i& out) {
+        __m128i v     = _mm_loadu_si128((const __m128i*)str);
+        __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+        __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+        __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+        out = _mm_or_si128(_mm_and_si128(digit, _mm_sub_epi8(v, _mm_set1_epi8('0'))),
+                           _mm_and_si128(alpha, _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10))));
+        return _mm_movemask_epi8(_mm_or_si128(digit, alpha)) == 0xFFFF;
+    }
+
+    //-------------------------------------------------------------------------
+    // Each pair of nibbles (high one first) sits in a 16-bit lane, so shift them together and
+    // pack the lanes down to bytes
+    static inline __m128i packNibbles(__m128i n0, __m128i n1) {
+        __m128i mask = _mm_set1_epi16(0x00FF);
+        __m128i b0 = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(n0, mask), 4), _mm_srli_epi16(n0, 8));
+        __m128i b1 = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(n1, mask), 4), _mm_srli_epi16(n1, 8));
+        return _mm_packus_epi16(b0, b1);
+    }
+
+    //-------------------------------------------------------------------------
+    static inline void hexToWord(const char *str, uint8_t *out) {
+        __m128i n0, n1, n2, n3;
+        bool valid = hexNibbles(str, n0) & hexNibbles(str + 16, n1) & hexNibbles(str + 32, n2) & hexNibbles(str + 48, n3);
+        if (!valid) {
+            memset(out, 0, ADDR_WORD_SIZE);
+            return;
+        }
+        _mm_storeu_si128((__m128i*)out, packNibbles(n0, n1));
+        _mm_storeu_si128((__m128i*)(out + 16), packNibbles(n2, n3));
+    }
+#else
+    //-------------------------------------------------------------------------
+    static inline uint32_t zeroMask(const uint8_t *word) {
+        uint32_t ret = 0;
+        for (uint32_t i = 0 ; i < ADDR_WORD_SIZE ; i++)
+            ret |= (uint32_t)(word[i] == 0) << i;
+        return ret;
+    }
+
+    //-------------------------------------------------------------------------
+    static inline void hexToWord(const char *str, uint8_t *out) {
+        // hexToBytes would skip a leading "0x", but here it's just two bad digits
+        if (str[1] == 'x' || str[1] == 'X' || !hexToBytes(str, ADDR_WORD_HEX, out, ADDR_WORD_SIZE))
+            memset(out, 0, ADDR_WORD_SIZE);
+    }
+#endif
+
+    //-------------------------------------------------------------------------
+    bool isPotentialAddrWord(const uint8_t *word) {
+        return isAddrMask(zeroMask(word));
+    }
+
+    //-------------------------------------------------------------------------
+    void hexToWords(const char *str, size_t nWords, uint8_t *out) {
+        for (size_t i = 0 ; i < nWords ; i++)
+            hexToWord(str + i * ADDR_WORD_HEX, out + i * ADDR_WORD_SIZE);
+    }
+
+    //-------------------------------------------------------------------------
+    size_t findPotentialAddrs(const uint8_t *words, size_t nWords, uint32_t *hits) {
+        size_t nHits = 0;
+        for (size_t i = 0 ; i < nWords ; i++) {
+            // written unconditionally and kept only on a hit, so there's no branch to mispredict
+            hits[nHits] = (uint32_t)i;
+            nHits += isAddrMask(zeroMask(words + i * ADDR_WORD_SIZE));
+        }
+        return nHits;
+    }
+
+}  // namespace qblocks
@@ -0,0 +1,39 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include "utillib.h"
+
+namespace qblocks {
+
+    //-------------------------------------------------------------------------
+    // Input, log data and topics are made of 32-byte words. A word is taken to be an address if
+    // its first twelve bytes are zero (it is less than 2^160), at least one of the next seven
+    // bytes is not (it is at least 2^104, so small numbers are not mistaken for addresses), and
+    // its last four bytes are not all zero (a heuristic: such values are far more likely to be
+    // shifted amounts than addresses). The address is the word's last twenty bytes.
+    //-------------------------------------------------------------------------
+    #define ADDR_WORD_SIZE  32
+    #define ADDR_WORD_HEX   (ADDR_WORD_SIZE * 2)
+
+    //-------------------------------------------------------------------------
+    extern bool     isPotentialAddrWord(const uint8_t *word);
+
+    // Decodes the first 'nWords' 64-digit words of the hex string 'str' into 'out'. A word with
+    // a non-hex digit in it decodes to zeros (which is never an address).
+    extern void     hexToWords(const char *str, size_t nWords, uint8_t *out);
+
+    // Tests 'nWords' consecutive words and writes the index of each potential address to 'hits'
+    // (which must have room for 'nWords' entries). Returns the number of hits.
+    extern size_t   findPotentialAddrs(const uint8_t *words, size_t nWords, uint32_t *hits);
+
+}  // namespace qblocks
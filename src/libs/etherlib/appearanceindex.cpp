@@ -0,0 +1,381 @@
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include <algorithm>
+#include "appearanceindex.h"
+
+namespace qblocks {
+
+    static_assert(sizeof(CAppearanceHeader) == 64, "appearance header must be 64 bytes");
+    static_assert(sizeof(CAppearanceEntry)  == 32, "appearance entries must be 32 bytes");
+
+    //-------------------------------------------------------------------------
+    static void putVarint(std::string& out, uint64_t val) {
+        while (val >= 0x80) {
+            out += (char)((val & 0x7f) | 0x80);
+            val >>= 7;
+        }
+        out += (char)val;
+    }
+
+    //-------------------------------------------------------------------------
+    static bool getVarint(const uint8_t*& p, const uint8_t *end, uint64_t& val) {
+        val = 0;
+        for (uint32_t shift = 0 ; p < end && shift < 64 ; shift += 7) {
+            uint8_t byte = *p++;
+            val |= (uint64_t)(byte & 0x7f) << shift;
+            if (!(byte & 0x80))
+                return true;
+        }
+        return false;
+    }
+
+    //-------------------------------------------------------------------------
+    // Transactions are stored one higher than their index so the block itself (NOPOS) is zero
+    #define txToCode(tx)   ((tx) == NOPOS ? 0 : (tx) + 1)
+    #define codeToTx(code) ((code) == 0 ? NOPOS : (code) - 1)
+
+    //-------------------------------------------------------------------------
+    static bool isValidHeader(const CAppearanceHeader *header, uint64_t fileSize) {
+        if (fileSize < sizeof(CAppearanceHeader))
+            return false;
+        if (memcmp(header->magic, APPEARANCE_MAGIC, sizeof(header->magic)))
+            return false;
+        if (header->version != APPEARANCE_VERSION)
+            return false;
+        if (header->postingsOffset != sizeof(CAppearanceHeader) + header->nAddrs * sizeof(CAppearanceEntry))
+            return false;
+        return (header->postingsOffset + header->postingsSize <= fileSize);
+    }
+
+    //-------------------------------------------------------------------------
+    CAppearanceSegment::CAppearanceSegment(void) : m_file(NULL), m_header(NULL), m_entries(NULL), m_postings(NULL) {
+    }
+
+    //-------------------------------------------------------------------------
+    CAppearanceSegment::~CAppearanceSegment(void) {
+        close();
+    }
+
+    //-------------------------------------------------------------------------
+    bool CAppearanceSegment::open(const SFString& fileName) {
+        close();
+        if (!fileExists(fileName))
+            return false;
+
+        m_file = new CMemMapFile(fileName.c_str(), CMemMapFile::WholeFile, CMemMapFile::RandomAccess);
+        if (!m_file->isValid()) {
+            close();
+            return false;
+        }
+
+        const unsigned char *data = m_file->getData();
+        const CAppearanceHeader *header = (const CAppearanceHeader *)data;
+        if (!isValidHeader(header, m_file->size())) {
+            cerr << "The appearance index at " << fileName << " is corrupted or from a different version. Ignoring it.\n";
+            close();
+            return false;
+        }
+
+        m_header   = header;
+        m_entries  = (const CAppearanceEntry *)(data + sizeof(CAppearanceHeader));
+        m_postings = data + header->postingsOffset;
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    void CAppearanceSegment::close(void) {
+        if (m_file)
+            delete m_file;
+        m_file     = NULL;
+        m_header   = NULL;
+        m_entries  = NULL;
+        m_postings = NULL;
+    }
+
+    //-------------------------------------------------------------------------
+    static bool entryLess(const CAppearanceEntry& entry, const CAddress20& addr) {
+        return memcmp(entry.addr, addr.bytes, sizeof(entry.addr)) < 0;
+    }
+
+    //-------------------------------------------------------------------------
+    uint64_t CAppearanceSegment::findAddress(const CAddress20& addr) const {
+        if (!isValid())
+            return NOPOS;
+        const CAppearanceEntry *end   = m_entries + nAddrs();
+        const CAppearanceEntry *found = std::lower_bound(m_entries, end, addr, entryLess);
+        if (found == end || memcmp(found->addr, addr.bytes, sizeof(found->addr)))
+            return NOPOS;
+        return (uint64_t)(found - m_entries);
+    }
+
+    //-------------------------------------------------------------------------
+    bool CAppearanceSegment::forEveryPosting(uint64_t index, blknum_t start, blknum_t end, APPEARANCEFUNC func, void *data) const {
+        if (!isValid() || index >= nAddrs() || !func)
+            return true;
+
+        const CAppearanceEntry& entry = m_entries[index];
+        uint64_t stop = (index + 1 < nAddrs() ? m_entries[index + 1].offset : m_header->postingsSize);
+        if (entry.offset > stop || stop > m_header->postingsSize)
+            return true;  // corrupted, but there's nothing sensible to report
+
+        const uint8_t *p = m_postings + entry.offset;
+        const uint8_t *e = m_postings + stop;
+        blknum_t bn = firstBlock();
+        uint64_t code = 0;
+        for (uint32_t i = 0 ; i < entry.count ; i++) {
+            uint64_t delta, txCode;
+            if (!getVarint(p, e, delta) || !getVarint(p, e, txCode))
+                return true;
+            bn += delta;
+            code = (delta ? txCode : code + txCode);
+            if (bn > end)
+                return true;
+            if (bn >= start && !(*func)(bn, codeToTx(code), data))
+                return false;
+        }
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    CAppearanceWriter::CAppearanceWriter(blknum_t firstBlock, uint32_t flags)
+        : m_firstBlock(firstBlock), m_lastBlock(NOPOS), m_nBlocks(0), m_flags(flags) {
+    }
+
+    //-------------------------------------------------------------------------
+    // Appearances arrive in block and transaction order, so an address's list stays sorted and
+    // a repeat (the same address more than once in a transaction) can only be the last item
+    void CAppearanceWriter::addAppearance(const CAddress20& addr, blknum_t bn, blknum_t tx) {
+        CAppearanceList& list = m_postings[addr];
+        if (!list.empty() && list.back().blockNum == bn && list.back().transIndex == tx)
+            return;
+        list.push_back(CAppearance(bn, tx));
+    }
+
+    //-------------------------------------------------------------------------
+    static bool collectAppearance(blknum_t bn, blknum_t tx, void *data) {
+        std::pair<CAppearanceWriter*, CAddress20> *p = (std::pair<CAppearanceWriter*, CAddress20> *)data;
+        p->first->addAppearance(p->second, bn, tx);
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    bool CAppearanceWriter::load(const CAppearanceSegment& segment) {
+        if (!segment.isValid() || segment.firstBlock() != m_firstBlock || segment.flags() != m_flags)
+            return false;
+        if (m_nBlocks || !m_postings.empty())
+            return false;
+
+        m_postings.reserve(segment.nAddrs());
+        for (uint64_t i = 0 ; i < segment.nAddrs() ; i++) {
+            std::pair<CAppearanceWriter*, CAddress20> p(this, segment.getAddress(i));
+            segment.forEveryPosting(i, 0, NOPOS, collectAppearance, &p);
+        }
+        m_lastBlock = segment.lastBlock();
+        m_nBlocks   = segment.nBlocks();
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    static bool addAddress(blknum_t bn, blknum_t tx, blknum_t tc, const SFAddress& addr, void *data) {
+        CAddress20 bytes;
+        if (!bytes.fromHex(addr) || bytes.isZero())
+            return true;
+        ((CAppearanceWriter*)data)->addAppearance(bytes, bn, tx);
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    // forEveryAddress only asks the node for a transaction's traces if the filter returns false
+    static bool skipTraces(const CTransaction *trans, void *data) {
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    bool CAppearanceWriter::addBlock(CBlock& block) {
+        if (block.blockNumber < m_firstBlock || block.blockNumber >= m_firstBlock + APPEARANCE_CHUNK_SIZE)
+            return false;
+        if (m_nBlocks && block.blockNumber <= m_lastBlock)
+            return false;
+
+        block.forEveryAddress(addAddress, (m_flags & APPEAR_TRACES) ? NULL : skipTraces, this);
+        m_lastBlock = block.blockNumber;
+        m_nBlocks++;
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    // The segment is written to a temporary file which is then renamed over the old one, so a
+    // reader that has the old segment mapped keeps seeing it whole
+    bool CAppearanceWriter::write(const SFString& fileName) const {
+        if (!establishFolder(fileName))
+            return false;
+
+        std::vector<CAddress20> addrs;
+        addrs.reserve(m_postings.size());
+        for (auto it = m_postings.begin() ; it != m_postings.end() ; ++it)
+            addrs.push_back(it->first);
+        std::sort(addrs.begin(), addrs.end());
+
+        std::vector<CAppearanceEntry> entries(addrs.size());
+        std::string postings;
+        for (size_t i = 0 ; i < addrs.size() ; i++) {
+            const CAppearanceList& list = m_postings.find(addrs[i])->second;
+            CAppearanceEntry& entry = entries[i];
+            memcpy(entry.addr, addrs[i].bytes, sizeof(entry.addr));
+            entry.count  = (uint32_t)list.size();
+            entry.offset = postings.size();
+
+            blknum_t prevBlock = m_firstBlock;
+            uint64_t prevCode  = 0;
+            for (size_t j = 0 ; j < list.size() ; j++) {
+                uint64_t delta = list[j].blockNum - prevBlock;
+                uint64_t code  = txToCode(list[j].transIndex);
+                putVarint(postings, delta);
+                putVarint(postings, (delta ? code : code - prevCode));
+                prevBlock = list[j].blockNum;
+                prevCode  = code;
+            }
+        }
+
+        SFString tempName = fileName + ".tmp";
+        SFArchive archive(WRITING_ARCHIVE);
+        if (!archive.Lock(tempName, binaryWriteCreate, LOCK_WAIT)) {
+            cerr << "Could not write the appearance index " << tempName << ": " << archive.LockFailure() << "\n";
+            return false;
+        }
+
+        CAppearanceHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, APPEARANCE_MAGIC, sizeof(header.magic));
+        header.version        = APPEARANCE_VERSION;
+        header.flags          = m_flags;
+        header.firstBlock     = m_firstBlock;
+        header.lastBlock      = (m_nBlocks ? m_lastBlock : m_firstBlock);
+        header.nBlocks        = m_nBlocks;
+        header.nAddrs         = entries.size();
+        header.postingsOffset = sizeof(CAppearanceHeader) + entries.size() * sizeof(CAppearanceEntry);
+        header.postingsSize   = postings.size();
+
+        archive.Write(&header, sizeof(header), 1);
+        if (entries.size())
+            archive.Write(entries.data(), sizeof(CAppearanceEntry), entries.size());
+        if (postings.size())
+            archive.Write(postings.data(), postings.size(), 1);
+        archive.Release();
+
+        return (rename(tempName.c_str(), fileName.c_str()) == 0);
+    }
+
+    //-------------------------------------------------------------------------
+    SFString getAppearanceFilename(blknum_t bn) {
+        return appearFolder + padNum9(bn - (bn % APPEARANCE_CHUNK_SIZE)) + ".bin";
+    }
+
+    //-------------------------------------------------------------------------
+    // Brings one segment of the index up to date with the block files in the cache. Unless asked
+    // to rebuild it, an existing segment is extended with the blocks past its last block. Blocks
+    // added to the cache below that (to fill a gap, say) are only picked up by a rebuild. nBlocks
+    // is the number of blocks read.
+    bool buildAppearanceChunk(uint64_t chunk, uint32_t flags, bool rebuild, uint64_t& nBlocks) {
+        nBlocks = 0;
+        blknum_t firstBlock = chunk * APPEARANCE_CHUNK_SIZE;
+        SFString fileName = getAppearanceFilename(firstBlock);
+
+        SFUintArray blocks;
+        listCachedBlocks(chunk, blocks);
+        if (!blocks.getCount())
+            return false;
+
+        CAppearanceWriter writer(firstBlock, flags);
+        if (!rebuild) {
+            CAppearanceSegment segment;
+            if (segment.open(fileName))
+                writer.load(segment);  // if the flags differ, we start over
+        }
+
+        for (uint32_t i = 0 ; i < blocks.getCount() && !shouldQuit() ; i++) {
+            if (writer.nBlocks() && blocks[i] <= writer.lastBlock())
+                continue;
+            CBlock block;
+            if (readBlockFromBinary(block, getBinaryFilename(blocks[i])) && writer.addBlock(block))
+                nBlocks++;
+        }
+        if (shouldQuit() || !nBlocks)
+            return false;
+
+        return writer.write(fileName);
+    }
+
+    //-------------------------------------------------------------------------
+    static bool collectSegment(const SFString& path, void *data) {
+        if (path.endsWith(".bin")) {
+            SFUintArray *segments = (SFUintArray*)data;
+            segments->addValue(bnFromPath(path) / APPEARANCE_CHUNK_SIZE);
+        }
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    static int sortSegments(const void *v1, const void *v2) {
+        uint64_t s1 = *(uint64_t*)v1;
+        uint64_t s2 = *(uint64_t*)v2;
+        return (s1 < s2 ? -1 : (s1 > s2 ? 1 : 0));
+    }
+
+    //-------------------------------------------------------------------------
+    // Visits every appearance of 'addr' from block 'start' to block 'end' (inclusive) in block
+    // order. Blocks that have not been indexed are not visited. Returns false if 'func' does.
+    bool forEveryAppearance(const SFAddress& addr, blknum_t start, blknum_t end, APPEARANCEFUNC func, void *data) {
+        CAddress20 bytes;
+        if (!func || !bytes.fromHex(addr))
+            return false;
+
+        SFUintArray segments;
+        forAllFiles(appearFolder + "*", collectSegment, &segments);
+        segments.Sort(sortSegments);
+
+        for (uint32_t i = 0 ; i < segments.getCount() ; i++) {
+            blknum_t first = segments[i] * APPEARANCE_CHUNK_SIZE;
+            if (first + APPEARANCE_CHUNK_SIZE <= start)
+                continue;
+            if (first > end)
+                break;
+
+            CAppearanceSegment segment;
+            if (!segment.open(getAppearanceFilename(first)))
+                continue;
+            if (!segment.forEveryPosting(segment.findAddress(bytes), start, end, func, data))
+                return false;
+        }
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    // The last block in the most recent segment of the index or NOPOS if there is no index
+    blknum_t getLastAppearanceBlock(void) {
+        if (!folderExists(appearFolder))
+            return NOPOS;
+
+        SFUintArray segments;
+        forAllFiles(appearFolder + "*", collectSegment, &segments);
+        segments.Sort(sortSegments);
+
+        for (uint32_t i = segments.getCount() ; i > 0 ; i--) {
+            CAppearanceSegment segment;
+            if (segment.open(getAppearanceFilename(segments[i-1] * APPEARANCE_CHUNK_SIZE)))
+                return segment.lastBlock();
+        }
+        return NOPOS;
+    }
+
+}  // namespace qblocks
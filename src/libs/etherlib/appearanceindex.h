@@ -0,0 +1,140 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "etherlib.h"
+
+namespace qblocks {
+
+    //-------------------------------------------------------------------------
+    // The appearance index records every (block, transaction) pair in which an address appears,
+    // as found by CBlock::forEveryAddress. It is kept in segments of 100,000 blocks (one for each
+    // second-level folder of the block cache):
+    //
+    //      header | address directory | postings
+    //
+    // The directory has one fixed-width entry per address, sorted by address, so a lookup is a
+    // binary search of the memory mapped file. Each entry points to that address's postings: its
+    // appearances in block order, each written as the distance from the previous block and the
+    // transaction index (or the distance from the previous transaction in the same block) in
+    // variable-length integers. Appearances of an address in the block itself (as its miner, for
+    // example) have a transaction index of NOPOS.
+    //-------------------------------------------------------------------------
+    #define APPEARANCE_MAGIC      "qbAppear"
+    #define APPEARANCE_VERSION    1
+    #define APPEARANCE_CHUNK_SIZE 100000
+
+    // header flags
+    #define APPEAR_TRACES (1<<0)  // the segment includes addresses found in traces
+
+    //-------------------------------------------------------------------------
+    struct CAppearanceHeader {
+        char     magic[8];
+        uint32_t version;
+        uint32_t flags;
+        uint64_t firstBlock;  // the first block the segment covers (not necessarily present)
+        uint64_t lastBlock;   // the last block indexed
+        uint64_t nBlocks;     // the number of blocks indexed (the cache may have gaps)
+        uint64_t nAddrs;
+        uint64_t postingsOffset;
+        uint64_t postingsSize;
+    };
+
+    //-------------------------------------------------------------------------
+    struct CAppearanceEntry {
+        uint8_t  addr[20];
+        uint32_t count;
+        uint64_t offset;  // from the start of the postings
+    };
+
+    //-------------------------------------------------------------------------
+    typedef bool (*APPEARANCEFUNC)(blknum_t bn, blknum_t tx, void *data);
+
+    //-------------------------------------------------------------------------
+    // Read-only view of one segment of the appearance index
+    class CAppearanceSegment {
+    public:
+        CAppearanceSegment(void);
+        ~CAppearanceSegment(void);
+
+        bool open (const SFString& fileName);
+        void close(void);
+
+        bool     isValid   (void) const { return m_header != NULL; }
+        blknum_t firstBlock(void) const { return (m_header ? m_header->firstBlock : 0); }
+        blknum_t lastBlock (void) const { return (m_header ? m_header->lastBlock : 0); }
+        uint64_t nBlocks   (void) const { return (m_header ? m_header->nBlocks : 0); }
+        uint64_t nAddrs    (void) const { return (m_header ? m_header->nAddrs : 0); }
+        uint32_t flags     (void) const { return (m_header ? m_header->flags : 0); }
+
+        // Index of the address's directory entry or NOPOS if it never appears in this segment
+        uint64_t findAddress(const CAddress20& addr) const;
+        CAddress20 getAddress(uint64_t index) const { return CAddress20(m_entries[index].addr); }
+
+        // Visits the appearances (from block 'start' to block 'end' inclusive) of the address at
+        // 'index' in the directory. Returns false if 'func' returns false.
+        bool forEveryPosting(uint64_t index, blknum_t start, blknum_t end, APPEARANCEFUNC func, void *data) const;
+
+    private:
+        CMemMapFile             *m_file;
+        const CAppearanceHeader *m_header;
+        const CAppearanceEntry  *m_entries;
+        const uint8_t           *m_postings;
+
+        CAppearanceSegment(const CAppearanceSegment&);
+        CAppearanceSegment& operator=(const CAppearanceSegment&);
+    };
+
+    //-------------------------------------------------------------------------
+    class CAppearance {
+    public:
+        blknum_t blockNum;
+        blknum_t transIndex;
+        CAppearance(blknum_t bn, blknum_t tx) : blockNum(bn), transIndex(tx) { }
+    };
+    typedef std::vector<CAppearance> CAppearanceList;
+
+    //-------------------------------------------------------------------------
+    // Collects the appearances of one segment in memory and writes the segment all at once.
+    // Blocks must be added in increasing order. An existing segment may be loaded first so that
+    // only newer blocks need to be read.
+    class CAppearanceWriter {
+    public:
+        CAppearanceWriter(blknum_t firstBlock, uint32_t flags);
+
+        bool     load    (const CAppearanceSegment& segment);
+        bool     addBlock(CBlock& block);
+        bool     write   (const SFString& fileName) const;
+        void     addAppearance(const CAddress20& addr, blknum_t bn, blknum_t tx);
+
+        blknum_t lastBlock(void) const { return m_lastBlock; }
+        uint64_t nBlocks  (void) const { return m_nBlocks; }
+        uint64_t nAddrs   (void) const { return m_postings.size(); }
+
+    private:
+        blknum_t m_firstBlock;
+        blknum_t m_lastBlock;
+        uint64_t m_nBlocks;
+        uint32_t m_flags;
+        std::unordered_map<CAddress20, CAppearanceList> m_postings;
+    };
+
+    //-------------------------------------------------------------------------
+    extern SFString getAppearanceFilename (blknum_t bn);
+    extern bool     buildAppearanceChunk  (uint64_t chunk, uint32_t flags, bool rebuild, uint64_t& nBlocks);
+    extern bool     forEveryAppearance    (const SFAddress& addr, blknum_t start, blknum_t end, APPEARANCEFUNC func, void *data);
+    extern blknum_t getLastAppearanceBlock(void);
+
+}  // namespace qblocks
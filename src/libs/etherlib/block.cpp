@@ -26,6 +26,32 @@ IMPLEMENT_NODE(CBlock, CBaseNode);
 extern SFString nextBlockChunk(const SFString& fieldIn, const void *dataPtr);
 static SFString nextBlockChunk_custom(const SFString& fieldIn, const void *dataPtr);
 
+//---------------------------------------------------------------------------
+// makeClass chose the seed so that no two of these names share a slot in the table
+enum {
+    FLD_GASLIMIT = 1,
+    FLD_GASUSED,
+    FLD_HASH,
+    FLD_BLOCKNUMBER,
+    FLD_PARENTHASH,
+    FLD_MINER,
+    FLD_DIFFICULTY,
+    FLD_PRICE,
+    FLD_FINALIZED,
+    FLD_TIMESTAMP,
+    FLD_TRANSACTIONS,
+    FLD_TRANSACTIONSCNT,
+};
+static const char *blockFieldNames[] = {
+    "gasLimit", "gasUsed", "hash", "blockNumber", "parentHash", "miner", "difficulty", "price",
+    "finalized", "timestamp", "transactions", "transactionsCnt",
+};
+static const uint8_t blockFieldSlots[] = {
+    1, 0, 0, 6, 12, 0, 11, 0, 0, 7, 0, 0, 4, 9, 3, 8,
+    0, 0, 0, 0, 10, 0, 0, 0, 0, 0, 0, 0, 5, 0, 2, 0,
+};
+static const CFieldTable blockFieldTable(blockFieldNames, 12, blockFieldSlots, 32, 1);
+
 //---------------------------------------------------------------------------
 void CBlock::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr) const {
     if (!m_showing)
@@ -36,12 +62,10 @@ void CBlock::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr) c
         return;
     }
 
-    SFString fmt = fmtIn;
-    if (handleCustomFormat(ctx, fmt, dataPtr))
+    if (handleCustomFormat(ctx, fmtIn, dataPtr))
         return;
 
-    while (!fmt.empty())
-        ctx << getNextChunk(fmt, nextBlockChunk, this);
+    formatChunks(ctx, fmtIn, nextBlockChunk, this);
 }
 
 //---------------------------------------------------------------------------
@@ -82,63 +106,82 @@ bool CBlock::setValueByName(const SFString& fieldName, const SFString& fieldValu
     }
     // EXISTING_CODE
 
-    switch (tolower(fieldName[0])) {
-        case 'b':
-            if ( fieldName % "blockNumber" ) { blockNumber = toUnsigned(fieldValue); return true; }
-            break;
-        case 'd':
-            if ( fieldName % "difficulty" ) { difficulty = toUnsigned(fieldValue); return true; }
-            break;
-        case 'f':
-            if ( fieldName % "finalized" ) { finalized = toBool(fieldValue); return true; }
-            break;
-        case 'g':
-            if ( fieldName % "gasLimit" ) { gasLimit = toGas(fieldValue); return true; }
-            if ( fieldName % "gasUsed" ) { gasUsed = toGas(fieldValue); return true; }
-            break;
-        case 'h':
-            if ( fieldName % "hash" ) { hash = toHash(fieldValue); return true; }
-            break;
-        case 'm':
-            if ( fieldName % "miner" ) { miner = toAddress(fieldValue); return true; }
-            break;
-        case 'p':
-            if ( fieldName % "parentHash" ) { parentHash = toHash(fieldValue); return true; }
-            if ( fieldName % "price" ) { price = toDouble(fieldValue); return true; }
-            break;
-        case 't':
-            if ( fieldName % "timestamp" ) { timestamp = toTimestamp(fieldValue); return true; }
-            if ( fieldName % "transactions" ) {
-                char *p = (char *)fieldValue.c_str();
-                while (p && *p) {
-                    CTransaction item;
-                    uint32_t nFields = 0;
-                    p = item.parseJson(p, nFields);
-                    if (nFields)
-                        transactions[transactions.getCount()] = item;
-                }
-                return true;
+    switch (blockFieldTable.find(fieldName)) {
+        case FLD_GASLIMIT: gasLimit = toGas(fieldValue); return true;
+        case FLD_GASUSED: gasUsed = toGas(fieldValue); return true;
+        case FLD_HASH: hash = toHash(fieldValue); return true;
+        case FLD_BLOCKNUMBER: blockNumber = toUnsigned(fieldValue); return true;
+        case FLD_PARENTHASH: parentHash = toHash(fieldValue); return true;
+        case FLD_MINER: miner = toAddress(fieldValue); return true;
+        case FLD_DIFFICULTY: difficulty = toUnsigned(fieldValue); return true;
+        case FLD_PRICE: price = toDouble(fieldValue); return true;
+        case FLD_FINALIZED: finalized = toBool(fieldValue); return true;
+        case FLD_TIMESTAMP: timestamp = toTimestamp(fieldValue); return true;
+        case FLD_TRANSACTIONS: {
+            char *p = (char *)fieldValue.c_str();
+            while (p && *p) {
+                CTransaction item;
+                uint32_t nFields = 0;
+                p = item.parseJson(p, nFields);
+                if (nFields)
+                    transactions[transactions.getCount()] = item;
             }
-            break;
+            return true;
+        }
         default:
             break;
     }
     return false;
 }
 
+//---------------------------------------------------------------------------------------------------
+bool CBlock::parseTape(CJsonTape& tape, uint32_t node) {
+    if (!tape.isObject(node))
+        return false;
+
+    // Objects are parsed in place from the tape. Anything else goes to setValueByName
+    for (uint32_t key = tape.firstMember(node) ; key != JSON_NOTOKEN ; key = tape.nextMember(node, key)) {
+        uint32_t val = key + 1;
+        string_view_q name = tape.getView(key);
+        switch (blockFieldTable.find(name.data(), name.length())) {
+            case FLD_TRANSACTIONS:
+                if (tape.isArrayOf(val, JSON_OBJECT)) {
+                    for (uint32_t item = tape.firstItem(val) ; item != JSON_NOTOKEN ; item = tape.nextItem(val, item)) {
+                        if (tape.firstMember(item) != JSON_NOTOKEN)
+                            transactions[transactions.getCount()].parseTape(tape, item);
+                    }
+                    continue;
+                }
+                break;
+            default:
+                break;
+        }
+        setValueFromTape(tape, key);
+    }
+    finishParse();
+    return true;
+}
+
 //---------------------------------------------------------------------------------------------------
 void CBlock::finishParse() {
     // EXISTING_CODE
+    SFStringArray hashes;
+    SFUintArray which;
     for (uint32_t i=0;i<transactions.getCount();i++) {
         CTransaction *trans = &transactions[i];
         trans->pBlock = this;
         if (blockNumber >= byzantiumBlock && trans->receipt.status == NO_STATUS) {
             // If we have NO_STATUS in a receipt after the byzantium block, we have to pick it up.
-            CReceipt rec;
-            getReceipt(rec, trans->hash);
-            trans->receipt.status = rec.status;
+            which[which.getCount()] = i;
+            hashes[hashes.getCount()] = trans->hash.asString();
         }
     }
+    if (hashes.getCount()) {
+        CReceiptArray receipts;
+        getReceipts(receipts, hashes);
+        for (uint32_t i=0;i<which.getCount();i++)
+            transactions[(uint32_t)which[i]].receipt.status = receipts[i].status;
+    }
     //finalized = isFinal(timestamp);
     // EXISTING_CODE
 }
@@ -248,7 +291,7 @@ SFString nextBlockChunk_custom(const SFString& fieldIn, const void *dataPtr) {
                     if (!cnt) return EMPTY;
                     SFString ret;
                     for (uint32_t i = 0 ; i < cnt ; i++) {
-                        ret += blo->transactions[i].hash;
+                        ret += blo->transactions[i].hash.asString();
                         ret += ((i < cnt-1) ? ",\n" : "\n");
                     }
                     return ret;
@@ -292,7 +335,10 @@ bool CBlock::readBackLevel(SFArchive& archive) {
         archive >> parentHash;
         archive >> timestamp;
         archive >> transactions;
+        if (deferBlockUpgrade())
+            return true;  // the caller reads the block again where it may ask the node
         // TODO -- technically we should re-read these values from the node
+        std::lock_guard<std::recursive_mutex> guard(getRPCLock());
         SFString save = getCurlContext()->provider;
         getCurlContext()->provider = "local";
         CBlock upgrade;uint32_t unused;
@@ -344,44 +390,29 @@ SFString CBlock::getValueByName(const SFString& fieldName) const {
         return ret;
 
     // Return field values
-    switch (tolower(fieldName[0])) {
-        case 'b':
-            if ( fieldName % "blockNumber" ) return asStringU(blockNumber);
-            break;
-        case 'd':
-            if ( fieldName % "difficulty" ) return asStringU(difficulty);
-            break;
-        case 'f':
-            if ( fieldName % "finalized" ) return asString(finalized);
-            break;
-        case 'g':
-            if ( fieldName % "gasLimit" ) return fromGas(gasLimit);
-            if ( fieldName % "gasUsed" ) return fromGas(gasUsed);
-            break;
-        case 'h':
-            if ( fieldName % "hash" ) return fromHash(hash);
-            break;
-        case 'm':
-            if ( fieldName % "miner" ) return fromAddress(miner);
-            break;
-        case 'p':
-            if ( fieldName % "parentHash" ) return fromHash(parentHash);
-            if ( fieldName % "price" ) return fmtFloat(price);
-            break;
-        case 't':
-            if ( fieldName % "timestamp" ) return fromTimestamp(timestamp);
-            if ( fieldName % "transactions" || fieldName % "transactionsCnt" ) {
-                uint32_t cnt = transactions.getCount();
-                if (fieldName.endsWith("Cnt"))
-                    return asStringU(cnt);
-                if (!cnt) return "";
-                SFString retS;
-                for (uint32_t i = 0 ; i < cnt ; i++) {
-                    retS += transactions[i].Format();
-                    retS += ((i < cnt - 1) ? ",\n" : "\n");
-                }
-                return retS;
+    switch (blockFieldTable.find(fieldName)) {
+        case FLD_GASLIMIT: return fromGas(gasLimit);
+        case FLD_GASUSED: return fromGas(gasUsed);
+        case FLD_HASH: return fromHash(hash);
+        case FLD_BLOCKNUMBER: return asStringU(blockNumber);
+        case FLD_PARENTHASH: return fromHash(parentHash);
+        case FLD_MINER: return fromAddress(miner);
+        case FLD_DIFFICULTY: return asStringU(difficulty);
+        case FLD_PRICE: return fmtFloat(price);
+        case FLD_FINALIZED: return asString(finalized);
+        case FLD_TIMESTAMP: return fromTimestamp(timestamp);
+        case FLD_TRANSACTIONS: {
+            uint32_t cnt = transactions.getCount();
+            if (!cnt) return "";
+            SFString retS;
+            for (uint32_t i = 0 ; i < cnt ; i++) {
+                retS += transactions[i].Format();
+                retS += ((i < cnt - 1) ? ",\n" : "\n");
             }
+            return retS;
+        }
+        case FLD_TRANSACTIONSCNT: return asStringU(transactions.getCount());
+        default:
             break;
     }
 
@@ -446,44 +477,40 @@ public:
 typedef SFArrayBase<CAddressItem> CAddressItemArray;
 
 //---------------------------------------------------------------------------
-int compareAddr(const void *ob1, const void *ob2) {
-    const CAddressItem *a1 = (const CAddressItem*)ob1;
-    const CAddressItem *a2 = (const CAddressItem*)ob2;
-//    cout << "comparing: " << *a1 << " to: " << *a2 << " r: " << (*a1 != *a2) << "\n";
-    return a1->addr.compare(a2->addr);
-}
+class CUniqueAddresses {
+public:
+    std::unordered_set<CAddress20> seen;
+    CAddressItemArray items;  // in the order first seen
+};
 
 //---------------------------------------------------------------------------
 bool accumulateAddresses(blknum_t bn, blknum_t tx, blknum_t tc, const SFAddress& addr, void *data) {
-    if (zeroAddr(addr))
+    CAddress20 bytes;
+    if (!bytes.fromHex(addr) || bytes.isZero())
         return true;
 
-    //    cout << "\n--------------------------------------------\n";
-    CAddressItem search;
-    search.addr = addr;
-    search.blockNum = bn;
-    search.transIndex = tx;
-    search.traceId = tc;
-    CAddressItemArray *array = (CAddressItemArray *)data;
-    if (!array->Find(&search, compareAddr)) {
-        array->addValue(search);
-        array->Sort(compareAddr);
-//        cout << "adding:    " << addr << "\n";
-//    } else {
-//        cout << "not adding " << addr << "\n";
+    CUniqueAddresses *unique = (CUniqueAddresses *)data;
+    if (unique->seen.insert(bytes).second) {
+        CAddressItem& item = unique->items[unique->items.getCount()];
+        item.addr = addr;
+        item.blockNum = bn;
+        item.transIndex = tx;
+        item.traceId = tc;
     }
     return true;
 }
 
 //---------------------------------------------------------------------------
+// Visits each address once, where it first appears in the block
 bool CBlock::forEveryUniqueAddress(ADDRESSFUNC func, TRANSFUNC filterFunc, void *data) {
     if (!func)
         return false;
 
-    CAddressItemArray array;
-    forEveryAddress(accumulateAddresses, filterFunc, &array);
-    for (uint32_t i = 0 ; i < array.getCount() ; i++) {
-        (*func)(array[i].blockNum, array[i].transIndex, array[i].traceId, array[i].addr, data);
+    CUniqueAddresses unique;
+    forEveryAddress(accumulateAddresses, filterFunc, &unique);
+    for (uint32_t i = 0 ; i < unique.items.getCount() ; i++) {
+        const CAddressItem *item = &unique.items[i];
+        (*func)(item->blockNum, item->transIndex, item->traceId, item->addr, data);
     }
     return true;
 }
@@ -493,81 +520,103 @@ bool isPotentialAddr(SFUintBN test, SFAddress& addrOut) {
 
     addrOut = "";
 
-    static const SFUintBN small = hex2BN(  "0x00000000000000ffffffffffffffffffffffffff"); // the smallest address we search for
-    static const SFUintBN large = hex2BN("0x010000000000000000000000000000000000000000"); // the largest address we search for
-    if (test <= small || test >= large)
+    // Anything wider than a word is not an address
+    if (test.len > ADDR_WORD_SIZE / 8)
         return false;
 
-    addrOut = to_hex(test).c_str();
-    // Totally a heuristic that can't really be supported, but a good probability that this isn't an address
-    if (addrOut.endsWith("00000000"))
-        return false;
+    uint8_t word[ADDR_WORD_SIZE];
+    memset(word, 0, sizeof(word));
+    for (uint32_t i = 0 ; i < test.len ; i++)
+        for (uint32_t b = 0 ; b < 8 ; b++)
+            word[ADDR_WORD_SIZE - 1 - i * 8 - b] = (uint8_t)(test.blk[i] >> (b * 8));
 
-    if (addrOut.length()<40)
-        addrOut = padLeft(addrOut, 40, '0');
-    addrOut = addrOut.substr(addrOut.length()-40,40);
-    addrOut = toLower("0x" + addrOut);
+    if (!isPotentialAddrWord(word))
+        return false;
 
+    char hex[43];
+    bytesToHex(word + ADDR_WORD_SIZE - 20, 20, hex);
+    addrOut = hex;
     return true;
 }
 
 //---------------------------------------------------------------------------
-void processPotentialAddrs(blknum_t bn, blknum_t tx, blknum_t tc, const SFString& potList, ADDRESSFUNC func, void *data) {
+// Decodes the whole 32-byte words in 'str' (a hex string with no leading '0x') and reports
+// those that look like addresses
+static void scanPotentialAddrs(blknum_t bn, blknum_t tx, blknum_t tc, const char *str, size_t len, ADDRESSFUNC func, void *data) {
 
-    if (!func)
+    size_t nWords = len / ADDR_WORD_HEX;
+    if (!func || !nWords)
         return;
 
-    // Pull out 32-byte chunks and check to see if they are addresses
-    SFAddress addr;
-    for (uint32_t s = 0 ; s < potList.length() / 64 ; s++) {
-        SFUintBN test  = hex2BN("0x" + potList.substr(s*64,64));
-        if (isPotentialAddr(test, addr))
-            (*func)(bn, tx, tc, addr, data);
+    // Per thread so the block visitors can share this without locking
+    thread_local std::vector<uint8_t> words;
+    thread_local std::vector<uint32_t> hits;
+    if (words.size() < nWords * ADDR_WORD_SIZE) {
+        words.resize(nWords * ADDR_WORD_SIZE);
+        hits.resize(nWords);
+    }
+
+    hexToWords(str, nWords, words.data());
+    size_t nHits = findPotentialAddrs(words.data(), nWords, hits.data());
+    for (size_t i = 0 ; i < nHits ; i++) {
+        char hex[43];
+        bytesToHex(words.data() + hits[i] * ADDR_WORD_SIZE + ADDR_WORD_SIZE - 20, 20, hex);
+        (*func)(bn, tx, tc, SFAddress(hex), data);
     }
 }
 
+//---------------------------------------------------------------------------
+void processPotentialAddrs(blknum_t bn, blknum_t tx, blknum_t tc, const SFString& potList, ADDRESSFUNC func, void *data) {
+    scanPotentialAddrs(bn, tx, tc, potList.c_str(), potList.length(), func, data);
+}
+
+//---------------------------------------------------------------------------
+// Skips the first 'skip' characters of 'str' the way substr would
+static inline void scanPotentialAddrsFrom(blknum_t bn, blknum_t tx, blknum_t tc, const SFString& str, size_t skip, ADDRESSFUNC func, void *data) {
+    if (str.length() > skip)
+        scanPotentialAddrs(bn, tx, tc, str.c_str() + skip, str.length() - skip, func, data);
+}
+
 //---------------------------------------------------------------------------
 bool CBlock::forEveryAddress(ADDRESSFUNC func, TRANSFUNC filterFunc, void *data) {
 
     if (!func)
         return false;
 
-    (*func)(blockNumber, NOPOS, 0, miner, data);
+    (*func)(blockNumber, NOPOS, 0, fromAddress(miner), data);
 
     for (uint32_t tr = 0 ; tr < transactions.getCount() ; tr++) {
         CTransaction *trans   = &transactions[tr];
         CReceipt     *receipt = &trans->receipt;
-        (*func)(blockNumber, tr, 0, trans->from, data);
-        (*func)(blockNumber, tr, 0, trans->to,   data);
-        (*func)(blockNumber, tr, 0, receipt->contractAddress, data);
-        processPotentialAddrs(blockNumber, tr, 0, trans->input.substr(10), func, data);
+        (*func)(blockNumber, tr, 0, fromAddress(trans->from), data);
+        (*func)(blockNumber, tr, 0, fromAddress(trans->to),   data);
+        (*func)(blockNumber, tr, 0, fromAddress(receipt->contractAddress), data);
+        scanPotentialAddrsFrom(blockNumber, tr, 0, trans->input, 10, func, data);
         for (uint32_t l = 0 ; l < receipt->logs.getCount() ; l++) {
             CLogEntry *log = &receipt->logs[l];
-            (*func)(blockNumber, tr, 0, log->address, data);
+            (*func)(blockNumber, tr, 0, fromAddress(log->address), data);
             for (uint32_t t = 0 ; t < log->topics.getCount() ; t++) {
                 SFAddress addr;
                 if (isPotentialAddr(log->topics[t], addr)) {
                     (*func)(blockNumber, tr, 0, addr, data);
                 }
             }
-            processPotentialAddrs(blockNumber, tr, 0, log->data.substr(2), func, data);
+            scanPotentialAddrsFrom(blockNumber, tr, 0, log->data, 2, func, data);
         }
 
         // If we're not filtering, or the filter passes, proceed. Note the filter depends on the
         // transaction only, not on any address.
         if (!filterFunc || !filterFunc(trans, data)) { // may look at DDos range and nTraces for example
             CTraceArray traces;
-            getTraces(traces, trans->hash);
+            getTraces(traces, *trans);
             for (uint32_t t = 0 ; t < traces.getCount() ; t++) {
                 CTrace *trace = &traces[t];
-                (*func)(blockNumber, tr, t+10, trace->action.from, data);
-                (*func)(blockNumber, tr, t+10, trace->action.to, data);
-                (*func)(blockNumber, tr, t+10, trace->action.refundAddress, data);
-                (*func)(blockNumber, tr, t+10, trace->action.address, data);
-                (*func)(blockNumber, tr, t+10, trace->result.address, data);
-                SFString input = trace->action.input.substr(10);
-                if (!input.empty())
-                    processPotentialAddrs(blockNumber, tr, t+10, input, func, data);
+                (*func)(blockNumber, tr, t+10, fromAddress(trace->action.from), data);
+                (*func)(blockNumber, tr, t+10, fromAddress(trace->action.to), data);
+                (*func)(blockNumber, tr, t+10, fromAddress(trace->action.refundAddress), data);
+                (*func)(blockNumber, tr, t+10, fromAddress(trace->action.address), data);
+                (*func)(blockNumber, tr, t+10, fromAddress(trace->result.address), data);
+                scanPotentialAddrsFrom(blockNumber, tr, t+10, trace->action.input, 10, func, data);
             }
         }
     }
@@ -36,10 +36,10 @@ class CBlock : public CBaseNode {
 public:
     SFGas gasLimit;
     SFGas gasUsed;
-    SFHash hash;
+    CHashField hash;
     blknum_t blockNumber;
-    SFHash parentHash;
-    SFAddress miner;
+    CHashField parentHash;
+    CAddressField miner;
     uint64_t difficulty;
     double price;
     bool finalized;
@@ -54,6 +54,7 @@ public:
 
     DECLARE_NODE(CBlock);
 
+    bool parseTape(CJsonTape& tape, uint32_t node) override;
     const CBaseNode *getObjectAt(const SFString& fieldName, uint32_t index) const override;
 
     // EXISTING_CODE
@@ -110,10 +111,10 @@ inline void CBlock::Init(void) {
 
     gasLimit = 0;
     gasUsed = 0;
-    hash = "";
+    hash.setEmpty();
     blockNumber = 0;
-    parentHash = "";
-    miner = "";
+    parentHash.setEmpty();
+    miner.setEmpty();
     difficulty = 0;
     price = 0.0;
     finalized = 0;
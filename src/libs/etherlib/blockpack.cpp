@@ -0,0 +1,405 @@
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <atomic>
+#include <cstddef>
+#include "blockpack.h"
+
+namespace qblocks {
+
+    //-------------------------------------------------------------------------
+    CBlockPack::CBlockPack(void) : m_fd(-1) {
+        memset(&m_header, 0, sizeof(m_header));
+    }
+
+    //-------------------------------------------------------------------------
+    bool CBlockPack::open(const SFString& fileName) {
+        close();
+        m_fd = ::open(fileName.c_str(), O_RDONLY | O_CLOEXEC);
+        if (m_fd == -1)
+            return false;
+
+        if (pread(m_fd, &m_header, sizeof(m_header), 0) != (ssize_t)sizeof(m_header) ||
+                m_header.magic != BLOCK_PACK_MAGIC || m_header.version != BLOCK_PACK_VERSION ||
+                m_header.firstBlock % BLOCKS_PER_PACK) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    void CBlockPack::close(void) {
+        if (m_fd != -1)
+            ::close(m_fd);
+        m_fd = -1;
+        memset(&m_header, 0, sizeof(m_header));
+    }
+
+    //-------------------------------------------------------------------------
+    bool CBlockPack::hasBlock(blknum_t bn) const {
+        return (isOpen() && bn >= m_header.firstBlock && bn < m_header.firstBlock + BLOCKS_PER_PACK &&
+                m_header.entries[bn - m_header.firstBlock].length > 0);
+    }
+
+    //-------------------------------------------------------------------------
+    bool CBlockPack::readBlock(blknum_t bn, CMemArchive& archive) const {
+        if (!hasBlock(bn))
+            return false;
+        const CEntry *entry = &m_header.entries[bn - m_header.firstBlock];
+        return archive.open(m_fd, entry->offset, entry->length);
+    }
+
+    //-------------------------------------------------------------------------
+    bool CBlockPack::readBytes(blknum_t bn, std::vector<char>& bytes) const {
+        if (!hasBlock(bn))
+            return false;
+        const CEntry *entry = &m_header.entries[bn - m_header.firstBlock];
+        bytes.resize((size_t)entry->length);
+        return (pread(m_fd, bytes.data(), bytes.size(), (off_t)entry->offset) == (ssize_t)bytes.size());
+    }
+
+    //-------------------------------------------------------------------------
+    SFString getPackFilename(blknum_t bn) {
+        blknum_t first = bn - (bn % BLOCKS_PER_PACK);
+        SFString path = getBinaryPath(first);  // ends with the third level folder, CC/
+        return path.substr(0, path.length() - 3) + padLeft(asStringU(first), 9, '0') + ".pack";
+    }
+
+    //-------------------------------------------------------------------------
+    bool CBlockPack::isFile(const struct stat& st) const {
+        struct stat ours;
+        return (isOpen() && fstat(m_fd, &ours) == 0 && ours.st_ino == st.st_ino && ours.st_dev == st.st_dev);
+    }
+
+    //-------------------------------------------------------------------------
+    // Each thread keeps the last pack it looked at open (or remembers that there isn't one).
+    // Making or changing a pack bumps its generation, which has every thread look at that pack
+    // again. Packs share the slots, so now and then a pack is looked at again for nothing.
+    #define PACK_SLOTS 256
+    static std::atomic<uint32_t> packGenerations[PACK_SLOTS];
+
+    //-------------------------------------------------------------------------
+    static std::atomic<uint32_t>& packGeneration(blknum_t first) {
+        return packGenerations[(first / BLOCKS_PER_PACK) % PACK_SLOTS];
+    }
+
+    //-------------------------------------------------------------------------
+    struct CPackCursor {
+        CBlockPack pack;
+        blknum_t   first;
+        uint32_t   generation;
+        CPackCursor(void) : first(NOPOS), generation(0) { }
+    };
+    static thread_local CPackCursor packCursor;
+
+    //-------------------------------------------------------------------------
+    void forgetBlockPack(blknum_t bn) {
+        packGeneration(bn - (bn % BLOCKS_PER_PACK))++;
+    }
+
+    //-------------------------------------------------------------------------
+    void forgetBlockPacks(void) {
+        for (uint32_t i = 0 ; i < PACK_SLOTS ; i++)
+            packGenerations[i]++;
+    }
+
+    //-------------------------------------------------------------------------
+    static const CBlockPack *findPack(blknum_t bn) {
+        blknum_t first = bn - (bn % BLOCKS_PER_PACK);
+        uint32_t generation = packGeneration(first);
+        if (packCursor.first != first || packCursor.generation != generation) {
+            packCursor.first = first;
+            packCursor.generation = generation;
+            packCursor.pack.open(getPackFilename(first));
+        }
+        return (packCursor.pack.isOpen() ? &packCursor.pack : NULL);
+    }
+
+    //-------------------------------------------------------------------------
+    // Another process may have made the pack, or made it again, since this thread opened it.
+    // Only this thread looks again, and only if the file is not the one it has open.
+    bool refreshBlockPack(blknum_t bn) {
+        findPack(bn);
+        struct stat st;
+        if (stat(getPackFilename(bn).c_str(), &st) != 0) {
+            if (!packCursor.pack.isOpen())
+                return false;
+            packCursor.pack.close();
+            return true;
+        }
+        if (packCursor.pack.isFile(st))
+            return false;
+        packCursor.pack.open(getPackFilename(bn));
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    bool isBlockInPack(blknum_t bn) {
+        const CBlockPack *pack = findPack(bn);
+        return (pack && pack->hasBlock(bn));
+    }
+
+    //-------------------------------------------------------------------------
+    bool readBlockFromPack(CBlock& block, blknum_t bn) {
+        const CBlockPack *pack = findPack(bn);
+        if (!pack || !pack->hasBlock(bn))
+            return false;
+
+        thread_local CMemArchive archive;
+        if (!pack->readBlock(bn, archive))
+            return false;
+        block.Serialize(archive);
+        archive.close();
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    // packBlocks renames a new pack over the old one while it holds the lock on the old one, so
+    // once we have the lock we make sure it's still the pack, and lock the new one if it isn't.
+    // Returns false if there is no pack (or we timed out waiting for it).
+    static bool lockPack(const SFString& packName, CBinFile& pack) {
+        while (fileExists(packName)) {
+            if (!pack.Lock(packName, binaryReadWrite, LOCK_WAIT))
+                return false;
+            if (!pack.wasReplaced())
+                return true;
+            pack.Release();
+        }
+        return false;
+    }
+
+    //-------------------------------------------------------------------------
+    // Clears the block's entry in the table of a pack we hold the lock on
+    static bool clearEntry(CBinFile& pack, blknum_t bn) {
+        CBlockPack::CEntry empty = { 0, 0 };
+        pack.Seek((long)(offsetof(CBlockPack::CHeader, entries) + (bn % BLOCKS_PER_PACK) * sizeof(empty)), SEEK_SET);
+        return (pack.Write(&empty, sizeof(empty), 1) == 1);
+    }
+
+    //-------------------------------------------------------------------------
+    // A block written to the cache after it was packed replaces the packed one. We clear its
+    // entry in the table so readers go to the new file. The space stays used until the pack is
+    // made again.
+    bool dropFromPack(blknum_t bn) {
+        if (!isBlockInPack(bn))
+            return true;
+
+        CBinFile pack;
+        if (!lockPack(getPackFilename(bn), pack))
+            return !fileExists(getPackFilename(bn));
+        bool ret = clearEntry(pack, bn);
+        pack.Release();
+        forgetBlockPack(bn);
+        return ret;
+    }
+
+    //-------------------------------------------------------------------------
+    // True if the file at 'fileName' was written since 'st' was taken (a file that's gone wasn't).
+    // Block files are written in place, so the time of the last write counts as well as the inode.
+    static bool rewritten(const SFString& fileName, const struct stat& st) {
+        struct stat now;
+        if (stat(fileName.c_str(), &now) != 0)
+            return false;
+#ifdef __APPLE__
+        bool sameTime = (now.st_mtimespec.tv_sec == st.st_mtimespec.tv_sec && now.st_mtimespec.tv_nsec == st.st_mtimespec.tv_nsec);
+#else
+        bool sameTime = (now.st_mtim.tv_sec == st.st_mtim.tv_sec && now.st_mtim.tv_nsec == st.st_mtim.tv_nsec);
+#endif
+        return !(sameTime && now.st_ino == st.st_ino && now.st_dev == st.st_dev && now.st_size == st.st_size);
+    }
+
+    //-------------------------------------------------------------------------
+    static bool readWholeFile(const SFString& fileName, std::vector<char>& bytes, struct stat& st) {
+        int fd = ::open(fileName.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd == -1)
+            return false;
+        bool ret = (fstat(fd, &st) == 0);
+        if (ret) {
+            bytes.resize((size_t)st.st_size);
+            ret = (read(fd, bytes.data(), bytes.size()) == (ssize_t)bytes.size());
+        }
+        ::close(fd);
+        return ret;
+    }
+
+    //-------------------------------------------------------------------------
+    static bool writeAll(int fd, const void *data, size_t len, off_t where) {
+        const char *p = (const char *)data;
+        while (len) {
+            ssize_t n = pwrite(fd, p, len, where);
+            if (n <= 0)
+                return false;
+            p += n;
+            where += n;
+            len -= (size_t)n;
+        }
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    // Packs the block files of the thousand blocks around 'bn', along with whatever an earlier
+    // pack of them holds (a block file wins over a packed block). The blocks are copied as they
+    // are, one at a time, and the table is written last. The new pack goes to a temp file which
+    // is synced and then renamed over the old one, so a reader sees either pack, never half of
+    // one. Blocks may be dropped from the old pack (see dropFromPack) while we copy, so just
+    // before the rename we take its lock and drop them from the new one too, keeping their
+    // files. A block file may also be written again after we copy it. Under the new pack's lock
+    // we check each file against what we read, drop the changed ones from the pack and keep
+    // them. Only then are the other block files (and their folder) removed. Returns false on
+    // error; 'nPacked' is the number of block files that went into the pack.
+    bool packBlocks(blknum_t bn, bool keepFiles, uint32_t& nPacked) {
+        nPacked = 0;
+        blknum_t first = bn - (bn % BLOCKS_PER_PACK);
+        SFString packName = getPackFilename(first);
+
+        SFUintArray files;
+        for (blknum_t b = first ; b < first + BLOCKS_PER_PACK ; b++)
+            if (fileSize(getBinaryFilename(b)) > 0)
+                files.addValue(b);
+        if (!files.getCount())
+            return true;
+
+        CBlockPack old;
+        old.open(packName);
+
+        SFString tmpName = packName + ".tmp";
+        int fd = ::open(tmpName.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd == -1) {
+            cerr << "Could not create " << tmpName << "\n";
+            return false;
+        }
+
+        CBlockPack::CHeader *header = new CBlockPack::CHeader;
+        memset(header, 0, sizeof(CBlockPack::CHeader));
+        header->magic      = BLOCK_PACK_MAGIC;
+        header->version    = BLOCK_PACK_VERSION;
+        header->firstBlock = first;
+
+        bool ok = true;
+        uint64_t offset = sizeof(CBlockPack::CHeader);
+        uint32_t next = 0;
+        std::vector<char> bytes;
+        std::vector<struct stat> copied(files.getCount());
+        for (blknum_t b = first ; b < first + BLOCKS_PER_PACK && ok ; b++) {
+            bool isFile = (next < files.getCount() && files[next] == b);
+            if (isFile) {
+                next++;
+                if (!readWholeFile(getBinaryFilename(b), bytes, copied[next - 1])) {
+                    cerr << "Could not read " << getBinaryFilename(b) << "\n";
+                    ok = false;
+                    break;
+                }
+            } else if (!old.readBytes(b, bytes)) {
+                continue;
+            }
+            if (bytes.empty())
+                continue;
+            ok = writeAll(fd, bytes.data(), bytes.size(), (off_t)offset);
+            header->entries[b - first].offset = offset;
+            header->entries[b - first].length = bytes.size();
+            offset += bytes.size();
+        }
+
+        // The lock is held until the rename, so nothing can be dropped from the old pack unseen
+        CBinFile lock;
+        std::vector<bool> dropped(BLOCKS_PER_PACK, false);
+        if (ok && old.isOpen()) {
+            CBlockPack current;
+            if (!lockPack(packName, lock) || !current.open(packName)) {
+                cerr << "Could not lock " << packName << "\n";
+                ok = false;
+            }
+            for (blknum_t b = first ; b < first + BLOCKS_PER_PACK && ok ; b++) {
+                if (old.hasBlock(b) && !current.hasBlock(b)) {
+                    header->entries[b - first].offset = 0;
+                    header->entries[b - first].length = 0;
+                    dropped[b - first] = true;
+                }
+            }
+        }
+        old.close();
+
+        ok = ok && writeAll(fd, header, sizeof(CBlockPack::CHeader), 0) && fsync(fd) == 0;
+        delete header;
+        ::close(fd);
+        if (!ok || rename(tmpName.c_str(), packName.c_str()) != 0) {
+            cerr << "Could not write " << packName << "\n";
+            unlink(tmpName.c_str());
+            return false;
+        }
+        lock.Release();
+
+        // The rename has to last before the files it replaces are gone
+        SFString folder = packName.substr(0, packName.ReverseFind('/') + 1);
+        int dirFd = ::open(folder.c_str(), O_RDONLY | O_CLOEXEC);
+        if (dirFd != -1) {
+            fsync(dirFd);
+            ::close(dirFd);
+        }
+
+        // Files written since we copied them stay, and the pack's copies go
+        if (!lockPack(packName, lock)) {
+            cerr << "Could not lock " << packName << "\n";
+            forgetBlockPack(first);
+            return false;
+        }
+        for (uint32_t i = 0 ; i < files.getCount() ; i++) {
+            if (dropped[files[i] - first])
+                continue;
+            if (rewritten(getBinaryFilename(files[i]), copied[i]))
+                clearEntry(lock, files[i]);
+            else if (!keepFiles)
+                removeFile(getBinaryFilename(files[i]));
+        }
+        lock.Release();
+        forgetBlockPack(first);
+
+        nPacked = files.getCount();
+        if (!keepFiles)
+            rmdir(getBinaryPath(first).c_str());  // only if it's empty
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    // The path ends with .../blocks/AA/BB/CC/, which holds blocks AABBCC000 to AABBCC999
+    static bool collectPackGroup(const SFString& path, void *data) {
+        if (path.endsWith("/")) {
+            SFString p = path.substr(0, path.length() - 1);
+            SFString third = p.substr(p.ReverseFind('/') + 1);
+            p = p.substr(0, p.ReverseFind('/'));
+            SFString second = p.substr(p.ReverseFind('/') + 1);
+            p = p.substr(0, p.ReverseFind('/'));
+            SFString first = p.substr(p.ReverseFind('/') + 1);
+            SFUintArray *groups = (SFUintArray*)data;
+            groups->addValue((toUnsigned(first) * 10000 + toUnsigned(second) * 100 + toUnsigned(third)) * BLOCKS_PER_PACK);
+        }
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    // The first block of every folder of block files, that is, every pack that could be made
+    void listPackGroups(SFUintArray& groups) {
+        groups.Clear();
+        SFUintArray chunks;
+        listCacheChunks(chunks);
+        for (uint32_t i = 0 ; i < chunks.getCount() ; i++) {
+            SFString folder = getBinaryPath(chunks[i] * 100000);
+            folder = folder.substr(0, folder.length() - 3);  // drop the third level
+            forAllFiles(folder + "*", collectPackGroup, &groups);
+        }
+    }
+
+}  // namespace qblocks
@@ -0,0 +1,79 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include <sys/stat.h>
+#include "etherlib.h"
+
+namespace qblocks {
+
+    //-------------------------------------------------------------------------
+    // A pack holds up to a thousand consecutive blocks (those of one third-level folder of the
+    // block cache) in one file. It sits beside the folder it replaces:
+    //
+    //      blocks/AA/BB/CC/AABBCC000.bin ... AABBCC999.bin  ->  blocks/AA/BB/AABBCC000.pack
+    //
+    // The header is a fixed table of the offset and length of every block (a length of zero if
+    // the pack doesn't have it) followed by the blocks themselves, each exactly as it would be in
+    // its own file. Reading a block whose pack is open is a single pread.
+    //-------------------------------------------------------------------------
+    #define BLOCK_PACK_MAGIC   0x4b504251  // "QBPK"
+    #define BLOCK_PACK_VERSION 1
+    #define BLOCKS_PER_PACK    1000
+
+    //-------------------------------------------------------------------------
+    class CBlockPack {
+    public:
+        struct CEntry {
+            uint64_t offset;
+            uint64_t length;
+        };
+        struct CHeader {
+            uint32_t magic;
+            uint32_t version;
+            uint64_t firstBlock;
+            CEntry   entries[BLOCKS_PER_PACK];
+        };
+
+        CBlockPack(void);
+        ~CBlockPack(void) { close(); }
+
+        bool     open      (const SFString& fileName);
+        void     close     (void);
+        bool     isOpen    (void) const { return m_fd != -1; }
+        bool     isFile    (const struct stat& st) const;
+
+        blknum_t firstBlock(void) const { return m_header.firstBlock; }
+        bool     hasBlock  (blknum_t bn) const;
+        bool     readBlock (blknum_t bn, CMemArchive& archive) const;
+        bool     readBytes (blknum_t bn, std::vector<char>& bytes) const;
+
+    private:
+        int      m_fd;
+        CHeader  m_header;
+
+        CBlockPack(const CBlockPack&);
+        CBlockPack& operator=(const CBlockPack&);
+    };
+
+    //-------------------------------------------------------------------------
+    extern SFString getPackFilename  (blknum_t bn);
+    extern bool     isBlockInPack    (blknum_t bn);
+    extern bool     readBlockFromPack(CBlock& block, blknum_t bn);
+    extern bool     dropFromPack     (blknum_t bn);
+    extern bool     refreshBlockPack (blknum_t bn);
+    extern void     forgetBlockPack  (blknum_t bn);
+    extern void     forgetBlockPacks (void);
+    extern bool     packBlocks       (blknum_t bn, bool keepFiles, uint32_t& nPacked);
+    extern void     listPackGroups   (SFUintArray& groups);
+
+}  // namespace qblocks
@@ -0,0 +1,324 @@
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include <algorithm>
+#include <unistd.h>
+#include "bloomindex.h"
+
+namespace qblocks {
+
+    static_assert(sizeof(CBloomIndexHeader) == 64,  "bloom index header must be 64 bytes");
+    static_assert(sizeof(CBloomRecord)      == 272, "bloom index records must be 272 bytes");
+
+    //-------------------------------------------------------------------------
+    static bool isValidHeader(const CBloomIndexHeader *header, uint64_t fileSize) {
+        if (fileSize < sizeof(CBloomIndexHeader))
+            return false;
+        if (memcmp(header->magic, BLOOM_INDEX_MAGIC, sizeof(header->magic)))
+            return false;
+        if (header->version != BLOOM_INDEX_VERSION || header->recordSize != sizeof(CBloomRecord))
+            return false;
+        if (header->tableOffset != sizeof(CBloomIndexHeader) + header->nRecords * sizeof(CBloomRecord))
+            return false;
+        return (header->tableOffset + header->nBuckets * sizeof(uint64_t) <= fileSize);
+    }
+
+    //-------------------------------------------------------------------------
+    CBloomIndex::CBloomIndex(void) : m_file(NULL), m_records(NULL) {
+        memset(&m_header, 0, sizeof(m_header));
+    }
+
+    //-------------------------------------------------------------------------
+    CBloomIndex::~CBloomIndex(void) {
+        close();
+    }
+
+    //-------------------------------------------------------------------------
+    bool CBloomIndex::open(const SFString& fileName) {
+        close();
+        if (!fileExists(fileName))
+            return false;
+
+        m_file = new CMemMapFile(fileName.c_str(), CMemMapFile::WholeFile, CMemMapFile::RandomAccess);
+        if (!m_file->isValid()) {
+            close();
+            return false;
+        }
+
+        const unsigned char *data = m_file->getData();
+        const CBloomIndexHeader *header = (const CBloomIndexHeader *)data;
+        if (!isValidHeader(header, m_file->size())) {
+            cerr << "The bloom index at " << fileName << " is corrupted or from a different version. Ignoring it.\n";
+            close();
+            return false;
+        }
+
+        // A writer is part way through an append (or died there), so the table may not be whole.
+        // Callers fall back to the bloom files until it's done.
+        if (header->flags & BLOOM_INDEX_WRITING) {
+            close();
+            return false;
+        }
+
+        // A writer may re-write the header and table in place while we have the file open, so we
+        // keep our own copies. The records we know of are never written to again.
+        m_header  = *header;
+        m_records = (const CBloomRecord *)(data + sizeof(CBloomIndexHeader));
+        const uint64_t *table = (const uint64_t *)(data + header->tableOffset);
+        m_table.assign(table, table + header->nBuckets);
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    void CBloomIndex::close(void) {
+        if (m_file)
+            delete m_file;
+        m_file    = NULL;
+        m_records = NULL;
+        m_table.clear();
+        memset(&m_header, 0, sizeof(m_header));
+    }
+
+    //-------------------------------------------------------------------------
+    // Returns the index of the first record at or after block 'bn' (or nRecords if there is none)
+    uint64_t CBloomIndex::findFirst(blknum_t bn) const {
+        if (!isValid())
+            return 0;
+
+        uint64_t bucket = bn / BLOOM_INDEX_BUCKET;
+        if (bucket >= m_table.size())
+            return m_header.nRecords;
+
+        // The table gets us to the right bucket, a binary search finds the block within it
+        uint64_t last  = (bucket + 1 < m_table.size() ? m_table[bucket + 1] : m_header.nRecords);
+        last = min(last, m_header.nRecords);
+        uint64_t first = min(m_table[bucket], last);
+        const CBloomRecord *found =
+            std::lower_bound(m_records + first, m_records + last, bn,
+                             [](const CBloomRecord& rec, blknum_t val) { return rec.blockNum < val; });
+        return (uint64_t)(found - m_records);
+    }
+
+    //-------------------------------------------------------------------------
+    bool CBloomIndex::getBlooms(blknum_t bn, SFBloomArray& blooms) const {
+        blooms.Clear();
+        for (uint64_t i = findFirst(bn) ; i < nRecords() && m_records[i].blockNum == bn ; i++)
+            blooms[blooms.getCount()] = m_records[i].bloom;
+        return blooms.getCount() > 0;
+    }
+
+    //-------------------------------------------------------------------------
+    CBloomIndexWriter::CBloomIndexWriter(void) : m_archive(NULL), m_isEmpty(true), m_marked(false) {
+        memset(&m_header, 0, sizeof(m_header));
+    }
+
+    //-------------------------------------------------------------------------
+    CBloomIndexWriter::~CBloomIndexWriter(void) {
+        close();
+    }
+
+    //-------------------------------------------------------------------------
+    bool CBloomIndexWriter::open(const SFString& fileName) {
+        if (m_archive)
+            return false;
+
+        memset(&m_header, 0, sizeof(m_header));
+        memcpy(m_header.magic, BLOOM_INDEX_MAGIC, sizeof(m_header.magic));
+        m_header.version     = BLOOM_INDEX_VERSION;
+        m_header.recordSize  = sizeof(CBloomRecord);
+        m_header.tableOffset = sizeof(CBloomIndexHeader);
+        m_table.Clear();
+        m_isEmpty = true;
+        m_marked  = false;
+
+        bool exists = fileExists(fileName) && fileSize(fileName) > 0;
+        if (!exists && !establishFolder(fileName))
+            return false;
+
+        m_archive = new SFArchive(WRITING_ARCHIVE);
+        if (!m_archive->Lock(fileName, exists ? binaryReadWrite : binaryWriteCreate, LOCK_WAIT)) {
+            cerr << "Could not open the bloom index " << fileName << ": " << m_archive->LockFailure() << "\n";
+            delete m_archive;
+            m_archive = NULL;
+            return false;
+        }
+
+        if (exists) {
+            CBloomIndexHeader header;
+            memset(&header, 0, sizeof(header));
+            m_archive->Read(&header, sizeof(header), 1);
+            if (!isValidHeader(&header, fileSize(fileName))) {
+                cerr << "The bloom index at " << fileName << " is corrupted or from a different version. "
+                        "Remove it and rebuild.\n";
+                m_archive->Release();
+                delete m_archive;
+                m_archive = NULL;
+                return false;
+            }
+            m_header = header;
+            m_isEmpty = (m_header.nRecords == 0);
+            if (m_header.flags & BLOOM_INDEX_WRITING) {
+                // The last writer died part way. The header still describes the records it had
+                // finished with, but it may have written over their table.
+                rebuildTable();
+                m_marked = true;
+            } else {
+                m_archive->Seek((long)m_header.tableOffset, SEEK_SET);
+                for (uint64_t i = 0 ; i < m_header.nBuckets ; i++) {
+                    uint64_t val = 0;
+                    m_archive->Read(&val, sizeof(val), 1);
+                    m_table[(uint32_t)i] = val;
+                }
+            }
+        } else {
+            m_archive->Write(&m_header, sizeof(m_header), 1);
+        }
+
+        // New records go where the table used to be
+        m_archive->Seek((long)m_header.tableOffset, SEEK_SET);
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    // Finds each bucket's first record by searching the records themselves
+    void CBloomIndexWriter::rebuildTable(void) {
+        m_table.Clear();
+        for (uint64_t bucket = 0 ; bucket < m_header.nBuckets ; bucket++) {
+            blknum_t bn = bucket * BLOOM_INDEX_BUCKET;
+            uint64_t first = 0, last = m_header.nRecords;
+            while (first < last) {
+                uint64_t mid = first + (last - first) / 2;
+                blknum_t val = 0;
+                m_archive->Seek((long)(sizeof(CBloomIndexHeader) + mid * sizeof(CBloomRecord)), SEEK_SET);
+                m_archive->Read(&val, sizeof(val), 1);
+                if (val < bn)
+                    first = mid + 1;
+                else
+                    last = mid;
+            }
+            m_table[(uint32_t)bucket] = first;
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    // Writes the header with the given flags and waits for it to reach the disc
+    bool CBloomIndexWriter::writeHeader(uint64_t flags) {
+        m_header.flags = flags;
+        m_archive->Seek(0, SEEK_SET);
+        bool ok = (m_archive->Write(&m_header, sizeof(m_header), 1) == 1);
+        m_archive->flush();
+        return ok && fsync(fileno(m_archive->m_fp)) == 0;
+    }
+
+    //-------------------------------------------------------------------------
+    bool CBloomIndexWriter::append(blknum_t bn, const SFBloomArray& blooms) {
+        if (!m_archive)
+            return false;
+        if (!m_isEmpty && bn <= m_header.lastBlock)
+            return false;
+        if (!blooms.getCount())
+            return true;
+
+        // Every bucket up to and including this block's bucket that does not yet have an entry
+        // starts at the record we're about to write
+        uint64_t bucket = bn / BLOOM_INDEX_BUCKET;
+        while (m_table.getCount() <= bucket)
+            m_table[m_table.getCount()] = m_header.nRecords;
+
+        // The first record goes where the table is, so readers must stop trusting it first. The
+        // header keeps the old counts until close(), which is what a writer after a crash needs.
+        if (!m_marked) {
+            if (!writeHeader(BLOOM_INDEX_WRITING))
+                return false;
+            m_marked = true;
+            m_archive->Seek((long)m_header.tableOffset, SEEK_SET);
+        }
+
+        CBloomRecord record;
+        record.blockNum = bn;
+        record.nBlooms  = blooms.getCount();
+        for (uint32_t i = 0 ; i < blooms.getCount() ; i++) {
+            record.which = i;
+            record.bloom = blooms[i];
+            m_archive->Write(&record, sizeof(record), 1);
+        }
+
+        m_header.nRecords   += blooms.getCount();
+        m_header.tableOffset = sizeof(CBloomIndexHeader) + m_header.nRecords * sizeof(CBloomRecord);
+        m_header.lastBlock   = bn;
+        m_isEmpty            = false;
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    bool CBloomIndexWriter::close(void) {
+        if (!m_archive)
+            return false;
+
+        m_header.nBuckets = m_table.getCount();
+        m_archive->Seek((long)m_header.tableOffset, SEEK_SET);
+        for (uint32_t i = 0 ; i < m_table.getCount() ; i++) {
+            uint64_t val = m_table[i];
+            m_archive->Write(&val, sizeof(val), 1);
+        }
+
+        // The header goes last, once the table is on disc, so a reader never sees a table that
+        // is not there yet
+        m_archive->flush();
+        fsync(fileno(m_archive->m_fp));
+        writeHeader(0);
+        m_archive->Release();
+        delete m_archive;
+        m_archive = NULL;
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    CBloomIndex *getBloomIndex(bool cleanup) {
+        static CBloomIndex *theIndex = NULL;
+        if (cleanup) {
+            if (theIndex)
+                delete theIndex;
+            theIndex = NULL;
+            return NULL;
+        }
+
+        if (!theIndex) {
+            theIndex = new CBloomIndex;
+            theIndex->open(bloomIndex);
+        }
+        return theIndex;
+    }
+
+    //-------------------------------------------------------------------------
+    bool forEveryBloomInIndex(BLOOMVISITFUNC func, void *data, uint64_t start, uint64_t count, uint64_t skip) {
+        if (!func)
+            return false;
+
+        const CBloomIndex *index = getBloomIndex();
+        if (!index->isValid())
+            return false;
+
+        blknum_t end = (count > UINT64_MAX - start ? UINT64_MAX : start + count);
+        for (uint64_t i = index->findFirst(start) ; i < index->nRecords() ; i++) {
+            const CBloomRecord& record = (*index)[i];
+            if (record.blockNum >= end)
+                break;
+            if (skip > 1 && ((record.blockNum - start) % skip))
+                continue;
+            if (!(*func)(record, data))
+                return false;
+        }
+        return true;
+    }
+
+}  // namespace qblocks
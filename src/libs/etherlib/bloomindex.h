@@ -0,0 +1,126 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include <vector>
+#include "etherlib.h"
+
+namespace qblocks {
+
+    //-------------------------------------------------------------------------
+    // The bloom index packs every block's EAB blooms into a single file:
+    //
+    //      header | record 0 | record 1 | ... | record n-1 | offset table
+    //
+    // Records are fixed size and sorted by block number (a block with more than one bloom has
+    // one record per bloom). Entry 'i' of the offset table is the index of the first record at
+    // or after block i * BLOOM_INDEX_BUCKET. Appending new records overwrites the table, which
+    // is then re-written at the new end of the file, so existing records never move.
+    //
+    // Before it overwrites the table a writer marks the header as being written (and syncs it),
+    // and it only clears the mark once the new table is on disc. Readers that open a marked
+    // index ignore it. Readers that opened it before keep their own copy of the header and the
+    // table, and the records they know of are never written to, so they are not disturbed. If a
+    // writer dies part way, the next one rebuilds the table from the records it had finished.
+    //-------------------------------------------------------------------------
+    #define BLOOM_INDEX_MAGIC   "qbBlooms"
+    #define BLOOM_INDEX_VERSION 1
+    #define BLOOM_INDEX_BUCKET  1000
+    #define BLOOM_INDEX_WRITING 1
+
+    //-------------------------------------------------------------------------
+    struct CBloomIndexHeader {
+        char     magic[8];
+        uint32_t version;
+        uint32_t recordSize;
+        uint64_t nRecords;
+        uint64_t lastBlock;
+        uint64_t tableOffset;
+        uint64_t nBuckets;
+        uint64_t flags;
+        uint64_t unused;
+    };
+
+    //-------------------------------------------------------------------------
+    struct CBloomRecord {
+        uint64_t   blockNum;
+        uint32_t   which;    // this bloom's position in its block's bloom array
+        uint32_t   nBlooms;  // the number of blooms in this block
+        CBloom2048 bloom;
+    };
+
+    //-------------------------------------------------------------------------
+    // Read-only view of a bloom index. The file is memory mapped, so opening it costs the same
+    // no matter how many blocks it holds
+    class CBloomIndex {
+    public:
+        CBloomIndex(void);
+        ~CBloomIndex(void);
+
+        bool open (const SFString& fileName);
+        void close(void);
+
+        bool     isValid   (void) const { return m_records != NULL; }
+        uint64_t nRecords  (void) const { return (isValid() ? m_header.nRecords : 0); }
+        blknum_t lastBlock (void) const { return (isValid() ? m_header.lastBlock : 0); }
+
+        const CBloomRecord& operator[](uint64_t index) const { return m_records[index]; }
+
+        uint64_t findFirst (blknum_t bn) const;
+        bool     getBlooms (blknum_t bn, SFBloomArray& blooms) const;
+
+    private:
+        CMemMapFile           *m_file;
+        CBloomIndexHeader      m_header;
+        const CBloomRecord    *m_records;
+        std::vector<uint64_t>  m_table;
+
+        CBloomIndex(const CBloomIndex&);
+        CBloomIndex& operator=(const CBloomIndex&);
+    };
+
+    //-------------------------------------------------------------------------
+    // Appends blocks to a bloom index (creating it if needed). Blocks must be appended in
+    // increasing order and after the index's last block. Readers that open the index between the
+    // first append and close() don't see it at all. After close() they see the new blocks.
+    class CBloomIndexWriter {
+    public:
+        CBloomIndexWriter(void);
+        ~CBloomIndexWriter(void);
+
+        bool open  (const SFString& fileName);
+        bool append(blknum_t bn, const SFBloomArray& blooms);
+        bool close (void);
+
+        blknum_t lastBlock(void) const { return m_header.lastBlock; }
+        bool     isEmpty  (void) const { return m_isEmpty; }
+
+    private:
+        SFArchive        *m_archive;
+        CBloomIndexHeader m_header;
+        SFUintArray       m_table;
+        bool              m_isEmpty;
+        bool              m_marked;
+
+        bool writeHeader(uint64_t flags);
+        void rebuildTable(void);
+
+        CBloomIndexWriter(const CBloomIndexWriter&);
+        CBloomIndexWriter& operator=(const CBloomIndexWriter&);
+    };
+
+    //-------------------------------------------------------------------------
+    typedef bool (*BLOOMVISITFUNC)(const CBloomRecord& record, void *data);
+    extern bool forEveryBloomInIndex(BLOOMVISITFUNC func, void *data, uint64_t start, uint64_t count, uint64_t skip=1);
+    extern CBloomIndex *getBloomIndex(bool cleanup=false);
+
+}  // namespace qblocks
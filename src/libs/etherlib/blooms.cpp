@@ -19,7 +19,7 @@
 namespace qblocks {
 
     //-------------------------------------------------------------------------
-    SFString formatBloom(const SFBloom& b1, bool bits) {
+    SFString formatBloom(const CBloom2048& b1, bool bits) {
         SFString ret;
         if (bits) {
             ret = "\tbits: " + asStringU(bitsTwiddled(b1));
@@ -46,7 +46,7 @@ namespace qblocks {
     }
 
     //-------------------------------------------------------------------------
-    bool compareBlooms(const SFBloom& b1, const SFBloom& b2, SFString& str) {
+    bool compareBlooms(const CBloom2048& b1, const CBloom2048& b2, SFString& str) {
         if (verbose > 2) {
             str = "\n\tbits1: " + asStringU(bitsTwiddled(b1)) + " bits2: " + asStringU(bitsTwiddled(b2));
             SFString s1 = bloom2Bits(b1).Substitute("0", ".");
@@ -81,7 +81,7 @@ namespace qblocks {
         if (blooms.getCount() == 0)
             blooms[0] = 0;
         uint32_t cnt = blooms.getCount();
-        blooms[cnt - 1] = joinBloom(blooms[cnt - 1], makeBloom(addr));
+        blooms[cnt - 1] |= makeBloom(addr);
         if (bitsTwiddled(blooms[cnt - 1]) > maxBits) {
             blooms[cnt] = 0; // start a new bloom
             return true;
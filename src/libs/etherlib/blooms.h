@@ -21,36 +21,55 @@ namespace qblocks {
 #define dbgBloom(a) bloom2Bytes(a).Substitute("0"," ")
 
     //-------------------------------------------------------------------------
-    inline SFUintBN makeBloom(const SFString& hexIn) {
-        if (hexIn.empty() || !hexIn.startsWith("0x"))
-            return 0;
-
-extern SFString getSha3 (const SFString& hexIn);
-        SFString sha = getSha3(hexIn);
-        SFUintBN bloom;
+    // The bloom bits for an item are taken from the first three 16-bit words of its sha3
+    inline CBloom2048 shaToBloom(const SFString& sha) {
+        CBloom2048 bloom;
         for (uint32_t i=0;i<3;i++)
-            bloom |= (SFUintBN(1) << (strtoul((const char*)"0x"+sha.substr(2+(i*4),4),NULL,16))%2048);
+            bloom.setBit((uint32_t)(strtoul((const char*)"0x"+sha.substr(2+(i*4),4),NULL,16) % 2048));
         return bloom;
     }
 
+    //-------------------------------------------------------------------------
+    inline CBloom2048 makeBloom(const SFString& hexIn) {
+        if (hexIn.empty() || !hexIn.startsWith("0x"))
+            return CBloom2048();
+
+        return shaToBloom(keccak256(hexIn));
+    }
+
+    //-------------------------------------------------------------------------
+    inline CBloom2048 joinBloom(const CBloom2048& b1, const CBloom2048& b2) {
+        return (b1 | b2);
+    }
+
     //-------------------------------------------------------------------------
     inline SFBloom joinBloom(const SFBloom& b1, const SFBloom& b2) {
         return (b1 | b2);
     }
 
+    //-------------------------------------------------------------------------
+    inline bool isBloomHit(const CBloom2048& test, const CBloom2048& filter) {
+        return filter.contains(test);
+    }
+
     //-------------------------------------------------------------------------
     inline bool isBloomHit(const SFUintBN& test, const SFUintBN filter) {
         return ((test & filter) == test);
     }
 
     //-------------------------------------------------------------------------
-    inline bool isBloomHit(const SFString& hexIn, const SFUintBN filter) {
+    inline bool isBloomHit(const SFString& hexIn, const CBloom2048& filter) {
         return isBloomHit(makeBloom(hexIn),filter);
     }
 
+    //-------------------------------------------------------------------------
+    inline bool isBloomHit(const SFString& hexIn, const SFUintBN filter) {
+        return isBloomHit(makeBloom(hexIn),CBloom2048(filter));
+    }
+
     //----------------------------------------------------------------------------------
-    extern bool compareBlooms(const SFBloom& b1, const SFBloom& b2, SFString& str);
-    extern SFString formatBloom(const SFBloom& b1, bool bits);
+    extern bool compareBlooms(const CBloom2048& b1, const CBloom2048& b2, SFString& str);
+    extern SFString formatBloom(const CBloom2048& b1, bool bits);
     extern bool addAddrToBloom(const SFAddress& addr, SFBloomArray& blooms, uint32_t maxBits);
 
     //----------------------------------------------------------------------------------
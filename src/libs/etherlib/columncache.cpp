@@ -0,0 +1,672 @@
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include "columncache.h"
+
+namespace qblocks {
+
+    static_assert(sizeof(CColumnChunkHeader) == 64, "column chunk header must be 64 bytes");
+    static_assert(sizeof(CColumnDesc)        == 16, "column descriptors must be 16 bytes");
+
+    //-------------------------------------------------------------------------
+    // The width in bytes of each column's rows
+    static const uint32_t columnWidths[N_COLUMNS] = {
+        8, 8, 8, 8, 32, 32, 20, 8, 8, 2, 8, 4,       // blocks
+        32, 8, 8, 20, 20, 32, 8, 8, 4, 2, 20, 8, 4,  // transactions
+    };
+
+    //-------------------------------------------------------------------------
+    // Hashes and addresses are stored as raw bytes. The flags record whether the field was empty.
+    // (Chunks written while these fields were strings may also hold SHAPE_0X, which reads as
+    // empty, as "0x" does everywhere else.)
+    #define SHAPE_FULL  0  // a value
+    #define SHAPE_EMPTY 1  // no value
+    #define SHAPE_0X    2  // "0x"
+    #define SHAPE_BAD   3  // not used
+
+    // COL_BLOCKFLAGS
+    #define BF_FINALIZED   (1<<0)
+    #define BF_INEXACT     (1<<1)
+    #define BF_HASH        2
+    #define BF_PARENTHASH  4
+    #define BF_MINER       6
+
+    // COL_TX_FLAGS
+    #define TF_ISERROR     (1<<0)
+    #define TF_ISINTERNAL  (1<<1)
+    #define TF_TIMESTAMP   (1<<2)  // the transaction carries its block's timestamp (otherwise zero)
+    #define TF_BLOCKINFO   (1<<3)  // the transaction carries its block's number and hash (otherwise empty)
+    #define TF_HASH        4
+    #define TF_FROM        6
+    #define TF_TO          8
+    #define TF_CONTRACT    10
+
+    #define getShape(flags, at)  (((flags) >> (at)) & 0x3)
+
+    //-------------------------------------------------------------------------
+    template<size_t WIDTH>
+    static uint32_t toBytes(const CFieldBytes<WIDTH>& field, uint8_t *out) {
+        memcpy(out, field.bytes, WIDTH);
+        return (field.empty() ? SHAPE_EMPTY : SHAPE_FULL);
+    }
+
+    //-------------------------------------------------------------------------
+    template<size_t WIDTH>
+    static void fromBytes(CFieldBytes<WIDTH>& field, const uint8_t *in, uint32_t shape) {
+        if (shape == SHAPE_FULL)
+            field = CFixedBytes<WIDTH>(in);
+        else
+            field.setEmpty();
+    }
+
+    //-------------------------------------------------------------------------
+    static bool isValidHeader(const CColumnChunkHeader *header, uint64_t fileSize) {
+        if (fileSize < sizeof(CColumnChunkHeader) + N_COLUMNS * sizeof(CColumnDesc))
+            return false;
+        if (memcmp(header->magic, COLUMN_CACHE_MAGIC, sizeof(header->magic)))
+            return false;
+        if (header->version != COLUMN_CACHE_VERSION || header->nColumns != N_COLUMNS)
+            return false;
+        return (header->dictOffset + (header->nStrings + 1) * sizeof(uint64_t) <= fileSize);
+    }
+
+    //-------------------------------------------------------------------------
+    CColumnChunk::CColumnChunk(void) : m_file(NULL), m_data(NULL), m_header(NULL), m_columns(NULL), m_strings(NULL) {
+    }
+
+    //-------------------------------------------------------------------------
+    CColumnChunk::~CColumnChunk(void) {
+        close();
+    }
+
+    //-------------------------------------------------------------------------
+    bool CColumnChunk::open(const SFString& fileName) {
+        close();
+        if (!fileExists(fileName))
+            return false;
+
+        m_file = new CMemMapFile(fileName.c_str(), CMemMapFile::WholeFile, CMemMapFile::RandomAccess);
+        if (!m_file->isValid()) {
+            close();
+            return false;
+        }
+
+        const unsigned char *data = m_file->getData();
+        const CColumnChunkHeader *header = (const CColumnChunkHeader *)data;
+        if (!isValidHeader(header, m_file->size())) {
+            cerr << "The column cache at " << fileName << " is corrupted or from a different version. Ignoring it.\n";
+            close();
+            return false;
+        }
+
+        const CColumnDesc *columns = (const CColumnDesc *)(data + sizeof(CColumnChunkHeader));
+        for (uint32_t col = 0 ; col < N_COLUMNS ; col++) {
+            uint64_t nRows = (col < COL_TX_HASH ? header->nBlocks : header->nTrans);
+            if (columns[col].width != columnWidths[col] || columns[col].offset + nRows * columns[col].width > header->dictOffset) {
+                cerr << "The column cache at " << fileName << " is corrupted. Ignoring it.\n";
+                close();
+                return false;
+            }
+        }
+
+        m_data    = data;
+        m_header  = header;
+        m_columns = columns;
+        m_strings = (const uint64_t *)(data + header->dictOffset);
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    void CColumnChunk::close(void) {
+        if (m_file)
+            delete m_file;
+        m_file    = NULL;
+        m_data    = NULL;
+        m_header  = NULL;
+        m_columns = NULL;
+        m_strings = NULL;
+    }
+
+    //-------------------------------------------------------------------------
+    // Returns the row holding block 'bn' or NOPOS if the block is not in this chunk
+    uint64_t CColumnChunk::findBlock(blknum_t bn) const {
+        if (!isValid())
+            return NOPOS;
+        const uint64_t *blocks = column<uint64_t>(COL_BLOCKNUMBER);
+        const uint64_t *found  = std::lower_bound(blocks, blocks + nBlocks(), bn);
+        if (found == blocks + nBlocks() || *found != bn)
+            return NOPOS;
+        return (uint64_t)(found - blocks);
+    }
+
+    //-------------------------------------------------------------------------
+    SFString CColumnChunk::getString(uint64_t index) const {
+        if (index >= m_header->nStrings)
+            return "";
+        const char *base = (const char *)(m_strings + m_header->nStrings + 1);
+        return SFString(string_view_q(base + m_strings[index], m_strings[index + 1] - m_strings[index]));
+    }
+
+    //-------------------------------------------------------------------------
+    // Fills in only the fields in 'columns'. The rest are left as they are in an empty block.
+    // Returns false if the block could not be stored exactly, in which case the caller should
+    // read the block's own file.
+    bool CColumnChunk::readBlock(CBlock& block, uint64_t row, uint64_t columns) const {
+        if (!isValid() || row >= nBlocks())
+            return false;
+
+        uint16_t flags = column<uint16_t>(COL_BLOCKFLAGS)[row];
+        if (flags & BF_INEXACT)
+            return false;
+
+        block = CBlock();
+        block.blockNumber = column<uint64_t>(COL_BLOCKNUMBER)[row];
+        block.finalized   = (flags & BF_FINALIZED);
+
+        #define want(col) (columns & COLUMN_BIT(col))
+        if (want(COL_TIMESTAMP))  block.timestamp  = column<int64_t>(COL_TIMESTAMP)[row];
+        if (want(COL_GASLIMIT))   block.gasLimit   = column<uint64_t>(COL_GASLIMIT)[row];
+        if (want(COL_GASUSED))    block.gasUsed    = column<uint64_t>(COL_GASUSED)[row];
+        if (want(COL_DIFFICULTY)) block.difficulty = column<uint64_t>(COL_DIFFICULTY)[row];
+        if (want(COL_PRICE))      block.price      = column<double>(COL_PRICE)[row];
+        if (want(COL_HASH))       fromBytes(block.hash,       column<uint8_t>(COL_HASH) + row * 32,       getShape(flags, BF_HASH));
+        if (want(COL_PARENTHASH)) fromBytes(block.parentHash, column<uint8_t>(COL_PARENTHASH) + row * 32, getShape(flags, BF_PARENTHASH));
+        if (want(COL_MINER))      fromBytes(block.miner,      column<uint8_t>(COL_MINER) + row * 20,      getShape(flags, BF_MINER));
+
+        if (!(columns & (COLUMN_BIT(COL_FIRSTTRANS) | COLUMN_BIT(COL_NTRANS) | TRANS_COLUMNS)))
+            return true;
+
+        // The transactions' copy of the block's hash and timestamp comes from the block
+        int64_t  timestamp = column<int64_t>(COL_TIMESTAMP)[row];
+        CHashField blockHash;
+        fromBytes(blockHash, column<uint8_t>(COL_HASH) + row * 32, getShape(flags, BF_HASH));
+
+        uint64_t first = column<uint64_t>(COL_FIRSTTRANS)[row];
+        uint32_t count = column<uint32_t>(COL_NTRANS)[row];
+        for (uint32_t i = 0 ; i < count ; i++) {
+            uint64_t t = first + i;
+            CTransaction *trans = &block.transactions[i];
+            uint16_t tFlags = column<uint16_t>(COL_TX_FLAGS)[t];
+            if (tFlags & TF_BLOCKINFO) {
+                trans->blockNumber = block.blockNumber;
+                trans->blockHash   = blockHash;
+            }
+            if (tFlags & TF_TIMESTAMP)
+                trans->timestamp = timestamp;
+            trans->isError    = (tFlags & TF_ISERROR    ? 1 : 0);
+            trans->isInternal = (tFlags & TF_ISINTERNAL ? 1 : 0);
+
+            if (want(COL_TX_HASH))     fromBytes(trans->hash,   column<uint8_t>(COL_TX_HASH) + t * 32, getShape(tFlags, TF_HASH));
+            if (want(COL_TX_INDEX))    trans->transactionIndex = column<uint64_t>(COL_TX_INDEX)[t];
+            if (want(COL_TX_NONCE))    trans->nonce            = column<uint64_t>(COL_TX_NONCE)[t];
+            if (want(COL_TX_FROM))     fromBytes(trans->from,   column<uint8_t>(COL_TX_FROM) + t * 20, getShape(tFlags, TF_FROM));
+            if (want(COL_TX_TO))       fromBytes(trans->to,     column<uint8_t>(COL_TX_TO) + t * 20,   getShape(tFlags, TF_TO));
+            if (want(COL_TX_GAS))      trans->gas              = column<uint64_t>(COL_TX_GAS)[t];
+            if (want(COL_TX_GASPRICE)) trans->gasPrice         = column<uint64_t>(COL_TX_GASPRICE)[t];
+            if (want(COL_TX_INPUT))    trans->input            = getString(column<uint32_t>(COL_TX_INPUT)[t]);
+            if (want(COL_TX_VALUE)) {
+                const uint64_t *words = column<uint64_t>(COL_TX_VALUE) + t * 4;
+                unsigned int len = 4;
+                while (len > 0 && words[len - 1] == 0)
+                    len--;
+                trans->value = SFUintBN(words, len);
+            }
+            if (want(COL_RC_CONTRACT)) fromBytes(trans->receipt.contractAddress, column<uint8_t>(COL_RC_CONTRACT) + t * 20, getShape(tFlags, TF_CONTRACT));
+            if (want(COL_RC_GASUSED))  trans->receipt.gasUsed         = column<uint64_t>(COL_RC_GASUSED)[t];
+            if (want(COL_RC_STATUS))   trans->receipt.status          = column<uint32_t>(COL_RC_STATUS)[t];
+        }
+        #undef want
+
+        // The array is complete, so the back pointers won't move from here on
+        for (uint32_t i = 0 ; i < block.transactions.getCount() ; i++) {
+            CTransaction *trans = &block.transactions[i];
+            trans->pBlock = &block;
+            trans->finishParse();
+        }
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    CColumnChunkWriter::CColumnChunkWriter(blknum_t firstBlock) : m_firstBlock(firstBlock), m_nBlocks(0), m_nTrans(0) {
+    }
+
+    //-------------------------------------------------------------------------
+    uint32_t CColumnChunkWriter::addString(const SFString& str) {
+        std::string key((const char *)str, str.length());
+        std::map<std::string, uint32_t>::const_iterator it = m_stringIndex.find(key);
+        if (it != m_stringIndex.end())
+            return it->second;
+
+        uint32_t index = m_stringOffsets.getCount();
+        m_stringOffsets[index] = m_dictionary.size();
+        m_dictionary += key;
+        m_stringIndex[key] = index;
+        return index;
+    }
+
+    //-------------------------------------------------------------------------
+    #define appendValue(col, val) { \
+        static_assert(sizeof(val) == 8 || sizeof(val) == 4 || sizeof(val) == 2, "bad column type"); \
+        m_columns[col].append((const char *)&(val), sizeof(val)); }
+    #define appendBytes(col, field, shift, width, flags) { \
+        uint8_t bytes[32]; \
+        uint32_t shape = toBytes(field, bytes); \
+        flags |= (uint16_t)((shape & 0x3) << shift); \
+        m_columns[col].append((const char *)bytes, width); }
+
+    //-------------------------------------------------------------------------
+    bool CColumnChunkWriter::addBlock(const CBlock& block) {
+        if (block.blockNumber < m_firstBlock || block.blockNumber >= m_firstBlock + COLUMN_CHUNK_SIZE)
+            return false;
+        if (m_nBlocks) {
+            const uint64_t *blocks = (const uint64_t *)m_columns[COL_BLOCKNUMBER].data();
+            if (block.blockNumber <= blocks[m_nBlocks - 1])
+                return false;
+        }
+
+        bool inexact = false;
+        uint16_t flags = (block.finalized ? BF_FINALIZED : 0);
+        uint64_t first = m_nTrans;
+        uint32_t count = block.transactions.getCount();
+        appendValue(COL_BLOCKNUMBER, block.blockNumber);
+        appendValue(COL_TIMESTAMP,   block.timestamp);
+        appendValue(COL_GASLIMIT,    block.gasLimit);
+        appendValue(COL_GASUSED,     block.gasUsed);
+        appendValue(COL_DIFFICULTY,  block.difficulty);
+        appendValue(COL_PRICE,       block.price);
+        appendValue(COL_FIRSTTRANS,  first);
+        appendValue(COL_NTRANS,      count);
+        appendBytes(COL_HASH,        block.hash,       BF_HASH,       32, flags);
+        appendBytes(COL_PARENTHASH,  block.parentHash, BF_PARENTHASH, 32, flags);
+        appendBytes(COL_MINER,       block.miner,      BF_MINER,      20, flags);
+
+        for (uint32_t i = 0 ; i < count ; i++) {
+            const CTransaction *trans = &block.transactions[i];
+            uint16_t tFlags = 0;
+
+            if (trans->blockNumber == block.blockNumber && trans->blockHash == block.hash)
+                tFlags |= TF_BLOCKINFO;
+            else if (trans->blockNumber != 0 || !trans->blockHash.empty())
+                inexact = true;
+            if (trans->timestamp == block.timestamp)
+                tFlags |= TF_TIMESTAMP;
+            else if (trans->timestamp != 0)
+                inexact = true;
+            if (trans->isError > 1 || trans->isInternal > 1)
+                inexact = true;
+            tFlags |= (trans->isError ? TF_ISERROR : 0) | (trans->isInternal ? TF_ISINTERNAL : 0);
+
+            uint64_t words[4] = { 0, 0, 0, 0 };
+            if (trans->value.len > 4)
+                inexact = true;
+            for (uint32_t w = 0 ; w < trans->value.len && w < 4 ; w++)
+                words[w] = trans->value.blk[w];
+            m_columns[COL_TX_VALUE].append((const char *)words, sizeof(words));
+
+            uint32_t input = addString(trans->input);
+            appendValue(COL_TX_INDEX,    trans->transactionIndex);
+            appendValue(COL_TX_NONCE,    trans->nonce);
+            appendValue(COL_TX_GAS,      trans->gas);
+            appendValue(COL_TX_GASPRICE, trans->gasPrice);
+            appendValue(COL_TX_INPUT,    input);
+            appendValue(COL_RC_GASUSED,  trans->receipt.gasUsed);
+            appendValue(COL_RC_STATUS,   trans->receipt.status);
+            appendBytes(COL_TX_HASH,     trans->hash,                    TF_HASH,     32, tFlags);
+            appendBytes(COL_TX_FROM,     trans->from,                    TF_FROM,     20, tFlags);
+            appendBytes(COL_TX_TO,       trans->to,                      TF_TO,       20, tFlags);
+            appendBytes(COL_RC_CONTRACT, trans->receipt.contractAddress, TF_CONTRACT, 20, tFlags);
+            appendValue(COL_TX_FLAGS,    tFlags);
+
+            // Logs are not in the columnar cache
+            if (trans->receipt.logs.getCount())
+                inexact = true;
+        }
+
+        if (inexact)
+            flags |= BF_INEXACT;
+        appendValue(COL_BLOCKFLAGS, flags);
+
+        m_nBlocks++;
+        m_nTrans += count;
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    // The chunk is written to a temporary file which is then renamed over the old one, so a reader
+    // that has the old chunk mapped keeps seeing it whole
+    bool CColumnChunkWriter::write(const SFString& fileName) const {
+        if (!establishFolder(fileName))
+            return false;
+
+        SFString tempName = fileName + ".tmp";
+        SFArchive archive(WRITING_ARCHIVE);
+        if (!archive.Lock(tempName, binaryWriteCreate, LOCK_WAIT)) {
+            cerr << "Could not write the column cache " << tempName << ": " << archive.LockFailure() << "\n";
+            return false;
+        }
+
+        CColumnChunkHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, COLUMN_CACHE_MAGIC, sizeof(header.magic));
+        header.version    = COLUMN_CACHE_VERSION;
+        header.nColumns   = N_COLUMNS;
+        header.firstBlock = m_firstBlock;
+        header.nBlocks    = m_nBlocks;
+        header.nTrans     = m_nTrans;
+        header.nStrings   = m_stringOffsets.getCount();
+
+        // Every column starts on an eight byte boundary
+        CColumnDesc columns[N_COLUMNS];
+        uint64_t offset = sizeof(CColumnChunkHeader) + sizeof(columns);
+        for (uint32_t col = 0 ; col < N_COLUMNS ; col++) {
+            columns[col].width  = columnWidths[col];
+            columns[col].unused = 0;
+            columns[col].offset = offset;
+            offset += (m_columns[col].size() + 7) & ~(uint64_t)7;
+        }
+        header.dictOffset = offset;
+
+        archive.Write(&header, sizeof(header), 1);
+        archive.Write(columns, sizeof(columns), 1);
+        static const char zeros[8] = { 0 };
+        for (uint32_t col = 0 ; col < N_COLUMNS ; col++) {
+            const std::string& data = m_columns[col];
+            if (data.size())
+                archive.Write(data.data(), data.size(), 1);
+            uint64_t pad = ((data.size() + 7) & ~(uint64_t)7) - data.size();
+            if (pad)
+                archive.Write(zeros, pad, 1);
+        }
+
+        for (uint32_t i = 0 ; i < m_stringOffsets.getCount() ; i++) {
+            uint64_t val = m_stringOffsets[i];
+            archive.Write(&val, sizeof(val), 1);
+        }
+        uint64_t end = m_dictionary.size();
+        archive.Write(&end, sizeof(end), 1);
+        if (m_dictionary.size())
+            archive.Write(m_dictionary.data(), m_dictionary.size(), 1);
+        archive.Release();
+
+        return (rename(tempName.c_str(), fileName.c_str()) == 0);
+    }
+
+    //-------------------------------------------------------------------------
+    // Marks the rows of 'blocks' (in increasing order) in the open chunk as inexact, so readers go
+    // to the blocks' own files. Blocks not in the chunk are skipped.
+    static bool markInexact(int fd, const SFUintArray& blocks) {
+        struct stat st;
+        CColumnChunkHeader header;
+        CColumnDesc columns[N_COLUMNS];
+        if (fstat(fd, &st) != 0 || pread(fd, &header, sizeof(header), 0) != sizeof(header))
+            return false;
+        if (!isValidHeader(&header, (uint64_t)st.st_size) || pread(fd, columns, sizeof(columns), sizeof(header)) != sizeof(columns))
+            return false;
+
+        uint64_t lo = 0;
+        for (uint32_t i = 0 ; i < blocks.getCount() ; i++) {
+            uint64_t hi = header.nBlocks, val = 0;
+            while (lo < hi) {
+                uint64_t mid = lo + (hi - lo) / 2;
+                if (pread(fd, &val, sizeof(val), (off_t)(columns[COL_BLOCKNUMBER].offset + mid * sizeof(val))) != sizeof(val))
+                    return false;
+                if (val < blocks[i])
+                    lo = mid + 1;
+                else
+                    hi = mid;
+            }
+            if (lo == header.nBlocks)
+                break;
+            if (pread(fd, &val, sizeof(val), (off_t)(columns[COL_BLOCKNUMBER].offset + lo * sizeof(val))) != sizeof(val))
+                return false;
+            if (val != blocks[i])
+                continue;
+            uint16_t flags = 0;
+            off_t where = (off_t)(columns[COL_BLOCKFLAGS].offset + lo * sizeof(flags));
+            if (pread(fd, &flags, sizeof(flags), where) != sizeof(flags))
+                return false;
+            flags |= BF_INEXACT;
+            if (pwrite(fd, &flags, sizeof(flags), where) != sizeof(flags))
+                return false;
+        }
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    SFString getColumnFilename(blknum_t bn) {
+        return columnFolder + padNum9(bn - (bn % COLUMN_CHUNK_SIZE)) + ".bin";
+    }
+
+    //-------------------------------------------------------------------------
+    struct CColumnMap {
+        const char *fieldName;
+        uint64_t    columns;
+    };
+    #define NO_COLUMN ((uint64_t)-1)
+
+    //-------------------------------------------------------------------------
+    // Derived fields are listed with the columns they are computed from. Fields that are not
+    // listed (or are listed with NO_COLUMN) cannot be read from the columnar cache.
+    static const CColumnMap blockFields[] = {
+        { "gasLimit",     COLUMN_BIT(COL_GASLIMIT)   },
+        { "gasUsed",      COLUMN_BIT(COL_GASUSED)    },
+        { "hash",         COLUMN_BIT(COL_HASH)       },
+        { "blockNumber",  0                          },
+        { "parentHash",   COLUMN_BIT(COL_PARENTHASH) },
+        { "miner",        COLUMN_BIT(COL_MINER)      },
+        { "difficulty",   COLUMN_BIT(COL_DIFFICULTY) },
+        { "price",        COLUMN_BIT(COL_PRICE)      },
+        { "finalized",    0                          },
+        { "timestamp",    COLUMN_BIT(COL_TIMESTAMP)  },
+        { "date",         COLUMN_BIT(COL_TIMESTAMP)  },
+        { "transactions", COLUMN_BIT(COL_FIRSTTRANS) | COLUMN_BIT(COL_NTRANS) | COLUMN_BIT(COL_TX_FLAGS) },
+        { NULL, 0 },
+    };
+
+    static const CColumnMap transFields[] = {
+        { "hash",             COLUMN_BIT(COL_TX_HASH)     },
+        { "blockHash",        COLUMN_BIT(COL_HASH)        },
+        { "blockNumber",      0                           },
+        { "transactionIndex", COLUMN_BIT(COL_TX_INDEX)    },
+        { "nonce",            COLUMN_BIT(COL_TX_NONCE)    },
+        { "timestamp",        COLUMN_BIT(COL_TIMESTAMP)   },
+        { "from",             COLUMN_BIT(COL_TX_FROM)     },
+        { "to",               COLUMN_BIT(COL_TX_TO)       },
+        { "value",            COLUMN_BIT(COL_TX_VALUE)    },
+        { "gas",              COLUMN_BIT(COL_TX_GAS)      },
+        { "gasPrice",         COLUMN_BIT(COL_TX_GASPRICE) },
+        { "input",            COLUMN_BIT(COL_TX_INPUT)    },
+        { "isError",          0                           },
+        { "isInternal",       0                           },
+        { "receipt",          0                           },
+        { "gasUsed",          COLUMN_BIT(COL_RC_GASUSED)  },
+        { "gasCost",          COLUMN_BIT(COL_RC_GASUSED) | COLUMN_BIT(COL_TX_GASPRICE) },
+        { "ether",            COLUMN_BIT(COL_TX_VALUE)    },
+        { "date",             COLUMN_BIT(COL_TIMESTAMP)   },
+        { "datesh",           COLUMN_BIT(COL_TIMESTAMP)   },
+        { "time",             COLUMN_BIT(COL_TIMESTAMP)   },
+        { "function",         COLUMN_BIT(COL_TX_INPUT) | COLUMN_BIT(COL_TX_TO) },
+        { "encoding",         COLUMN_BIT(COL_TX_INPUT)    },
+        { NULL, 0 },
+    };
+
+    static const CColumnMap receiptFields[] = {
+        { "contractAddress", COLUMN_BIT(COL_RC_CONTRACT) },
+        { "gasUsed",         COLUMN_BIT(COL_RC_GASUSED)  },
+        { "status",          COLUMN_BIT(COL_RC_STATUS)   },
+        { NULL, 0 },
+    };
+
+    //-------------------------------------------------------------------------
+    static bool addVisible(CRuntimeClass *pClass, const CColumnMap *map, uint64_t& columns) {
+        CFieldList *fieldList = pClass->GetFieldList();
+        if (!fieldList)
+            return true;
+
+        LISTPOS pos = fieldList->GetHeadPosition();
+        while (pos) {
+            const CFieldData *field = fieldList->GetNext(pos);
+            if (field->isHidden())
+                continue;
+
+            uint64_t found = NO_COLUMN;
+            for (const CColumnMap *m = map ; m->fieldName ; m++) {
+                if (field->getName() == m->fieldName) {
+                    found = m->columns;
+                    break;
+                }
+            }
+            if (found == NO_COLUMN)
+                return false;
+            columns |= found;
+        }
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    // Finds the columns needed to display every visible field of a block. Returns false if a
+    // visible field is not in the columnar cache (the logs, for example).
+    bool getVisibleColumns(uint64_t& columns) {
+        columns = COLUMN_BIT(COL_BLOCKNUMBER) | COLUMN_BIT(COL_BLOCKFLAGS);
+        if (!addVisible(GETRUNTIME_CLASS(CBlock), blockFields, columns))
+            return false;
+        if (GETRUNTIME_CLASS(CBlock)->isFieldHidden("transactions"))
+            return true;
+        if (!addVisible(GETRUNTIME_CLASS(CTransaction), transFields, columns))
+            return false;
+        if (GETRUNTIME_CLASS(CTransaction)->isFieldHidden("receipt"))
+            return true;
+        return addVisible(GETRUNTIME_CLASS(CReceipt), receiptFields, columns);
+    }
+
+    //-------------------------------------------------------------------------
+    // Readers tend to move through the blocks in order, so we keep the last chunk we used open
+    static CColumnChunk *theChunk = NULL;
+    static uint64_t      theChunkId = NOPOS;
+
+    //-------------------------------------------------------------------------
+    void clearColumnCache(void) {
+        if (theChunk)
+            delete theChunk;
+        theChunk = NULL;
+        theChunkId = NOPOS;
+    }
+
+    //-------------------------------------------------------------------------
+    bool readBlockFromColumns(CBlock& block, blknum_t bn, uint64_t columns) {
+        uint64_t chunkId = bn / COLUMN_CHUNK_SIZE;
+        if (chunkId != theChunkId) {
+            if (!theChunk)
+                theChunk = new CColumnChunk;
+            theChunk->open(getColumnFilename(bn));  // a missing chunk leaves it invalid
+            theChunkId = chunkId;
+        }
+        return theChunk->readBlock(block, theChunk->findBlock(bn), columns);
+    }
+
+    //-------------------------------------------------------------------------
+    // A block written to the cache after its chunk was built is marked inexact in the chunk, so
+    // readers go to the new file. It stays that way until the chunk is built again.
+    bool dropFromColumns(blknum_t bn) {
+        int fd = ::open(getColumnFilename(bn).c_str(), O_RDWR | O_CLOEXEC);
+        if (fd == -1)
+            return true;  // no chunk, nothing to drop
+        SFUintArray blocks;
+        blocks.addValue(bn);
+        bool ret = markInexact(fd, blocks);
+        ::close(fd);
+        if (theChunkId == bn / COLUMN_CHUNK_SIZE)
+            clearColumnCache();
+        return ret;
+    }
+
+    //-------------------------------------------------------------------------
+    // True if the file was last written at or after 'since' (a file that's gone wasn't)
+    static bool writtenSince(const SFString& fileName, const struct stat& since) {
+        struct stat st;
+        if (stat(fileName.c_str(), &st) != 0)
+            return false;
+#ifdef __APPLE__
+        const struct timespec& a = st.st_mtimespec;
+        const struct timespec& b = since.st_mtimespec;
+#else
+        const struct timespec& a = st.st_mtim;
+        const struct timespec& b = since.st_mtim;
+#endif
+        return (a.tv_sec > b.tv_sec || (a.tv_sec == b.tv_sec && a.tv_nsec >= b.tv_nsec));
+    }
+
+    //-------------------------------------------------------------------------
+    // (Re-)builds one chunk of the columnar cache from the block files in the cache. A chunk
+    // of 100,000 blocks is exactly one second-level folder of the block cache. A block written
+    // while we build may be marked in the old chunk (see dropFromColumns) after we read it, so
+    // once the new chunk is in place we mark every block whose file was written since we started.
+    // The time we start is that of a file we write, so it's on the same clock as the blocks'.
+    bool buildColumnChunk(uint64_t chunk, uint64_t& nBlocks) {
+        nBlocks = 0;
+        blknum_t firstBlock = chunk * COLUMN_CHUNK_SIZE;
+        SFString fileName = getColumnFilename(firstBlock);
+
+        SFUintArray blocks;
+        listCachedBlocks(chunk, blocks);
+        if (!blocks.getCount() || !establishFolder(fileName))
+            return false;
+
+        struct stat started;
+        SFString stampName = fileName + ".started";
+        int stamp = ::open(stampName.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (stamp == -1 || fstat(stamp, &started) != 0) {
+            cerr << "Could not write " << stampName << "\n";
+            if (stamp != -1)
+                ::close(stamp);
+            return false;
+        }
+        ::close(stamp);
+        unlink(stampName.c_str());
+
+        CColumnChunkWriter writer(firstBlock);
+        for (uint32_t i = 0 ; i < blocks.getCount() && !shouldQuit() ; i++) {
+            CBlock block;
+            if (readBlockFromBinary(block, getBinaryFilename(blocks[i])))
+                writer.addBlock(block);
+        }
+        if (shouldQuit())
+            return false;
+
+        // If someone has this chunk open, they'll need to re-open it
+        if (theChunkId == chunk)
+            clearColumnCache();
+
+        nBlocks = writer.nBlocks();
+        if (!writer.write(fileName))
+            return false;
+
+        SFUintArray written;
+        for (uint32_t i = 0 ; i < blocks.getCount() ; i++)
+            if (writtenSince(getBinaryFilename(blocks[i]), started))
+                written.addValue(blocks[i]);
+        if (!written.getCount())
+            return true;
+        int fd = ::open(fileName.c_str(), O_RDWR | O_CLOEXEC);
+        bool ret = (fd != -1 && markInexact(fd, written));
+        if (fd != -1)
+            ::close(fd);
+        if (theChunkId == chunk)
+            clearColumnCache();
+        return ret;
+    }
+
+}  // namespace qblocks
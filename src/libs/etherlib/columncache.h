@@ -0,0 +1,163 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include <map>
+#include <string>
+#include "etherlib.h"
+
+namespace qblocks {
+
+    //-------------------------------------------------------------------------
+    // The columnar cache holds the same blocks as the per-block files in the block cache, but
+    // stores each field of every block (and every transaction) in a chunk of 100,000 blocks
+    // together, one column after another:
+    //
+    //      header | column directory | column 0 | column 1 | ... | string dictionary
+    //
+    // Block columns have one row per block, transaction columns one row per transaction (in block
+    // order). Numbers are stored as they are, hashes and addresses as raw 32 and 20 byte values
+    // and input data as an index into the chunk's string dictionary. Reading one field for every
+    // block in a chunk therefore touches only that field's column.
+    //
+    // The per-block files remain the real cache. Logs and traces are not in the columnar cache,
+    // and blocks that cannot be stored exactly (for example, a hash that is not 32 bytes of hex)
+    // are marked as such so readers go back to the block's own file. So are blocks written to
+    // the cache again after their chunk was built.
+    //-------------------------------------------------------------------------
+    #define COLUMN_CACHE_MAGIC   "qbColumn"
+    #define COLUMN_CACHE_VERSION 1
+    #define COLUMN_CHUNK_SIZE    100000
+
+    //-------------------------------------------------------------------------
+    enum {
+        // one row per block
+        COL_BLOCKNUMBER = 0,
+        COL_TIMESTAMP,
+        COL_GASLIMIT,
+        COL_GASUSED,
+        COL_HASH,
+        COL_PARENTHASH,
+        COL_MINER,
+        COL_DIFFICULTY,
+        COL_PRICE,
+        COL_BLOCKFLAGS,
+        COL_FIRSTTRANS,
+        COL_NTRANS,
+        // one row per transaction
+        COL_TX_HASH,
+        COL_TX_INDEX,
+        COL_TX_NONCE,
+        COL_TX_FROM,
+        COL_TX_TO,
+        COL_TX_VALUE,
+        COL_TX_GAS,
+        COL_TX_GASPRICE,
+        COL_TX_INPUT,
+        COL_TX_FLAGS,
+        COL_RC_CONTRACT,
+        COL_RC_GASUSED,
+        COL_RC_STATUS,
+        N_COLUMNS
+    };
+    #define COLUMN_BIT(col)   (((uint64_t)1) << (col))
+    #define ALL_COLUMNS       (COLUMN_BIT(N_COLUMNS) - 1)
+    #define TRANS_COLUMNS     (ALL_COLUMNS & ~(COLUMN_BIT(COL_TX_HASH) - 1))
+
+    //-------------------------------------------------------------------------
+    struct CColumnChunkHeader {
+        char     magic[8];
+        uint32_t version;
+        uint32_t nColumns;
+        uint64_t firstBlock;  // the first block the chunk covers (not necessarily present)
+        uint64_t nBlocks;
+        uint64_t nTrans;
+        uint64_t nStrings;
+        uint64_t dictOffset;
+        uint64_t unused;
+    };
+
+    //-------------------------------------------------------------------------
+    struct CColumnDesc {
+        uint32_t width;
+        uint32_t unused;
+        uint64_t offset;
+    };
+
+    //-------------------------------------------------------------------------
+    // Read-only view of one chunk of the columnar cache. The file is memory mapped, so reading a
+    // column for every block costs no more than the size of that column.
+    class CColumnChunk {
+    public:
+        CColumnChunk(void);
+        ~CColumnChunk(void);
+
+        bool open (const SFString& fileName);
+        void close(void);
+
+        bool     isValid   (void) const { return m_header != NULL; }
+        blknum_t firstBlock(void) const { return (m_header ? m_header->firstBlock : 0); }
+        uint64_t nBlocks   (void) const { return (m_header ? m_header->nBlocks : 0); }
+        uint64_t nTrans    (void) const { return (m_header ? m_header->nTrans : 0); }
+
+        // The raw rows of one column (use nBlocks() or nTrans() for the row count)
+        template<class TYPE>
+        const TYPE *column(uint32_t col) const { return (const TYPE *)(m_data + m_columns[col].offset); }
+        uint32_t    width (uint32_t col) const { return m_columns[col].width; }
+
+        uint64_t findBlock(blknum_t bn) const;
+        bool     readBlock(CBlock& block, uint64_t row, uint64_t columns = ALL_COLUMNS) const;
+        SFString getString(uint64_t index) const;
+
+    private:
+        CMemMapFile              *m_file;
+        const unsigned char      *m_data;
+        const CColumnChunkHeader *m_header;
+        const CColumnDesc        *m_columns;
+        const uint64_t           *m_strings;
+
+        CColumnChunk(const CColumnChunk&);
+        CColumnChunk& operator=(const CColumnChunk&);
+    };
+
+    //-------------------------------------------------------------------------
+    // Collects the blocks of one chunk in memory and writes the chunk all at once. Blocks must be
+    // added in increasing order.
+    class CColumnChunkWriter {
+    public:
+        explicit CColumnChunkWriter(blknum_t firstBlock);
+
+        bool     addBlock(const CBlock& block);
+        bool     write   (const SFString& fileName) const;
+        uint64_t nBlocks (void) const { return m_nBlocks; }
+
+    private:
+        blknum_t    m_firstBlock;
+        uint64_t    m_nBlocks;
+        uint64_t    m_nTrans;
+        std::string m_columns[N_COLUMNS];
+        std::string m_dictionary;
+        SFUintArray m_stringOffsets;
+        std::map<std::string, uint32_t> m_stringIndex;
+
+        uint32_t addString(const SFString& str);
+    };
+
+    //-------------------------------------------------------------------------
+    extern SFString getColumnFilename    (blknum_t bn);
+    extern bool     getVisibleColumns    (uint64_t& columns);
+    extern bool     readBlockFromColumns (CBlock& block, blknum_t bn, uint64_t columns = ALL_COLUMNS);
+    extern bool     buildColumnChunk     (uint64_t chunk, uint64_t& nBlocks);
+    extern bool     dropFromColumns      (blknum_t bn);
+    extern void     clearColumnCache     (void);
+
+}  // namespace qblocks
@@ -26,6 +26,14 @@
 #include "miniblock.h"
 #include "node.h"
 #include "blooms.h"
+#include "bloomindex.h"
+#include "fullblockindex.h"
+#include "timestampindex.h"
+#include "columncache.h"
+#include "appearanceindex.h"
+#include "addressscan.h"
+#include "tracecache.h"
+#include "blockpack.h"
 #include "blockoptions.h"
 #include "abirecord.h"
 
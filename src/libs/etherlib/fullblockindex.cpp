@@ -0,0 +1,93 @@
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include <algorithm>
+#include "fullblockindex.h"
+
+namespace qblocks {
+
+    //-------------------------------------------------------------------------
+    CFullBlockIndex::CFullBlockIndex(void) : m_file(NULL), m_blocks(NULL), m_nBlocks(0) {
+    }
+
+    //-------------------------------------------------------------------------
+    CFullBlockIndex::~CFullBlockIndex(void) {
+        close();
+    }
+
+    //-------------------------------------------------------------------------
+    bool CFullBlockIndex::open(const SFString& fileName, uint32_t lockType) {
+        close();
+
+        // Going through the lock lets us wait for (or notice) a scraper that is writing the file
+        SFArchive fullBlockCache(READING_ARCHIVE);
+        if (!fullBlockCache.Lock(fileName, binaryReadOnly, lockType)) {
+            m_error = fullBlockCache.LockFailure();
+            return false;
+        }
+        fullBlockCache.Release();
+
+        m_file = new CMemMapFile(fileName.c_str(), CMemMapFile::WholeFile, CMemMapFile::RandomAccess);
+        if (!m_file->isValid()) {
+            // mmap refuses empty files, which is a perfectly good (empty) index
+            bool isEmpty = (fileSize(fileName) == 0);
+            delete m_file;
+            m_file = NULL;
+            if (!isEmpty) {
+                m_error = "Could not map file: " + fileName;
+                return false;
+            }
+            m_file = new CMemMapFile;
+            return true;
+        }
+
+        // A partially written last entry (if any) is ignored
+        m_blocks  = (const blknum_t *)m_file->getData();
+        m_nBlocks = m_file->size() / sizeof(blknum_t);
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    void CFullBlockIndex::close(void) {
+        if (m_file)
+            delete m_file;
+        m_file    = NULL;
+        m_blocks  = NULL;
+        m_nBlocks = 0;
+    }
+
+    //-------------------------------------------------------------------------
+    // On return, entries [first, last) are the non-empty blocks in the range [start, end)
+    void CFullBlockIndex::rangeOf(blknum_t start, blknum_t end, uint64_t& first, uint64_t& last) const {
+        first = last = 0;
+        if (!m_nBlocks || end <= start)
+            return;
+        first = (uint64_t)(std::lower_bound(m_blocks, m_blocks + m_nBlocks, start) - m_blocks);
+        last  = (uint64_t)(std::lower_bound(m_blocks + first, m_blocks + m_nBlocks, end) - m_blocks);
+    }
+
+    //-------------------------------------------------------------------------
+    bool CFullBlockIndex::contains(blknum_t bn) const {
+        return std::binary_search(m_blocks, m_blocks + m_nBlocks, bn);
+    }
+
+    //-------------------------------------------------------------------------
+    // Finds the first non-empty block at or after 'bn'. Returns false if there isn't one.
+    bool CFullBlockIndex::nextNonEmpty(blknum_t bn, blknum_t& next) const {
+        const blknum_t *found = std::lower_bound(m_blocks, m_blocks + m_nBlocks, bn);
+        if (found == m_blocks + m_nBlocks)
+            return false;
+        next = *found;
+        return true;
+    }
+
+}  // namespace qblocks
@@ -0,0 +1,50 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include "etherlib.h"
+
+namespace qblocks {
+
+    //-------------------------------------------------------------------------
+    // Read-only view of the full block index (fullBlocks.bin), which is the sorted list of the
+    // block numbers of every block with at least one transaction. The file is memory mapped and
+    // searched in place, so nothing is copied no matter how large it gets.
+    class CFullBlockIndex {
+    public:
+        CFullBlockIndex(void);
+        ~CFullBlockIndex(void);
+
+        bool open (const SFString& fileName, uint32_t lockType = LOCK_WAIT);
+        void close(void);
+
+        uint64_t        nBlocks    (void) const { return m_nBlocks; }
+        const blknum_t *blocks     (void) const { return m_blocks; }
+        blknum_t        operator[] (uint64_t index) const { return m_blocks[index]; }
+        blknum_t        lastBlock  (void) const { return (m_nBlocks ? m_blocks[m_nBlocks - 1] : 0); }
+        SFString        LockFailure(void) const { return m_error; }
+
+        void rangeOf     (blknum_t start, blknum_t end, uint64_t& first, uint64_t& last) const;
+        bool contains    (blknum_t bn) const;
+        bool nextNonEmpty(blknum_t bn, blknum_t& next) const;
+
+    private:
+        CMemMapFile    *m_file;
+        const blknum_t *m_blocks;
+        uint64_t        m_nBlocks;
+        SFString        m_error;
+
+        CFullBlockIndex(const CFullBlockIndex&);
+        CFullBlockIndex& operator=(const CFullBlockIndex&);
+    };
+
+}  // namespace qblocks
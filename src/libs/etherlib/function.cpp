@@ -25,6 +25,31 @@ IMPLEMENT_NODE(CFunction, CBaseNode);
 static SFString nextFunctionChunk(const SFString& fieldIn, const void *dataPtr);
 static SFString nextFunctionChunk_custom(const SFString& fieldIn, const void *dataPtr);
 
+//---------------------------------------------------------------------------
+// makeClass chose the seed so that no two of these names share a slot in the table
+enum {
+    FLD_NAME = 1,
+    FLD_TYPE,
+    FLD_ANONYMOUS,
+    FLD_CONSTANT,
+    FLD_PAYABLE,
+    FLD_SIGNATURE,
+    FLD_ENCODING,
+    FLD_INPUTS,
+    FLD_OUTPUTS,
+    FLD_INPUTSCNT,
+    FLD_OUTPUTSCNT,
+};
+static const char *functionFieldNames[] = {
+    "name", "type", "anonymous", "constant", "payable", "signature", "encoding", "inputs",
+    "outputs", "inputsCnt", "outputsCnt",
+};
+static const uint8_t functionFieldSlots[] = {
+    0, 0, 0, 0, 4, 0, 9, 0, 0, 0, 0, 0, 5, 0, 0, 0,
+    10, 0, 0, 11, 0, 0, 3, 1, 7, 6, 0, 0, 8, 0, 2, 0,
+};
+static const CFieldTable functionFieldTable(functionFieldNames, 11, functionFieldSlots, 32, 11);
+
 //---------------------------------------------------------------------------
 void CFunction::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr) const {
     if (!m_showing)
@@ -35,12 +60,10 @@ void CFunction::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr
         return;
     }
 
-    SFString fmt = fmtIn;
-    if (handleCustomFormat(ctx, fmt, dataPtr))
+    if (handleCustomFormat(ctx, fmtIn, dataPtr))
         return;
 
-    while (!fmt.empty())
-        ctx << getNextChunk(fmt, nextFunctionChunk, this);
+    formatChunks(ctx, fmtIn, nextFunctionChunk, this);
 }
 
 //---------------------------------------------------------------------------
@@ -66,60 +89,79 @@ bool CFunction::setValueByName(const SFString& fieldName, const SFString& fieldV
     }
     // EXISTING_CODE
 
-    switch (tolower(fieldName[0])) {
-        case 'a':
-            if ( fieldName % "anonymous" ) { anonymous = toBool(fieldValue); return true; }
-            break;
-        case 'c':
-            if ( fieldName % "constant" ) { constant = toBool(fieldValue); return true; }
-            break;
-        case 'e':
-            if ( fieldName % "encoding" ) { encoding = fieldValue; return true; }
-            break;
-        case 'i':
-            if ( fieldName % "inputs" ) {
-                char *p = (char *)fieldValue.c_str();
-                while (p && *p) {
-                    CParameter item;
-                    uint32_t nFields = 0;
-                    p = item.parseJson(p, nFields);
-                    if (nFields)
-                        inputs[inputs.getCount()] = item;
-                }
-                return true;
+    switch (functionFieldTable.find(fieldName)) {
+        case FLD_NAME: name = fieldValue; return true;
+        case FLD_TYPE: type = fieldValue; return true;
+        case FLD_ANONYMOUS: anonymous = toBool(fieldValue); return true;
+        case FLD_CONSTANT: constant = toBool(fieldValue); return true;
+        case FLD_PAYABLE: payable = toBool(fieldValue); return true;
+        case FLD_SIGNATURE: signature = fieldValue; return true;
+        case FLD_ENCODING: encoding = fieldValue; return true;
+        case FLD_INPUTS: {
+            char *p = (char *)fieldValue.c_str();
+            while (p && *p) {
+                CParameter item;
+                uint32_t nFields = 0;
+                p = item.parseJson(p, nFields);
+                if (nFields)
+                    inputs[inputs.getCount()] = item;
             }
-            break;
-        case 'n':
-            if ( fieldName % "name" ) { name = fieldValue; return true; }
-            break;
-        case 'o':
-            if ( fieldName % "outputs" ) {
-                char *p = (char *)fieldValue.c_str();
-                while (p && *p) {
-                    CParameter item;
-                    uint32_t nFields = 0;
-                    p = item.parseJson(p, nFields);
-                    if (nFields)
-                        outputs[outputs.getCount()] = item;
-                }
-                return true;
+            return true;
+        }
+        case FLD_OUTPUTS: {
+            char *p = (char *)fieldValue.c_str();
+            while (p && *p) {
+                CParameter item;
+                uint32_t nFields = 0;
+                p = item.parseJson(p, nFields);
+                if (nFields)
+                    outputs[outputs.getCount()] = item;
             }
-            break;
-        case 'p':
-            if ( fieldName % "payable" ) { payable = toBool(fieldValue); return true; }
-            break;
-        case 's':
-            if ( fieldName % "signature" ) { signature = fieldValue; return true; }
-            break;
-        case 't':
-            if ( fieldName % "type" ) { type = fieldValue; return true; }
-            break;
+            return true;
+        }
         default:
             break;
     }
     return false;
 }
 
+//---------------------------------------------------------------------------------------------------
+bool CFunction::parseTape(CJsonTape& tape, uint32_t node) {
+    if (!tape.isObject(node))
+        return false;
+
+    // Objects are parsed in place from the tape. Anything else goes to setValueByName
+    for (uint32_t key = tape.firstMember(node) ; key != JSON_NOTOKEN ; key = tape.nextMember(node, key)) {
+        uint32_t val = key + 1;
+        string_view_q name = tape.getView(key);
+        switch (functionFieldTable.find(name.data(), name.length())) {
+            case FLD_INPUTS:
+                if (tape.isArrayOf(val, JSON_OBJECT)) {
+                    for (uint32_t item = tape.firstItem(val) ; item != JSON_NOTOKEN ; item = tape.nextItem(val, item)) {
+                        if (tape.firstMember(item) != JSON_NOTOKEN)
+                            inputs[inputs.getCount()].parseTape(tape, item);
+                    }
+                    continue;
+                }
+                break;
+            case FLD_OUTPUTS:
+                if (tape.isArrayOf(val, JSON_OBJECT)) {
+                    for (uint32_t item = tape.firstItem(val) ; item != JSON_NOTOKEN ; item = tape.nextItem(val, item)) {
+                        if (tape.firstMember(item) != JSON_NOTOKEN)
+                            outputs[outputs.getCount()].parseTape(tape, item);
+                    }
+                    continue;
+                }
+                break;
+            default:
+                break;
+        }
+        setValueFromTape(tape, key);
+    }
+    finishParse();
+    return true;
+}
+
 //---------------------------------------------------------------------------------------------------
 void CFunction::finishParse() {
     // EXISTING_CODE
@@ -286,55 +328,37 @@ SFString CFunction::getValueByName(const SFString& fieldName) const {
         return ret;
 
     // Return field values
-    switch (tolower(fieldName[0])) {
-        case 'a':
-            if ( fieldName % "anonymous" ) return asString(anonymous);
-            break;
-        case 'c':
-            if ( fieldName % "constant" ) return asString(constant);
-            break;
-        case 'e':
-            if ( fieldName % "encoding" ) return encoding;
-            break;
-        case 'i':
-            if ( fieldName % "inputs" || fieldName % "inputsCnt" ) {
-                uint32_t cnt = inputs.getCount();
-                if (fieldName.endsWith("Cnt"))
-                    return asStringU(cnt);
-                if (!cnt) return "";
-                SFString retS;
-                for (uint32_t i = 0 ; i < cnt ; i++) {
-                    retS += inputs[i].Format();
-                    retS += ((i < cnt - 1) ? ",\n" : "\n");
-                }
-                return retS;
+    switch (functionFieldTable.find(fieldName)) {
+        case FLD_NAME: return name;
+        case FLD_TYPE: return type;
+        case FLD_ANONYMOUS: return asString(anonymous);
+        case FLD_CONSTANT: return asString(constant);
+        case FLD_PAYABLE: return asString(payable);
+        case FLD_SIGNATURE: return signature;
+        case FLD_ENCODING: return encoding;
+        case FLD_INPUTS: {
+            uint32_t cnt = inputs.getCount();
+            if (!cnt) return "";
+            SFString retS;
+            for (uint32_t i = 0 ; i < cnt ; i++) {
+                retS += inputs[i].Format();
+                retS += ((i < cnt - 1) ? ",\n" : "\n");
             }
-            break;
-        case 'n':
-            if ( fieldName % "name" ) return name;
-            break;
-        case 'o':
-            if ( fieldName % "outputs" || fieldName % "outputsCnt" ) {
-                uint32_t cnt = outputs.getCount();
-                if (fieldName.endsWith("Cnt"))
-                    return asStringU(cnt);
-                if (!cnt) return "";
-                SFString retS;
-                for (uint32_t i = 0 ; i < cnt ; i++) {
-                    retS += outputs[i].Format();
-                    retS += ((i < cnt - 1) ? ",\n" : "\n");
-                }
-                return retS;
+            return retS;
+        }
+        case FLD_INPUTSCNT: return asStringU(inputs.getCount());
+        case FLD_OUTPUTS: {
+            uint32_t cnt = outputs.getCount();
+            if (!cnt) return "";
+            SFString retS;
+            for (uint32_t i = 0 ; i < cnt ; i++) {
+                retS += outputs[i].Format();
+                retS += ((i < cnt - 1) ? ",\n" : "\n");
             }
-            break;
-        case 'p':
-            if ( fieldName % "payable" ) return asString(payable);
-            break;
-        case 's':
-            if ( fieldName % "signature" ) return signature;
-            break;
-        case 't':
-            if ( fieldName % "type" ) return type;
+            return retS;
+        }
+        case FLD_OUTPUTSCNT: return asStringU(outputs.getCount());
+        default:
             break;
     }
 
@@ -399,9 +423,7 @@ SFString CFunction::getSignature(uint64_t parts) const {
 //-----------------------------------------------------------------------
 SFString CFunction::encodeItem(void) const {
     SFString hex = "0x"+string2Hex(signature);
-    SFString ret;
-extern bool getSha3(const SFString& hexIn, SFString& shaOut);
-    getSha3(hex, ret);
+    SFString ret = keccak256(hex);
     ret = (type == "event" ? ret : ret.substr(0,10));
     return ret;
 }
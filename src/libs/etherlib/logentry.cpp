@@ -26,6 +26,23 @@ IMPLEMENT_NODE(CLogEntry, CBaseNode);
 extern SFString nextLogentryChunk(const SFString& fieldIn, const void *dataPtr);
 static SFString nextLogentryChunk_custom(const SFString& fieldIn, const void *dataPtr);
 
+//---------------------------------------------------------------------------
+// makeClass chose the seed so that no two of these names share a slot in the table
+enum {
+    FLD_ADDRESS = 1,
+    FLD_DATA,
+    FLD_LOGINDEX,
+    FLD_TOPICS,
+    FLD_TOPICSCNT,
+};
+static const char *logentryFieldNames[] = {
+    "address", "data", "logIndex", "topics", "topicsCnt",
+};
+static const uint8_t logentryFieldSlots[] = {
+    0, 0, 1, 0, 2, 0, 0, 0, 0, 0, 4, 5, 0, 0, 0, 3,
+};
+static const CFieldTable logentryFieldTable(logentryFieldNames, 5, logentryFieldSlots, 16, 0);
+
 //---------------------------------------------------------------------------
 void CLogEntry::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr) const {
     if (!m_showing)
@@ -36,12 +53,10 @@ void CLogEntry::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr
         return;
     }
 
-    SFString fmt = fmtIn;
-    if (handleCustomFormat(ctx, fmt, dataPtr))
+    if (handleCustomFormat(ctx, fmtIn, dataPtr))
         return;
 
-    while (!fmt.empty())
-        ctx << getNextChunk(fmt, nextLogentryChunk, this);
+    formatChunks(ctx, fmtIn, nextLogentryChunk, this);
 }
 
 //---------------------------------------------------------------------------
@@ -63,25 +78,17 @@ bool CLogEntry::setValueByName(const SFString& fieldName, const SFString& fieldV
             return true;
     // EXISTING_CODE
 
-    switch (tolower(fieldName[0])) {
-        case 'a':
-            if ( fieldName % "address" ) { address = toAddress(fieldValue); return true; }
-            break;
-        case 'd':
-            if ( fieldName % "data" ) { data = fieldValue; return true; }
-            break;
-        case 'l':
-            if ( fieldName % "logIndex" ) { logIndex = toUnsigned(fieldValue); return true; }
-            break;
-        case 't':
-            if ( fieldName % "topics" ) {
-                SFString str = fieldValue;
-                while (!str.empty()) {
-                    topics[topics.getCount()] = toTopic(nextTokenClear(str,','));
-                }
-                return true;
+    switch (logentryFieldTable.find(fieldName)) {
+        case FLD_ADDRESS: address = toAddress(fieldValue); return true;
+        case FLD_DATA: data = fieldValue; return true;
+        case FLD_LOGINDEX: logIndex = toUnsigned(fieldValue); return true;
+        case FLD_TOPICS: {
+            SFString str = fieldValue;
+            while (!str.empty()) {
+                topics[topics.getCount()] = toTopic(nextTokenClear(str,','));
             }
-            break;
+            return true;
+        }
         default:
             break;
     }
@@ -213,29 +220,22 @@ SFString CLogEntry::getValueByName(const SFString& fieldName) const {
         return ret;
 
     // Return field values
-    switch (tolower(fieldName[0])) {
-        case 'a':
-            if ( fieldName % "address" ) return fromAddress(address);
-            break;
-        case 'd':
-            if ( fieldName % "data" ) return data;
-            break;
-        case 'l':
-            if ( fieldName % "logIndex" ) return asStringU(logIndex);
-            break;
-        case 't':
-            if ( fieldName % "topics" || fieldName % "topicsCnt" ) {
-                uint32_t cnt = topics.getCount();
-                if (fieldName.endsWith("Cnt"))
-                    return asStringU(cnt);
-                if (!cnt) return "";
-                SFString retS;
-                for (uint32_t i = 0 ; i < cnt ; i++) {
-                    retS += ("\"" + fromTopic(topics[i]) + "\"");
-                    retS += ((i < cnt - 1) ? ",\n" + indent() : "\n");
-                }
-                return retS;
+    switch (logentryFieldTable.find(fieldName)) {
+        case FLD_ADDRESS: return fromAddress(address);
+        case FLD_DATA: return data;
+        case FLD_LOGINDEX: return asStringU(logIndex);
+        case FLD_TOPICS: {
+            uint32_t cnt = topics.getCount();
+            if (!cnt) return "";
+            SFString retS;
+            for (uint32_t i = 0 ; i < cnt ; i++) {
+                retS += ("\"" + fromTopic(topics[i]) + "\"");
+                retS += ((i < cnt - 1) ? ",\n" + indent() : "\n");
             }
+            return retS;
+        }
+        case FLD_TOPICSCNT: return asStringU(topics.getCount());
+        default:
             break;
     }
 
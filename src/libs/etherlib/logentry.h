@@ -33,7 +33,7 @@ class CReceipt;
 //--------------------------------------------------------------------------
 class CLogEntry : public CBaseNode {
 public:
-    SFAddress address;
+    CAddressField address;
     SFString data;
     uint64_t logIndex;
     SFTopicArray topics;
@@ -105,7 +105,7 @@ inline void CLogEntry::Clear(void) {
 inline void CLogEntry::Init(void) {
     CBaseNode::Init();
 
-    address = "";
+    address.setEmpty();
     data = "";
     logIndex = 0;
     topics.Clear();
@@ -11,6 +11,7 @@
  * Public License along with this program. If not, see http://www.gnu.org/licenses/.
  *-------------------------------------------------------------------------------------------*/
 #include "node.h"
+#include <algorithm>
 #include "miniblock.h"
 
 namespace qblocks {
@@ -66,7 +67,7 @@ namespace qblocks {
         gasUsed  = t->receipt.gasUsed;
         gasPrice = t->gasPrice;
         isError  = t->isError;
-        nTraces  = getTraceCount(t->hash);
+        nTraces  = getTraceCount(*t);
         strncpy(value, fromWei(t->value), 40); value[40] = '\0';
     }
 
@@ -94,6 +95,8 @@ namespace qblocks {
 
     //--------------------------------------------------------------------------
     CInMemoryCache::CInMemoryCache(void) {
+        blockFile = NULL;
+        transFile = NULL;
         Init();
     }
 
@@ -104,42 +107,26 @@ namespace qblocks {
 
     //--------------------------------------------------------------------------
     void CInMemoryCache::Init(void) {
-        // blocksOnDisc
-        // transOnDisc
-        blocks    = NULL;
-        trans     = NULL;
-
-        nBlocks   = fileSize(miniBlockCache) / sizeof(CMiniBlock);
-        nTrans    = fileSize(miniTransCache) / sizeof(CMiniTrans);
-        start     = 0;
-        count     = 0;
-
+        blocks    = CMiniBlockSpan();
+        trans     = CMiniTransSpan();
         isLoaded  = false;
     }
 
     //--------------------------------------------------------------------------
     void CInMemoryCache::Clear(void) {
-        // VERY IMPORTANT NOTE: The 'block' and 'trans' pointers are not allocated, they are FILE pointers
-        // instead, so don't 'delete' them.
-        // if (blocks)
-        //     delete [] blocks;
-        // if (trans)
-        //     delete [] trans;
-        blocks = NULL;
-        trans = NULL;
-
-        blocksOnDisc.Release();
-        transOnDisc.Release();
+        // The spans point into the mappings, so they go first
+        blocks = CMiniBlockSpan();
+        trans  = CMiniTransSpan();
 
-        Init();
-    }
+        if (blockFile)
+            delete blockFile;
+        blockFile = NULL;
 
-    //--------------------------------------------------------------------------
-    inline SFString TIMER_IN(double& st) {
-        CStringExportContext ctx;
-        ctx << (qbNow()-st) << ": ";
-        st = qbNow();
-        return ctx.str;
+        if (transFile)
+            delete transFile;
+        transFile = NULL;
+
+        Init();
     }
 
     //-------------------------------------------------------------------------
@@ -150,14 +137,12 @@ namespace qblocks {
     }
 
     //--------------------------------------------------------------------------
-    bool CInMemoryCache::Load(blknum_t _start, blknum_t _count) {
-
-        double startTime = qbNow();
+    bool CInMemoryCache::Load(bool populate) {
 
         //--------------------------------------------------------------------------
         // Only come through here once, even if we fail to load
         if (isLoaded)
-            return true;
+            return !blocks.empty();
         isLoaded = true;
 
         // Cannot process anything if the files are locked.
@@ -171,28 +156,51 @@ namespace qblocks {
             exit(0);
         }
 
-        blknum_t latestBlock = getLatestBlockFromCache();
-        start = min(_start,          latestBlock);
-        count = min(_start + _count, latestBlock) - _start;
-
-        CMemMapFile blockFile(miniBlockCache.c_str(),  CMemMapFile::WholeFile, CMemMapFile::SequentialScan);
-        blocks = (CMiniBlock*)(blockFile.getData());
+        // Lookups are binary searches that touch a handful of pages, so unless the caller is
+        // about to scan everything, we let the pages come in as they're needed
+        CMemMapFile::CacheHint hint = (populate ? CMemMapFile::Populate : CMemMapFile::RandomAccess);
+        blockFile = new CMemMapFile(miniBlockCache.c_str(), CMemMapFile::WholeFile, hint);
+        transFile = new CMemMapFile(miniTransCache.c_str(), CMemMapFile::WholeFile, hint);
+        blocks = asSpan<CMiniBlock>(*blockFile);
+        trans  = asSpan<CMiniTrans>(*transFile);
+
+        if (verbose)
+            cerr << "Mapped " << blocks.size() << " miniBlocks and " << trans.size() << " miniTrans.\n";
+        return !blocks.empty();
+    }
 
-        CMemMapFile transFile(miniTransCache.c_str(),  CMemMapFile::WholeFile, CMemMapFile::SequentialScan);
-        trans  = reinterpret_cast<const CMiniTrans *>(transFile.getData());
+    //--------------------------------------------------------------------------
+    // Starts reading the mini blocks from index 'first' up to 'last' (and their transactions) in
+    // the background, so a scan of them doesn't wait on the disc page by page
+    void CInMemoryCache::warmUp(uint64_t first, uint64_t last) const {
+        last = min(last, (uint64_t)blocks.size());
+        if (first >= last)
+            return;
+        if (blockFile)
+            blockFile->prefetch(first * sizeof(CMiniBlock), (last - first) * sizeof(CMiniBlock));
+        txnum_t firstTrans = blocks[first].firstTrans;
+        txnum_t lastTrans  = blocks[last - 1].firstTrans + blocks[last - 1].nTrans;
+        if (transFile && lastTrans > firstTrans)
+            transFile->prefetch(firstTrans * sizeof(CMiniTrans), (lastTrans - firstTrans) * sizeof(CMiniTrans));
+    }
 
-        cerr << "\n" << TIMER_IN(startTime);
-        return true;
+    //--------------------------------------------------------------------------
+    // Returns the index of the first mini block at or after block 'bn' (or blocks.size() if none)
+    uint64_t CInMemoryCache::findBlock(blknum_t bn) const {
+        const CMiniBlock *found =
+            std::lower_bound(blocks.begin(), blocks.end(), bn,
+                             [](const CMiniBlock& mini, blknum_t val) { return mini.blockNumber < val; });
+        return (uint64_t)(found - blocks.begin());
     }
 
     //--------------------------------------------------------------------------
-    blknum_t CInMemoryCache::firstBlock(void) {
-        return 0;
+    blknum_t CInMemoryCache::firstBlock(void) const {
+        return (blocks.empty() ? 0 : blocks[0].blockNumber);
     }
 
     //--------------------------------------------------------------------------
-    blknum_t CInMemoryCache::lastBlock(void) {
-        return nBlocks;
+    blknum_t CInMemoryCache::lastBlock(void) const {
+        return (blocks.empty() ? 0 : blocks[blocks.size() - 1].blockNumber);
     }
 
     //--------------------------------------------------------------------------
@@ -217,28 +225,16 @@ namespace qblocks {
     bool forEveryMiniBlockInMemory(MINIBLOCKVISITFUNC func, void *data, uint64_t start, uint64_t count, uint64_t skip) {
 
         CInMemoryCache *cache = getTheCache();
-        if (!cache->Load(start,count))
+        if (!cache->Load())
             return false;
-
-        blknum_t first = cache->firstBlock();
-        blknum_t last = cache->lastBlock();
-
-        bool done = false;
-        for (blknum_t i = first ; i < last && !done ; i = i + skip) {
-
-            if (inRange(cache->blocks[i].blockNumber, start, start+count-1)) {
-
-                if (!(*func)(cache->blocks[i], &cache->trans[0], data))
-                    return false;
-
-            } else if (cache->blocks[i].blockNumber >= start+count) {
-
-                done = true;
-
-            } else {
-
-                // do nothing
-            }
+        blknum_t end = (count > UINT64_MAX - start ? UINT64_MAX : start + count);
+        uint64_t first = cache->findBlock(start);
+        cache->warmUp(first, cache->findBlock(end));
+        for (uint64_t i = first ; i < cache->blocks.size() ; i = i + skip) {
+            if (cache->blocks[i].blockNumber >= end)
+                break;
+            if (!(*func)(cache->blocks[i], cache->trans.begin(), data))
+                return false;
         }
 
         return true;
@@ -248,38 +244,29 @@ namespace qblocks {
     bool forEveryFullBlockInMemory(BLOCKVISITFUNC func, void *data, uint64_t start, uint64_t count, uint64_t skip) {
 
         CInMemoryCache *cache = getTheCache();
-        if (!cache->Load(start, count))
+        if (!cache->Load())
             return false;
-
-        blknum_t first = cache->firstBlock();
-        blknum_t last  = cache->lastBlock();
-
-        bool done=false;
-        for (blknum_t i = first ; i < last && !done ; i = i + skip) {
-
-            if (inRange(cache->blocks[i].blockNumber, start, start+count-1)) {
-
-                CBlock block;
-                cache->blocks[i].toBlock(block);
-                SFGas gasUsed = 0;
-                for (txnum_t tr = cache->blocks[i].firstTrans ; tr < cache->blocks[i].firstTrans + cache->blocks[i].nTrans ; tr++) {
-                    CTransaction tt;
-                    cache->trans[tr].toTrans(tt);
-                    gasUsed += tt.receipt.gasUsed;
-                    block.transactions[block.transactions.getCount()] = tt;
-                }
-                block.gasUsed = gasUsed;
-                if (!(*func)(block, data))
-                    return false;
-
-            } else if (cache->blocks[i].blockNumber >= start+count) {
-
-                done=true;
-
-            } else {
-
-                // do nothing
+        blknum_t end = (count > UINT64_MAX - start ? UINT64_MAX : start + count);
+        uint64_t first = cache->findBlock(start);
+        cache->warmUp(first, cache->findBlock(end));
+        for (uint64_t i = first ; i < cache->blocks.size() ; i = i + skip) {
+            const CMiniBlock& mini = cache->blocks[i];
+            if (mini.blockNumber >= end)
+                break;
+
+            CBlock block;
+            mini.toBlock(block);
+            SFGas gasUsed = 0;
+            txnum_t lastTrans = min(mini.firstTrans + mini.nTrans, (txnum_t)cache->trans.size());
+            for (txnum_t tr = mini.firstTrans ; tr < lastTrans ; tr++) {
+                CTransaction tt;
+                cache->trans[tr].toTrans(tt);
+                gasUsed += tt.receipt.gasUsed;
+                block.transactions[block.transactions.getCount()] = tt;
             }
+            block.gasUsed = gasUsed;
+            if (!(*func)(block, data))
+                return false;
         }
 
         return true;
@@ -53,6 +53,13 @@ namespace qblocks {
     };
 
     //--------------------------------------------------------------------------
+    typedef CMemMapSpan<CMiniBlock> CMiniBlockSpan;
+    typedef CMemMapSpan<CMiniTrans> CMiniTransSpan;
+
+    //--------------------------------------------------------------------------
+    // The miniBlock and miniTrans databases, memory mapped read-only (so every process reading them
+    // shares the same pages) for as long as the cache is alive. Nothing is copied, so loading is
+    // close to instant no matter how large the files are.
     class CInMemoryCache {
     public:
                  CInMemoryCache (void);
@@ -61,32 +68,30 @@ namespace qblocks {
         void     Init           (void);
         void     Clear          (void);
 
-        bool     Load           (blknum_t _start, blknum_t _count);
-        blknum_t firstBlock     (void);
-        blknum_t lastBlock      (void);
+        bool     Load           (bool populate = false);
+        void     warmUp         (uint64_t first, uint64_t last) const;
+        uint64_t findBlock      (blknum_t bn) const;
+        blknum_t firstBlock     (void) const;
+        blknum_t lastBlock      (void) const;
 
     public:
         bool            isLoaded;
 
-        CBinFile blocksOnDisc;
-        CBinFile transOnDisc;
-
-        // Very important note: the two pointers are not allocated. They are pointers to a location
-        // in the memory mapped file. They appear to be allocated array pointers, but they are
-        // actually FILE pointers and should not be cleaned up.
-        CMiniBlock *blocks;
-        const CMiniTrans *trans;
+        // Views into the mappings below. They are only valid until the cache is cleared.
+        CMiniBlockSpan  blocks;
+        CMiniTransSpan  trans;
 
     private:
-        blknum_t        nBlocks;
-        txnum_t         nTrans;
-        uint64_t        start;
-        uint64_t        count;
+        CMemMapFile    *blockFile;
+        CMemMapFile    *transFile;
+
+        CInMemoryCache(const CInMemoryCache&);
+        CInMemoryCache& operator=(const CInMemoryCache&);
     };
 
     //-------------------------------------------------------------------------
     // function pointer types for forEvery functions
-    typedef bool (*MINIBLOCKVISITFUNC)(CMiniBlock& block, const CMiniTrans *trans, void *data);
+    typedef bool (*MINIBLOCKVISITFUNC)(const CMiniBlock& block, const CMiniTrans *trans, void *data);
     typedef bool (*MINITRANSVISITFUNC)(CMiniTrans& trans, void *data);
     typedef bool (*BLOCKVISITFUNC)(CBlock& block, void *data);
 
@@ -96,8 +101,9 @@ namespace qblocks {
     extern bool forOnlyMiniBlocks            (MINIBLOCKVISITFUNC func, void *data, uint64_t start, uint64_t count, uint64_t skip=1);
     extern bool forOnlyMiniTransactions      (MINITRANSVISITFUNC func, void *data, uint64_t start, uint64_t count, uint64_t skip=1);
     extern void clearInMemoryCache           (void);
+    extern CInMemoryCache *getTheCache       (void);
 
 }  // namespace qblocks
 
 //-------------------------------------------------------------------------
-extern bool visitMiniBlock(CMiniBlock& block, const CMiniTrans *trans, void *data);
+extern bool visitMiniBlock(const CMiniBlock& block, const CMiniTrans *trans, void *data);
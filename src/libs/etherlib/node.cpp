@@ -10,6 +10,7 @@
  * General Public License for more details. You should have received a copy of the GNU General
  * Public License along with this program. If not, see http://www.gnu.org/licenses/.
  *-------------------------------------------------------------------------------------------*/
+#include <algorithm>
 #include "node.h"
 
 namespace qblocks {
@@ -55,12 +56,23 @@ extern void registerQuitHandler(QUITHANDLER qh);
         CNameValue::registerClass();
         CAccountName::registerClass();
 
+        CToml toml(configPath("quickBlocks.toml"));
+        getCurlContext()->maxBatch = (uint32_t)toml.getConfigInt("settings", "maxBatch", 100);
+        getCurlContext()->maxConnections = (uint32_t)toml.getConfigInt("settings", "maxConnections", 20);
+
+        uint32_t codec = CODEC_NONE;
+        SFString codecStr = toml.getConfigStr("settings", "blockCodec", "none");
+        if (!parseCodec(codecStr, codec))
+            cerr << "Unknown blockCodec '" << codecStr << "' in quickBlocks.toml. Blocks are written without one.\n";
+        setBlockCodec(codec);
+
         if (sourceIn != "remote" && sourceIn != "local" && sourceIn != "ropsten")
             getCurlContext()->provider = "binary";
         else
             getCurlContext()->provider = sourceIn;
 
         // if curl has already been initialized, we want to clear it out
+        getRPCPool(true);
         getCurl(true);
         // initialize curl
         getCurl();
@@ -70,8 +82,13 @@ extern void registerQuitHandler(QUITHANDLER qh);
 
     //-------------------------------------------------------------------------
     void etherlib_cleanup(void) {
+        getCacheWriter(true);
+        getRPCPool(true);
         getCurl(true);
         clearInMemoryCache();
+        getBloomIndex(true);
+        getTimestampIndex(true);
+        clearColumnCache();
         if (theQuitHandler)
             (*theQuitHandler)(-1);
         else
@@ -80,7 +97,7 @@ extern void registerQuitHandler(QUITHANDLER qh);
 
     //-------------------------------------------------------------------------
     bool getBlock(CBlock& block, blknum_t blockNum) {
-        getCurlContext()->provider = fileExists(getBinaryFilename(blockNum)) ? "binary" : "local";
+        getCurlContext()->provider = blockInCache(blockNum) ? "binary" : "local";
         bool ret = queryBlock(block, asStringU(blockNum), true, false);
         getCurlContext()->provider = "binary";
         return ret;
@@ -108,7 +125,7 @@ extern void registerQuitHandler(QUITHANDLER qh);
     //-------------------------------------------------------------------------
     bool getTransaction(CTransaction& trans, blknum_t blockNum, txnum_t txID) {
 
-        if (fileExists(getBinaryFilename(blockNum))) {
+        if (blockInCache(blockNum)) {
             CBlock block;
             readBlockFromBinary(block, getBinaryFilename(blockNum));
             if (txID < block.transactions.getCount())
@@ -132,6 +149,24 @@ extern void registerQuitHandler(QUITHANDLER qh);
         return true;
     }
 
+    //-------------------------------------------------------------------------
+    bool getReceipts(CReceiptArray& receipts, const SFStringArray& txHashes) {
+        SFStringArray params;
+        for (uint32_t i = 0 ; i < txHashes.getCount() ; i++)
+            params[i] = "[\"" + fixHash(txHashes[i]) + "\"]";
+
+        SFStringArray results;
+        callRPCBatch("eth_getTransactionReceipt", params, results);
+
+        receipts.Clear();
+        for (uint32_t i = 0 ; i < results.getCount() ; i++) {
+            CReceipt receipt;
+            receipt.parseJson((char *)(const char*)results[i]);
+            receipts[i] = receipt;
+        }
+        return true;
+    }
+
     //--------------------------------------------------------------
     void getTraces(CTraceArray& traces, const SFHash& hash) {
 
@@ -139,10 +174,9 @@ extern void registerQuitHandler(QUITHANDLER qh);
         queryRawTrace(trace, hash);
 
         CRPCResult generic;
-        char *p = cleanUpJson((char*)(const char*)trace);
-        generic.parseJson(p);
+        generic.parseJson((char*)(const char*)trace);
 
-        p = cleanUpJson((char *)(generic.result.c_str()));  // NOLINT
+        char *p = cleanUpJson((char *)(generic.result.c_str()));  // NOLINT
         while (p && *p) {
             CTrace tr;
             uint32_t nFields = 0;
@@ -170,7 +204,7 @@ extern void registerQuitHandler(QUITHANDLER qh);
 
         } else {
             uint64_t num = toLongU(datIn);
-            if (getCurlContext()->provider == "binary" && fileSize(getBinaryFilename(num)) > 0) {
+            if (getCurlContext()->provider == "binary" && blockInCache(num)) {
                 UNHIDE_FIELD(CTransaction, "receipt");
                 block = CBlock();
                 return readBlockFromBinary(block, getBinaryFilename(num));
@@ -185,15 +219,21 @@ extern void registerQuitHandler(QUITHANDLER qh);
         if (!block.transactions.getCount())
             return false;
 
-        // We have the transactions, but we also want the receipts, and we need an error indication
+        // We have the transactions, but we also want the receipts (which we get in batches),
+        // and we need an error indication
+        SFStringArray hashes;
+        for (uint32_t i=0;i<block.transactions.getCount();i++)
+            hashes[i] = block.transactions[i].hash.asString();
+        CReceiptArray receipts;
+        getReceipts(receipts, hashes);
+
         nTraces=0;
+        UNHIDE_FIELD(CTransaction, "receipt");
         for (uint32_t i=0;i<block.transactions.getCount();i++) {
             CTransaction *trans = &block.transactions[i];
             trans->pBlock = &block;
 
-            UNHIDE_FIELD(CTransaction, "receipt");
-            CReceipt receipt;
-            getReceipt(receipt, trans->hash);
+            const CReceipt& receipt = receipts[i];
             trans->receipt = receipt; // deep copy
             if (block.blockNumber >= byzantiumBlock) {
                 trans->isError = (receipt.status == 0);
@@ -203,7 +243,7 @@ extern void registerQuitHandler(QUITHANDLER qh);
                 SFString unused;
                 CURLCALLBACKFUNC prev = getCurlContext()->setCurlCallback(traceCallback);
                 getCurlContext()->is_error = false;
-                queryRawTrace(unused, trans->hash);
+                queryRawTrace(unused, trans->hash.asString());
                 trans->isError = getCurlContext()->is_error;
                 getCurlContext()->setCurlCallback(prev);
                 nTraces++;
@@ -230,8 +270,7 @@ extern void registerQuitHandler(QUITHANDLER qh);
         SFString results;
         queryRawBlock(results, numStr, true, false);
         CRPCResult generic;
-        char *p = cleanUpJson((char*)results.c_str());
-        generic.parseJson(p);
+        generic.parseJson((char*)results.c_str());
         return generic.result;
     }
 
@@ -271,6 +310,12 @@ extern void registerQuitHandler(QUITHANDLER qh);
         return true;
     }
 
+    //-------------------------------------------------------------------------
+    bool queryRawBlockTrace(SFString& trace, blknum_t blockNum) {
+        trace = "[" + callRPC("trace_block", "[\"" + toHex(blockNum) +"\"]", true) + "]";
+        return true;
+    }
+
     //-------------------------------------------------------------------------
     bool queryRawLogs(SFString& results, const SFAddress& addr, uint64_t fromBlock, uint64_t toBlock) {
         SFString data = "[{\"fromBlock\":\"[START]\",\"toBlock\":\"[STOP]\", \"address\": \"[ADDR]\"}]";
@@ -314,19 +359,13 @@ extern void registerQuitHandler(QUITHANDLER qh);
     //--------------------------------------------------------------------------
     uint64_t getLatestBlockFromCache(void) {
 
-        SFArchive fullBlockCache(READING_ARCHIVE);
-        if (!fullBlockCache.Lock(fullBlockIndex, binaryReadOnly, LOCK_NOWAIT)) {
+        CFullBlockIndex index;
+        if (!index.open(fullBlockIndex, LOCK_NOWAIT)) {
             if (!isTestMode())
-                cerr << "getLatestBlockFromCache failed: " << fullBlockCache.LockFailure() << "\n";
+                cerr << "getLatestBlockFromCache failed: " << index.LockFailure() << "\n";
             return 0;
         }
-        ASSERT(fullBlockCache.isOpen());
-
-        uint64_t ret = 0;
-        fullBlockCache.Seek( (-1 * (long)sizeof(uint64_t)), SEEK_END);
-        fullBlockCache.Read(ret);
-        fullBlockCache.Release();
-        return ret;
+        return index.lastBlock();
     }
 
     //--------------------------------------------------------------------------
@@ -353,67 +392,39 @@ extern void registerQuitHandler(QUITHANDLER qh);
     }
 
     //-------------------------------------------------------------------------
-    bool nodeHasBalances(void) {
-        // The known balance of the DAO smart contract at block 1,500,001 was 4423518369662462108465682, if the node reports this correctly, it has historical balances
-        return getBalance("0xbb9bc244d798123fde783fcc1c72d3bb8c189413", 1500001, false) == canonicalWei("4423518369662462108465682");
+    bool getBalances(SFBigUintArray& bals, const SFAddress& addr, const SFUintArray& blocks) {
+        SFString a = "0x" + padLeft(addr.substr(2),40,'0');
+        SFStringArray params;
+        for (uint32_t i = 0 ; i < blocks.getCount() ; i++)
+            params[i] = "[\"" + a +"\",\""+toHex(blocks[i])+"\"]";
+
+        SFStringArray results;
+        bool ret = callRPCMany("eth_getBalance", params, results);
+        bals.Clear();
+        for (uint32_t i = 0 ; i < results.getCount() ; i++)
+            bals[i] = toWei(results[i]);
+        return ret;
     }
 
     //-------------------------------------------------------------------------
-    bool hasTraceAt(const SFString& hashIn, uint32_t where) {
-        SFString cmd = "[\"" + fixHash(hashIn) +"\",[\"" + toHex(where) + "\"]]";
-        SFString ret = callRPC("trace_get", cmd.c_str(), true);
-        return ret.find("blockNumber") != NOPOS;
-    }
-
-    //--------------------------------------------------------------
-    uint32_t getTraceCount_binarySearch(const SFHash& hashIn, uint32_t first, uint32_t last) {
-        if (last > first) {
-            uint32_t mid = first + ((last - first) / 2);
-            bool atMid  = hasTraceAt(hashIn, mid);
-            bool atMid1 = hasTraceAt(hashIn, mid + 1);
-            if (atMid && !atMid1)
-                return mid; // found it
-            if (!atMid) {
-                // we're too high, so search below
-                return getTraceCount_binarySearch(hashIn, first, mid-1);
-            }
-            // we're too low, so search above
-            return getTraceCount_binarySearch(hashIn, mid+1, last);
-        }
-        return first;
+    bool nodeHasBalances(void) {
+        // The known balance of the DAO smart contract at block 1,500,001 was 4423518369662462108465682, if the node reports this correctly, it has historical balances
+        return getBalance("0xbb9bc244d798123fde783fcc1c72d3bb8c189413", 1500001, false) == canonicalWei("4423518369662462108465682");
     }
 
-    // https://ethereum.stackexchange.com/questions/9883/why-is-my-node-synchronization-stuck-extremely-slow-at-block-2-306-843/10453
     //--------------------------------------------------------------
+    // The count comes from the transaction's block, so we need to know where the transaction is
     uint32_t getTraceCount(const SFHash& hashIn) {
-        // handle most likely cases linearly
-        for (uint32_t n = 2 ; n < 8 ; n++) {
-            if (!hasTraceAt(hashIn, n)) {
-                if (verbose>2) cerr << "tiny trace" << (n-1) << "\n";
-                return n-1;
-            }
-        }
-
-        // binary search the rest
-        uint32_t ret = 0;
-        if (!hasTraceAt(hashIn, (1<<8))) { // small?
-            ret = getTraceCount_binarySearch(hashIn, 0, (1<<8)-1);
-            if (verbose>2) cerr << "small trace" << ret << "\n";
-            return ret;
-        } else if (!hasTraceAt(hashIn, (1<<16))) { // medium?
-            ret = getTraceCount_binarySearch(hashIn, 0, (1<<16)-1);
-            if (verbose>2) cerr << "medium trace" << ret << "\n";
-            return ret;
-        } else {
-            ret = getTraceCount_binarySearch(hashIn, 0, (1<<30)); // TODO: is this big enough?
-            if (verbose>2) cerr << "large trace" << ret << "\n";
-        }
-        return ret;
+        CTransaction trans;
+        getTransaction(trans, hashIn);
+        if (trans.hash.empty())
+            return 0;
+        return getTraceCount(trans);
     }
 
     //-------------------------------------------------------------------------
     bool getSha3(const SFString& hexIn, SFString& shaOut) {
-        shaOut = callRPC("web3_sha3", "[\"" + hexIn + "\"]", false);
+        shaOut = keccak256(hexIn);
         return true;
     }
 
@@ -447,53 +458,172 @@ extern void registerQuitHandler(QUITHANDLER qh);
         return nFields;
     }
 
+    //-----------------------------------------------------------------------
+    // Creates the file's folder quietly, the way CCacheWriter does, so both write paths look the same
+    static bool openForWriting(SFArchive& archive, const SFString& fileName) {
+        if (!establishFolder(fileName))
+            return false;
+        return archive.Lock(fileName, binaryWriteCreate, LOCK_CREATE);
+    }
+
     //-----------------------------------------------------------------------
     bool writeNodeToBinary(const CBaseNode& node, const SFString& fileName) {
-        SFString created;
-        if (establishFolder(fileName, created)) {
-            if (!created.empty() && !isTestMode())
-                cerr << "mkdir(" << created << ")" << SFString(' ',20) << "                                                     \n";
-            SFArchive nodeCache(WRITING_ARCHIVE);
-            if (nodeCache.Lock(fileName, binaryWriteCreate, LOCK_CREATE)) {
-                node.SerializeC(nodeCache);
-                nodeCache.Close();
-                return true;
-            }
+        SFArchive nodeCache(WRITING_ARCHIVE);
+        if (!openForWriting(nodeCache, fileName))
+            return false;
+        node.SerializeC(nodeCache);
+        nodeCache.Close();
+        return true;
+    }
+
+    //-----------------------------------------------------------------------
+    // The bytes of a node as they go into a file, encoded with 'codec' (see codec.h)
+    static void serializeNode(const CBaseNode& node, uint32_t codec, std::vector<char>& bytes) {
+        thread_local CMemArchive nodeCache(WRITING_ARCHIVE);
+        nodeCache.setCodec(codec);
+        node.SerializeC(nodeCache);
+        nodeCache.takeBuffer(bytes);
+    }
+
+    //-----------------------------------------------------------------------
+    static bool writeBytesToBinary(const std::vector<char>& bytes, const SFString& fileName) {
+        SFArchive nodeCache(WRITING_ARCHIVE);
+        if (!openForWriting(nodeCache, fileName))
+            return false;
+        nodeCache.Write(bytes.data(), sizeof(char), bytes.size());
+        nodeCache.Close();
+        return true;
+    }
+
+    //-----------------------------------------------------------------------
+    static uint32_t theBlockCodec = CODEC_NONE;
+    uint32_t getBlockCodec(void) { return theBlockCodec; }
+    void     setBlockCodec(uint32_t codec) { theBlockCodec = (codec & CODEC_ALL); }
+
+    //-----------------------------------------------------------------------
+    static CCacheWriter *theCacheWriter = NULL;
+    static void flushAtExit(void) { getCacheWriter(true); }
+
+    //-----------------------------------------------------------------------
+    CCacheWriter *getCacheWriter(bool cleanup) {
+        if (cleanup) {
+            if (theCacheWriter)
+                delete theCacheWriter;  // writes and syncs whatever is still queued
+            theCacheWriter = NULL;
+            return NULL;
         }
-        return false;
+
+        if (!theCacheWriter) {
+            static bool registered = false;
+            if (!registered)
+                atexit(flushAtExit);  // so a tool that just exits doesn't lose its queued writes
+            registered = true;
+            theCacheWriter = new CCacheWriter;
+        }
+        return theCacheWriter;
+    }
+
+    //-----------------------------------------------------------------------
+    bool queueNodeToBinary(const CBaseNode& node, const SFString& fileName, uint32_t codec) {
+        std::vector<char> bytes;
+        serializeNode(node, codec, bytes);
+        getCacheWriter()->write(fileName, bytes);
+        return true;
+    }
+
+    //-----------------------------------------------------------------------
+    bool flushCacheWrites(void) {
+        return (theCacheWriter ? theCacheWriter->flush() : true);
     }
 
     //-----------------------------------------------------------------------
     bool readNodeFromBinary(CBaseNode& item, const SFString& fileName) {
-        // Assumes that the item is clear, so no Init
-        SFArchive nodeCache(READING_ARCHIVE);
-        if (nodeCache.Lock(fileName, binaryReadOnly, LOCK_NOWAIT)) {
+        if (theCacheWriter)
+            theCacheWriter->waitFor(fileName);
+
+        // Assumes that the item is clear, so no Init. Each thread keeps its archive (and so its
+        // buffer) from one file to the next, which is what the forEvery*OnDisc loops want.
+        thread_local CMemArchive nodeCache;
+        if (nodeCache.open(fileName)) {
             item.Serialize(nodeCache);
-            nodeCache.Close();
+            nodeCache.close();
             return true;
         }
         return false;
     }
 
+    //-----------------------------------------------------------------------
+    // The block number of a file in the block cache, or NOPOS for any other file
+    static blknum_t cachedBlockNumber(const SFString& fileName) {
+        if (!fileName.endsWith(".bin") || !fileName.startsWith(blockFolder))
+            return NOPOS;
+        return bnFromPath(fileName);
+    }
+
     //-----------------------------------------------------------------------
     bool writeBlockToBinary(const CBlock& block, const SFString& fileName) {
         //SFArchive blockCache(READING_ARCHIVE);  -- so search hits
-        return writeNodeToBinary(block, fileName);
+        blknum_t bn = cachedBlockNumber(fileName);
+        if (bn != NOPOS) {
+            dropFromPack(bn);
+            dropFromColumns(bn);
+        }
+        if (theBlockCodec == CODEC_NONE)
+            return writeNodeToBinary(block, fileName);
+        std::vector<char> bytes;
+        serializeNode(block, theBlockCodec, bytes);
+        return writeBytesToBinary(bytes, fileName);
     }
 
     //-----------------------------------------------------------------------
+    // Blocks in the cache may be packed (see blockpack.h), so we look there first
     bool readBlockFromBinary(CBlock& block, const SFString& fileName) {
         //SFArchive blockCache(READING_ARCHIVE);  -- so search hits
-        return readNodeFromBinary(block, fileName);
+        blknum_t bn = cachedBlockNumber(fileName);
+        if (bn != NOPOS && readBlockFromPack(block, bn))
+            return true;
+        if (readNodeFromBinary(block, fileName))
+            return true;
+        // Another process may have packed the file (and removed it) since we opened its pack
+        if (bn == NOPOS || !refreshBlockPack(bn))
+            return false;
+        return readBlockFromPack(block, bn);
+    }
+
+    //-----------------------------------------------------------------------
+    bool blockInCache(blknum_t bn) {
+        return (isBlockInPack(bn) || fileSize(getBinaryFilename(bn)) > 0);
+    }
+
+    //-----------------------------------------------------------------------
+    static thread_local bool *upgradesDeferred = NULL;
+    void deferBlockUpgrades(bool *deferred) { upgradesDeferred = deferred; }
+
+    //-----------------------------------------------------------------------
+    bool deferBlockUpgrade(void) {
+        if (!upgradesDeferred)
+            return false;
+        *upgradesDeferred = true;
+        return true;
+    }
+
+    //-----------------------------------------------------------------------
+    bool queueBlockToBinary(const CBlock& block, const SFString& fileName) {
+        blknum_t bn = cachedBlockNumber(fileName);
+        if (bn != NOPOS) {
+            dropFromPack(bn);
+            dropFromColumns(bn);
+        }
+        return queueNodeToBinary(block, fileName, theBlockCodec);
     }
 
     //----------------------------------------------------------------------------------
     bool readBloomArray(SFBloomArray& blooms, const SFString& fileName) {
         blooms.Clear();
-        SFArchive bloomCache(READING_ARCHIVE);
-        if (bloomCache.Lock(fileName, binaryReadOnly, LOCK_NOWAIT)) {
+        CMemArchive bloomCache;
+        if (bloomCache.open(fileName)) {
             bloomCache >> blooms;
-            bloomCache.Close();
+            bloomCache.close();
             return true;
         }
         return false;
@@ -555,6 +685,81 @@ extern void registerQuitHandler(QUITHANDLER qh);
         return ret;
     }
 
+    //-------------------------------------------------------------------------
+    static int sortUints(const void *v1, const void *v2) {
+        uint64_t u1 = *(uint64_t*)v1;
+        uint64_t u2 = *(uint64_t*)v2;
+        return (u1 < u2 ? -1 : (u1 > u2 ? 1 : 0));
+    }
+
+    //-------------------------------------------------------------------------
+    // The path ends with .../blocks/AA/BB/, which holds blocks AABB00000 to AABB99999
+    static bool collectChunkFolder(const SFString& path, void *data) {
+        if (path.endsWith("/")) {
+            SFString p = path.substr(0, path.length() - 1);
+            p.Reverse();
+            SFString second = nextTokenClear(p, '/');
+            SFString first  = nextTokenClear(p, '/');
+            second.Reverse();
+            first.Reverse();
+            SFUintArray *chunks = (SFUintArray*)data;
+            chunks->addValue(toUnsigned(first) * 100 + toUnsigned(second));
+        }
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    static bool collectTopFolder(const SFString& path, void *data) {
+        if (path.endsWith("/"))
+            forAllFiles(path + "*", collectChunkFolder, data);
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    void listCacheChunks(SFUintArray& chunks) {
+        chunks.Clear();
+        forAllFiles(blockFolder + "*", collectTopFolder, &chunks);
+        chunks.Sort(sortUints);
+    }
+
+    //-------------------------------------------------------------------------
+    static bool collectBlockFile(const SFString& path, void *data) {
+        if (path.endsWith("/")) {
+            forAllFiles(path + "*", collectBlockFile, data);
+
+        } else if (path.endsWith(".bin")) {
+            SFUintArray *blocks = (SFUintArray*)data;
+            blocks->addValue(bnFromPath(path));
+
+        } else if (path.endsWith(".pack")) {
+            CBlockPack pack;
+            if (pack.open(path)) {
+                SFUintArray *blocks = (SFUintArray*)data;
+                for (blknum_t bn = pack.firstBlock() ; bn < pack.firstBlock() + BLOCKS_PER_PACK ; bn++)
+                    if (pack.hasBlock(bn))
+                        blocks->addValue(bn);
+            }
+        }
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    void listCachedBlocks(uint64_t chunk, SFUintArray& blocks) {
+        blocks.Clear();
+        SFString folder = getBinaryPath(chunk * 100000);
+        folder = folder.substr(0, folder.length() - 3);  // drop the third level
+        forAllFiles(folder + "*", collectBlockFile, &blocks);
+        blocks.Sort(sortUints);
+
+        // A block may be both packed and in its own file
+        SFUintArray unique;
+        unique.reserve(blocks.getCount());
+        for (uint32_t i = 0 ; i < blocks.getCount() ; i++)
+            if (!unique.getCount() || blocks[i] != unique[unique.getCount() - 1])
+                unique.addValue(blocks[i]);
+        blocks = unique;
+    }
+
     //-------------------------------------------------------------------------
     bool forEveryBlock(BLOCKVISITFUNC func, void *data, uint64_t start, uint64_t count, uint64_t skip) {
         // Here we simply scan the numbers and either read from disc or query the node
@@ -564,7 +769,7 @@ extern void registerQuitHandler(QUITHANDLER qh);
         for (uint64_t i = start ; i < start + count - 1 ; i = i + skip) {
             SFString fileName = getBinaryFilename(i);
             CBlock block;
-            if (fileExists(fileName)) {
+            if (blockInCache(i)) {
                 block = CBlock();
                 readBlockFromBinary(block, fileName);
             } else {
@@ -606,39 +811,26 @@ extern void registerQuitHandler(QUITHANDLER qh);
         // Read the non-empty block index file and spit it out only non-empty blocks
         if (!func)
             return false;
+        if (!skip)
+            skip = 1;
 
-        SFArchive fullBlockCache(READING_ARCHIVE);
-        if (!fullBlockCache.Lock(fullBlockIndex, binaryReadOnly, LOCK_WAIT)) {
-            cerr << "forEveryNonEmptyBlockOnDisc failed: " << fullBlockCache.LockFailure() << "\n";
+        CFullBlockIndex index;
+        if (!index.open(fullBlockIndex)) {
+            cerr << "forEveryNonEmptyBlockOnDisc failed: " << index.LockFailure() << "\n";
             return false;
         }
-        ASSERT(fullBlockCache.isOpen());
-
-        uint64_t nItems = fileSize(fullBlockIndex) / sizeof(uint64_t);
-        uint64_t *contents = new uint64_t[nItems];
-        if (contents) {
-            // read the entire full block index
-            fullBlockCache.Read(contents, sizeof(uint64_t), nItems);
-            fullBlockCache.Release();  // release it since we don't need it any longer
-
-            for (uint64_t i = 0 ; i < nItems ; i = i + skip) {
-                // TODO: This should be a binary search not a scan. This is why it appears to wait
-                uint64_t item = contents[i];
-                if (inRange(item, start, start+count-1)) {
-                    CBlock block;
-                    if (getBlock(block,contents[i])) {
-                        bool ret = (*func)(block, data);
-                        if (!ret) {
-                            // Cleanup and return if user tells us to
-                            delete [] contents;
-                            return false;
-                        }
-                    }
-                } else {
-                    // do nothing
+
+        uint64_t first, last;
+        index.rangeOf(start, (count > UINT64_MAX - start ? UINT64_MAX : start + count), first, last);
+        for (uint64_t i = first ; i < last ; i = i + skip) {
+            CBlock block;
+            if (getBlock(block, index[i])) {
+                bool ret = (*func)(block, data);
+                if (!ret) {
+                    // Cleanup and return if user tells us to
+                    return false;
                 }
             }
-            delete [] contents;
         }
         return true;
     }
@@ -647,46 +839,241 @@ extern void registerQuitHandler(QUITHANDLER qh);
     bool forEveryEmptyBlockOnDisc(BLOCKVISITFUNC func, void *data, uint64_t start, uint64_t count, uint64_t skip) {
         if (!func)
             return false;
+        if (!skip)
+            skip = 1;
+
+        CFullBlockIndex index;
+        if (!index.open(fullBlockIndex)) {
+            cerr << "forEveryEmptyBlockOnDisc failed: " << index.LockFailure() << "\n";
+            return false;
+        }
+
+        // We only know a block is empty if it's before the last block we've scraped
+        uint64_t end = (count > UINT64_MAX - start ? UINT64_MAX : start + count);
+        end = min(end, index.lastBlock());
 
         getCurlContext()->provider = "local"; // the empty blocks are not on disk, so we have to ask parity. Don't write them, though
 
-        SFArchive fullBlockCache(READING_ARCHIVE);
-        if (!fullBlockCache.Lock(fullBlockIndex, binaryReadOnly, LOCK_WAIT)) {
-            cerr << "forEveryEmptyBlockOnDisc failed: " << fullBlockCache.LockFailure() << "\n";
-            return false;
+        uint64_t first, last;
+        index.rangeOf(start, end, first, last);
+        for (uint64_t bn = start ; bn < end ; bn = (end - bn <= skip ? end : bn + skip)) {
+            // step past the non-empty blocks up to this one
+            while (first < last && index[first] < bn)
+                first++;
+            if (first < last && index[first] == bn)
+                continue;
+
+            CBlock block;
+            // Both 'queryBlock' and 'getBlock' return false if there are no
+            // transactions, so we ignore the return value
+            getBlock(block, bn);
+            if (!(*func)(block, data)) {
+                getCurlContext()->provider = "binary";
+                return false;
+            }
         }
-        ASSERT(fullBlockCache.isOpen());
-
-        uint64_t nItems = fileSize(fullBlockIndex) / sizeof(uint64_t) + 1;  // we need an extra one for item '0'
-        uint64_t *contents = new uint64_t[nItems+2];  // extra space
-        if (contents) {
-            // read the entire full block index
-            fullBlockCache.Read(&contents[0], sizeof(uint64_t), nItems-1);  // one less since we asked for an extra one
-            fullBlockCache.Release();  // release it since we don't need it any longer
-
-            contents[0] = 0;  // the starting point (needed because we are build the empty list from the non-empty list
-            uint64_t cnt = start;
-            for (uint64_t i = 1 ; i < nItems ; i = i + skip) { // first one (at index '0') is assumed to be the '0' block
-                while (cnt<contents[i]) {
-                    CBlock block;
-                    // Both 'queryBlock' and 'getBlock' return false if there are no
-                    // transactions, so we ignore the return value
-                    getBlock(block,cnt);
-                    if (!(*func)(block, data)) {
-                        getCurlContext()->provider = "binary";
-                        delete [] contents;
-                        return false;
+        getCurlContext()->provider = "binary";
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    // Each thread keeps this many blocks in memory. Smaller chunks keep the readers close to the
+    // block being delivered, which matters when blocks have to come out in order.
+    #define PARALLEL_BLOCKS_PER_THREAD 256
+    #define PARALLEL_CHUNK_SIZE        8
+
+    //-------------------------------------------------------------------------
+    class CParallelVisitor {
+    public:
+        CParallelVisitor(BLOCKVISITFUNC func, void *data, uint32_t mode, bool nonEmptyOnly);
+        ~CParallelVisitor(void);
+
+        uint64_t batchSize(void) const { return m_batchSize; }
+        bool     visit(const blknum_t *blocks, uint64_t nBlocks);
+
+    private:
+        //---------------------------------------------------------------------
+        struct CBlockSlot {
+            blknum_t bn;
+            CBlock   block;
+            bool     onDisc;
+            bool     ready;
+        };
+
+        BLOCKVISITFUNC          m_func;
+        void                   *m_data;
+        uint32_t                m_mode;
+        bool                    m_nonEmptyOnly;
+        CWorkPool               m_pool;
+        uint64_t                m_batchSize;
+        CBlockSlot             *m_slots;
+        std::mutex              m_lock;
+        std::condition_variable m_ready;
+        std::deque<uint64_t>    m_finished;  // slots in the order they were read (unordered mode only)
+
+        static void readSlot(uint64_t item, void *data);
+        bool        deliver (CBlockSlot& slot);
+    };
+
+    //-------------------------------------------------------------------------
+    CParallelVisitor::CParallelVisitor(BLOCKVISITFUNC func, void *data, uint32_t mode, bool nonEmptyOnly)
+        : m_func(func), m_data(data), m_mode(mode), m_nonEmptyOnly(nonEmptyOnly), m_pool(0) {
+        m_batchSize = m_pool.nThreads() * PARALLEL_BLOCKS_PER_THREAD;
+        m_slots = new CBlockSlot[m_batchSize];
+
+        // This is what queryBlock does before reading a block from the cache. We do it once here
+        // since the readers can't touch the field lists
+        UNHIDE_FIELD(CTransaction, "receipt");
+    }
+
+    //-------------------------------------------------------------------------
+    CParallelVisitor::~CParallelVisitor(void) {
+        m_pool.cancel();
+        m_pool.wait();
+        delete [] m_slots;
+    }
+
+    //-------------------------------------------------------------------------
+    // Runs on one of the pool's threads
+    void CParallelVisitor::readSlot(uint64_t item, void *data) {
+        CParallelVisitor *visitor = reinterpret_cast<CParallelVisitor*>(data);
+        CBlockSlot& slot = visitor->m_slots[item];
+
+        // Old blocks that need the node are left for the calling thread (see deliver)
+        SFString fileName = getBinaryFilename(slot.bn);
+        bool deferred = false;
+        deferBlockUpgrades(&deferred);
+        slot.block = CBlock();
+        slot.onDisc = (blockInCache(slot.bn) && readBlockFromBinary(slot.block, fileName) && !deferred);
+        deferBlockUpgrades(NULL);
+
+        std::lock_guard<std::mutex> guard(visitor->m_lock);
+        slot.ready = true;
+        if (visitor->m_mode == VISIT_UNORDERED)
+            visitor->m_finished.push_back(item);
+        visitor->m_ready.notify_one();
+    }
+
+    //-------------------------------------------------------------------------
+    // Runs on the calling thread
+    bool CParallelVisitor::deliver(CBlockSlot& slot) {
+        if (!slot.onDisc) {
+            // Not in the cache (or unreadable, or an old block that needs the node), so get it the
+            // way the serial versions do
+            std::lock_guard<std::recursive_mutex> guard(getRPCLock());
+            slot.block = CBlock();
+            bool nonEmpty = getBlock(slot.block, slot.bn);
+            if (m_nonEmptyOnly && !nonEmpty)
+                return true;
+        }
+        return (*m_func)(slot.block, m_data);
+    }
+
+    //-------------------------------------------------------------------------
+    bool CParallelVisitor::visit(const blknum_t *blocks, uint64_t nBlocks) {
+        for (uint64_t first = 0 ; first < nBlocks ; first += m_batchSize) {
+            uint64_t cnt = min(m_batchSize, nBlocks - first);
+            for (uint64_t i = 0 ; i < cnt ; i++) {
+                m_slots[i].bn    = blocks[first + i];
+                m_slots[i].ready = false;
+            }
+            m_finished.clear();
+            m_pool.start(cnt, readSlot, this, PARALLEL_CHUNK_SIZE);
+
+            for (uint64_t n = 0 ; n < cnt ; n++) {
+                uint64_t which = n;
+                {
+                    std::unique_lock<std::mutex> guard(m_lock);
+                    if (m_mode == VISIT_UNORDERED) {
+                        m_ready.wait(guard, [this] { return !m_finished.empty(); });
+                        which = m_finished.front();
+                        m_finished.pop_front();
+                    } else {
+                        m_ready.wait(guard, [this, n] { return m_slots[n].ready; });
                     }
-                    cnt++; // go to the next one
                 }
-                cnt++; // contents[i] has transactions, so skip it
+
+                if (!deliver(m_slots[which])) {
+                    // Cleanup and return if user tells us to
+                    m_pool.cancel();
+                    m_pool.wait();
+                    return false;
+                }
             }
-            delete [] contents;
+            m_pool.wait();
         }
-        getCurlContext()->provider = "binary";
         return true;
     }
 
+    //-------------------------------------------------------------------------
+    bool forEveryBlockParallel(BLOCKVISITFUNC func, void *data, uint64_t start, uint64_t count, uint64_t skip, uint32_t mode) {
+        if (!func)
+            return false;
+        if (!skip)
+            skip = 1;
+
+        CParallelVisitor visitor(func, data, mode, false);
+        blknum_t *blocks = new blknum_t[visitor.batchSize()];
+        uint64_t end = (count > UINT64_MAX - start ? UINT64_MAX : start + count);
+        uint64_t nBlocks = 0;
+        bool ret = true;
+        for (uint64_t i = start ; i < end && ret ; i = (end - i <= skip ? end : i + skip)) {
+            blocks[nBlocks++] = i;
+            if (nBlocks == visitor.batchSize()) {
+                ret = visitor.visit(blocks, nBlocks);
+                nBlocks = 0;
+            }
+        }
+        if (ret && nBlocks)
+            ret = visitor.visit(blocks, nBlocks);
+        delete [] blocks;
+        return ret;
+    }
+
+    //-------------------------------------------------------------------------
+    bool forEveryNonEmptyBlockOnDiscParallel(BLOCKVISITFUNC func, void *data, uint64_t start, uint64_t count, uint64_t skip, uint32_t mode) {
+        if (!func)
+            return false;
+        if (!skip)
+            skip = 1;
+
+        CFullBlockIndex index;
+        if (!index.open(fullBlockIndex)) {
+            cerr << "forEveryNonEmptyBlockOnDiscParallel failed: " << index.LockFailure() << "\n";
+            return false;
+        }
+
+        uint64_t first, last;
+        index.rangeOf(start, (count > UINT64_MAX - start ? UINT64_MAX : start + count), first, last);
+
+        CParallelVisitor visitor(func, data, mode, true);
+        bool ret = true;
+        if (skip == 1) {
+            // the matching blocks are already contiguous in the index
+            ret = visitor.visit(index.blocks() + first, last - first);
+        } else {
+            blknum_t *blocks = new blknum_t[(last - first) / skip + 1];
+            uint64_t nBlocks = 0;
+            for (uint64_t i = first ; i < last ; i = i + skip)
+                blocks[nBlocks++] = index[i];
+            ret = visitor.visit(blocks, nBlocks);
+            delete [] blocks;
+        }
+        return ret;
+    }
+
+    //-------------------------------------------------------------------------
+    // Visits the given blocks (which need not be contiguous) in the order given
+    bool forEveryBlockInListParallel(BLOCKVISITFUNC func, void *data, const SFUintArray& blocks, uint32_t mode) {
+        if (!func)
+            return false;
+        if (!blocks.getCount())
+            return true;
+
+        CParallelVisitor visitor(func, data, mode, false);
+        return visitor.visit(blocks.begin(), blocks.getCount());
+    }
+
     //-------------------------------------------------------------------------
     bool forEveryBloomFile(FILEVISITOR func, void *data, uint64_t start, uint64_t count, uint64_t skip) {
 
@@ -714,7 +1101,7 @@ extern void registerQuitHandler(QUITHANDLER qh);
             return false;
 
         CTraceArray traces;
-        getTraces(traces, trans.hash);
+        getTraces(traces, trans);
         for (uint32_t i=0;i<traces.getCount();i++) {
             CTrace trace = traces[i];
             if (!(*func)(trace, data))
@@ -781,7 +1168,11 @@ extern void registerQuitHandler(QUITHANDLER qh);
         if (!func)
             return false;
 
-        // trans_list is a list of tx_hash, blk_hash.tx_id, or blk_num.tx_id, or any combination
+        // trans_list is a list of tx_hash, blk_hash.tx_id, or blk_num.tx_id, or any combination. We
+        // first pick up each transaction, then we ask for all of their receipts in a single batch
+        CTransactionArray transList;
+        SFStringArray items, hashes;
+        SFUintArray blockItems;
         SFString list = trans_list;
         while (!list.empty()) {
             SFString item = nextTokenClear(list, '|');
@@ -804,30 +1195,56 @@ extern void registerQuitHandler(QUITHANDLER qh);
                 getTransaction(trans, (uint32_t)toLongU(hash), txID);  // blockNum.txID
             }
 
+            uint32_t n = transList.getCount();
+            transList[n] = trans;
+            hashes[n] = trans.getValueByName("hash");
+            items[n] = hash;
+            blockItems[n] = (!isHex || hasDot);
+        }
+
+        CReceiptArray receipts;
+        getReceipts(receipts, hashes);
+
+        for (uint32_t i = 0 ; i < transList.getCount() ; i++) {
+            CTransaction *trans = &transList[i];
+
             CBlock block;
-            trans.pBlock = &block;
-            getBlock(block, trans.blockNumber);
-            if (block.transactions.getCount() > trans.transactionIndex)
-                trans.isError = block.transactions[(uint32_t)trans.transactionIndex].isError;
-            getReceipt(trans.receipt, trans.getValueByName("hash"));
-            trans.finishParse();
-            if (!isHash(trans.hash)) {
-                // If the transaction has no hash here, either the block hash or the transaction hash being asked for doesn't exist. We need to
-                // report which hash failed and why to the caller. Because we have no better way, we report that in the hash itself. There are
-                // three cases, two with either block hash or block num one with transaction hash. Note: This will fail if we move to non-string hashes
-                trans.hash = hash + "-" + (!isHex || hasDot ? "block_not_found" : "trans_not_found");
+            trans->pBlock = &block;
+            getBlock(block, trans->blockNumber);
+            if (block.transactions.getCount() > trans->transactionIndex)
+                trans->isError = block.transactions[(uint32_t)trans->transactionIndex].isError;
+            trans->receipt = receipts[i];
+            trans->finishParse();
+            if (trans->hash.empty()) {
+                // If the transaction has no hash here, either the block (by hash or number) or the transaction
+                // hash being asked for doesn't exist. We tell the caller which.
+                trans->notFound = items[i];
+                trans->notFoundBlock = blockItems[i];
             }
 
-            if (!(*func)(trans, data))
+            bool ret = (*func)(*trans, data);
+            trans->pBlock = NULL;  // the block is about to go out of scope
+            if (!ret)
                 return false;
         }
         return true;
     }
 
+    //-------------------------------------------------------------------------
+    static SFString blockCache;
+
+    //-------------------------------------------------------------------------
+    void setBlockCachePath(const SFString& path) {
+        establishFolder(path.endsWith("/") ? path : path + "/");
+        blockCache = CFilename(path).getFullPath();
+        if (!blockCache.endsWith("/"))
+            blockCache += "/";
+        forgetBlockPacks();
+    }
+
     //-------------------------------------------------------------------------
     SFString blockCachePath(const SFString& _part) {
 
-        static SFString blockCache;
         if (blockCache.empty()) {
             CToml toml(configPath("quickBlocks.toml"));
             SFString path = toml.getConfigStr("settings", "blockCachePath", "<NOT_SET>");
@@ -27,8 +27,11 @@ namespace qblocks {
     extern bool     getBlock                (CBlock& block,       blknum_t blockNum);
     extern bool     getTransaction          (CTransaction& trans, blknum_t blockNum, txnum_t txID);
     extern bool     getReceipt              (CReceipt& receipt,   const SFHash& txHash);
+    extern bool     getReceipts             (CReceiptArray& receipts, const SFStringArray& txHashes);
     extern bool     getLogEntry             (CLogEntry& log,      const SFHash& txHash);
+    extern void     getTraces               (CTraceArray& traces, const CTransaction& trans);
     extern void     getTraces               (CTraceArray& traces, const SFHash& txHash);
+    extern uint32_t getTraceCount           (const CTransaction& trans);
     extern uint32_t getTraceCount           (const SFHash& hashIn);
 
     //-------------------------------------------------------------------------
@@ -48,6 +51,7 @@ namespace qblocks {
     extern bool     queryRawReceipt         (SFString& results,   const SFHash& txHash);
     extern bool     queryRawLog             (SFString& results,   const SFHash& hashIn);
     extern bool     queryRawTrace           (SFString& results,   const SFHash& hashIn);
+    extern bool     queryRawBlockTrace      (SFString& results,   blknum_t blockNum);
     extern bool     queryRawLogs            (SFString& results,   const SFAddress& addr, uint64_t fromBlock, uint64_t toBlock);
 
     //-----------------------------------------------------------------------
@@ -62,6 +66,29 @@ namespace qblocks {
     //-----------------------------------------------------------------------
     extern bool     writeBlockToBinary      (const CBlock& block, const SFString& fileName);
     extern bool     readBlockFromBinary     (      CBlock& block, const SFString& fileName);
+    extern bool     blockInCache            (blknum_t bn);
+
+    //-----------------------------------------------------------------------
+    // Blocks written before version 0.4.0 get some fields from the node when they are read. A
+    // thread that may not talk to the node passes a flag here. Such a block then sets the flag,
+    // and the caller reads it again on a thread that may. Pass NULL to stop. Per thread.
+    extern void     deferBlockUpgrades      (bool *deferred);
+    extern bool     deferBlockUpgrade       (void);
+
+    //-----------------------------------------------------------------------
+    // Write-behind: the block is serialized right away but written (and synced) by the cache
+    // writer's thread. Reading a queued block waits for it. flushCacheWrites returns once all
+    // queued blocks are on disc (false if any could not be written).
+    extern bool     queueBlockToBinary      (const CBlock& block, const SFString& fileName);
+    extern bool     flushCacheWrites        (void);
+    extern CCacheWriter *getCacheWriter     (bool cleanup=false);
+
+    //-----------------------------------------------------------------------
+    // The codec blocks are written with (see codec.h), from [settings] blockCodec in
+    // quickBlocks.toml. It defaults to none, which older versions of the tools can read.
+    // Blocks are read with whatever codec they were written with.
+    extern uint32_t getBlockCodec           (void);
+    extern void     setBlockCodec           (uint32_t codec);
 
     //-------------------------------------------------------------------------
     extern SFString getVersionFromClient    (void);
@@ -77,6 +104,7 @@ namespace qblocks {
     inline SFString getCode                 (const SFAddress& addr) { SFString ret; getCode(addr, ret); return ret; }
     inline bool     isContract              (const SFAddress& addr) { return !getCode(addr).Substitute("0x","").empty(); }
     extern SFUintBN getBalance              (const SFAddress& addr, blknum_t blockNum, bool isDemo);
+    extern bool     getBalances             (SFBigUintArray& bals, const SFAddress& addr, const SFUintArray& blocks);
     extern bool     getSha3                 (const SFString& hexIn, SFString& shaOut);
     inline SFString getSha3                 (const SFString& hexIn) { SFString ret; getSha3(hexIn,ret); return ret; }
 
@@ -84,6 +112,10 @@ namespace qblocks {
     extern SFString getJsonFilename         (uint64_t num);
     extern SFString getBinaryFilename       (uint64_t num);
     extern SFString getBinaryPath           (uint64_t num);
+    // The block cache has one second-level folder for every 100,000 blocks. These list the folders
+    // (as block number / 100,000) and the blocks in one of them, both in order.
+    extern void     listCacheChunks         (SFUintArray& chunks);
+    extern void     listCachedBlocks        (uint64_t chunk, SFUintArray& blocks);
 
     //-------------------------------------------------------------------------
     // function pointer types for forEvery functions
@@ -100,6 +132,18 @@ namespace qblocks {
     extern bool forEveryNonEmptyBlockOnDisc  (BLOCKVISITFUNC func, void *data, uint64_t start, uint64_t count, uint64_t skip=1);
     extern bool forEveryEmptyBlockOnDisc     (BLOCKVISITFUNC func, void *data, uint64_t start, uint64_t count, uint64_t skip=1);
 
+    //-------------------------------------------------------------------------
+    // Parallel versions of the above (forEveryBlockParallel stands in for both forEveryBlock and
+    // forEveryBlockOnDisc, which do the same thing). Cached blocks are read on a pool of threads,
+    // but 'func' is always called on the calling thread, so it needs no locking of its own.
+    // VISIT_ORDERED hands over blocks in block order, VISIT_UNORDERED hands them over as soon as
+    // they are read.
+    #define VISIT_ORDERED   1
+    #define VISIT_UNORDERED 2
+    extern bool forEveryBlockParallel              (BLOCKVISITFUNC func, void *data, uint64_t start, uint64_t count, uint64_t skip=1, uint32_t mode=VISIT_ORDERED);
+    extern bool forEveryNonEmptyBlockOnDiscParallel(BLOCKVISITFUNC func, void *data, uint64_t start, uint64_t count, uint64_t skip=1, uint32_t mode=VISIT_ORDERED);
+    extern bool forEveryBlockInListParallel        (BLOCKVISITFUNC func, void *data, const SFUintArray& blocks, uint32_t mode=VISIT_ORDERED);
+
     //-------------------------------------------------------------------------
     // forEvery functions
     extern bool forEveryBloomFile            (FILEVISITOR    func, void *data, uint64_t start, uint64_t count, uint64_t skip=1);
@@ -118,6 +162,7 @@ namespace qblocks {
 
     //-------------------------------------------------------------------------
     extern SFString blockCachePath(const SFString& _part);
+    extern void     setBlockCachePath(const SFString& path);  // overrides the config file (for tests)
 
     #define fullBlockIndex (blockCachePath("fullBlocks.bin"))
     #define accountIndex   (blockCachePath("accountTree.bin"))
@@ -125,6 +170,11 @@ namespace qblocks {
     #define miniTransCache (blockCachePath("miniTrans.bin"))
     #define blockFolder    (blockCachePath("blocks/"))
     #define bloomFolder    (blockCachePath("blooms/"))
+    #define bloomIndex     (blockCachePath("bloomIndex.bin"))
+    #define timestampIndex (blockCachePath("timestamps.bin"))
+    #define columnFolder   (blockCachePath("columns/"))
+    #define appearFolder   (blockCachePath("appearances/"))
+    #define traceFolder    (blockCachePath("traces/"))
     extern SFUintBN weiPerEther;
 
 }  // namespace qblocks
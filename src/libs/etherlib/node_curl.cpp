@@ -19,23 +19,41 @@ namespace qblocks {
     extern size_t writeCallback(char *ptr, size_t size, size_t nmemb, void *userdata);
     extern size_t traceCallback(char *ptr, size_t size, size_t nmemb, void *userdata);
     extern size_t nullCallback(char *ptr, size_t size, size_t nmemb, void *userdata);
+    static bool   handleCurlError(CURLcode res, const SFString& method);
 
     //-------------------------------------------------------------------------
     CCurlContext::CCurlContext(void) {
-        headers      = "Content-Type: application/json\n";
-        baseURL      = "http://localhost:8545";
-        callBackFunc = writeCallback;
-        theID        = 1;
+        headers        = "Content-Type: application/json\n";
+        baseURL        = "http://localhost:8545";
+        callBackFunc   = writeCallback;
+        theID          = 1;
+        maxBatch       = 100;
+        maxConnections = 20;
+        handle         = NULL;
         Clear();
     }
 
+    //-------------------------------------------------------------------------
+//#define DEBUG_RPC
+    void CCurlContext::applyPostData(void) {
+#ifdef DEBUG_RPC
+        cerr << postData << "\n";
+        cerr.flush();
+#endif
+        // Contexts that belong to an RPC pool carry their own curl handle, the global one uses getCurl()
+        CURL *curl = (handle ? handle : getCurl());
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS,    (const char*)postData);
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, postData.length());
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA,     this);
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, callBackFunc);
+    }
+
     //-------------------------------------------------------------------------
     SFString CCurlContext::getCurlID(void) {
         return asString(isTestMode() ? 1 : theID++);
     }
 
     //-------------------------------------------------------------------------
-//#define DEBUG_RPC
     void CCurlContext::setPostData(const SFString& method, const SFString& params) {
         Clear();
         postData += "{";
@@ -44,14 +62,25 @@ namespace qblocks {
         postData +=  quote("params")  + ":"  + params + ",";
         postData +=  quote("id")      + ":"  + quote(getCurlID());
         postData += "}";
-#ifdef DEBUG_RPC
-        cerr << postData << "\n";
-        cerr.flush();
-#endif
-        curl_easy_setopt(getCurl(), CURLOPT_POSTFIELDS,    (const char*)postData);
-        curl_easy_setopt(getCurl(), CURLOPT_POSTFIELDSIZE, postData.length());
-        curl_easy_setopt(getCurl(), CURLOPT_WRITEDATA,     this);
-        curl_easy_setopt(getCurl(), CURLOPT_WRITEFUNCTION, callBackFunc);
+        applyPostData();
+    }
+
+    //-------------------------------------------------------------------------
+    void CCurlContext::setPostData(const SFString& method, const SFStringArray& params, uint32_t first, uint32_t cnt) {
+        // A JSON-RPC batch request. Each item's id is its offset into the batch so we can match
+        // the node's responses (which may come back in any order) to the requests.
+        Clear();
+        postData += "[";
+        for (uint32_t i = 0 ; i < cnt ; i++) {
+            postData += (i ? ",{" : "{");
+            postData +=  quote("jsonrpc") + ":"  + quote("2.0")  + ",";
+            postData +=  quote("method")  + ":"  + quote(method) + ",";
+            postData +=  quote("params")  + ":"  + params[first+i] + ",";
+            postData +=  quote("id")      + ":"  + quote(asStringU(i));
+            postData += "}";
+        }
+        postData += "]";
+        applyPostData();
     }
 
     //-------------------------------------------------------------------------
@@ -71,6 +100,14 @@ namespace qblocks {
         return &theCurlContext;
     }
 
+    //-------------------------------------------------------------------------
+    // The curl handles and the context above are shared, so only one thread talks to the node
+    // at a time. Code that changes the context's provider from a thread should hold this too.
+    std::recursive_mutex& getRPCLock(void) {
+        static std::recursive_mutex theLock;
+        return theLock;
+    }
+
     //--------------------------------------------------------------------------
     CURLCALLBACKFUNC CCurlContext::setCurlCallback(CURLCALLBACKFUNC func) {
         CURLCALLBACKFUNC prev = getCurlContext()->callBackFunc;
@@ -78,6 +115,30 @@ namespace qblocks {
         return prev;
     }
 
+    //-------------------------------------------------------------------------
+    static void setCurlURL(CURL *curl) {
+        if (getCurlContext()->provider == "remote") {
+            curl_easy_setopt(curl, CURLOPT_URL, "https://pmainnet.infura.io/");
+
+        } else if (getCurlContext()->provider == "ropsten") {
+            curl_easy_setopt(curl, CURLOPT_URL, "https://testnet.infura.io/");
+
+        } else {
+            curl_easy_setopt(curl, CURLOPT_URL, (const char*)getCurlContext()->baseURL);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    static struct curl_slist *getCurlHeaders(void) {
+        struct curl_slist *headers = NULL;
+        SFString head = getCurlContext()->headers;
+        while (!head.empty()) {
+            SFString next = nextTokenClear(head, '\n');
+            headers = curl_slist_append(headers, (char*)(const char*)next);
+        }
+        return headers;
+    }
+
     //-------------------------------------------------------------------------
     CURL *getCurl(bool cleanup) {
         static CURL *curl = NULL;
@@ -89,22 +150,9 @@ namespace qblocks {
                 exit(0);
             }
 
-            SFString head = getCurlContext()->headers;
-            while (!head.empty()) {
-                SFString next = nextTokenClear(head, '\n');
-                headers = curl_slist_append(headers, (char*)(const char*)next);
-            }
+            headers = getCurlHeaders();
             curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-
-            if (getCurlContext()->provider == "remote") {
-                curl_easy_setopt(curl, CURLOPT_URL, "https://pmainnet.infura.io/");
-
-            } else if (getCurlContext()->provider == "ropsten") {
-                curl_easy_setopt(curl, CURLOPT_URL, "https://testnet.infura.io/");
-
-            } else {
-                curl_easy_setopt(curl, CURLOPT_URL, (const char*)getCurlContext()->baseURL);
-            }
+            setCurlURL(curl);
 
         } else if (cleanup) {
 
@@ -120,62 +168,248 @@ namespace qblocks {
         return curl;
     }
 
+    //-------------------------------------------------------------------------
+    CRPCPool *getRPCPool(bool cleanup) {
+        static CRPCPool *pool = NULL;
+        if (!pool && !cleanup) {
+            pool = new CRPCPool;
+
+        } else if (cleanup) {
+            if (pool)
+                delete pool;
+            pool = NULL;
+        }
+        return pool;
+    }
+
+    //-------------------------------------------------------------------------
+    CRPCPool::CRPCPool(void) {
+        m_multi       = NULL;
+        m_single      = NULL;
+        m_headers     = NULL;
+        m_slots       = NULL;
+        m_which       = NULL;
+        m_nSlots      = 0;
+        m_nextInQueue = 0;
+    }
+
+    //-------------------------------------------------------------------------
+    CRPCPool::~CRPCPool(void) {
+        Clear();
+    }
+
+    //-------------------------------------------------------------------------
+    void CRPCPool::Clear(void) {
+        for (uint32_t i = 0 ; i < m_nSlots ; i++) {
+            if (m_multi)
+                curl_multi_remove_handle(m_multi, m_slots[i].handle);
+            curl_easy_cleanup(m_slots[i].handle);
+        }
+        if (m_slots)
+            delete [] m_slots;
+        if (m_which)
+            delete [] m_which;
+        if (m_headers)
+            curl_slist_free_all(m_headers);
+        if (m_multi)
+            curl_multi_cleanup(m_multi);
+        if (m_single)
+            curl_multi_cleanup(m_single);
+        m_multi   = NULL;
+        m_single  = NULL;
+        m_headers = NULL;
+        m_slots   = NULL;
+        m_which   = NULL;
+        m_nSlots  = 0;
+        m_methods.Clear();
+        m_params.Clear();
+        m_queue.Clear();
+        m_nextInQueue = 0;
+    }
+
+    //-------------------------------------------------------------------------
+    CURLcode CRPCPool::perform(CURL *curl) {
+        // A single blocking request (this is what callRPC uses). We use our own multi handle so we
+        // don't pick up completion messages that belong to requests submitted to the pool
+        if (!m_single)
+            m_single = curl_multi_init();
+
+        curl_multi_add_handle(m_single, curl);
+        int stillRunning = 1;
+        while (stillRunning) {
+            if (curl_multi_perform(m_single, &stillRunning) != CURLM_OK)
+                break;
+            if (stillRunning)
+                curl_multi_wait(m_single, NULL, 0, 1000, NULL);
+        }
+
+        CURLcode ret = CURLE_OK;
+        int nMsgs = 0;
+        CURLMsg *msg = NULL;
+        while ((msg = curl_multi_info_read(m_single, &nMsgs)) != NULL)
+            if (msg->msg == CURLMSG_DONE && msg->easy_handle == curl)
+                ret = msg->data.result;
+        curl_multi_remove_handle(m_single, curl);
+        return ret;
+    }
+
+    //-------------------------------------------------------------------------
+    uint32_t CRPCPool::submit(const SFString& method, const SFString& params) {
+        uint32_t id = m_methods.getCount();
+        m_methods[id] = method;
+        m_params[id]  = params;
+        m_queue[m_queue.getCount()] = id;
+        return id;
+    }
+
+    //-------------------------------------------------------------------------
+    void CRPCPool::initSlots(void) {
+        if (m_nSlots)
+            return;
+
+        m_multi   = curl_multi_init();
+        m_headers = getCurlHeaders();
+        m_nSlots  = max((uint32_t)1, getCurlContext()->maxConnections);
+        m_slots   = new CCurlContext[m_nSlots];
+        m_which   = new uint32_t[m_nSlots];
+        for (uint32_t i = 0 ; i < m_nSlots ; i++) {
+            m_slots[i].handle = curl_easy_init();
+            if (!m_slots[i].handle) {
+                fprintf(stderr, "Curl failed to initialize. Quitting...\n");
+                exit(0);
+            }
+            curl_easy_setopt(m_slots[i].handle, CURLOPT_HTTPHEADER, m_headers);
+        }
+        curl_multi_setopt(m_multi, CURLMOPT_MAX_HOST_CONNECTIONS, (long)m_nSlots);
+    }
+
+    //-------------------------------------------------------------------------
+    bool CRPCPool::startNext(uint32_t slot) {
+        if (m_nextInQueue >= m_queue.getCount())
+            return false;
+
+        uint32_t id = (uint32_t)m_queue[m_nextInQueue++];
+        m_which[slot] = id;
+        // The provider may have changed (because of a fallback) since the last request
+        setCurlURL(m_slots[slot].handle);
+        m_slots[slot].setPostData(m_methods[id], m_params[id]);
+        curl_multi_add_handle(m_multi, m_slots[slot].handle);
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    bool CRPCPool::run(RPCRESULTFUNC func, void *data) {
+
+        initSlots();
+
+        uint32_t nRunning = 0;
+        for (uint32_t i = 0 ; i < m_nSlots ; i++)
+            if (startNext(i))
+                nRunning++;
+
+        bool keepGoing = true;
+        while (nRunning) {
+            int stillRunning = 0;
+            if (curl_multi_perform(m_multi, &stillRunning) != CURLM_OK)
+                break;
+
+            int nMsgs = 0;
+            CURLMsg *msg = NULL;
+            while ((msg = curl_multi_info_read(m_multi, &nMsgs)) != NULL) {
+                if (msg->msg != CURLMSG_DONE)
+                    continue;
+
+                uint32_t slot = 0;
+                while (slot < m_nSlots && m_slots[slot].handle != msg->easy_handle)
+                    slot++;
+                if (slot == m_nSlots)
+                    continue;
+
+                CURLcode res = msg->data.result;
+                curl_multi_remove_handle(m_multi, m_slots[slot].handle);
+                nRunning--;
+
+                uint32_t id = m_which[slot];
+                CCurlContext *ctx = &m_slots[slot];
+                if (res != CURLE_OK && !ctx->earlyAbort && handleCurlError(res, m_methods[id])) {
+                    // we've switched to the fallback provider, so send it again
+                    m_queue[m_queue.getCount()] = id;
+
+                } else if (keepGoing && func) {
+                    CRPCResult generic;
+                    generic.parseJson((char*)(const char*)ctx->result);
+                    keepGoing = (*func)(id, generic.result, data);
+                }
+
+                if (keepGoing && startNext(slot))
+                    nRunning++;
+            }
+
+            if (nRunning)
+                curl_multi_wait(m_multi, NULL, 0, 1000, NULL);
+        }
+
+        m_methods.Clear();
+        m_params.Clear();
+        m_queue.Clear();
+        m_nextInQueue = 0;
+        return keepGoing;
+    }
+
     //-------------------------------------------------------------------------
     bool isNodeRunning(void) {
         CURLCALLBACKFUNC prev = getCurlContext()->setCurlCallback(nullCallback);
         getCurlContext()->setPostData("web3_clientVersion", "[]");
-        CURLcode res = curl_easy_perform(getCurl());
+        CURLcode res = getRPCPool()->perform(getCurl());
         getCurlContext()->setCurlCallback(prev);
         return (res == CURLE_OK);
     }
 
     //-------------------------------------------------------------------------
-    SFString callRPC(const SFString& method, const SFString& params, bool raw) {
-
-        //getCurlContext()->callBackFunc = writeCallback;
-        getCurlContext()->setPostData(method, params);
-
-        CURLcode res = curl_easy_perform(getCurl());
-        if (res != CURLE_OK && !getCurlContext()->earlyAbort) {
-            SFString currentSource = getCurlContext()->provider;
-            SFString fallBack = getenv("FALLBACK");
-            if (!fallBack.empty() && currentSource != fallBack) {
-                if (fallBack != "infura") {
-                    cerr << cYellow;
-                    cerr << "\n";
-                    cerr << "\tWarning: " << cOff << "Only the 'infura' fallback is supported.\n";
-                    cerr << "\tIt is impossible for QuickBlocks to proceed. Quitting...\n";
-                    cerr << "\n";
-                    exit(0);
-                }
+    // Returns true if the caller should re-send its request (because we've switched to the
+    // fallback provider). Otherwise, reports the error and quits.
+    static bool handleCurlError(CURLcode res, const SFString& method) {
+        SFString currentSource = getCurlContext()->provider;
+        SFString fallBack = getenv("FALLBACK");
+        if (!fallBack.empty() && currentSource != fallBack) {
+            if (fallBack != "infura") {
+                cerr << cYellow;
+                cerr << "\n";
+                cerr << "\tWarning: " << cOff << "Only the 'infura' fallback is supported.\n";
+                cerr << "\tIt is impossible for QuickBlocks to proceed. Quitting...\n";
+                cerr << "\n";
+                exit(0);
+            }
 
-                if (fallBack == "infura" && method.startsWith("trace_")) {
-                    cerr << cYellow;
-                    cerr << "\n";
-                    cerr << "\tWarning: " << cOff << "A trace request was made to the fallback\n";
-                    cerr << "\tnode. " << toProper(fallBack) << " does not support tracing. It ";
-                    cerr << "is impossible\n\tfor QuickBlocks to proceed. Quitting...\n";
-                    cerr << "\n";
-                    exit(0);
-                }
-                getCurlContext()->theID--;
-                getCurlContext()->provider = "remote";
-                // reset curl
-                getCurl(true); getCurl();
-                // since we failed, we leave the new provider, otherwise we would have to save
-                // the results and reset it here.
-                return callRPC(method, params, raw);
+            if (fallBack == "infura" && method.startsWith("trace_")) {
+                cerr << cYellow;
+                cerr << "\n";
+                cerr << "\tWarning: " << cOff << "A trace request was made to the fallback\n";
+                cerr << "\tnode. " << toProper(fallBack) << " does not support tracing. It ";
+                cerr << "is impossible\n\tfor QuickBlocks to proceed. Quitting...\n";
+                cerr << "\n";
+                exit(0);
             }
-            cerr << cYellow;
-            cerr << "\n";
-            cerr << "\tWarning: " << cOff << "The request to the Ethereum node ";
-            cerr << "resulted in\n\tfollowing error message: ";
-            cerr << bTeal << curl_easy_strerror(res) << cOff << ".\n";
-            cerr << "\tIt is impossible for QuickBlocks to proceed. Quitting...\n";
-            cerr << "\n";
-            exit(0);
+            getCurlContext()->provider = "remote";
+            // reset curl
+            getCurl(true); getCurl();
+            // since we failed, we leave the new provider, otherwise we would have to save
+            // the results and reset it here.
+            return true;
         }
+        cerr << cYellow;
+        cerr << "\n";
+        cerr << "\tWarning: " << cOff << "The request to the Ethereum node ";
+        cerr << "resulted in\n\tfollowing error message: ";
+        cerr << bTeal << curl_easy_strerror(res) << cOff << ".\n";
+        cerr << "\tIt is impossible for QuickBlocks to proceed. Quitting...\n";
+        cerr << "\n";
+        exit(0);
+        return false;
+    }
 
+    //-------------------------------------------------------------------------
+    static void checkEmptyResult(void) {
         if (getCurlContext()->result.empty()) {
             cerr << cYellow;
             cerr << "\n";
@@ -189,6 +423,23 @@ namespace qblocks {
                 cerr << getCurlContext()->postData << "\n";
             }
         }
+    }
+
+    //-------------------------------------------------------------------------
+    SFString callRPC(const SFString& method, const SFString& params, bool raw) {
+
+        std::lock_guard<std::recursive_mutex> guard(getRPCLock());
+        //getCurlContext()->callBackFunc = writeCallback;
+        getCurlContext()->setPostData(method, params);
+
+        CURLcode res = getRPCPool()->perform(getCurl());
+        if (res != CURLE_OK && !getCurlContext()->earlyAbort) {
+            if (handleCurlError(res, method)) {
+                getCurlContext()->theID--;
+                return callRPC(method, params, raw);
+            }
+        }
+        checkEmptyResult();
 
 #ifdef DEBUG_RPC
         //    cout << "\n" << SFString('-',80) << "\n";
@@ -201,15 +452,91 @@ namespace qblocks {
         if (raw)
             return getCurlContext()->result;
         CRPCResult generic;
-        char *p = cleanUpJson((char*)(const char*)getCurlContext()->result);
-        generic.parseJson(p);
+        generic.parseJson((char*)(const char*)getCurlContext()->result);
         return generic.result;
     }
 
+    //-------------------------------------------------------------------------
+    bool callRPCBatch(const SFString& method, const SFStringArray& params, SFStringArray& results) {
+
+        // Sends the same method with each of the given params to the node, at most 'maxBatch'
+        // items per round-trip. On return, results[i] holds the 'result' field of the response
+        // to params[i] (or is empty if the node did not return one)
+        std::lock_guard<std::recursive_mutex> guard(getRPCLock());
+        results.Clear();
+        uint32_t nItems = params.getCount();
+        if (nItems)
+            results[nItems-1] = "";  // size the array so results line up with params
+
+        uint32_t maxBatch = max((uint32_t)1, getCurlContext()->maxBatch);
+        for (uint32_t first = 0 ; first < nItems ; first += maxBatch) {
+            uint32_t cnt = min(maxBatch, nItems - first);
+            getCurlContext()->setPostData(method, params, first, cnt);
+
+            CURLcode res = getRPCPool()->perform(getCurl());
+            if (res != CURLE_OK && !getCurlContext()->earlyAbort) {
+                if (handleCurlError(res, method)) {
+                    first -= maxBatch;  // re-send this batch to the fallback provider
+                    continue;
+                }
+            }
+            checkEmptyResult();
+
+#ifdef DEBUG_RPC
+            cout << SFString('=',60) << "\n";
+            cout << "received: " << getCurlContext()->result << "\n";
+            cout.flush();
+#endif
+            // The node returns an array of responses. Parse each one and put it in its place
+            char *p = (char*)(const char*)getCurlContext()->result;
+            while (p && *p) {
+                CRPCResult generic;
+                uint32_t nFields = 0;
+                p = generic.parseJson(p, nFields);
+                if (nFields && !generic.id.empty()) {
+                    uint32_t id = toLong32u(generic.id);
+                    if (id < cnt)
+                        results[first+id] = generic.result;
+                }
+            }
+        }
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    static bool collectResult(uint32_t id, const SFString& result, void *data) {
+        SFStringArray *results = (SFStringArray*)data;
+        (*results)[id] = result;
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    bool callRPCMany(const SFString& method, const SFStringArray& params, SFStringArray& results) {
+
+        // Sends each request on its own connection from the pool, with many requests in flight
+        // at once. On return, results[i] holds the 'result' field of the response to params[i]
+        std::lock_guard<std::recursive_mutex> guard(getRPCLock());
+        results.Clear();
+        uint32_t nItems = params.getCount();
+        if (!nItems)
+            return true;
+        results[nItems-1] = "";  // size the array so results line up with params
+
+        CRPCPool *pool = getRPCPool();
+        for (uint32_t i = 0 ; i < nItems ; i++)
+            pool->submit(method, params[i]);
+        return pool->run(collectResult, &results);
+    }
+
     //-------------------------------------------------------------------------
     bool getObjectViaRPC(CBaseNode &node, const SFString& method, const SFString& params) {
-        SFString ret = callRPC(method, params, false);
-        node.parseJson((char *)(const char*)ret);
+        // Parse the node's reply straight into the object rather than pulling out the result
+        // as a string and parsing that a second time
+        SFString ret = callRPC(method, params, true);
+        CJsonTape tape;
+        if (tape.tokenize(ret)) {
+            node.parseTape(tape, tape.findMember(0, "result"));
+        }
         return true;
     }
 
@@ -230,7 +557,7 @@ namespace qblocks {
             // This is the hack trace (there are many), so skip it
             cerr << "Curl response contains '5b5b5b5b5b5b5b5b5b5b5b5b5b5b5b'. Aborting.\n";
             cerr.flush();
-            getCurlContext()->earlyAbort = true;
+            data->earlyAbort = true;
             return 0;
         }
 
@@ -250,8 +577,8 @@ namespace qblocks {
         data->result = "ok";
         if (strstr(ptr,"erro")!=NULL) {
             data->result = "error";
-            getCurlContext()->is_error = true;
-            getCurlContext()->earlyAbort = true;
+            data->is_error = true;
+            data->earlyAbort = true;
             return 0;
         }
 
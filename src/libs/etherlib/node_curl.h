@@ -11,6 +11,7 @@
  * General Public License for more details. You should have received a copy of the GNU General
  * Public License along with this program. If not, see http://www.gnu.org/licenses/.
  *-------------------------------------------------------------------------------------------*/
+#include <mutex>
 #include "etherlib.h"
 
 namespace qblocks {
@@ -29,12 +30,58 @@ namespace qblocks {
         SFString         provider;
         bool             is_error;
         uint32_t         theID;
+        uint32_t         maxBatch;
+        uint32_t         maxConnections;
+        CURL            *handle;
 
         CCurlContext(void);
         SFString getCurlID(void);
         void setPostData(const SFString& method, const SFString& params);
+        void setPostData(const SFString& method, const SFStringArray& params, uint32_t first, uint32_t cnt);
         void Clear(void);
         CURLCALLBACKFUNC setCurlCallback(CURLCALLBACKFUNC func);
+
+    private:
+        void applyPostData(void);
+    };
+
+    //-------------------------------------------------------------------------
+    // Called once for each completed request in the order they complete (not the order they were
+    // submitted). 'id' is the value returned from CRPCPool::submit. Return false to cancel any
+    // requests that have not yet been sent.
+    typedef bool (*RPCRESULTFUNC)(uint32_t id, const SFString& result, void *data);
+
+    //-------------------------------------------------------------------------
+    // A pool of keep-alive connections to the node driven by curl's multi interface. Callers
+    // submit any number of requests and then run the pool, which keeps up to 'maxConnections'
+    // of them in flight at once. callRPC is a single request sent through the same pool.
+    class CRPCPool {
+    public:
+        CRPCPool(void);
+        ~CRPCPool(void);
+
+        CURLcode perform(CURL *curl);
+        uint32_t submit(const SFString& method, const SFString& params);
+        bool     run(RPCRESULTFUNC func, void *data);
+        void     Clear(void);
+
+    private:
+        CURLM             *m_multi;
+        CURLM             *m_single;
+        struct curl_slist *m_headers;
+        CCurlContext      *m_slots;
+        uint32_t          *m_which;
+        uint32_t           m_nSlots;
+        SFStringArray      m_methods;
+        SFStringArray      m_params;
+        SFUintArray        m_queue;
+        uint32_t           m_nextInQueue;
+
+        void initSlots(void);
+        bool startNext(uint32_t slot);
+
+        CRPCPool(const CRPCPool& pool);
+        CRPCPool& operator=(const CRPCPool& pool);
     };
 
     extern CURL         *getCurl         (bool cleanup=false);
@@ -42,7 +89,11 @@ namespace qblocks {
     extern bool          nodeHasBalances (void);
     extern bool          getObjectViaRPC (CBaseNode &node, const SFString& method, const SFString& params);
     extern SFString      callRPC         (const SFString& method, const SFString& params, bool raw);
+    extern bool          callRPCBatch    (const SFString& method, const SFStringArray& params, SFStringArray& results);
+    extern bool          callRPCMany     (const SFString& method, const SFStringArray& params, SFStringArray& results);
+    extern CRPCPool     *getRPCPool      (bool cleanup=false);
     extern CCurlContext *getCurlContext  (void);
+    extern std::recursive_mutex& getRPCLock(void);
     extern size_t        writeCallback   (char *ptr, size_t size, size_t nmemb, void *userdata);
     extern size_t        traceCallback   (char *ptr, size_t size, size_t nmemb, void *userdata);
 }  // namespace qblocks
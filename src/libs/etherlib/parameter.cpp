@@ -25,6 +25,25 @@ IMPLEMENT_NODE(CParameter, CBaseNode);
 static SFString nextParameterChunk(const SFString& fieldIn, const void *dataPtr);
 static SFString nextParameterChunk_custom(const SFString& fieldIn, const void *dataPtr);
 
+//---------------------------------------------------------------------------
+// makeClass chose the seed so that no two of these names share a slot in the table
+enum {
+    FLD_INDEXED = 1,
+    FLD_NAME,
+    FLD_TYPE,
+    FLD_ISPOINTER,
+    FLD_ISARRAY,
+    FLD_ISOBJECT,
+    FLD_STRDEFAULT,
+};
+static const char *parameterFieldNames[] = {
+    "indexed", "name", "type", "isPointer", "isArray", "isObject", "strDefault",
+};
+static const uint8_t parameterFieldSlots[] = {
+    0, 0, 0, 0, 0, 5, 2, 6, 7, 1, 3, 0, 0, 0, 0, 4,
+};
+static const CFieldTable parameterFieldTable(parameterFieldNames, 7, parameterFieldSlots, 16, 3);
+
 //---------------------------------------------------------------------------
 void CParameter::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr) const {
     if (!m_showing)
@@ -35,12 +54,10 @@ void CParameter::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPt
         return;
     }
 
-    SFString fmt = fmtIn;
-    if (handleCustomFormat(ctx, fmt, dataPtr))
+    if (handleCustomFormat(ctx, fmtIn, dataPtr))
         return;
 
-    while (!fmt.empty())
-        ctx << getNextChunk(fmt, nextParameterChunk, this);
+    formatChunks(ctx, fmtIn, nextParameterChunk, this);
 }
 
 //---------------------------------------------------------------------------
@@ -59,22 +76,14 @@ bool CParameter::setValueByName(const SFString& fieldName, const SFString& field
     // EXISTING_CODE
     // EXISTING_CODE
 
-    switch (tolower(fieldName[0])) {
-        case 'i':
-            if ( fieldName % "indexed" ) { indexed = toBool(fieldValue); return true; }
-            if ( fieldName % "isPointer" ) { isPointer = toBool(fieldValue); return true; }
-            if ( fieldName % "isArray" ) { isArray = toBool(fieldValue); return true; }
-            if ( fieldName % "isObject" ) { isObject = toBool(fieldValue); return true; }
-            break;
-        case 'n':
-            if ( fieldName % "name" ) { name = fieldValue; return true; }
-            break;
-        case 's':
-            if ( fieldName % "strDefault" ) { strDefault = fieldValue; return true; }
-            break;
-        case 't':
-            if ( fieldName % "type" ) { type = fieldValue; return true; }
-            break;
+    switch (parameterFieldTable.find(fieldName)) {
+        case FLD_INDEXED: indexed = toBool(fieldValue); return true;
+        case FLD_NAME: name = fieldValue; return true;
+        case FLD_TYPE: type = fieldValue; return true;
+        case FLD_ISPOINTER: isPointer = toBool(fieldValue); return true;
+        case FLD_ISARRAY: isArray = toBool(fieldValue); return true;
+        case FLD_ISOBJECT: isObject = toBool(fieldValue); return true;
+        case FLD_STRDEFAULT: strDefault = fieldValue; return true;
         default:
             break;
     }
@@ -203,21 +212,15 @@ SFString CParameter::getValueByName(const SFString& fieldName) const {
         return ret;
 
     // Return field values
-    switch (tolower(fieldName[0])) {
-        case 'i':
-            if ( fieldName % "indexed" ) return asString(indexed);
-            if ( fieldName % "isPointer" ) return asString(isPointer);
-            if ( fieldName % "isArray" ) return asString(isArray);
-            if ( fieldName % "isObject" ) return asString(isObject);
-            break;
-        case 'n':
-            if ( fieldName % "name" ) return name;
-            break;
-        case 's':
-            if ( fieldName % "strDefault" ) return strDefault;
-            break;
-        case 't':
-            if ( fieldName % "type" ) return type;
+    switch (parameterFieldTable.find(fieldName)) {
+        case FLD_INDEXED: return asString(indexed);
+        case FLD_NAME: return name;
+        case FLD_TYPE: return type;
+        case FLD_ISPOINTER: return asString(isPointer);
+        case FLD_ISARRAY: return asString(isArray);
+        case FLD_ISOBJECT: return asString(isObject);
+        case FLD_STRDEFAULT: return strDefault;
+        default:
             break;
     }
 
@@ -27,6 +27,20 @@ IMPLEMENT_NODE(CPriceQuote, CBaseNode);
 static SFString nextPricequoteChunk(const SFString& fieldIn, const void *dataPtr);
 static SFString nextPricequoteChunk_custom(const SFString& fieldIn, const void *dataPtr);
 
+//---------------------------------------------------------------------------
+// makeClass chose the seed so that no two of these names share a slot in the table
+enum {
+    FLD_TIMESTAMP = 1,
+    FLD_CLOSE,
+};
+static const char *pricequoteFieldNames[] = {
+    "timestamp", "close",
+};
+static const uint8_t pricequoteFieldSlots[] = {
+    1, 2, 0, 0,
+};
+static const CFieldTable pricequoteFieldTable(pricequoteFieldNames, 2, pricequoteFieldSlots, 4, 0);
+
 //---------------------------------------------------------------------------
 void CPriceQuote::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr) const {
     if (!m_showing)
@@ -37,12 +51,10 @@ void CPriceQuote::Format(CExportContext& ctx, const SFString& fmtIn, void *dataP
         return;
     }
 
-    SFString fmt = fmtIn;
-    if (handleCustomFormat(ctx, fmt, dataPtr))
+    if (handleCustomFormat(ctx, fmtIn, dataPtr))
         return;
 
-    while (!fmt.empty())
-        ctx << getNextChunk(fmt, nextPricequoteChunk, this);
+    formatChunks(ctx, fmtIn, nextPricequoteChunk, this);
 }
 
 //---------------------------------------------------------------------------
@@ -66,13 +78,9 @@ bool CPriceQuote::setValueByName(const SFString& fieldName, const SFString& fiel
     }
     // EXISTING_CODE
 
-    switch (tolower(fieldName[0])) {
-        case 'c':
-            if ( fieldName % "close" ) { close = toDouble(fieldValue); return true; }
-            break;
-        case 't':
-            if ( fieldName % "timestamp" ) { timestamp = toTimestamp(fieldValue); return true; }
-            break;
+    switch (pricequoteFieldTable.find(fieldName)) {
+        case FLD_TIMESTAMP: timestamp = toTimestamp(fieldValue); return true;
+        case FLD_CLOSE: close = toDouble(fieldValue); return true;
         default:
             break;
     }
@@ -211,12 +219,10 @@ SFString CPriceQuote::getValueByName(const SFString& fieldName) const {
         return ret;
 
     // Return field values
-    switch (tolower(fieldName[0])) {
-        case 'c':
-            if ( fieldName % "close" ) return fmtFloat(close);
-            break;
-        case 't':
-            if ( fieldName % "timestamp" ) return fromTimestamp(timestamp);
+    switch (pricequoteFieldTable.find(fieldName)) {
+        case FLD_TIMESTAMP: return fromTimestamp(timestamp);
+        case FLD_CLOSE: return fmtFloat(close);
+        default:
             break;
     }
 
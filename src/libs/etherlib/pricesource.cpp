@@ -126,8 +126,8 @@ namespace qblocks {
                 //            if (verbose > 1)
                 //                cerr << "JSON: " << response << "\n";
 
-                // And grow the array so we don't have to allocate for each new record
-                quotes.Grow(nRecords+10);
+                // And make room for the new records (on top of the ones we already have)
+                quotes.reserve(quotes.getCount() + nRecords);
 
                 // Parse the response and populate the array
                 char *p = cleanUpJson((char *)(const char*)response);  // NOLINT
@@ -26,6 +26,23 @@ IMPLEMENT_NODE(CReceipt, CBaseNode);
 extern SFString nextReceiptChunk(const SFString& fieldIn, const void *dataPtr);
 static SFString nextReceiptChunk_custom(const SFString& fieldIn, const void *dataPtr);
 
+//---------------------------------------------------------------------------
+// makeClass chose the seed so that no two of these names share a slot in the table
+enum {
+    FLD_CONTRACTADDRESS = 1,
+    FLD_GASUSED,
+    FLD_LOGS,
+    FLD_STATUS,
+    FLD_LOGSCNT,
+};
+static const char *receiptFieldNames[] = {
+    "contractAddress", "gasUsed", "logs", "status", "logsCnt",
+};
+static const uint8_t receiptFieldSlots[] = {
+    3, 0, 0, 0, 5, 4, 0, 0, 0, 0, 0, 1, 0, 0, 2, 0,
+};
+static const CFieldTable receiptFieldTable(receiptFieldNames, 5, receiptFieldSlots, 16, 2);
+
 //---------------------------------------------------------------------------
 void CReceipt::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr) const {
     if (!m_showing)
@@ -36,12 +53,10 @@ void CReceipt::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr)
         return;
     }
 
-    SFString fmt = fmtIn;
-    if (handleCustomFormat(ctx, fmt, dataPtr))
+    if (handleCustomFormat(ctx, fmtIn, dataPtr))
         return;
 
-    while (!fmt.empty())
-        ctx << getNextChunk(fmt, nextReceiptChunk, this);
+    formatChunks(ctx, fmtIn, nextReceiptChunk, this);
 }
 
 //---------------------------------------------------------------------------
@@ -69,35 +84,55 @@ bool CReceipt::setValueByName(const SFString& fieldName, const SFString& fieldVa
             return true;
     // EXISTING_CODE
 
-    switch (tolower(fieldName[0])) {
-        case 'c':
-            if ( fieldName % "contractAddress" ) { contractAddress = toAddress(fieldValue); return true; }
-            break;
-        case 'g':
-            if ( fieldName % "gasUsed" ) { gasUsed = toGas(fieldValue); return true; }
-            break;
-        case 'l':
-            if ( fieldName % "logs" ) {
-                char *p = (char *)fieldValue.c_str();
-                while (p && *p) {
-                    CLogEntry item;
-                    uint32_t nFields = 0;
-                    p = item.parseJson(p, nFields);
-                    if (nFields)
-                        logs[logs.getCount()] = item;
-                }
-                return true;
+    switch (receiptFieldTable.find(fieldName)) {
+        case FLD_CONTRACTADDRESS: contractAddress = toAddress(fieldValue); return true;
+        case FLD_GASUSED: gasUsed = toGas(fieldValue); return true;
+        case FLD_LOGS: {
+            char *p = (char *)fieldValue.c_str();
+            while (p && *p) {
+                CLogEntry item;
+                uint32_t nFields = 0;
+                p = item.parseJson(p, nFields);
+                if (nFields)
+                    logs[logs.getCount()] = item;
             }
-            break;
-        case 's':
-            if ( fieldName % "status" ) { status = newUnsigned32(fieldValue); return true; }
-            break;
+            return true;
+        }
+        case FLD_STATUS: status = newUnsigned32(fieldValue); return true;
         default:
             break;
     }
     return false;
 }
 
+//---------------------------------------------------------------------------------------------------
+bool CReceipt::parseTape(CJsonTape& tape, uint32_t node) {
+    if (!tape.isObject(node))
+        return false;
+
+    // Objects are parsed in place from the tape. Anything else goes to setValueByName
+    for (uint32_t key = tape.firstMember(node) ; key != JSON_NOTOKEN ; key = tape.nextMember(node, key)) {
+        uint32_t val = key + 1;
+        string_view_q name = tape.getView(key);
+        switch (receiptFieldTable.find(name.data(), name.length())) {
+            case FLD_LOGS:
+                if (tape.isArrayOf(val, JSON_OBJECT)) {
+                    for (uint32_t item = tape.firstItem(val) ; item != JSON_NOTOKEN ; item = tape.nextItem(val, item)) {
+                        if (tape.firstMember(item) != JSON_NOTOKEN)
+                            logs[logs.getCount()].parseTape(tape, item);
+                    }
+                    continue;
+                }
+                break;
+            default:
+                break;
+        }
+        setValueFromTape(tape, key);
+    }
+    finishParse();
+    return true;
+}
+
 //---------------------------------------------------------------------------------------------------
 void CReceipt::finishParse() {
     // EXISTING_CODE
@@ -260,29 +295,22 @@ SFString CReceipt::getValueByName(const SFString& fieldName) const {
         return ret;
 
     // Return field values
-    switch (tolower(fieldName[0])) {
-        case 'c':
-            if ( fieldName % "contractAddress" ) return fromAddress(contractAddress);
-            break;
-        case 'g':
-            if ( fieldName % "gasUsed" ) return fromGas(gasUsed);
-            break;
-        case 'l':
-            if ( fieldName % "logs" || fieldName % "logsCnt" ) {
-                uint32_t cnt = logs.getCount();
-                if (fieldName.endsWith("Cnt"))
-                    return asStringU(cnt);
-                if (!cnt) return "";
-                SFString retS;
-                for (uint32_t i = 0 ; i < cnt ; i++) {
-                    retS += logs[i].Format();
-                    retS += ((i < cnt - 1) ? ",\n" : "\n");
-                }
-                return retS;
+    switch (receiptFieldTable.find(fieldName)) {
+        case FLD_CONTRACTADDRESS: return fromAddress(contractAddress);
+        case FLD_GASUSED: return fromGas(gasUsed);
+        case FLD_LOGS: {
+            uint32_t cnt = logs.getCount();
+            if (!cnt) return "";
+            SFString retS;
+            for (uint32_t i = 0 ; i < cnt ; i++) {
+                retS += logs[i].Format();
+                retS += ((i < cnt - 1) ? ",\n" : "\n");
             }
-            break;
-        case 's':
-            if ( fieldName % "status" ) return asStringU(status);
+            return retS;
+        }
+        case FLD_LOGSCNT: return asStringU(logs.getCount());
+        case FLD_STATUS: return asStringU(status);
+        default:
             break;
     }
 
@@ -34,7 +34,7 @@ class CTransaction;
 //--------------------------------------------------------------------------
 class CReceipt : public CBaseNode {
 public:
-    SFAddress contractAddress;
+    CAddressField contractAddress;
     SFGas gasUsed;
     CLogEntryArray logs;
     uint32_t status;
@@ -47,6 +47,7 @@ public:
 
     DECLARE_NODE(CReceipt);
 
+    bool parseTape(CJsonTape& tape, uint32_t node) override;
     const CBaseNode *getObjectAt(const SFString& fieldName, uint32_t index) const override;
 
     // EXISTING_CODE
@@ -111,7 +112,7 @@ inline void CReceipt::Clear(void) {
 inline void CReceipt::Init(void) {
     CBaseNode::Init();
 
-    contractAddress = "";
+    contractAddress.setEmpty();
     gasUsed = 0;
     logs.Clear();
     status = NO_STATUS;
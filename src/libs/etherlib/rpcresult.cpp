@@ -26,6 +26,21 @@ IMPLEMENT_NODE(CRPCResult, CBaseNode);
 static SFString nextRpcresultChunk(const SFString& fieldIn, const void *dataPtr);
 static SFString nextRpcresultChunk_custom(const SFString& fieldIn, const void *dataPtr);
 
+//---------------------------------------------------------------------------
+// makeClass chose the seed so that no two of these names share a slot in the table
+enum {
+    FLD_JSONRPC = 1,
+    FLD_RESULT,
+    FLD_ID,
+};
+static const char *rpcresultFieldNames[] = {
+    "jsonrpc", "result", "id",
+};
+static const uint8_t rpcresultFieldSlots[] = {
+    0, 0, 0, 0, 1, 3, 0, 2,
+};
+static const CFieldTable rpcresultFieldTable(rpcresultFieldNames, 3, rpcresultFieldSlots, 8, 0);
+
 //---------------------------------------------------------------------------
 void CRPCResult::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr) const {
     if (!m_showing)
@@ -36,12 +51,10 @@ void CRPCResult::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPt
         return;
     }
 
-    SFString fmt = fmtIn;
-    if (handleCustomFormat(ctx, fmt, dataPtr))
+    if (handleCustomFormat(ctx, fmtIn, dataPtr))
         return;
 
-    while (!fmt.empty())
-        ctx << getNextChunk(fmt, nextRpcresultChunk, this);
+    formatChunks(ctx, fmtIn, nextRpcresultChunk, this);
 }
 
 //---------------------------------------------------------------------------
@@ -60,16 +73,10 @@ bool CRPCResult::setValueByName(const SFString& fieldName, const SFString& field
     // EXISTING_CODE
     // EXISTING_CODE
 
-    switch (tolower(fieldName[0])) {
-        case 'i':
-            if ( fieldName % "id" ) { id = fieldValue; return true; }
-            break;
-        case 'j':
-            if ( fieldName % "jsonrpc" ) { jsonrpc = fieldValue; return true; }
-            break;
-        case 'r':
-            if ( fieldName % "result" ) { result = fieldValue; return true; }
-            break;
+    switch (rpcresultFieldTable.find(fieldName)) {
+        case FLD_JSONRPC: jsonrpc = fieldValue; return true;
+        case FLD_RESULT: result = fieldValue; return true;
+        case FLD_ID: id = fieldValue; return true;
         default:
             break;
     }
@@ -186,15 +193,11 @@ SFString CRPCResult::getValueByName(const SFString& fieldName) const {
         return ret;
 
     // Return field values
-    switch (tolower(fieldName[0])) {
-        case 'i':
-            if ( fieldName % "id" ) return id;
-            break;
-        case 'j':
-            if ( fieldName % "jsonrpc" ) return jsonrpc;
-            break;
-        case 'r':
-            if ( fieldName % "result" ) return result;
+    switch (rpcresultFieldTable.find(fieldName)) {
+        case FLD_JSONRPC: return jsonrpc;
+        case FLD_RESULT: return result;
+        case FLD_ID: return id;
+        default:
             break;
     }
 
@@ -0,0 +1,325 @@
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include <algorithm>
+#include <vector>
+#include "timestampindex.h"
+
+namespace qblocks {
+
+    static_assert(sizeof(CTimestampIndexHeader) == 32, "timestamp index header must be 32 bytes");
+
+    //-------------------------------------------------------------------------
+    static bool isValidHeader(const CTimestampIndexHeader *header, uint64_t fileSize) {
+        if (fileSize < sizeof(CTimestampIndexHeader))
+            return false;
+        if (memcmp(header->magic, TIMESTAMP_INDEX_MAGIC, sizeof(header->magic)))
+            return false;
+        if (header->version != TIMESTAMP_INDEX_VERSION)
+            return false;
+        return (sizeof(CTimestampIndexHeader) + header->nBlocks * sizeof(uint32_t) <= fileSize);
+    }
+
+    //-------------------------------------------------------------------------
+    CTimestampIndex::CTimestampIndex(void) : m_file(NULL), m_header(NULL), m_offsets(NULL) {
+    }
+
+    //-------------------------------------------------------------------------
+    CTimestampIndex::~CTimestampIndex(void) {
+        close();
+    }
+
+    //-------------------------------------------------------------------------
+    bool CTimestampIndex::open(const SFString& fileName) {
+        close();
+        if (!fileExists(fileName))
+            return false;
+
+        m_file = new CMemMapFile(fileName.c_str(), CMemMapFile::WholeFile, CMemMapFile::RandomAccess);
+        if (!m_file->isValid()) {
+            close();
+            return false;
+        }
+
+        const unsigned char *data = m_file->getData();
+        const CTimestampIndexHeader *header = (const CTimestampIndexHeader *)data;
+        if (!isValidHeader(header, m_file->size())) {
+            cerr << "The timestamp index at " << fileName << " is corrupted or from a different version. Ignoring it.\n";
+            close();
+            return false;
+        }
+
+        m_header  = header;
+        m_offsets = (const uint32_t *)(data + sizeof(CTimestampIndexHeader));
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    void CTimestampIndex::close(void) {
+        if (m_file)
+            delete m_file;
+        m_file    = NULL;
+        m_header  = NULL;
+        m_offsets = NULL;
+    }
+
+    //-------------------------------------------------------------------------
+    // Returns the first position in [lo, hi) whose offset is greater than 'offset' (or hi if there
+    // is none). Each round makes one interpolated guess, and if that doesn't at least halve the
+    // range (which only happens where block times are very uneven) it also bisects, so the worst
+    // case is no worse than a binary search.
+    uint64_t CTimestampIndex::upperBound(uint64_t offset, uint64_t lo, uint64_t hi) const {
+        while (hi - lo > 8) {
+            uint64_t vLo = m_offsets[lo];
+            uint64_t vHi = m_offsets[hi - 1];
+            if (offset < vLo)
+                return lo;
+            if (offset >= vHi)
+                return hi;
+
+            uint64_t width = hi - lo;
+            uint64_t guess = lo + (offset - vLo) * (hi - 1 - lo) / (vHi - vLo);
+            if (m_offsets[guess] <= offset)
+                lo = guess + 1;
+            else
+                hi = guess;
+
+            if ((hi - lo) * 2 > width) {
+                uint64_t mid = lo + (hi - lo) / 2;
+                if (m_offsets[mid] <= offset)
+                    lo = mid + 1;
+                else
+                    hi = mid;
+            }
+        }
+        return (uint64_t)(std::upper_bound(m_offsets + lo, m_offsets + hi, offset) - m_offsets);
+    }
+
+    //-------------------------------------------------------------------------
+    // 'upper' is the first block after the timestamp
+    void CTimestampIndex::setBounds(CBlockBounds& bounds, uint64_t upper) const {
+        bounds.floor = (upper > 0 ? upper - 1 : NOPOS);
+        if (bounds.floor != NOPOS && timestampAt(bounds.floor) == bounds.ts)
+            bounds.ceil = bounds.floor;
+        else
+            bounds.ceil = (upper < nBlocks() ? upper : NOPOS);
+    }
+
+    //-------------------------------------------------------------------------
+    // Returns true if the timestamp falls within the index (i.e. both 'floor' and 'ceil' are found)
+    bool CTimestampIndex::findBlock(timestamp_t ts, blknum_t& floor, blknum_t& ceil) const {
+        CBlockBounds bounds(ts);
+        if (nBlocks()) {
+            if (ts < m_header->baseTimestamp)
+                setBounds(bounds, 0);
+            else if (ts - m_header->baseTimestamp > UINT32_MAX)
+                setBounds(bounds, nBlocks());
+            else
+                setBounds(bounds, upperBound((uint64_t)(ts - m_header->baseTimestamp), 0, nBlocks()));
+        }
+        floor = bounds.floor;
+        ceil  = bounds.ceil;
+        return (floor != NOPOS && ceil != NOPOS);
+    }
+
+    //-------------------------------------------------------------------------
+    // Resolves every query in one pass over the index. The queries are visited in timestamp order
+    // and each search starts where the previous one ended, galloping forward to find a small range
+    // to search, so a large batch costs much less than the same number of separate lookups. The
+    // queries are left in their original order.
+    void CTimestampIndex::findBlocks(CBlockBoundsArray& queries) const {
+        std::vector<uint32_t> order(queries.getCount());
+        for (uint32_t i = 0 ; i < queries.getCount() ; i++)
+            order[i] = i;
+        std::sort(order.begin(), order.end(),
+                  [&queries](uint32_t a, uint32_t b) { return queries[a].ts < queries[b].ts; });
+
+        uint64_t n = nBlocks();
+        uint64_t cursor = 0;
+        for (size_t i = 0 ; i < order.size() ; i++) {
+            CBlockBounds& bounds = queries[order[i]];
+            bounds.floor = bounds.ceil = NOPOS;
+            if (!n)
+                continue;
+
+            if (bounds.ts < m_header->baseTimestamp) {
+                setBounds(bounds, 0);
+                continue;
+            }
+            if (bounds.ts - m_header->baseTimestamp > UINT32_MAX) {
+                setBounds(bounds, n);
+                continue;
+            }
+
+            uint64_t offset = (uint64_t)(bounds.ts - m_header->baseTimestamp);
+            uint64_t lo = cursor, step = 1;
+            while (lo + step < n && m_offsets[lo + step - 1] <= offset) {
+                lo += step;
+                step *= 2;
+            }
+            cursor = upperBound(offset, lo, min(n, lo + step));
+            setBounds(bounds, cursor);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    CTimestampIndexWriter::CTimestampIndexWriter(void) : m_archive(NULL), m_lastOffset(0) {
+        memset(&m_header, 0, sizeof(m_header));
+    }
+
+    //-------------------------------------------------------------------------
+    CTimestampIndexWriter::~CTimestampIndexWriter(void) {
+        close();
+    }
+
+    //-------------------------------------------------------------------------
+    bool CTimestampIndexWriter::open(const SFString& fileName) {
+        if (m_archive)
+            return false;
+
+        memset(&m_header, 0, sizeof(m_header));
+        memcpy(m_header.magic, TIMESTAMP_INDEX_MAGIC, sizeof(m_header.magic));
+        m_header.version = TIMESTAMP_INDEX_VERSION;
+        m_lastOffset = 0;
+
+        bool exists = fileExists(fileName) && fileSize(fileName) > 0;
+        if (!exists && !establishFolder(fileName))
+            return false;
+
+        m_archive = new SFArchive(WRITING_ARCHIVE);
+        if (!m_archive->Lock(fileName, exists ? binaryReadWrite : binaryWriteCreate, LOCK_WAIT)) {
+            cerr << "Could not open the timestamp index " << fileName << ": " << m_archive->LockFailure() << "\n";
+            delete m_archive;
+            m_archive = NULL;
+            return false;
+        }
+
+        if (exists) {
+            CTimestampIndexHeader header;
+            memset(&header, 0, sizeof(header));
+            m_archive->Read(&header, sizeof(header), 1);
+            if (!isValidHeader(&header, fileSize(fileName))) {
+                cerr << "The timestamp index at " << fileName << " is corrupted or from a different version. "
+                        "Remove it and rebuild.\n";
+                m_archive->Release();
+                delete m_archive;
+                m_archive = NULL;
+                return false;
+            }
+            m_header = header;
+            if (m_header.nBlocks) {
+                m_archive->Seek((long)(sizeof(CTimestampIndexHeader) + (m_header.nBlocks - 1) * sizeof(uint32_t)), SEEK_SET);
+                m_archive->Read(&m_lastOffset, sizeof(m_lastOffset), 1);
+            }
+        } else {
+            m_archive->Write(&m_header, sizeof(m_header), 1);
+        }
+
+        // Anything past the last block in the header was never finished, so we write over it
+        m_archive->Seek((long)(sizeof(CTimestampIndexHeader) + m_header.nBlocks * sizeof(uint32_t)), SEEK_SET);
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    bool CTimestampIndexWriter::append(blknum_t bn, timestamp_t ts) {
+        if (!m_archive || bn != m_header.nBlocks)
+            return false;
+
+        if (!m_header.nBlocks)
+            m_header.baseTimestamp = ts;
+
+        uint32_t offset = m_lastOffset;
+        if (ts > m_header.baseTimestamp + m_lastOffset) {
+            if (ts - m_header.baseTimestamp > UINT32_MAX)
+                return false;
+            offset = (uint32_t)(ts - m_header.baseTimestamp);
+        }
+
+        m_archive->Write(&offset, sizeof(offset), 1);
+        m_lastOffset = offset;
+        m_header.nBlocks++;
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    bool CTimestampIndexWriter::appendThrough(blknum_t bn, timestamp_t ts) {
+        if (!m_archive || bn < m_header.nBlocks)
+            return false;
+        while (m_header.nBlocks < bn)
+            if (!append(m_header.nBlocks, ts))
+                return false;
+        return append(bn, ts);
+    }
+
+    //-------------------------------------------------------------------------
+    bool CTimestampIndexWriter::close(void) {
+        if (!m_archive)
+            return false;
+
+        // The header goes last so a reader never sees blocks that are not there yet
+        m_archive->Seek(0, SEEK_SET);
+        m_archive->Write(&m_header, sizeof(m_header), 1);
+        m_archive->Release();
+        delete m_archive;
+        m_archive = NULL;
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    bool updateTimestampIndex(uint64_t& nAdded) {
+        nAdded = 0;
+        CInMemoryCache *cache = getTheCache();
+        if (!cache->Load()) {
+            cerr << "Could not open the mini-block database: " << miniBlockCache << "\n";
+            return false;
+        }
+
+        CTimestampIndexWriter writer;
+        if (!writer.open(timestampIndex))
+            return false;
+
+        uint64_t start = writer.nBlocks();
+        for (uint64_t i = cache->findBlock(writer.nBlocks()) ; i < cache->blocks.size() ; i++) {
+            const CMiniBlock& block = cache->blocks[i];
+            if (block.blockNumber < writer.nBlocks())
+                continue;
+            if (!writer.appendThrough(block.blockNumber, block.timestamp))
+                break;
+            if (!(i % 10000) && !isTestMode())
+                cerr << "\tindexed timestamps through block " << block.blockNumber << "\r";
+        }
+        nAdded = writer.nBlocks() - start;
+
+        // Readers holding the old mapping don't see the new blocks, so have them re-open it
+        writer.close();
+        getTimestampIndex(true);
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    CTimestampIndex *getTimestampIndex(bool cleanup) {
+        static CTimestampIndex *theIndex = NULL;
+        if (cleanup) {
+            if (theIndex)
+                delete theIndex;
+            theIndex = NULL;
+            return NULL;
+        }
+
+        if (!theIndex) {
+            theIndex = new CTimestampIndex;
+            theIndex->open(timestampIndex);
+        }
+        return theIndex;
+    }
+
+}  // namespace qblocks
@@ -0,0 +1,120 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include "etherlib.h"
+
+namespace qblocks {
+
+    //-------------------------------------------------------------------------
+    // The timestamp index holds one entry for every block starting at block zero:
+    //
+    //      header | offset 0 | offset 1 | ... | offset n-1
+    //
+    // Each offset is a uint32 holding the block's timestamp less the header's base timestamp
+    // (the timestamp of block zero). Offsets never decrease, so the file is a sorted array that
+    // can be searched in place. Blocks are only ever appended.
+    //-------------------------------------------------------------------------
+    #define TIMESTAMP_INDEX_MAGIC   "qbStamps"
+    #define TIMESTAMP_INDEX_VERSION 1
+
+    //-------------------------------------------------------------------------
+    struct CTimestampIndexHeader {
+        char     magic[8];
+        uint32_t version;
+        uint32_t unused;
+        int64_t  baseTimestamp;
+        uint64_t nBlocks;
+    };
+
+    //-------------------------------------------------------------------------
+    // The result of looking up a timestamp. 'floor' is the last block at or before the timestamp
+    // and 'ceil' is the first block at or after it (they are the same block on an exact match).
+    // Either may be NOPOS if the timestamp is before the first block or after the last indexed one.
+    struct CBlockBounds {
+        timestamp_t ts;
+        blknum_t    floor;
+        blknum_t    ceil;
+        CBlockBounds(void) : ts(0), floor(NOPOS), ceil(NOPOS) { }
+        explicit CBlockBounds(timestamp_t t) : ts(t), floor(NOPOS), ceil(NOPOS) { }
+    };
+    typedef SFArrayBase<CBlockBounds> CBlockBoundsArray;
+
+    //-------------------------------------------------------------------------
+    // Read-only view of the timestamp index. The file is memory mapped and searched in place with
+    // an interpolation search. Block times are close to evenly spaced, so a lookup usually takes
+    // two or three probes no matter how large the index is.
+    class CTimestampIndex {
+    public:
+        CTimestampIndex(void);
+        ~CTimestampIndex(void);
+
+        bool open (const SFString& fileName);
+        void close(void);
+
+        bool        isValid    (void) const { return m_header != NULL; }
+        uint64_t    nBlocks    (void) const { return (m_header ? m_header->nBlocks : 0); }
+        timestamp_t timestampAt(blknum_t bn) const { return m_header->baseTimestamp + m_offsets[bn]; }
+
+        bool findBlock (timestamp_t ts, blknum_t& floor, blknum_t& ceil) const;
+        void findBlocks(CBlockBoundsArray& queries) const;
+
+    private:
+        CMemMapFile                 *m_file;
+        const CTimestampIndexHeader *m_header;
+        const uint32_t              *m_offsets;
+
+        uint64_t upperBound(uint64_t offset, uint64_t lo, uint64_t hi) const;
+        void     setBounds (CBlockBounds& bounds, uint64_t upper) const;
+
+        CTimestampIndex(const CTimestampIndex&);
+        CTimestampIndex& operator=(const CTimestampIndex&);
+    };
+
+    //-------------------------------------------------------------------------
+    // Appends blocks to a timestamp index (creating it if needed). Blocks must be appended one
+    // after the other with no gaps. A timestamp earlier than the previous block's is stored as the
+    // previous block's so the index stays sorted. Readers see new blocks once close() is called.
+    //
+    // appendThrough fills any gap up to 'bn' with 'ts', the timestamp of the block after the gap,
+    // which is how blocks missing from the mini-block database (those without transactions) are
+    // indexed. Their real times are no later than that, so a lookup's floor is never a block
+    // from after the time asked for.
+    class CTimestampIndexWriter {
+    public:
+        CTimestampIndexWriter(void);
+        ~CTimestampIndexWriter(void);
+
+        bool open  (const SFString& fileName);
+        bool append       (blknum_t bn, timestamp_t ts);
+        bool appendThrough(blknum_t bn, timestamp_t ts);
+        bool close        (void);
+
+        uint64_t nBlocks(void) const { return m_header.nBlocks; }
+
+    private:
+        SFArchive            *m_archive;
+        CTimestampIndexHeader m_header;
+        uint32_t              m_lastOffset;
+
+        CTimestampIndexWriter(const CTimestampIndexWriter&);
+        CTimestampIndexWriter& operator=(const CTimestampIndexWriter&);
+    };
+
+    //-------------------------------------------------------------------------
+    // Extends the index from the mini-block database (see makeTimestampIndex). The node is never
+    // asked. Lookups are exact at the blocks in the database. An empty block, which isn't in it,
+    // is given the time of the next block with transactions.
+    extern bool updateTimestampIndex(uint64_t& nAdded);
+    extern CTimestampIndex *getTimestampIndex(bool cleanup=false);
+
+}  // namespace qblocks
@@ -25,6 +25,31 @@ IMPLEMENT_NODE(CTrace, CBaseNode);
 static SFString nextTraceChunk(const SFString& fieldIn, const void *dataPtr);
 static SFString nextTraceChunk_custom(const SFString& fieldIn, const void *dataPtr);
 
+//---------------------------------------------------------------------------
+// makeClass chose the seed so that no two of these names share a slot in the table
+enum {
+    FLD_BLOCKHASH = 1,
+    FLD_BLOCKNUMBER,
+    FLD_SUBTRACES,
+    FLD_TRACEADDRESS,
+    FLD_TRANSACTIONHASH,
+    FLD_TRANSACTIONPOSITION,
+    FLD_TYPE,
+    FLD_ERROR,
+    FLD_ACTION,
+    FLD_RESULT,
+    FLD_TRACEADDRESSCNT,
+};
+static const char *traceFieldNames[] = {
+    "blockHash", "blockNumber", "subtraces", "traceAddress", "transactionHash",
+    "transactionPosition", "type", "error", "action", "result", "traceAddressCnt",
+};
+static const uint8_t traceFieldSlots[] = {
+    0, 0, 0, 1, 0, 10, 0, 0, 0, 9, 0, 0, 0, 0, 0, 6,
+    0, 7, 0, 0, 0, 2, 0, 3, 0, 0, 8, 5, 0, 0, 11, 4,
+};
+static const CFieldTable traceFieldTable(traceFieldNames, 11, traceFieldSlots, 32, 9);
+
 //---------------------------------------------------------------------------
 void CTrace::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr) const {
     if (!m_showing)
@@ -35,12 +60,10 @@ void CTrace::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr) c
         return;
     }
 
-    SFString fmt = fmtIn;
-    if (handleCustomFormat(ctx, fmt, dataPtr))
+    if (handleCustomFormat(ctx, fmtIn, dataPtr))
         return;
 
-    while (!fmt.empty())
-        ctx << getNextChunk(fmt, nextTraceChunk, this);
+    formatChunks(ctx, fmtIn, nextTraceChunk, this);
 }
 
 //---------------------------------------------------------------------------
@@ -71,41 +94,60 @@ bool CTrace::setValueByName(const SFString& fieldName, const SFString& fieldValu
     }
     // EXISTING_CODE
 
-    switch (tolower(fieldName[0])) {
-        case 'a':
-            if ( fieldName % "action" ) { /* action = fieldValue; */ return false; }
-            break;
-        case 'b':
-            if ( fieldName % "blockHash" ) { blockHash = toHash(fieldValue); return true; }
-            if ( fieldName % "blockNumber" ) { blockNumber = toUnsigned(fieldValue); return true; }
-            break;
-        case 'e':
-            if ( fieldName % "error" ) { error = fieldValue; return true; }
-            break;
-        case 'r':
-            if ( fieldName % "result" ) { /* result = fieldValue; */ return false; }
-            break;
-        case 's':
-            if ( fieldName % "subtraces" ) { subtraces = toUnsigned(fieldValue); return true; }
-            break;
-        case 't':
-            if ( fieldName % "traceAddress" ) {
-                SFString str = fieldValue;
-                while (!str.empty()) {
-                    traceAddress[traceAddress.getCount()] = toAddress(nextTokenClear(str,','));
-                }
-                return true;
+    switch (traceFieldTable.find(fieldName)) {
+        case FLD_BLOCKHASH: blockHash = toHash(fieldValue); return true;
+        case FLD_BLOCKNUMBER: blockNumber = toUnsigned(fieldValue); return true;
+        case FLD_SUBTRACES: subtraces = toUnsigned(fieldValue); return true;
+        case FLD_TRACEADDRESS: {
+            SFString str = fieldValue;
+            while (!str.empty()) {
+                traceAddress[traceAddress.getCount()] = toAddress(nextTokenClear(str,','));
             }
-            if ( fieldName % "transactionHash" ) { transactionHash = toHash(fieldValue); return true; }
-            if ( fieldName % "transactionPosition" ) { transactionPosition = toUnsigned(fieldValue); return true; }
-            if ( fieldName % "type" ) { type = fieldValue; return true; }
-            break;
+            return true;
+        }
+        case FLD_TRANSACTIONHASH: transactionHash = toHash(fieldValue); return true;
+        case FLD_TRANSACTIONPOSITION: transactionPosition = toUnsigned(fieldValue); return true;
+        case FLD_TYPE: type = fieldValue; return true;
+        case FLD_ERROR: error = fieldValue; return true;
+        case FLD_ACTION: /* action = fieldValue; */ return false;
+        case FLD_RESULT: /* result = fieldValue; */ return false;
         default:
             break;
     }
     return false;
 }
 
+//---------------------------------------------------------------------------------------------------
+bool CTrace::parseTape(CJsonTape& tape, uint32_t node) {
+    if (!tape.isObject(node))
+        return false;
+
+    // Objects are parsed in place from the tape. Anything else goes to setValueByName
+    for (uint32_t key = tape.firstMember(node) ; key != JSON_NOTOKEN ; key = tape.nextMember(node, key)) {
+        uint32_t val = key + 1;
+        string_view_q name = tape.getView(key);
+        switch (traceFieldTable.find(name.data(), name.length())) {
+            case FLD_ACTION:
+                if (tape.isObject(val)) {
+                    action.parseTape(tape, val);
+                    continue;
+                }
+                break;
+            case FLD_RESULT:
+                if (tape.isObject(val)) {
+                    result.parseTape(tape, val);
+                    continue;
+                }
+                break;
+            default:
+                break;
+        }
+        setValueFromTape(tape, key);
+    }
+    finishParse();
+    return true;
+}
+
 //---------------------------------------------------------------------------------------------------
 void CTrace::finishParse() {
     // EXISTING_CODE
@@ -237,39 +279,28 @@ SFString CTrace::getValueByName(const SFString& fieldName) const {
         return ret;
 
     // Return field values
-    switch (tolower(fieldName[0])) {
-        case 'a':
-            if ( fieldName % "action" ) { expContext().noFrst=true; return action.Format(); }
-            break;
-        case 'b':
-            if ( fieldName % "blockHash" ) return fromHash(blockHash);
-            if ( fieldName % "blockNumber" ) return asStringU(blockNumber);
-            break;
-        case 'e':
-            if ( fieldName % "error" ) return error;
-            break;
-        case 'r':
-            if ( fieldName % "result" ) { expContext().noFrst=true; return result.Format(); }
-            break;
-        case 's':
-            if ( fieldName % "subtraces" ) return asStringU(subtraces);
-            break;
-        case 't':
-            if ( fieldName % "traceAddress" || fieldName % "traceAddressCnt" ) {
-                uint32_t cnt = traceAddress.getCount();
-                if (fieldName.endsWith("Cnt"))
-                    return asStringU(cnt);
-                if (!cnt) return "";
-                SFString retS;
-                for (uint32_t i = 0 ; i < cnt ; i++) {
-                    retS += ("\"" + traceAddress[i] + "\"");
-                    retS += ((i < cnt - 1) ? ",\n" + indent() : "\n");
-                }
-                return retS;
+    switch (traceFieldTable.find(fieldName)) {
+        case FLD_BLOCKHASH: return fromHash(blockHash);
+        case FLD_BLOCKNUMBER: return asStringU(blockNumber);
+        case FLD_SUBTRACES: return asStringU(subtraces);
+        case FLD_TRACEADDRESS: {
+            uint32_t cnt = traceAddress.getCount();
+            if (!cnt) return "";
+            SFString retS;
+            for (uint32_t i = 0 ; i < cnt ; i++) {
+                retS += ("\"" + traceAddress[i] + "\"");
+                retS += ((i < cnt - 1) ? ",\n" + indent() : "\n");
             }
-            if ( fieldName % "transactionHash" ) return fromHash(transactionHash);
-            if ( fieldName % "transactionPosition" ) return asStringU(transactionPosition);
-            if ( fieldName % "type" ) return type;
+            return retS;
+        }
+        case FLD_TRACEADDRESSCNT: return asStringU(traceAddress.getCount());
+        case FLD_TRANSACTIONHASH: return fromHash(transactionHash);
+        case FLD_TRANSACTIONPOSITION: return asStringU(transactionPosition);
+        case FLD_TYPE: return type;
+        case FLD_ERROR: return error;
+        case FLD_ACTION: expContext().noFrst=true; return action.Format();
+        case FLD_RESULT: expContext().noFrst=true; return result.Format();
+        default:
             break;
     }
 
@@ -43,11 +43,11 @@ typedef SFUniqueList<CTrace*>       CTraceListU;
 //--------------------------------------------------------------------------
 class CTrace : public CBaseNode {
 public:
-    SFHash blockHash;
+    CHashField blockHash;
     blknum_t blockNumber;
     uint64_t subtraces;
     SFAddressArray traceAddress;
-    SFHash transactionHash;
+    CHashField transactionHash;
     uint64_t transactionPosition;
     SFString type;
     SFString error;
@@ -62,6 +62,7 @@ public:
 
     DECLARE_NODE(CTrace);
 
+    bool parseTape(CJsonTape& tape, uint32_t node) override;
     const CBaseNode *getObjectAt(const SFString& fieldName, uint32_t index) const override;
     const SFString getStringAt(const SFString& name, uint32_t i) const override;
 
@@ -114,11 +115,11 @@ inline void CTrace::Clear(void) {
 inline void CTrace::Init(void) {
     CBaseNode::Init();
 
-    blockHash = "";
+    blockHash.setEmpty();
     blockNumber = 0;
     subtraces = 0;
     traceAddress.Clear();
-    transactionHash = "";
+    transactionHash.setEmpty();
     transactionPosition = 0;
     type = "";
     error = "";
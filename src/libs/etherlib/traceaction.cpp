@@ -26,6 +26,30 @@ IMPLEMENT_NODE(CTraceAction, CBaseNode);
 static SFString nextTraceactionChunk(const SFString& fieldIn, const void *dataPtr);
 static SFString nextTraceactionChunk_custom(const SFString& fieldIn, const void *dataPtr);
 
+//---------------------------------------------------------------------------
+// makeClass chose the seed so that no two of these names share a slot in the table
+enum {
+    FLD_ADDRESS = 1,
+    FLD_BALANCE,
+    FLD_CALLTYPE,
+    FLD_FROM,
+    FLD_GAS,
+    FLD_INIT,
+    FLD_INPUT,
+    FLD_REFUNDADDRESS,
+    FLD_TO,
+    FLD_VALUE,
+};
+static const char *traceactionFieldNames[] = {
+    "address", "balance", "callType", "from", "gas", "init", "input", "refundAddress", "to",
+    "value",
+};
+static const uint8_t traceactionFieldSlots[] = {
+    0, 5, 1, 6, 0, 7, 0, 0, 0, 3, 0, 8, 0, 0, 0, 2,
+    0, 10, 4, 0, 0, 0, 0, 0, 0, 0, 0, 0, 9, 0, 0, 0,
+};
+static const CFieldTable traceactionFieldTable(traceactionFieldNames, 10, traceactionFieldSlots, 32, 0);
+
 //---------------------------------------------------------------------------
 void CTraceAction::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr) const {
     if (!m_showing)
@@ -36,12 +60,10 @@ void CTraceAction::Format(CExportContext& ctx, const SFString& fmtIn, void *data
         return;
     }
 
-    SFString fmt = fmtIn;
-    if (handleCustomFormat(ctx, fmt, dataPtr))
+    if (handleCustomFormat(ctx, fmtIn, dataPtr))
         return;
 
-    while (!fmt.empty())
-        ctx << getNextChunk(fmt, nextTraceactionChunk, this);
+    formatChunks(ctx, fmtIn, nextTraceactionChunk, this);
 }
 
 //---------------------------------------------------------------------------
@@ -60,35 +82,17 @@ bool CTraceAction::setValueByName(const SFString& fieldName, const SFString& fie
     // EXISTING_CODE
     // EXISTING_CODE
 
-    switch (tolower(fieldName[0])) {
-        case 'a':
-            if ( fieldName % "address" ) { address = toAddress(fieldValue); return true; }
-            break;
-        case 'b':
-            if ( fieldName % "balance" ) { balance = toWei(fieldValue); return true; }
-            break;
-        case 'c':
-            if ( fieldName % "callType" ) { callType = fieldValue; return true; }
-            break;
-        case 'f':
-            if ( fieldName % "from" ) { from = toAddress(fieldValue); return true; }
-            break;
-        case 'g':
-            if ( fieldName % "gas" ) { gas = toGas(fieldValue); return true; }
-            break;
-        case 'i':
-            if ( fieldName % "init" ) { init = fieldValue; return true; }
-            if ( fieldName % "input" ) { input = fieldValue; return true; }
-            break;
-        case 'r':
-            if ( fieldName % "refundAddress" ) { refundAddress = toAddress(fieldValue); return true; }
-            break;
-        case 't':
-            if ( fieldName % "to" ) { to = toAddress(fieldValue); return true; }
-            break;
-        case 'v':
-            if ( fieldName % "value" ) { value = toWei(fieldValue); return true; }
-            break;
+    switch (traceactionFieldTable.find(fieldName)) {
+        case FLD_ADDRESS: address = toAddress(fieldValue); return true;
+        case FLD_BALANCE: balance = toWei(fieldValue); return true;
+        case FLD_CALLTYPE: callType = fieldValue; return true;
+        case FLD_FROM: from = toAddress(fieldValue); return true;
+        case FLD_GAS: gas = toGas(fieldValue); return true;
+        case FLD_INIT: init = fieldValue; return true;
+        case FLD_INPUT: input = fieldValue; return true;
+        case FLD_REFUNDADDRESS: refundAddress = toAddress(fieldValue); return true;
+        case FLD_TO: to = toAddress(fieldValue); return true;
+        case FLD_VALUE: value = toWei(fieldValue); return true;
         default:
             break;
     }
@@ -238,34 +242,18 @@ SFString CTraceAction::getValueByName(const SFString& fieldName) const {
         return ret;
 
     // Return field values
-    switch (tolower(fieldName[0])) {
-        case 'a':
-            if ( fieldName % "address" ) return fromAddress(address);
-            break;
-        case 'b':
-            if ( fieldName % "balance" ) return fromWei(balance);
-            break;
-        case 'c':
-            if ( fieldName % "callType" ) return callType;
-            break;
-        case 'f':
-            if ( fieldName % "from" ) return fromAddress(from);
-            break;
-        case 'g':
-            if ( fieldName % "gas" ) return fromGas(gas);
-            break;
-        case 'i':
-            if ( fieldName % "init" ) return init;
-            if ( fieldName % "input" ) return input;
-            break;
-        case 'r':
-            if ( fieldName % "refundAddress" ) return fromAddress(refundAddress);
-            break;
-        case 't':
-            if ( fieldName % "to" ) return fromAddress(to);
-            break;
-        case 'v':
-            if ( fieldName % "value" ) return fromWei(value);
+    switch (traceactionFieldTable.find(fieldName)) {
+        case FLD_ADDRESS: return fromAddress(address);
+        case FLD_BALANCE: return fromWei(balance);
+        case FLD_CALLTYPE: return callType;
+        case FLD_FROM: return fromAddress(from);
+        case FLD_GAS: return fromGas(gas);
+        case FLD_INIT: return init;
+        case FLD_INPUT: return input;
+        case FLD_REFUNDADDRESS: return fromAddress(refundAddress);
+        case FLD_TO: return fromAddress(to);
+        case FLD_VALUE: return fromWei(value);
+        default:
             break;
     }
 
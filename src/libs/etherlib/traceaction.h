@@ -31,15 +31,15 @@ typedef SFUniqueList<CTraceAction*>       CTraceActionListU;
 //--------------------------------------------------------------------------
 class CTraceAction : public CBaseNode {
 public:
-    SFAddress address;
+    CAddressField address;
     SFWei balance;
     SFString callType;
-    SFAddress from;
+    CAddressField from;
     SFGas gas;
     SFString init;
     SFString input;
-    SFAddress refundAddress;
-    SFAddress to;
+    CAddressField refundAddress;
+    CAddressField to;
     SFWei value;
 
 public:
@@ -99,15 +99,15 @@ inline void CTraceAction::Clear(void) {
 inline void CTraceAction::Init(void) {
     CBaseNode::Init();
 
-    address = "";
+    address.setEmpty();
     balance = 0;
     callType = "";
-    from = "";
+    from.setEmpty();
     gas = 0;
     init = "";
     input = "";
-    refundAddress = "";
-    to = "";
+    refundAddress.setEmpty();
+    to.setEmpty();
     value = 0;
 
     // EXISTING_CODE
@@ -0,0 +1,187 @@
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include "tracecache.h"
+
+namespace qblocks {
+
+    //-------------------------------------------------------------------------
+    // 'result' is the result field of trace_block's reply. Returns false if the traces are not
+    // in transaction order (which we would not be able to index).
+    bool CBlockTraces::parseJson(blknum_t bn, const SFString& result) {
+        blockNumber = bn;
+        blockHash.setEmpty();
+        hashes.Clear();
+        firstTrace.Clear();
+        traces.Clear();
+
+        SFString copy = result;
+        char *p = cleanUpJson((char *)(copy.c_str()));  // NOLINT
+        while (p && *p) {
+            CTrace tr;
+            uint32_t nFields = 0;
+            p = tr.parseJson(p, nFields);
+            if (!nFields)
+                continue;
+
+            // Block and uncle rewards belong to no transaction (and trace_transaction doesn't
+            // report them either)
+            if (tr.transactionHash.empty())
+                continue;
+
+            uint64_t pos = tr.transactionPosition;
+            if (pos + 1 < hashes.getCount())
+                return false;
+            while (hashes.getCount() <= pos) {
+                hashes.addValue("");
+                firstTrace.addValue(traces.getCount());
+            }
+            hashes[(uint32_t)pos] = tr.transactionHash.asString();
+            if (blockHash.empty())
+                blockHash = tr.blockHash;
+            traces.addValue(tr);
+        }
+        firstTrace.addValue(traces.getCount());
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    bool CBlockTraces::writeTo(const SFString& fileName) const {
+        SFString created;
+        if (!establishFolder(fileName, created))
+            return false;
+        if (!created.empty() && !isTestMode())
+            cerr << "mkdir(" << created << ")" << SFString(' ',20) << "                                                     \n";
+
+        SFArchive archive(WRITING_ARCHIVE);
+        if (!archive.Lock(fileName, binaryWriteCreate, LOCK_CREATE))
+            return false;
+
+        archive << (uint64_t)TRACE_CACHE_VERSION;
+        archive << blockNumber;
+        archive << blockHash;
+        archive << hashes;
+        archive << firstTrace;
+        archive << (uint64_t)traces.getCount();
+        for (uint32_t i = 0 ; i < traces.getCount() ; i++) {
+            CTrace tr = traces[i];
+            tr.blockHash.setEmpty();
+            tr.blockNumber = 0;
+            tr.transactionHash.setEmpty();
+            tr.transactionPosition = 0;
+            tr.SerializeC(archive);
+        }
+        archive.Close();
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    bool CBlockTraces::readFrom(const SFString& fileName) {
+        SFArchive archive(READING_ARCHIVE);
+        if (!archive.Lock(fileName, binaryReadOnly, LOCK_NOWAIT))
+            return false;
+
+        uint64_t version = 0, nTraces = 0;
+        archive >> version;
+        if (version != TRACE_CACHE_VERSION) {
+            archive.Close();
+            return false;
+        }
+        archive >> blockNumber;
+        archive >> blockHash;
+        archive >> hashes;
+        archive >> firstTrace;
+        archive >> nTraces;
+
+        traces.Clear();
+        traces.reserve((uint32_t)nTraces);
+        for (uint32_t tx = 0 ; tx < hashes.getCount() ; tx++) {
+            for (uint64_t i = firstTrace[tx] ; i < firstTrace[tx + 1] ; i++) {
+                CTrace *tr = &traces[traces.getCount()];
+                tr->Serialize(archive);
+                tr->blockHash = blockHash;
+                tr->blockNumber = blockNumber;
+                tr->transactionHash = hashes[tx];
+                tr->transactionPosition = tx;
+            }
+        }
+        archive.Close();
+        return (traces.getCount() == nTraces);
+    }
+
+    //-------------------------------------------------------------------------
+    void CBlockTraces::getTraces(uint32_t tx, CTraceArray& out) const {
+        for (uint64_t i = firstTrace[tx] ; i < firstTrace[tx + 1] ; i++)
+            out[out.getCount()] = traces[(uint32_t)i];
+    }
+
+    //-------------------------------------------------------------------------
+    bool CBlockTraces::hasTransaction(const CTransaction& trans) const {
+        return (trans.blockNumber == blockNumber &&
+                trans.transactionIndex < nTransactions() &&
+                trans.hash == hashes[(uint32_t)trans.transactionIndex]);
+    }
+
+    //-------------------------------------------------------------------------
+    SFString getTraceFilename(blknum_t bn) {
+        return getBinaryFilename(bn).Substitute("/blocks/", "/traces/");
+    }
+
+    //-------------------------------------------------------------------------
+    // Callers ask for the transactions of a block one after the other, so each thread keeps the
+    // last block's traces. They come from the trace cache if they are there. If not, we ask the
+    // node and, if the block itself is cached, cache its traces too.
+    const CBlockTraces *getBlockTraces(blknum_t bn) {
+        thread_local CBlockTraces last;
+        if (last.blockNumber == bn)
+            return &last;
+
+        SFString fileName = getTraceFilename(bn);
+        if (fileExists(fileName) && last.readFrom(fileName) && last.blockNumber == bn)
+            return &last;
+
+        SFString results;
+        queryRawBlockTrace(results, bn);
+        CRPCResult generic;
+        generic.parseJson((char*)results.c_str());  // NOLINT
+        if (!last.parseJson(bn, generic.result)) {
+            last = CBlockTraces();
+            return NULL;
+        }
+
+        // A node that doesn't trace gives us nothing, which we should not remember
+        if (last.traces.getCount() && blockInCache(bn))
+            last.writeTo(fileName);
+        return &last;
+    }
+
+    //-------------------------------------------------------------------------
+    void getTraces(CTraceArray& traces, const CTransaction& trans) {
+        const CBlockTraces *block = getBlockTraces(trans.blockNumber);
+        if (block && block->hasTransaction(trans))
+            block->getTraces((uint32_t)trans.transactionIndex, traces);
+        else
+            getTraces(traces, trans.hash.asString());
+    }
+
+    //-------------------------------------------------------------------------
+    uint32_t getTraceCount(const CTransaction& trans) {
+        const CBlockTraces *block = getBlockTraces(trans.blockNumber);
+        if (block && block->hasTransaction(trans))
+            return block->getCount((uint32_t)trans.transactionIndex);
+
+        CTraceArray traces;
+        getTraces(traces, trans.hash.asString());
+        return traces.getCount();
+    }
+
+}  // namespace qblocks
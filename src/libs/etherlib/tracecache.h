@@ -0,0 +1,57 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include "etherlib.h"
+
+namespace qblocks {
+
+    //-------------------------------------------------------------------------
+    // Every trace of a block, as returned by one call to trace_block. Once a block is in the
+    // block cache its traces are written next to it (under traces/ instead of blocks/), so they
+    // only have to be asked for once:
+    //
+    //      version | block number | block hash | transaction hashes | first traces | traces
+    //
+    // The traces are in transaction order and 'first traces' holds the index of each
+    // transaction's first trace (plus one past the last), so a transaction's traces and their
+    // count are found without a search. The block and transaction fields each trace repeats
+    // are left out of the file and filled back in when it's read.
+    //-------------------------------------------------------------------------
+    #define TRACE_CACHE_VERSION 1
+
+    //-------------------------------------------------------------------------
+    class CBlockTraces {
+    public:
+        blknum_t      blockNumber;
+        CHashField    blockHash;
+        SFStringArray hashes;
+        SFUintArray   firstTrace;
+        CTraceArray   traces;
+
+        CBlockTraces(void) : blockNumber(NOPOS) { }
+
+        bool     parseJson (blknum_t bn, const SFString& result);
+        bool     readFrom  (const SFString& fileName);
+        bool     writeTo   (const SFString& fileName) const;
+
+        uint32_t nTransactions(void) const { return hashes.getCount(); }
+        uint32_t getCount (uint32_t tx) const { return (uint32_t)(firstTrace[tx + 1] - firstTrace[tx]); }
+        void     getTraces(uint32_t tx, CTraceArray& out) const;
+        bool     hasTransaction(const CTransaction& trans) const;
+    };
+
+    //-------------------------------------------------------------------------
+    extern SFString            getTraceFilename(blknum_t bn);
+    extern const CBlockTraces *getBlockTraces  (blknum_t bn);
+
+}  // namespace qblocks
@@ -26,6 +26,22 @@ IMPLEMENT_NODE(CTraceResult, CBaseNode);
 static SFString nextTraceresultChunk(const SFString& fieldIn, const void *dataPtr);
 static SFString nextTraceresultChunk_custom(const SFString& fieldIn, const void *dataPtr);
 
+//---------------------------------------------------------------------------
+// makeClass chose the seed so that no two of these names share a slot in the table
+enum {
+    FLD_ADDRESS = 1,
+    FLD_CODE,
+    FLD_GASUSED,
+    FLD_OUTPUT,
+};
+static const char *traceresultFieldNames[] = {
+    "address", "code", "gasUsed", "output",
+};
+static const uint8_t traceresultFieldSlots[] = {
+    0, 0, 1, 0, 3, 4, 0, 2,
+};
+static const CFieldTable traceresultFieldTable(traceresultFieldNames, 4, traceresultFieldSlots, 8, 0);
+
 //---------------------------------------------------------------------------
 void CTraceResult::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr) const {
     if (!m_showing)
@@ -36,12 +52,10 @@ void CTraceResult::Format(CExportContext& ctx, const SFString& fmtIn, void *data
         return;
     }
 
-    SFString fmt = fmtIn;
-    if (handleCustomFormat(ctx, fmt, dataPtr))
+    if (handleCustomFormat(ctx, fmtIn, dataPtr))
         return;
 
-    while (!fmt.empty())
-        ctx << getNextChunk(fmt, nextTraceresultChunk, this);
+    formatChunks(ctx, fmtIn, nextTraceresultChunk, this);
 }
 
 //---------------------------------------------------------------------------
@@ -60,19 +74,11 @@ bool CTraceResult::setValueByName(const SFString& fieldName, const SFString& fie
     // EXISTING_CODE
     // EXISTING_CODE
 
-    switch (tolower(fieldName[0])) {
-        case 'a':
-            if ( fieldName % "address" ) { address = toAddress(fieldValue); return true; }
-            break;
-        case 'c':
-            if ( fieldName % "code" ) { code = fieldValue; return true; }
-            break;
-        case 'g':
-            if ( fieldName % "gasUsed" ) { gasUsed = toGas(fieldValue); return true; }
-            break;
-        case 'o':
-            if ( fieldName % "output" ) { output = fieldValue; return true; }
-            break;
+    switch (traceresultFieldTable.find(fieldName)) {
+        case FLD_ADDRESS: address = toAddress(fieldValue); return true;
+        case FLD_CODE: code = fieldValue; return true;
+        case FLD_GASUSED: gasUsed = toGas(fieldValue); return true;
+        case FLD_OUTPUT: output = fieldValue; return true;
         default:
             break;
     }
@@ -204,18 +210,12 @@ SFString CTraceResult::getValueByName(const SFString& fieldName) const {
         return ret;
 
     // Return field values
-    switch (tolower(fieldName[0])) {
-        case 'a':
-            if ( fieldName % "address" ) return fromAddress(address);
-            break;
-        case 'c':
-            if ( fieldName % "code" ) return code;
-            break;
-        case 'g':
-            if ( fieldName % "gasUsed" ) return fromGas(gasUsed);
-            break;
-        case 'o':
-            if ( fieldName % "output" ) return output;
+    switch (traceresultFieldTable.find(fieldName)) {
+        case FLD_ADDRESS: return fromAddress(address);
+        case FLD_CODE: return code;
+        case FLD_GASUSED: return fromGas(gasUsed);
+        case FLD_OUTPUT: return output;
+        default:
             break;
     }
 
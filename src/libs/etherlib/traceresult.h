@@ -31,7 +31,7 @@ typedef SFUniqueList<CTraceResult*>       CTraceResultListU;
 //--------------------------------------------------------------------------
 class CTraceResult : public CBaseNode {
 public:
-    SFAddress address;
+    CAddressField address;
     SFString code;
     SFGas gasUsed;
     SFString output;
@@ -93,7 +93,7 @@ inline void CTraceResult::Clear(void) {
 inline void CTraceResult::Init(void) {
     CBaseNode::Init();
 
-    address = "";
+    address.setEmpty();
     code = "";
     gasUsed = 0;
     output = "";
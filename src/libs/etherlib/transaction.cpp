@@ -26,6 +26,35 @@ IMPLEMENT_NODE(CTransaction, CBaseNode);
 extern SFString nextTransactionChunk(const SFString& fieldIn, const void *dataPtr);
 static SFString nextTransactionChunk_custom(const SFString& fieldIn, const void *dataPtr);
 
+//---------------------------------------------------------------------------
+// makeClass chose the seed so that no two of these names share a slot in the table
+enum {
+    FLD_HASH = 1,
+    FLD_BLOCKHASH,
+    FLD_BLOCKNUMBER,
+    FLD_TRANSACTIONINDEX,
+    FLD_NONCE,
+    FLD_TIMESTAMP,
+    FLD_FROM,
+    FLD_TO,
+    FLD_VALUE,
+    FLD_GAS,
+    FLD_GASPRICE,
+    FLD_INPUT,
+    FLD_ISERROR,
+    FLD_ISINTERNAL,
+    FLD_RECEIPT,
+};
+static const char *transactionFieldNames[] = {
+    "hash", "blockHash", "blockNumber", "transactionIndex", "nonce", "timestamp", "from", "to",
+    "value", "gas", "gasPrice", "input", "isError", "isInternal", "receipt",
+};
+static const uint8_t transactionFieldSlots[] = {
+    0, 10, 0, 11, 6, 12, 0, 0, 0, 0, 5, 0, 3, 1, 2, 0,
+    0, 9, 7, 0, 4, 0, 15, 0, 0, 0, 14, 13, 8, 0, 0, 0,
+};
+static const CFieldTable transactionFieldTable(transactionFieldNames, 15, transactionFieldSlots, 32, 0);
+
 //---------------------------------------------------------------------------
 void CTransaction::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr) const {
     if (!m_showing)
@@ -36,12 +65,10 @@ void CTransaction::Format(CExportContext& ctx, const SFString& fmtIn, void *data
         return;
     }
 
-    SFString fmt = fmtIn;
-    if (handleCustomFormat(ctx, fmt, dataPtr))
+    if (handleCustomFormat(ctx, fmtIn, dataPtr))
         return;
 
-    while (!fmt.empty())
-        ctx << getNextChunk(fmt, nextTransactionChunk, this);
+    formatChunks(ctx, fmtIn, nextTransactionChunk, this);
 }
 
 //---------------------------------------------------------------------------
@@ -94,51 +121,59 @@ bool CTransaction::setValueByName(const SFString& fieldName, const SFString& fie
             return true;
     // EXISTING_CODE
 
-    switch (tolower(fieldName[0])) {
-        case 'b':
-            if ( fieldName % "blockHash" ) { blockHash = toHash(fieldValue); return true; }
-            if ( fieldName % "blockNumber" ) { blockNumber = toUnsigned(fieldValue); return true; }
-            break;
-        case 'f':
-            if ( fieldName % "from" ) { from = toAddress(fieldValue); return true; }
-            break;
-        case 'g':
-            if ( fieldName % "gas" ) { gas = toGas(fieldValue); return true; }
-            if ( fieldName % "gasPrice" ) { gasPrice = toGas(fieldValue); return true; }
-            break;
-        case 'h':
-            if ( fieldName % "hash" ) { hash = toHash(fieldValue); return true; }
-            break;
-        case 'i':
-            if ( fieldName % "input" ) { input = fieldValue; return true; }
-            if ( fieldName % "isError" ) { isError = toUnsigned(fieldValue); return true; }
-            if ( fieldName % "isInternal" ) { isInternal = toUnsigned(fieldValue); return true; }
-            break;
-        case 'n':
-            if ( fieldName % "nonce" ) { nonce = toUnsigned(fieldValue); return true; }
-            break;
-        case 'r':
-            if ( fieldName % "receipt" ) { /* receipt = fieldValue; */ return false; }
-            break;
-        case 't':
-            if ( fieldName % "transactionIndex" ) { transactionIndex = toUnsigned(fieldValue); return true; }
-            if ( fieldName % "timestamp" ) { timestamp = toTimestamp(fieldValue); return true; }
-            if ( fieldName % "to" ) { to = toAddress(fieldValue); return true; }
-            break;
-        case 'v':
-            if ( fieldName % "value" ) { value = toWei(fieldValue); return true; }
-            break;
+    switch (transactionFieldTable.find(fieldName)) {
+        case FLD_HASH: hash = toHash(fieldValue); return true;
+        case FLD_BLOCKHASH: blockHash = toHash(fieldValue); return true;
+        case FLD_BLOCKNUMBER: blockNumber = toUnsigned(fieldValue); return true;
+        case FLD_TRANSACTIONINDEX: transactionIndex = toUnsigned(fieldValue); return true;
+        case FLD_NONCE: nonce = toUnsigned(fieldValue); return true;
+        case FLD_TIMESTAMP: timestamp = toTimestamp(fieldValue); return true;
+        case FLD_FROM: from = toAddress(fieldValue); return true;
+        case FLD_TO: to = toAddress(fieldValue); return true;
+        case FLD_VALUE: value = toWei(fieldValue); return true;
+        case FLD_GAS: gas = toGas(fieldValue); return true;
+        case FLD_GASPRICE: gasPrice = toGas(fieldValue); return true;
+        case FLD_INPUT: input = fieldValue; return true;
+        case FLD_ISERROR: isError = toUnsigned(fieldValue); return true;
+        case FLD_ISINTERNAL: isInternal = toUnsigned(fieldValue); return true;
+        case FLD_RECEIPT: /* receipt = fieldValue; */ return false;
         default:
             break;
     }
     return false;
 }
 
+//---------------------------------------------------------------------------------------------------
+bool CTransaction::parseTape(CJsonTape& tape, uint32_t node) {
+    if (!tape.isObject(node))
+        return false;
+
+    // Objects are parsed in place from the tape. Anything else goes to setValueByName
+    for (uint32_t key = tape.firstMember(node) ; key != JSON_NOTOKEN ; key = tape.nextMember(node, key)) {
+        uint32_t val = key + 1;
+        string_view_q name = tape.getView(key);
+        switch (transactionFieldTable.find(name.data(), name.length())) {
+            case FLD_RECEIPT:
+                if (tape.isObject(val)) {
+                    receipt.parseTape(tape, val);
+                    continue;
+                }
+                break;
+            default:
+                break;
+        }
+        setValueFromTape(tape, key);
+    }
+    finishParse();
+    return true;
+}
+
 //---------------------------------------------------------------------------------------------------
 void CTransaction::finishParse() {
     // EXISTING_CODE
-    function = Format("[{FUNCTION}]");
-    ether = (double)strtold((const char*)Format("[{ETHER}]"),NULL);
+    // Called as blocks are read, possibly on many threads, so this doesn't go through Format
+    function = inputToFunction();
+    ether = (double)strtold((const char*)wei2Ether(asStringBN(value)),NULL);
     receipt.pTrans = this;
     // EXISTING_CODE
 }
@@ -406,39 +441,23 @@ SFString CTransaction::getValueByName(const SFString& fieldName) const {
         return ret;
 
     // Return field values
-    switch (tolower(fieldName[0])) {
-        case 'b':
-            if ( fieldName % "blockHash" ) return fromHash(blockHash);
-            if ( fieldName % "blockNumber" ) return asStringU(blockNumber);
-            break;
-        case 'f':
-            if ( fieldName % "from" ) return fromAddress(from);
-            break;
-        case 'g':
-            if ( fieldName % "gas" ) return fromGas(gas);
-            if ( fieldName % "gasPrice" ) return fromGas(gasPrice);
-            break;
-        case 'h':
-            if ( fieldName % "hash" ) return fromHash(hash);
-            break;
-        case 'i':
-            if ( fieldName % "input" ) return input;
-            if ( fieldName % "isError" ) return asStringU(isError);
-            if ( fieldName % "isInternal" ) return asStringU(isInternal);
-            break;
-        case 'n':
-            if ( fieldName % "nonce" ) return asStringU(nonce);
-            break;
-        case 'r':
-            if ( fieldName % "receipt" ) { expContext().noFrst=true; return receipt.Format(); }
-            break;
-        case 't':
-            if ( fieldName % "transactionIndex" ) return asStringU(transactionIndex);
-            if ( fieldName % "timestamp" ) return fromTimestamp(timestamp);
-            if ( fieldName % "to" ) return fromAddress(to);
-            break;
-        case 'v':
-            if ( fieldName % "value" ) return fromWei(value);
+    switch (transactionFieldTable.find(fieldName)) {
+        case FLD_HASH: return fromHash(hash);
+        case FLD_BLOCKHASH: return fromHash(blockHash);
+        case FLD_BLOCKNUMBER: return asStringU(blockNumber);
+        case FLD_TRANSACTIONINDEX: return asStringU(transactionIndex);
+        case FLD_NONCE: return asStringU(nonce);
+        case FLD_TIMESTAMP: return fromTimestamp(timestamp);
+        case FLD_FROM: return fromAddress(from);
+        case FLD_TO: return fromAddress(to);
+        case FLD_VALUE: return fromWei(value);
+        case FLD_GAS: return fromGas(gas);
+        case FLD_GASPRICE: return fromGas(gasPrice);
+        case FLD_INPUT: return input;
+        case FLD_ISERROR: return asStringU(isError);
+        case FLD_ISINTERNAL: return asStringU(isInternal);
+        case FLD_RECEIPT: expContext().noFrst=true; return receipt.Format();
+        default:
             break;
     }
 
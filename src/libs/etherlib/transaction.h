@@ -34,14 +34,14 @@ class CBlock;
 //--------------------------------------------------------------------------
 class CTransaction : public CBaseNode {
 public:
-    SFHash hash;
-    SFHash blockHash;
+    CHashField hash;
+    CHashField blockHash;
     blknum_t blockNumber;
     uint64_t transactionIndex;
     uint64_t nonce;
     timestamp_t timestamp;
-    SFAddress from;
-    SFAddress to;
+    CAddressField from;
+    CAddressField to;
     SFWei value;
     SFGas gas;
     SFGas gasPrice;
@@ -58,6 +58,7 @@ public:
 
     DECLARE_NODE(CTransaction);
 
+    bool parseTape(CJsonTape& tape, uint32_t node) override;
     const CBaseNode *getObjectAt(const SFString& fieldName, uint32_t index) const override;
 
     // EXISTING_CODE
@@ -66,6 +67,9 @@ public:
     SFString function;
     double ether;
     CTraceArray traces;
+    // forEveryTransactionInList sets these if the transaction asked for was not found
+    SFString notFound;  // what was asked for (a transaction hash, block hash or block number)
+    bool notFoundBlock;  // it was the block that was not found
 
     SFString inputToFunction(void) const;
     bool isFunction(const SFString& func) const;
@@ -129,14 +133,14 @@ inline void CTransaction::Clear(void) {
 inline void CTransaction::Init(void) {
     CBaseNode::Init();
 
-    hash = "";
-    blockHash = "";
+    hash.setEmpty();
+    blockHash.setEmpty();
     blockNumber = 0;
     transactionIndex = 0;
     nonce = 0;
     timestamp = 0;
-    from = "";
-    to = "";
+    from.setEmpty();
+    to.setEmpty();
     value = 0;
     gas = 0;
     gasPrice = 0;
@@ -150,6 +154,8 @@ inline void CTransaction::Init(void) {
     function = "";
     funcPtr = NULL;
     ether = 0.;
+    notFound = "";
+    notFoundBlock = false;
 #if 0
     creates = "";
     confirmations = 0;
@@ -189,6 +195,8 @@ inline void CTransaction::Copy(const CTransaction& tr) {
     funcPtr = tr.funcPtr;
     function = tr.function;
     ether = tr.ether;
+    notFound = tr.notFound;
+    notFoundBlock = tr.notFoundBlock;
 #if 0
     creates = tr.creates;
     confirmations = tr.confirmations;
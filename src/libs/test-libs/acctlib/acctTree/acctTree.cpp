@@ -44,7 +44,7 @@ int main(int argc, const char *argv[]) {
                                 asStringU(options.startBlock+options.nBlocks) + " (nBlocks: " +
                                 asStringU(options.nBlocks) + ")";
             reporter.startTimer(msg);
-            forEveryBlockOnDisc(buildTree, &reporter, options.startBlock, options.nBlocks);
+            forEveryBlockParallel(buildTree, &reporter, options.startBlock, options.nBlocks);
             reporter.stopTimer();
 
             //-----------------------------------------------
@@ -66,11 +66,9 @@ bool buildTree(CBlock& block, void *data) {
     r->nBlocksVisited++;
     for (uint32_t i = 0 ; i < block.transactions.getCount() ; i++) {
         CTransaction *tr = (CTransaction*)&block.transactions[i];  // NOLINT
-        if (SFString(tr->to).empty())
-            tr->to = "0x0";
         r->nTransVisited++;
-        r->tree->insert(tr->from, asStringU(block.blockNumber));
-        r->tree->insert(tr->to, asStringU(block.blockNumber));
+        r->tree->insert(fromAddress(tr->from), asStringU(block.blockNumber));
+        r->tree->insert(fromAddress(tr->to), asStringU(block.blockNumber));
     }
     cerr << dateFromTimeStamp(block.timestamp) << " -- " << r->nBlocksVisited << ": " << r->nTransVisited << "\r";
     cerr.flush();
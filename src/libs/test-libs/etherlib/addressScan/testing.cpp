@@ -0,0 +1,159 @@
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include "etherlib.h"
+
+#define N_RANDOM 20000
+
+//--------------------------------------------------------------
+// The way isPotentialAddr used to work, with big numbers and strings
+bool oldIsPotentialAddr(SFUintBN test, SFAddress& addrOut) {
+    addrOut = "";
+    static const SFUintBN small = hex2BN(  "0x00000000000000ffffffffffffffffffffffffff");
+    static const SFUintBN large = hex2BN("0x010000000000000000000000000000000000000000");
+    if (test <= small || test >= large)
+        return false;
+    addrOut = to_hex(test).c_str();
+    if (addrOut.endsWith("00000000"))
+        return false;
+    if (addrOut.length()<40)
+        addrOut = padLeft(addrOut, 40, '0');
+    addrOut = addrOut.substr(addrOut.length()-40,40);
+    addrOut = toLower("0x" + addrOut);
+    return true;
+}
+
+//--------------------------------------------------------------
+bool collectAddr(blknum_t bn, blknum_t tx, blknum_t tc, const SFAddress& addr, void *data) {
+    SFString *str = (SFString*)data;
+    *str += addr + "\n";
+    return true;
+}
+
+//--------------------------------------------------------------
+// The way processPotentialAddrs used to work
+void oldProcessPotentialAddrs(const SFString& potList, SFString& found) {
+    SFAddress addr;
+    for (uint32_t s = 0 ; s < potList.length() / 64 ; s++) {
+        SFUintBN test  = hex2BN("0x" + potList.substr(s*64,64));
+        if (oldIsPotentialAddr(test, addr))
+            found += addr + "\n";
+    }
+}
+
+//--------------------------------------------------------------
+bool showAddr(blknum_t bn, blknum_t tx, blknum_t tc, const SFAddress& addr, void *data) {
+    cout << "\t" << bn << "." << (tx == NOPOS ? SFString("block") : asStringU(tx)) << "." << tc << "\t" << addr << "\n";
+    return true;
+}
+
+//--------------------------------------------------------------
+bool noTraces(const CTransaction *trans, void *data) {
+    return true;
+}
+
+//--------------------------------------------------------------
+// Words made mostly of zeros, with the interesting bytes where the heuristics look
+SFString randomWord(uint64_t& seed) {
+    uint8_t word[ADDR_WORD_SIZE];
+    memset(word, 0, sizeof(word));
+    for (uint32_t i = 0 ; i < ADDR_WORD_SIZE ; i++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        uint32_t r = (uint32_t)(seed >> 33);
+        if ((r % 100) < (i < 12 ? 3 : 60))
+            word[i] = (uint8_t)(r >> 8);
+    }
+    char hex[2 + ADDR_WORD_HEX + 1];
+    bytesToHex(word, ADDR_WORD_SIZE, hex);
+    return SFString(hex).substr(2);
+}
+
+//--------------------------------------------------------------
+int main(int argc, const char *argv[]) {
+
+    etherlib_init();
+
+    CDefaultOptions options;
+    options.minArgs = 0;
+    if (!options.prepareArguments(argc, argv))
+        return 0;
+
+    // Words that sit on either side of each of the heuristics
+    const char *edges[] = {
+        "0000000000000000000000000000000000000000000000000000000000000000",  // zero
+        "00000000000000000000000000000000000000ffffffffffffffffffffffffff",  // 2^104 - 1
+        "0000000000000000000000000000000000000100000000000000000000000001",  // 2^104 + 1
+        "000000000000000000000000ffffffffffffffffffffffffffffffffffffffff",  // 2^160 - 1
+        "0000000000000000000000010000000000000000000000000000000000000001",  // 2^160 + 1
+        "000000000000000000000000c0ffee0000000000000000000000000000000000",  // low four bytes zero
+        "000000000000000000000000c0ffee0000000000000000000000000000000100",  // low three bytes zero
+        "000000000000000000000000C0FFEE254729296A45A3885639AC7E10F9D54979",  // upper case
+        "000000000000000000000000c0ffee254729296a45a3885639ac7e10f9d5497g",  // not hex
+        "000000000000000000000000c0ffee254729296a45a3885639ac7e10f9d5497",   // short
+    };
+    uint32_t nEdges = sizeof(edges) / sizeof(const char *);
+
+    cout << "edge cases:\n";
+    for (uint32_t i = 0 ; i < nEdges ; i++) {
+        SFString scanned;
+        processPotentialAddrs(0, 0, 0, edges[i], collectAddr, &scanned);
+        SFString result;
+        try {
+            SFString old;
+            oldProcessPotentialAddrs(edges[i], old);
+            result = (scanned == old ? "same" : "different: " + old);
+        } catch (const char *) {
+            result = "hex2BN threw";  // the old way did not survive bad digits
+        }
+        cout << "\t" << i << "\t" << (scanned.empty() ? "none" : scanned.Substitute("\n", "")) << "\t" << result << "\n";
+    }
+
+    // A long run of random words scanned at once finds what testing them one at a time did
+    uint64_t seed = 42;
+    SFString payload, expected, topicsOld, topicsNew;
+    uint32_t nAddrs = 0;
+    for (uint32_t i = 0 ; i < N_RANDOM ; i++) {
+        SFString word = randomWord(seed);
+        payload += word;
+        SFUintBN bn = hex2BN("0x" + word);
+        SFAddress addr;
+        if (oldIsPotentialAddr(bn, addr)) {
+            expected += addr + "\n";
+            topicsOld += addr;
+            nAddrs++;
+        }
+        topicsOld += "\n";
+        if (isPotentialAddr(bn, addr))
+            topicsNew += addr;
+        topicsNew += "\n";
+    }
+    SFString scanned;
+    processPotentialAddrs(0, 0, 0, payload, collectAddr, &scanned);
+    cout << "random words: " << N_RANDOM << " addresses: " << nAddrs << "\n";
+    cout << "scanned the same: " << (scanned == expected ? "true" : "false") << "\n";
+    cout << "topics the same: " << (topicsNew == topicsOld ? "true" : "false") << "\n";
+
+    // Each address once, where it first appears. The zero address is never reported.
+    CBlock block;
+    block.blockNumber = 4000000;
+    block.miner = "0x1111111111111111111111111111111111111111";
+    for (uint32_t t = 0 ; t < 3 ; t++) {
+        CTransaction *trans = &block.transactions[t];
+        trans->from  = (t == 2 ? block.miner.asString() : "0x2222222222222222222222222222222222222222");
+        trans->to    = (t == 1 ? "0x0" : "0x3333333333333333333333333333333333333333");
+        trans->input = "0xa9059cbb" + SFString(edges[7]) + SFString(edges[3]);
+    }
+    cout << "unique addresses:\n";
+    block.forEveryUniqueAddress(showAddr, noTraces, NULL);
+
+    return 0;
+}
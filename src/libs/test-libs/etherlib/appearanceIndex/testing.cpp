@@ -0,0 +1,180 @@
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include <map>
+#include "etherlib.h"
+
+#define SEGMENT_FILE "./appearanceIndex_test.bin"
+#define FIRST_BLOCK  4600000
+#define N_BLOCKS     80
+
+//--------------------------------------------------------------
+SFString makeAddr(uint64_t seed) {
+    return "0x" + padLeft(asStringU(seed), 40, '0');
+}
+
+//--------------------------------------------------------------
+// Addresses found in input, topics and data must look like addresses (see isPotentialAddr)
+SFString makeBigAddr(char ch, uint64_t seed) {
+    return "0x" + SFString(ch, 38) + padLeft(asStringU(seed), 2, '0');
+}
+
+//--------------------------------------------------------------
+// Addresses show up as senders, recipients, in input, in log topics and data, and as the miner
+void makeBlock(CBlock& block, uint32_t i) {
+    block = CBlock();
+    block.blockNumber = FIRST_BLOCK + i * 3 + (i % 2);
+    block.miner       = makeAddr(1 + i % 2);
+    for (uint32_t t = 0 ; t < i % 5 ; t++) {
+        CTransaction *trans = &block.transactions[t];
+        trans->transactionIndex = t;
+        trans->from  = makeAddr(10 + t);
+        trans->to    = (t == 3 ? "0x" : makeAddr(20 + (i % 7)));
+        trans->input = "0xa9059cbb" + padLeft(makeBigAddr('4', i % 3).substr(2), 64, '0');
+        if (t == 2) {
+            CLogEntry *log = &trans->receipt.logs[0];
+            log->address = makeAddr(30);
+            log->topics[0] = hex2BN("0x" + padLeft(makeBigAddr('5', 0).substr(2), 64, '0'));
+            log->data = "0x" + padLeft(makeBigAddr('6', i % 4).substr(2), 64, '0');
+        }
+    }
+}
+
+//--------------------------------------------------------------
+typedef std::map<CAddress20, CAppearanceList> CExpected;
+
+//--------------------------------------------------------------
+bool addExpected(blknum_t bn, blknum_t tx, blknum_t tc, const SFAddress& addr, void *data) {
+    CAddress20 bytes;
+    if (!bytes.fromHex(addr) || bytes.isZero())
+        return true;
+    CAppearanceList& list = (*(CExpected*)data)[bytes];
+    for (size_t i = 0 ; i < list.size() ; i++)
+        if (list[i].blockNum == bn && list[i].transIndex == tx)
+            return true;
+    list.push_back(CAppearance(bn, tx));
+    return true;
+}
+
+//--------------------------------------------------------------
+bool noTraces(const CTransaction *trans, void *data) {
+    return true;
+}
+
+//--------------------------------------------------------------
+bool collect(blknum_t bn, blknum_t tx, void *data) {
+    ((CAppearanceList*)data)->push_back(CAppearance(bn, tx));
+    return true;
+}
+
+//--------------------------------------------------------------
+bool showAppearance(blknum_t bn, blknum_t tx, void *data) {
+    cout << "\t" << bn << "." << (tx == NOPOS ? SFString("block") : asStringU(tx)) << "\n";
+    return (--(*(uint32_t*)data) > 0);
+}
+
+//--------------------------------------------------------------
+int main(int argc, const char *argv[]) {
+
+    etherlib_init();
+
+    CDefaultOptions options;
+    options.minArgs = 0;
+    if (!options.prepareArguments(argc, argv))
+        return 0;
+
+    // The appearances are found by forEveryAddress, so that's what we check against
+    CExpected expected;
+    CAppearanceWriter writer(FIRST_BLOCK, 0);
+    for (uint32_t i = 0 ; i < N_BLOCKS ; i++) {
+        CBlock block;
+        makeBlock(block, i);
+        block.forEveryAddress(addExpected, noTraces, &expected);
+        writer.addBlock(block);
+    }
+    CBlock outOfOrder, outOfRange;
+    makeBlock(outOfOrder, 3);
+    outOfRange.blockNumber = FIRST_BLOCK + APPEARANCE_CHUNK_SIZE;
+    cout << "out of order block added: " << (writer.addBlock(outOfOrder) ? "true" : "false") << "\n";
+    cout << "out of range block added: " << (writer.addBlock(outOfRange) ? "true" : "false") << "\n";
+    cout << "wrote segment: " << (writer.write(SEGMENT_FILE) ? "true" : "false") << "\n";
+
+    CAppearanceSegment segment;
+    if (!segment.open(SEGMENT_FILE)) {
+        cout << "Could not open the segment\n";
+        return 0;
+    }
+    cout << "nBlocks: " << segment.nBlocks() << " nAddrs: " << segment.nAddrs()
+            << " lastBlock: " << segment.lastBlock() << " expected addrs: " << expected.size() << "\n";
+
+    // Every address comes back with exactly the appearances forEveryAddress reported
+    uint32_t nSame = 0, nAppearances = 0;
+    for (CExpected::const_iterator it = expected.begin() ; it != expected.end() ; ++it) {
+        CAppearanceList found;
+        segment.forEveryPosting(segment.findAddress(it->first), 0, NOPOS, collect, &found);
+        bool same = (found.size() == it->second.size());
+        for (size_t i = 0 ; same && i < found.size() ; i++)
+            same = (found[i].blockNum == it->second[i].blockNum && found[i].transIndex == it->second[i].transIndex);
+        if (same)
+            nSame++;
+        else
+            cout << "different: " << it->first << "\n";
+        nAppearances += found.size();
+    }
+    cout << "addresses read back exactly: " << nSame << " appearances: " << nAppearances << "\n";
+    cout << "missing address found: " << (segment.findAddress(CAddress20(makeAddr(99))) != NOPOS ? "true" : "false") << "\n";
+
+    // A range of blocks, and stopping when asked to
+    uint64_t index = segment.findAddress(CAddress20(makeBigAddr('4', 1)));
+    uint32_t nShow = 100;
+    cout << "in input, blocks " << FIRST_BLOCK + 30 << " to " << FIRST_BLOCK + 60 << ":\n";
+    segment.forEveryPosting(index, FIRST_BLOCK + 30, FIRST_BLOCK + 60, showAppearance, &nShow);
+    nShow = 3;
+    cout << "in topics, first three:\n";
+    segment.forEveryPosting(segment.findAddress(CAddress20(makeBigAddr('5', 0))), 0, NOPOS, showAppearance, &nShow);
+    nShow = 2;
+    cout << "miner, first two:\n";
+    segment.forEveryPosting(segment.findAddress(CAddress20(makeAddr(1))), 0, NOPOS, showAppearance, &nShow);
+
+    // Freshening (loading a segment and adding newer blocks) writes the same segment
+    CAppearanceWriter first(FIRST_BLOCK, 0);
+    for (uint32_t i = 0 ; i < N_BLOCKS / 2 ; i++) {
+        CBlock block;
+        makeBlock(block, i);
+        first.addBlock(block);
+    }
+    first.write(SEGMENT_FILE ".1");
+    CAppearanceSegment half;
+    half.open(SEGMENT_FILE ".1");
+    CAppearanceWriter second(FIRST_BLOCK, 0);
+    cout << "loaded: " << (second.load(half) ? "true" : "false") << " flags differ loaded: "
+            << (CAppearanceWriter(FIRST_BLOCK, APPEAR_TRACES).load(half) ? "true" : "false") << "\n";
+    for (uint32_t i = N_BLOCKS / 2 ; i < N_BLOCKS ; i++) {
+        CBlock block;
+        makeBlock(block, i);
+        second.addBlock(block);
+    }
+    second.write(SEGMENT_FILE ".2");
+    cout << "freshened segment is the same: "
+            << (asciiFileToString(SEGMENT_FILE) == asciiFileToString(SEGMENT_FILE ".2") ? "true" : "false") << "\n";
+
+    // A damaged file is not used
+    stringToAsciiFile(SEGMENT_FILE ".1", asciiFileToString(SEGMENT_FILE).substr(0, 100));
+    cout << "truncated segment opened: " << (half.open(SEGMENT_FILE ".1") ? "true" : "false") << "\n";
+
+    segment.close();
+    half.close();
+    removeFile(SEGMENT_FILE);
+    removeFile(SEGMENT_FILE ".1");
+    removeFile(SEGMENT_FILE ".2");
+    return 0;
+}
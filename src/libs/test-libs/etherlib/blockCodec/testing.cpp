@@ -0,0 +1,222 @@
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include "etherlib.h"
+#include "options.h"
+
+#define BLOCK_FILE "./blockCodec_block.bin"
+
+//------------------------------------------------------------------------
+class CThisTest : public testing::Test {
+public:
+    CThisTest(void) : Test() {}
+    virtual void SetUp() {
+    }
+    virtual void TearDown() {
+    }
+};
+
+//------------------------------------------------------------------------
+const uint32_t codecs[] = { CODEC_NONE, CODEC_HEX, CODEC_LZ, CODEC_HEX | CODEC_LZ };
+const uint32_t nCodecs = sizeof(codecs) / sizeof(uint32_t);
+
+//------------------------------------------------------------------------
+bool loadBlock(CBlock& block) {
+    SFString contents = asciiFileToString("./tests/blocks.json");
+    if (contents.empty()) {
+        cerr << "Could not read ./tests/blocks.json. Quitting...\n";
+        return false;
+    }
+    SFString json = contents;  // as jsonTape does, we parse a copy
+    block.parseJson((char*)(const char*)json);
+    // Reading a block gives its transactions the block's timestamp, so we do the same here
+    for (uint32_t i = 0 ; i < block.transactions.getCount() ; i++)
+        block.transactions[i].timestamp = block.timestamp;
+    return true;
+}
+
+//------------------------------------------------------------------------
+bool roundTrip(const SFString& in) {
+    std::vector<char> packed;
+    lzCompress(in.c_str(), in.length(), packed);
+    std::vector<char> out(in.length());
+    if (!lzDecompress(packed.data(), packed.size(), out.data(), out.size()))
+        return false;
+    return (SFString(out.data(), 0, out.size()) == in);
+}
+
+//------------------------------------------------------------------------
+TEST_F(CThisTest, TestCodecs) {
+
+    // The compressor on its own
+    SFString random;
+    uint64_t seed = 42;
+    for (uint32_t i = 0 ; i < 5000 ; i++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        random += (char)('a' + (seed >> 59));
+    }
+    ASSERT_TRUE("Empty",      roundTrip(""));
+    ASSERT_TRUE("Short",      roundTrip("abc"));
+    ASSERT_TRUE("Run",        roundTrip(SFString('z', 1000)));
+    ASSERT_TRUE("Repeats",    roundTrip(random.substr(0, 300) + random.substr(0, 300) + random.substr(100, 4000)));
+    ASSERT_TRUE("Random",     roundTrip(random));
+
+    std::vector<char> packed;
+    SFString run = SFString('z', 1000);
+    lzCompress(run.c_str(), run.length(), packed);
+    cout << "a run of 1000 compresses to: " << packed.size() << "\n";
+    std::vector<char> out(run.length());
+    ASSERT_FALSE("Too short",   lzDecompress(packed.data(), packed.size() - 1, out.data(), out.size()));
+    ASSERT_FALSE("Wrong size",  lzDecompress(packed.data(), packed.size(), out.data(), out.size() - 1));
+    packed[2] = 0x7f;  // an offset before the start
+    ASSERT_FALSE("Bad offset",  lzDecompress(packed.data(), packed.size(), out.data(), out.size()));
+
+    // Hex strings are packed if they are made of whole lower case bytes, and read back the same
+    const char *strs[] = { "0xdeadbeef", "0x", "0xDEADBEEF", "0x123", "hello", "0xabcg" };
+    CMemArchive writer(WRITING_ARCHIVE);
+    writer.setCodec(CODEC_HEX);
+    for (uint32_t i = 0 ; i < sizeof(strs) / sizeof(char*) ; i++)
+        writer << SFString(strs[i]);
+    std::vector<char> bytes;
+    writer.takeBuffer(bytes);
+    cout << "hex strings: " << bytes.size() << " bytes\n";
+    SFArchive file(WRITING_ARCHIVE);
+    ASSERT_TRUE("Opened for writing", file.Lock(BLOCK_FILE, binaryWriteCreate, LOCK_CREATE));
+    file.Write(bytes.data(), sizeof(char), bytes.size());
+    file.Close();
+    CMemArchive reader;
+    ASSERT_TRUE("Opened strings", reader.open(BLOCK_FILE));
+    bool sameStrings = true;
+    for (uint32_t i = 0 ; i < sizeof(strs) / sizeof(char*) ; i++) {
+        SFString str;
+        reader >> str;
+        sameStrings = sameStrings && (str == strs[i]);
+    }
+    reader.close();
+    ASSERT_TRUE("Same strings", sameStrings);
+
+    // A block written with each codec reads back the same, whether written now or queued
+    CBlock block;
+    ASSERT_TRUE("Loaded block", loadBlock(block));
+    cout << "block: " << block.blockNumber << " transactions: " << block.transactions.getCount() << "\n";
+    for (uint32_t c = 0 ; c < nCodecs ; c++) {
+        setBlockCodec(codecs[c]);
+
+        removeFile(BLOCK_FILE);
+        ASSERT_TRUE("Written", writeBlockToBinary(block, BLOCK_FILE));
+        uint64_t size = fileSize(BLOCK_FILE);
+        CBlock written;
+        ASSERT_TRUE("Read written", readBlockFromBinary(written, BLOCK_FILE));
+
+        removeFile(BLOCK_FILE);
+        queueBlockToBinary(block, BLOCK_FILE);
+        ASSERT_TRUE("Flushed", flushCacheWrites());
+        CBlock queued;
+        ASSERT_TRUE("Read queued", readBlockFromBinary(queued, BLOCK_FILE));
+
+        cout << padRight(codecName(codecs[c]), 8) << size << " bytes";
+        cout << " same: " << (written.Format() == block.Format() ? "true" : "false");
+        cout << " queued: " << (fileSize(BLOCK_FILE) == size && queued.Format() == block.Format() ? "true" : "false") << "\n";
+    }
+    setBlockCodec(CODEC_NONE);
+
+    // A damaged file reads as nothing rather than as a wrong block
+    setBlockCodec(CODEC_HEX | CODEC_LZ);
+    writeBlockToBinary(block, BLOCK_FILE);
+    setBlockCodec(CODEC_NONE);
+    ASSERT_EQ("Truncated", truncate(BLOCK_FILE, (off_t)fileSize(BLOCK_FILE) - 10), 0);
+    CBlock damaged;
+    ASSERT_FALSE("Damaged", readBlockFromBinary(damaged, BLOCK_FILE));
+    removeFile(BLOCK_FILE);
+
+    return true;
+}}
+
+//------------------------------------------------------------------------
+void testSpeed(void) {
+
+    CBlock block;
+    if (!loadBlock(block))
+        return;
+
+    const uint64_t nRuns = 200;
+    uint64_t rawSize = 0;
+    for (uint32_t c = 0 ; c < nCodecs ; c++) {
+        setBlockCodec(codecs[c]);
+        removeFile(BLOCK_FILE);
+
+        double start = qbNow();
+        for (uint64_t i = 0 ; i < nRuns ; i++)
+            writeBlockToBinary(block, BLOCK_FILE);
+        double writeTime = qbNow() - start;
+        uint64_t size = fileSize(BLOCK_FILE);
+        if (codecs[c] == CODEC_NONE)
+            rawSize = size;
+
+        SFString format;
+        start = qbNow();
+        for (uint64_t i = 0 ; i < nRuns ; i++) {
+            CBlock fromFile;
+            readBlockFromBinary(fromFile, BLOCK_FILE);
+            if (i == 0)
+                format = fromFile.Format();
+        }
+        double readTime = qbNow() - start;
+
+        // Opening the file is where it's decoded, so this is the codec's share of reading it
+        start = qbNow();
+        for (uint64_t i = 0 ; i < nRuns ; i++) {
+            CMemArchive archive;
+            archive.open(BLOCK_FILE);
+        }
+        double openTime = qbNow() - start;
+        removeFile(BLOCK_FILE);
+
+        cout << padRight(codecName(codecs[c]), 8) << size << " bytes per block";
+        cout << " (" << (size * 100 / rawSize) << "%)";
+        cout << " same: " << (format == block.Format() ? "true" : "false") << "\n";
+        // Timings vary from machine to machine, so they are not part of the test's output
+        if (!isTestMode()) {
+            cerr << "\twrite: " << (writeTime / nRuns * 1000.) << " ms per block";
+            cerr << "  read: " << (readTime / nRuns * 1000.) << " ms per block";
+            cerr << "  open and decode: " << (openTime / nRuns * 1000.) << " ms per block, ";
+            cerr << (rawSize * nRuns / openTime / 1024. / 1024.) << " MB/s of blocks\n";
+        }
+    }
+    setBlockCodec(CODEC_NONE);
+}
+
+//------------------------------------------------------------------------
+int main(int argc, const char *argv[]) {
+
+    etherlib_init();
+
+    COptions options;
+    options.minArgs = 0;
+    if (!options.prepareArguments(argc, argv))
+        return 0;
+
+    while (!options.commandList.empty()) {
+        SFString command = nextTokenClear(options.commandList, '\n');
+        if (!options.parseArguments(command))
+            return 0;
+
+        if (options.testNum == 0) {
+            LOAD_TEST(TestCodecs);
+
+        } else if (options.testNum == 1) {
+            testSpeed();
+        }
+    }
+
+    return RUN_ALL_TESTS();
+}
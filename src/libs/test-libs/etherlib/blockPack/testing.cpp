@@ -0,0 +1,176 @@
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include "etherlib.h"
+
+// The test works in a cache of its own and never touches the configured one
+#define CACHE_PATH "./blockPack_test/"
+#define FIRST      4500000
+#define N_BLOCKS   10
+
+//--------------------------------------------------------------
+blknum_t blockAt(uint32_t i) {
+    return FIRST + i * 97;
+}
+
+//--------------------------------------------------------------
+void makeBlock(CBlock& block, blknum_t bn) {
+    block = CBlock();
+    block.blockNumber = bn;
+    block.hash        = "0x" + padLeft(asStringU(bn), 64, 'c');
+    block.timestamp   = 1600000000 + (timestamp_t)bn;
+    for (uint32_t t = 0 ; t < bn % 3 ; t++) {
+        CTransaction *trans = &block.transactions[t];
+        trans->hash             = "0x" + padLeft(asStringU(bn * 10 + t), 64, 'd');
+        trans->blockNumber      = bn;
+        trans->transactionIndex = t;
+        trans->timestamp        = block.timestamp;
+        trans->input            = "0x" + SFString('2', 8 * (t + 1));
+        trans->receipt.status   = 1;  // as reading any block past byzantium leaves it
+    }
+}
+
+//--------------------------------------------------------------
+bool allAsWritten(void) {
+    bool ret = true;
+    for (uint32_t i = 0 ; i < N_BLOCKS ; i++) {
+        CBlock expected, block;
+        makeBlock(expected, blockAt(i));
+        ret = ret && readBlockFromBinary(block, getBinaryFilename(blockAt(i))) && block.Format() == expected.Format();
+    }
+    return ret;
+}
+
+//--------------------------------------------------------------
+uint32_t nFiles(void) {
+    uint32_t ret = 0;
+    for (uint32_t i = 0 ; i < N_BLOCKS ; i++)
+        if (fileExists(getBinaryFilename(blockAt(i))))
+            ret++;
+    return ret;
+}
+
+//--------------------------------------------------------------
+uint32_t nListed(void) {
+    SFUintArray blocks;
+    listCachedBlocks(FIRST / 100000, blocks);
+    return blocks.getCount();
+}
+
+//--------------------------------------------------------------
+void cleanUp(void) {
+    for (uint32_t i = 0 ; i < N_BLOCKS ; i++)
+        removeFile(getBinaryFilename(blockAt(i)));
+    removeFile(getPackFilename(FIRST));
+    removeFile(getPackFilename(FIRST) + ".tmp");
+    rmdir(getBinaryPath(FIRST).c_str());
+    SFString folder = getBinaryPath(FIRST);
+    for (uint32_t level = 0 ; level < 2 ; level++) {
+        folder = folder.substr(0, folder.length() - 3);
+        rmdir(folder.c_str());
+    }
+    removeFolder(blockFolder);
+    removeFolder(CACHE_PATH);
+    forgetBlockPacks();
+}
+
+//--------------------------------------------------------------
+int main(int argc, const char *argv[]) {
+
+    etherlib_init();
+
+    CDefaultOptions options;
+    options.minArgs = 0;
+    if (!options.prepareArguments(argc, argv))
+        return 0;
+
+    setBlockCachePath(CACHE_PATH);
+    cleanUp();
+    for (uint32_t i = 0 ; i < N_BLOCKS ; i++) {
+        CBlock block;
+        makeBlock(block, blockAt(i));
+        writeBlockToBinary(block, getBinaryFilename(blockAt(i)));
+    }
+    cout << "pack file: " << getPackFilename(FIRST).substr(blockFolder.length()) << "\n";
+    cout << "block files: " << nFiles() << "\n";
+    uint64_t nBytes = 0;
+    for (uint32_t i = 0 ; i < N_BLOCKS ; i++)
+        nBytes += fileSize(getBinaryFilename(blockAt(i)));
+
+    SFUintArray groups;
+    listPackGroups(groups);
+    bool listed = false;
+    for (uint32_t i = 0 ; i < groups.getCount() ; i++)
+        listed = listed || (groups[i] == FIRST);
+    cout << "group listed: " << (listed ? "true" : "false") << "\n";
+
+    // Packing removes the block files, and the blocks read the same from the pack
+    uint32_t nPacked = 0;
+    cout << "packed: " << (packBlocks(FIRST + 5, false, nPacked) ? "true" : "false") << " " << nPacked << "\n";
+    cout << "block files after: " << nFiles() << "\n";
+    cout << "folder removed: " << (folderExists(getBinaryPath(FIRST)) ? "false" : "true") << "\n";
+    cout << "read from the pack: " << (allAsWritten() ? "true" : "false") << "\n";
+    cout << "in cache: " << (blockInCache(blockAt(3)) ? "true" : "false") << "\n";
+    cout << "not in cache: " << (blockInCache(blockAt(3) + 1) ? "true" : "false") << "\n";
+    cout << "listed: " << nListed() << "\n";
+    cout << "pack is its table and the blocks: " << (fileSize(getPackFilename(FIRST)) == sizeof(CBlockPack::CHeader) + nBytes ? "true" : "false") << "\n";
+
+    CBlockPack pack;
+    cout << "opened: " << (pack.open(getPackFilename(FIRST)) ? "true" : "false") << " first: " << pack.firstBlock() << "\n";
+    cout << "has " << blockAt(2) << ": " << (pack.hasBlock(blockAt(2)) ? "true" : "false") << "\n";
+    cout << "has " << blockAt(2) + 1 << ": " << (pack.hasBlock(blockAt(2) + 1) ? "true" : "false") << "\n";
+    pack.close();
+
+    // Writing a packed block takes it out of the pack
+    CBlock changed;
+    makeBlock(changed, blockAt(4));
+    changed.timestamp = 42;
+    writeBlockToBinary(changed, getBinaryFilename(blockAt(4)));
+    CBlock block;
+    readBlockFromBinary(block, getBinaryFilename(blockAt(4)));
+    cout << "reads the new block: " << (block.timestamp == 42 ? "true" : "false") << "\n";
+    cout << "still in cache: " << (blockInCache(blockAt(4)) ? "true" : "false") << "\n";
+    pack.open(getPackFilename(FIRST));
+    cout << "dropped from pack: " << (pack.hasBlock(blockAt(4)) ? "false" : "true") << "\n";
+    pack.close();
+
+    // Packing again folds it back in, and a kept file is listed once
+    cout << "packed again: " << (packBlocks(FIRST, true, nPacked) ? "true" : "false") << " " << nPacked << "\n";
+    pack.open(getPackFilename(FIRST));
+    cout << "back in pack: " << (pack.hasBlock(blockAt(4)) ? "true" : "false") << "\n";
+    pack.close();
+    block = CBlock();
+    readBlockFromBinary(block, getBinaryFilename(blockAt(4)));
+    cout << "reads it from the pack: " << (block.timestamp == 42 ? "true" : "false") << "\n";
+    cout << "listed once: " << nListed() << "\n";
+
+    // A pack made again by another process is found once the block's file is gone
+    SFString copyName = getPackFilename(FIRST) + ".copy";
+    copyFile(getPackFilename(FIRST), copyName);
+    writeBlockToBinary(changed, getBinaryFilename(blockAt(6)));
+    cout << "dropped before: " << (isBlockInPack(blockAt(6)) ? "false" : "true") << "\n";
+    rename(copyName.c_str(), getPackFilename(FIRST).c_str());
+    removeFile(getBinaryFilename(blockAt(6)));
+    block = CBlock();
+    readBlockFromBinary(block, getBinaryFilename(blockAt(6)));
+    cout << "reads the other pack: " << (block.blockNumber == blockAt(6) ? "true" : "false") << "\n";
+
+    // A damaged pack is ignored
+    stringToAsciiFile(getPackFilename(FIRST), "not a pack");
+    forgetBlockPacks();
+    cout << "damaged pack opened: " << (pack.open(getPackFilename(FIRST)) ? "true" : "false") << "\n";
+    cout << "file still read: " << (blockInCache(blockAt(4)) ? "true" : "false") << "\n";
+    cout << "packed block gone: " << (blockInCache(blockAt(5)) ? "true" : "false") << "\n";
+
+    cleanUp();
+    return 0;
+}
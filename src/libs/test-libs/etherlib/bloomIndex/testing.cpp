@@ -0,0 +1,123 @@
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include "etherlib.h"
+
+#define INDEX_FILE   "./bloomIndex_test.bin"
+#define CRASH_FILE   "./bloomIndex_crash.bin"
+#define FIRST_BLOCK  1
+#define MID_BLOCK    2500  // on the same step as FIRST_BLOCK
+#define LAST_BLOCK   6000
+#define BLOCK_STEP   7
+
+//--------------------------------------------------------------
+// Some blocks have more than one bloom. Each bloom is made from the block number and its position.
+void makeTestBlooms(blknum_t bn, SFBloomArray& blooms) {
+    blooms.Clear();
+    uint32_t nBlooms = 1 + (uint32_t)(bn % 3);
+    for (uint32_t i = 0 ; i < nBlooms ; i++)
+        blooms[i] = makeBloom("0x" + padLeft(asStringU(bn * 10 + i), 40, '0'));
+}
+
+//--------------------------------------------------------------
+bool appendBlocks(CBloomIndexWriter& writer, blknum_t first, blknum_t last) {
+    for (blknum_t bn = first ; bn < last ; bn += BLOCK_STEP) {
+        SFBloomArray blooms;
+        makeTestBlooms(bn, blooms);
+        if (!writer.append(bn, blooms))
+            return false;
+    }
+    return true;
+}
+
+//--------------------------------------------------------------
+// Counts the blocks in [first, last) whose blooms read back as they were written, and the blocks
+// in between that correctly have none
+uint64_t nMatched(const CBloomIndex& index, blknum_t first, blknum_t last) {
+    uint64_t n = 0;
+    for (blknum_t bn = first ; bn < last ; bn++) {
+        SFBloomArray blooms;
+        bool found = index.getBlooms(bn, blooms);
+        if ((bn - FIRST_BLOCK) % BLOCK_STEP) {
+            n += !found;
+            continue;
+        }
+        SFBloomArray expected;
+        makeTestBlooms(bn, expected);
+        bool same = found && blooms.getCount() == expected.getCount();
+        for (uint32_t i = 0 ; same && i < blooms.getCount() ; i++)
+            same = (blooms[i] == expected[i]);
+        n += same;
+    }
+    return n;
+}
+
+//--------------------------------------------------------------
+int main(int argc, const char *argv[]) {
+
+    etherlib_init();
+
+    CDefaultOptions options;
+    options.minArgs = 0;
+    if (!options.prepareArguments(argc, argv))
+        return 0;
+
+    removeFile(INDEX_FILE);
+    removeFile(CRASH_FILE);
+
+    // Write part of the index
+    CBloomIndexWriter writer;
+    writer.open(INDEX_FILE);
+    cout << "first part written: " << (appendBlocks(writer, FIRST_BLOCK, MID_BLOCK) ? "true" : "false") << "\n";
+    writer.close();
+
+    CBloomIndex before;
+    before.open(INDEX_FILE);
+    cout << "before: last block: " << before.lastBlock() << " records: " << before.nRecords() << "\n";
+
+    // Re-open it and append the rest. Until the writer is closed, new readers don't trust the
+    // index, and a reader that was already open still sees what it saw before.
+    writer.open(INDEX_FILE);
+    cout << "going back: " << (writer.append(MID_BLOCK - 10, SFBloomArray()) ? "true" : "false") << "\n";
+    cout << "second part written: " << (appendBlocks(writer, MID_BLOCK, LAST_BLOCK) ? "true" : "false") << "\n";
+    copyFile(INDEX_FILE, CRASH_FILE);  // as if the writer died here
+
+    CBloomIndex during;
+    cout << "open while writing: " << (during.open(INDEX_FILE) ? "true" : "false") << "\n";
+    cout << "before, while writing: matched: " << nMatched(before, 0, LAST_BLOCK) << " of " << (LAST_BLOCK) << "\n";
+    writer.close();
+    cout << "before, after writing: matched: " << nMatched(before, 0, LAST_BLOCK) << " of " << (LAST_BLOCK) << "\n";
+    before.close();
+
+    CBloomIndex after;
+    after.open(INDEX_FILE);
+    cout << "after: last block: " << after.lastBlock() << " records: " << after.nRecords() << "\n";
+    cout << "after: matched: " << nMatched(after, 0, LAST_BLOCK) << " of " << (LAST_BLOCK) << "\n";
+    cout << "after: first record at or after " << MID_BLOCK << ": " << after[after.findFirst(MID_BLOCK)].blockNum << "\n";
+    after.close();
+
+    // The next writer picks up from the last finished close()
+    CBloomIndex crashed;
+    cout << "open after a crash: " << (crashed.open(CRASH_FILE) ? "true" : "false") << "\n";
+    CBloomIndexWriter recovery;
+    recovery.open(CRASH_FILE);
+    cout << "recovered: last block: " << recovery.lastBlock() << "\n";
+    cout << "recovery written: " << (appendBlocks(recovery, MID_BLOCK, LAST_BLOCK) ? "true" : "false") << "\n";
+    recovery.close();
+    crashed.open(CRASH_FILE);
+    cout << "recovered: records: " << crashed.nRecords() << " matched: " << nMatched(crashed, 0, LAST_BLOCK) << " of " << (LAST_BLOCK) << "\n";
+    crashed.close();
+
+    removeFile(INDEX_FILE);
+    removeFile(CRASH_FILE);
+    return 0;
+}
@@ -0,0 +1,146 @@
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include "etherlib.h"
+
+#define CACHE_PATH "./cacheWriter_test/"
+#define N_BLOCKS   500
+
+//--------------------------------------------------------------
+SFString folderFor(uint32_t n) {
+    return CACHE_PATH + padLeft(asStringU(n), 3, '0') + "/";
+}
+
+//--------------------------------------------------------------
+SFString fileFor(blknum_t bn) {
+    return folderFor((uint32_t)(bn / 100)) + padLeft(asStringU(bn), 9, '0') + ".bin";
+}
+
+//--------------------------------------------------------------
+void makeBlock(CBlock& block, blknum_t bn) {
+    block.blockNumber = bn;
+    block.hash        = "0x" + padLeft(asStringU(bn), 64, 'b');
+    block.timestamp   = 1500000000 + (timestamp_t)bn;
+    for (uint32_t t = 0 ; t < bn % 4 ; t++) {
+        CTransaction *trans = &block.transactions[t];
+        trans->hash             = "0x" + padLeft(asStringU(bn * 10 + t), 64, 'a');
+        trans->blockNumber      = bn;
+        trans->transactionIndex = t;
+        trans->timestamp        = block.timestamp;
+        trans->input            = "0x" + SFString('1', 8 * (t + 1));
+    }
+}
+
+//--------------------------------------------------------------
+bool sameAsWritten(blknum_t bn) {
+    CBlock expected, block;
+    makeBlock(expected, bn);
+    return readBlockFromBinary(block, fileFor(bn)) && block.Format() == expected.Format();
+}
+
+//--------------------------------------------------------------
+uint32_t countFiles(const SFString& ending) {
+    uint32_t ret = 0;
+    for (blknum_t bn = 0 ; bn < N_BLOCKS ; bn++)
+        if (fileExists(fileFor(bn) + ending))
+            ret++;
+    return ret;
+}
+
+//--------------------------------------------------------------
+void cleanUp(void) {
+    for (blknum_t bn = 0 ; bn < N_BLOCKS ; bn++)
+        removeFile(fileFor(bn));
+    for (uint32_t f = 0 ; f < N_BLOCKS / 100 ; f++)
+        removeFolder(folderFor(f));
+    removeFile(CACHE_PATH "notAFolder");
+    removeFolder(CACHE_PATH);
+}
+
+//--------------------------------------------------------------
+int main(int argc, const char *argv[]) {
+
+    etherlib_init();
+
+    CDefaultOptions options;
+    options.minArgs = 0;
+    if (!options.prepareArguments(argc, argv))
+        return 0;
+
+    cleanUp();
+
+    // A block that was just queued reads back as written
+    CBlock block;
+    makeBlock(block, 0);
+    queueBlockToBinary(block, fileFor(0));
+    cout << "read what was queued: " << (sameAsWritten(0) ? "true" : "false") << "\n";
+
+    for (blknum_t bn = 1 ; bn < N_BLOCKS ; bn++) {
+        CBlock next;
+        makeBlock(next, bn);
+        queueBlockToBinary(next, fileFor(bn));
+    }
+    cout << "flushed: " << (flushCacheWrites() ? "true" : "false") << "\n";
+
+    bool allSame = true;
+    for (blknum_t bn = 0 ; bn < N_BLOCKS ; bn++)
+        allSame = allSame && sameAsWritten(bn);
+    cout << "blocks: " << countFiles("") << "\n";
+    cout << "temp files: " << countFiles(".tmp") << "\n";
+    cout << "all the same: " << (allSame ? "true" : "false") << "\n";
+    CCacheWriter *writer = getCacheWriter();
+    cout << "written: " << writer->nWritten() << "\n";
+    cout << "synced in groups: " << (writer->nSyncs() < writer->nWritten() / 10 ? "true" : "false") << "\n";
+
+    // Writing a block again replaces it
+    makeBlock(block, 7);
+    block.timestamp = 42;
+    queueBlockToBinary(block, fileFor(7));
+    CBlock replaced;
+    readBlockFromBinary(replaced, fileFor(7));
+    cout << "replaced: " << (replaced.timestamp == 42 ? "true" : "false") << "\n";
+    makeBlock(block, 7);
+    queueBlockToBinary(block, fileFor(7));
+    flushCacheWrites();
+
+    // A small queue makes the caller wait but loses nothing
+    {
+        CCacheWriter small(2, 3, 10);
+        for (blknum_t bn = 0 ; bn < 50 ; bn++) {
+            CMemArchive archive(WRITING_ARCHIVE);
+            CBlock next;
+            makeBlock(next, bn);
+            next.SerializeC(archive);
+            std::vector<char> bytes;
+            archive.takeBuffer(bytes);
+            small.write(fileFor(bn), bytes);
+        }
+        cout << "small queue flushed: " << (small.flush() ? "true" : "false") << "\n";
+        cout << "small queue written: " << small.nWritten() << "\n";
+    }
+    allSame = true;
+    for (blknum_t bn = 0 ; bn < N_BLOCKS ; bn++)
+        allSame = allSame && sameAsWritten(bn);
+    cout << "still the same: " << (allSame ? "true" : "false") << "\n";
+
+    // A file that can't be written is reported when flushing
+    stringToAsciiFile(CACHE_PATH "notAFolder", "");
+    queueBlockToBinary(block, CACHE_PATH "notAFolder/000000007.bin");
+    bool flushed = flushCacheWrites();
+    cout << "flushed a bad file: " << (flushed ? "true" : "false") << "\n";
+    cout << "failed: " << writer->nFailed() << "\n";
+    cout << "flushed after: " << (flushCacheWrites() ? "true" : "false") << "\n";
+
+    cleanUp();
+    etherlib_cleanup();
+    return 0;
+}
@@ -0,0 +1,173 @@
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include "etherlib.h"
+
+#define CHUNK_FILE "./columnCache_test.bin"
+#define CACHE_PATH "./columnCache_test/"
+#define N_BLOCKS   60
+
+//--------------------------------------------------------------
+SFString makeHex(uint64_t seed, uint32_t width) {
+    SFString ret = toLower(padLeft(SFString(to_hex(SFUintBN((uint64_t)(seed * 2654435761ULL + 17))).c_str()), width * 2, '0'));
+    return "0x" + ret.substr(ret.length() - width * 2);
+}
+
+//--------------------------------------------------------------
+void makeBlock(CBlock& block, uint32_t i) {
+    block = CBlock();
+    block.blockNumber = 1000 + i * 7;
+    block.timestamp   = 1438270000 + i * 15;
+    block.gasLimit    = 5000 + i;
+    block.gasUsed     = 21000 * (i % 4);
+    block.difficulty  = 17171717 + i;
+    block.price       = 1.5 * i;
+    block.finalized   = (i % 2);
+    block.hash        = makeHex(i, 32);
+    block.parentHash  = makeHex(i + 1000, 32);
+    block.miner       = makeHex(i % 3, 20);
+    for (uint32_t t = 0 ; t < i % 4 ; t++) {
+        CTransaction *trans = &block.transactions[t];
+        trans->hash             = makeHex(i * 100 + t, 32);
+        trans->blockHash        = block.hash;
+        trans->blockNumber      = block.blockNumber;
+        trans->transactionIndex = t;
+        trans->nonce            = i + t;
+        trans->timestamp        = (t ? block.timestamp : 0);
+        trans->from             = makeHex(t, 20);
+        trans->to               = (t == 2 ? "0x" : makeHex(t + 50, 20));
+        trans->value            = str2BigUint(SFString("1000000000000000000")) * SFUintBN((uint64_t)(i + t));
+        trans->gas              = 90000;
+        trans->gasPrice         = 20000000000ULL;
+        trans->input            = (t == 1 ? "0xa9059cbb" + makeHex(i, 32).substr(2) : "0x");
+        trans->isError          = (i % 5 == 0);
+        trans->receipt.gasUsed  = 21000;
+        trans->receipt.status   = (t == 2 ? 1 : NO_STATUS);
+        if (t == 2)
+            trans->receipt.contractAddress = makeHex(i + 7, 20);
+    }
+    for (uint32_t t = 0 ; t < block.transactions.getCount() ; t++) {
+        block.transactions[t].pBlock = &block;
+        block.transactions[t].finishParse();
+    }
+}
+
+//--------------------------------------------------------------
+int main(int argc, const char *argv[]) {
+
+    etherlib_init();
+
+    CDefaultOptions options;
+    options.minArgs = 0;
+    if (!options.prepareArguments(argc, argv))
+        return 0;
+
+    CColumnChunkWriter writer(0);
+    uint64_t totalGas = 0;
+    for (uint32_t i = 0 ; i < N_BLOCKS ; i++) {
+        CBlock block;
+        makeBlock(block, i);
+        if (i == 10)
+            block.transactions[0].value = str2BigUint(SFString('9', 100));  // can't be stored exactly
+        if (i == 11)
+            block.transactions[0].receipt.logs[0].address = makeHex(1, 20);  // logs are not stored
+        totalGas += block.gasUsed;
+        writer.addBlock(block);
+    }
+    CBlock outOfOrder;
+    makeBlock(outOfOrder, 3);
+    cout << "out of order block added: " << (writer.addBlock(outOfOrder) ? "true" : "false") << "\n";
+    cout << "wrote chunk: " << (writer.write(CHUNK_FILE) ? "true" : "false") << "\n";
+
+    CColumnChunk chunk;
+    if (!chunk.open(CHUNK_FILE)) {
+        cout << "Could not open the chunk\n";
+        return 0;
+    }
+    cout << "nBlocks: " << chunk.nBlocks() << " nTrans: " << chunk.nTrans() << "\n";
+
+    // Every block but the two that could not be stored comes back exactly as it went in
+    uint32_t nSame = 0, nFallback = 0;
+    for (uint32_t i = 0 ; i < N_BLOCKS ; i++) {
+        CBlock expected, block;
+        makeBlock(expected, i);
+        uint64_t row = chunk.findBlock(expected.blockNumber);
+        if (!chunk.readBlock(block, row)) {
+            cout << "block " << expected.blockNumber << " must be read from its own file\n";
+            nFallback++;
+        } else if (block.Format() == expected.Format()) {
+            nSame++;
+        }
+    }
+    cout << "blocks read back exactly: " << nSame << " fallbacks: " << nFallback << "\n";
+    cout << "missing block found: " << (chunk.findBlock(1001) != NOPOS ? "true" : "false") << "\n";
+
+    // Scanning one column touches nothing else
+    uint64_t scanned = 0;
+    const uint64_t *gasUsed = chunk.column<uint64_t>(COL_GASUSED);
+    for (uint64_t row = 0 ; row < chunk.nBlocks() ; row++)
+        scanned += gasUsed[row];
+    cout << "gasUsed column total matches: " << (scanned == totalGas ? "true" : "false") << "\n";
+
+    // Projection fills only what was asked for
+    CBlock projected;
+    chunk.readBlock(projected, chunk.findBlock(1000 + 7 * 7), COLUMN_BIT(COL_TIMESTAMP) | COLUMN_BIT(COL_TX_FROM));
+    cout << "projected: " << projected.blockNumber << " " << projected.timestamp << " [" << projected.hash << "] "
+            << projected.transactions.getCount() << " " << projected.transactions[2].from << " ["
+            << projected.transactions[2].hash << "]\n";
+
+    // The visible fields decide whether the columnar cache can be used at all
+    uint64_t columns = 0;
+    cout << "default fields supported: " << (getVisibleColumns(columns) ? "true" : "false") << "\n";
+    HIDE_FIELD(CReceipt, "logs");
+    cout << "without logs supported: " << (getVisibleColumns(columns) ? "true" : "false")
+            << " all columns: " << (columns == ALL_COLUMNS ? "true" : "false") << "\n";
+    HIDE_ALL_FIELDS(CBlock);
+    UNHIDE_FIELD(CBlock, "gasUsed");
+    getVisibleColumns(columns);
+    cout << "gasUsed only: " << (columns == (COLUMN_BIT(COL_BLOCKNUMBER) | COLUMN_BIT(COL_BLOCKFLAGS) | COLUMN_BIT(COL_GASUSED)) ? "true" : "false") << "\n";
+
+    chunk.close();
+    removeFile(CHUNK_FILE);
+
+    // A block written to the cache again is read from its own file, not from its chunk
+    setBlockCachePath(CACHE_PATH);
+    for (uint32_t i = 0 ; i < N_BLOCKS ; i++) {
+        CBlock block;
+        makeBlock(block, i);
+        writeBlockToBinary(block, getBinaryFilename(block.blockNumber));
+    }
+    usleep(20000);  // so the blocks are older than the chunk
+    uint64_t nBuilt = 0;
+    buildColumnChunk(0, nBuilt);
+    CBlock fromColumns, changed;
+    cout << "built: " << nBuilt << " read from columns: " << (readBlockFromColumns(fromColumns, 1000 + 4 * 7) ? "true" : "false") << "\n";
+    makeBlock(changed, 4);
+    changed.timestamp = 42;
+    writeBlockToBinary(changed, getBinaryFilename(changed.blockNumber));
+    cout << "written again read from columns: " << (readBlockFromColumns(fromColumns, changed.blockNumber) ? "true" : "false") << "\n";
+    cout << "others still read from columns: " << (readBlockFromColumns(fromColumns, 1000 + 5 * 7) ? "true" : "false") << "\n";
+    clearColumnCache();
+
+    SFUintArray cached;
+    listCachedBlocks(0, cached);
+    for (uint32_t i = 0 ; i < cached.getCount() ; i++)
+        removeFile(getBinaryFilename(cached[i]));
+    for (uint32_t i = 0 ; i < cached.getCount() ; i++)
+        removeFolder(getBinaryPath(cached[i]));
+    removeFolder(blockCachePath("blocks/00/00/"));
+    removeFolder(blockCachePath("blocks/00/"));
+    removeFolder(blockFolder);
+    removeFolder(columnFolder);
+    removeFolder(CACHE_PATH);
+    return 0;
+}
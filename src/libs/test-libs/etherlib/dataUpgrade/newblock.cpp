@@ -24,6 +24,32 @@ IMPLEMENT_NODE(CNewBlock, CBaseNode);
 extern SFString nextNewblockChunk(const SFString& fieldIn, const void *dataPtr);
 static SFString nextNewblockChunk_custom(const SFString& fieldIn, const void *dataPtr);
 
+//---------------------------------------------------------------------------
+// makeClass chose the seed so that no two of these names share a slot in the table
+enum {
+    FLD_GASLIMIT = 1,
+    FLD_GASUSED,
+    FLD_HASH,
+    FLD_BLOCKNUMBER,
+    FLD_PARENTHASH,
+    FLD_MINER,
+    FLD_DIFFICULTY,
+    FLD_PRICE,
+    FLD_FINALIZED,
+    FLD_TIMESTAMP,
+    FLD_TRANSACTIONS,
+    FLD_TRANSACTIONSCNT,
+};
+static const char *newblockFieldNames[] = {
+    "gasLimit", "gasUsed", "hash", "blockNumber", "parentHash", "miner", "difficulty", "price",
+    "finalized", "timestamp", "transactions", "transactionsCnt",
+};
+static const uint8_t newblockFieldSlots[] = {
+    1, 0, 0, 6, 12, 0, 11, 0, 0, 7, 0, 0, 4, 9, 3, 8,
+    0, 0, 0, 0, 10, 0, 0, 0, 0, 0, 0, 0, 5, 0, 2, 0,
+};
+static const CFieldTable newblockFieldTable(newblockFieldNames, 12, newblockFieldSlots, 32, 1);
+
 //---------------------------------------------------------------------------
 void CNewBlock::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr) const {
     if (!m_showing)
@@ -34,12 +60,10 @@ void CNewBlock::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr
         return;
     }
 
-    SFString fmt = fmtIn;
-    if (handleCustomFormat(ctx, fmt, dataPtr))
+    if (handleCustomFormat(ctx, fmtIn, dataPtr))
         return;
 
-    while (!fmt.empty())
-        ctx << getNextChunk(fmt, nextNewblockChunk, this);
+    formatChunks(ctx, fmtIn, nextNewblockChunk, this);
 }
 
 //---------------------------------------------------------------------------
@@ -75,50 +99,62 @@ bool CNewBlock::setValueByName(const SFString& fieldName, const SFString& fieldV
     }
     // EXISTING_CODE
 
-    switch (tolower(fieldName[0])) {
-        case 'b':
-            if ( fieldName % "blockNumber" ) { blockNumber = toUnsigned(fieldValue); return true; }
-            break;
-        case 'd':
-            if ( fieldName % "difficulty" ) { difficulty = toUnsigned(fieldValue); return true; }
-            break;
-        case 'f':
-            if ( fieldName % "finalized" ) { finalized = toBool(fieldValue); return true; }
-            break;
-        case 'g':
-            if ( fieldName % "gasLimit" ) { gasLimit = toGas(fieldValue); return true; }
-            if ( fieldName % "gasUsed" ) { gasUsed = toGas(fieldValue); return true; }
-            break;
-        case 'h':
-            if ( fieldName % "hash" ) { hash = toHash(fieldValue); return true; }
-            break;
-        case 'm':
-            if ( fieldName % "miner" ) { miner = toAddress(fieldValue); return true; }
-            break;
-        case 'p':
-            if ( fieldName % "parentHash" ) { parentHash = toHash(fieldValue); return true; }
-            if ( fieldName % "price" ) { price = toDouble(fieldValue); return true; }
-            break;
-        case 't':
-            if ( fieldName % "timestamp" ) { timestamp = toTimestamp(fieldValue); return true; }
-            if ( fieldName % "transactions" ) {
-                char *p = (char *)fieldValue.c_str();
-                while (p && *p) {
-                    CTransaction item;
-                    uint32_t nFields = 0;
-                    p = item.parseJson(p, nFields);
-                    if (nFields)
-                        transactions[transactions.getCount()] = item;
-                }
-                return true;
+    switch (newblockFieldTable.find(fieldName)) {
+        case FLD_GASLIMIT: gasLimit = toGas(fieldValue); return true;
+        case FLD_GASUSED: gasUsed = toGas(fieldValue); return true;
+        case FLD_HASH: hash = toHash(fieldValue); return true;
+        case FLD_BLOCKNUMBER: blockNumber = toUnsigned(fieldValue); return true;
+        case FLD_PARENTHASH: parentHash = toHash(fieldValue); return true;
+        case FLD_MINER: miner = toAddress(fieldValue); return true;
+        case FLD_DIFFICULTY: difficulty = toUnsigned(fieldValue); return true;
+        case FLD_PRICE: price = toDouble(fieldValue); return true;
+        case FLD_FINALIZED: finalized = toBool(fieldValue); return true;
+        case FLD_TIMESTAMP: timestamp = toTimestamp(fieldValue); return true;
+        case FLD_TRANSACTIONS: {
+            char *p = (char *)fieldValue.c_str();
+            while (p && *p) {
+                CTransaction item;
+                uint32_t nFields = 0;
+                p = item.parseJson(p, nFields);
+                if (nFields)
+                    transactions[transactions.getCount()] = item;
             }
-            break;
+            return true;
+        }
         default:
             break;
     }
     return false;
 }
 
+//---------------------------------------------------------------------------------------------------
+bool CNewBlock::parseTape(CJsonTape& tape, uint32_t node) {
+    if (!tape.isObject(node))
+        return false;
+
+    // Objects are parsed in place from the tape. Anything else goes to setValueByName
+    for (uint32_t key = tape.firstMember(node) ; key != JSON_NOTOKEN ; key = tape.nextMember(node, key)) {
+        uint32_t val = key + 1;
+        string_view_q name = tape.getView(key);
+        switch (newblockFieldTable.find(name.data(), name.length())) {
+            case FLD_TRANSACTIONS:
+                if (tape.isArrayOf(val, JSON_OBJECT)) {
+                    for (uint32_t item = tape.firstItem(val) ; item != JSON_NOTOKEN ; item = tape.nextItem(val, item)) {
+                        if (tape.firstMember(item) != JSON_NOTOKEN)
+                            transactions[transactions.getCount()].parseTape(tape, item);
+                    }
+                    continue;
+                }
+                break;
+            default:
+                break;
+        }
+        setValueFromTape(tape, key);
+    }
+    finishParse();
+    return true;
+}
+
 //---------------------------------------------------------------------------------------------------
 void CNewBlock::finishParse() {
     // EXISTING_CODE
@@ -224,7 +260,7 @@ SFString nextNewblockChunk_custom(const SFString& fieldIn, const void *dataPtr)
                     if (!cnt) return EMPTY;
                     SFString ret;
                     for (uint32_t i = 0 ; i < cnt ; i++) {
-                        ret += newp->transactions[i].hash;
+                        ret += newp->transactions[i].hash.asString();
                         ret += ((i < cnt-1) ? ",\n" : "\n");
                     }
                     return ret;
@@ -274,7 +310,7 @@ bool CNewBlock::readBackLevel(SFArchive& archive) {
         CBlock upgrade;uint32_t unused;
         queryBlock(upgrade, asStringU(blockNumber), false, false, unused);
         getCurlContext()->provider = save;
-        miner = upgrade.miner;
+        miner = fromAddress(upgrade.miner);
         difficulty = upgrade.difficulty;
         price = 0.0;
         finishParse();
@@ -305,44 +341,29 @@ SFString CNewBlock::getValueByName(const SFString& fieldName) const {
         return ret;
 
     // Return field values
-    switch (tolower(fieldName[0])) {
-        case 'b':
-            if ( fieldName % "blockNumber" ) return asStringU(blockNumber);
-            break;
-        case 'd':
-            if ( fieldName % "difficulty" ) return asStringU(difficulty);
-            break;
-        case 'f':
-            if ( fieldName % "finalized" ) return asString(finalized);
-            break;
-        case 'g':
-            if ( fieldName % "gasLimit" ) return fromGas(gasLimit);
-            if ( fieldName % "gasUsed" ) return fromGas(gasUsed);
-            break;
-        case 'h':
-            if ( fieldName % "hash" ) return fromHash(hash);
-            break;
-        case 'm':
-            if ( fieldName % "miner" ) return fromAddress(miner);
-            break;
-        case 'p':
-            if ( fieldName % "parentHash" ) return fromHash(parentHash);
-            if ( fieldName % "price" ) return fmtFloat(price);
-            break;
-        case 't':
-            if ( fieldName % "timestamp" ) return fromTimestamp(timestamp);
-            if ( fieldName % "transactions" || fieldName % "transactionsCnt" ) {
-                uint32_t cnt = transactions.getCount();
-                if (fieldName.endsWith("Cnt"))
-                    return asStringU(cnt);
-                if (!cnt) return "";
-                SFString retS;
-                for (uint32_t i = 0 ; i < cnt ; i++) {
-                    retS += transactions[i].Format();
-                    retS += ((i < cnt - 1) ? ",\n" : "\n");
-                }
-                return retS;
+    switch (newblockFieldTable.find(fieldName)) {
+        case FLD_GASLIMIT: return fromGas(gasLimit);
+        case FLD_GASUSED: return fromGas(gasUsed);
+        case FLD_HASH: return fromHash(hash);
+        case FLD_BLOCKNUMBER: return asStringU(blockNumber);
+        case FLD_PARENTHASH: return fromHash(parentHash);
+        case FLD_MINER: return fromAddress(miner);
+        case FLD_DIFFICULTY: return asStringU(difficulty);
+        case FLD_PRICE: return fmtFloat(price);
+        case FLD_FINALIZED: return asString(finalized);
+        case FLD_TIMESTAMP: return fromTimestamp(timestamp);
+        case FLD_TRANSACTIONS: {
+            uint32_t cnt = transactions.getCount();
+            if (!cnt) return "";
+            SFString retS;
+            for (uint32_t i = 0 ; i < cnt ; i++) {
+                retS += transactions[i].Format();
+                retS += ((i < cnt - 1) ? ",\n" : "\n");
             }
+            return retS;
+        }
+        case FLD_TRANSACTIONSCNT: return asStringU(transactions.getCount());
+        default:
             break;
     }
 
@@ -374,10 +395,10 @@ const CBaseNode *CNewBlock::getObjectAt(const SFString& fieldName, uint32_t inde
 CNewBlock::CNewBlock(const CBlock& block) {
     gasLimit = block.gasLimit;
     gasUsed = block.gasUsed;
-    hash = block.hash;
+    hash = block.hash.asString();
 //    logsBloom = block.logsBloom;
     blockNumber = block.blockNumber;
-    parentHash = block.parentHash;
+    parentHash = block.parentHash.asString();
     timestamp = block.timestamp;
     transactions = block.transactions;
     miner = "0x0";
@@ -50,6 +50,7 @@ public:
 
     DECLARE_NODE(CNewBlock);
 
+    bool parseTape(CJsonTape& tape, uint32_t node) override;
     const CBaseNode *getObjectAt(const SFString& fieldName, uint32_t index) const override;
 
     // EXISTING_CODE
@@ -24,6 +24,24 @@ IMPLEMENT_NODE(CNewReceipt, CBaseNode);
 extern SFString nextNewreceiptChunk(const SFString& fieldIn, const void *dataPtr);
 static SFString nextNewreceiptChunk_custom(const SFString& fieldIn, const void *dataPtr);
 
+//---------------------------------------------------------------------------
+// makeClass chose the seed so that no two of these names share a slot in the table
+enum {
+    FLD_CONTRACTADDRESS = 1,
+    FLD_GASUSED,
+    FLD_LOGS,
+    FLD_LOGSBLOOM,
+    FLD_ISERROR,
+    FLD_LOGSCNT,
+};
+static const char *newreceiptFieldNames[] = {
+    "contractAddress", "gasUsed", "logs", "logsBloom", "isError", "logsCnt",
+};
+static const uint8_t newreceiptFieldSlots[] = {
+    0, 0, 1, 0, 0, 2, 0, 0, 6, 5, 0, 3, 0, 0, 4, 0,
+};
+static const CFieldTable newreceiptFieldTable(newreceiptFieldNames, 6, newreceiptFieldSlots, 16, 11);
+
 //---------------------------------------------------------------------------
 void CNewReceipt::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr) const {
     if (!m_showing)
@@ -34,12 +52,10 @@ void CNewReceipt::Format(CExportContext& ctx, const SFString& fmtIn, void *dataP
         return;
     }
 
-    SFString fmt = fmtIn;
-    if (handleCustomFormat(ctx, fmt, dataPtr))
+    if (handleCustomFormat(ctx, fmtIn, dataPtr))
         return;
 
-    while (!fmt.empty())
-        ctx << getNextChunk(fmt, nextNewreceiptChunk, this);
+    formatChunks(ctx, fmtIn, nextNewreceiptChunk, this);
 }
 
 //---------------------------------------------------------------------------
@@ -58,36 +74,56 @@ bool CNewReceipt::setValueByName(const SFString& fieldName, const SFString& fiel
     // EXISTING_CODE
     // EXISTING_CODE
 
-    switch (tolower(fieldName[0])) {
-        case 'c':
-            if ( fieldName % "contractAddress" ) { contractAddress = toAddress(fieldValue); return true; }
-            break;
-        case 'g':
-            if ( fieldName % "gasUsed" ) { gasUsed = toGas(fieldValue); return true; }
-            break;
-        case 'i':
-            if ( fieldName % "isError" ) { isError = toBool(fieldValue); return true; }
-            break;
-        case 'l':
-            if ( fieldName % "logs" ) {
-                char *p = (char *)fieldValue.c_str();
-                while (p && *p) {
-                    CLogEntry item;
-                    uint32_t nFields = 0;
-                    p = item.parseJson(p, nFields);
-                    if (nFields)
-                        logs[logs.getCount()] = item;
-                }
-                return true;
+    switch (newreceiptFieldTable.find(fieldName)) {
+        case FLD_CONTRACTADDRESS: contractAddress = toAddress(fieldValue); return true;
+        case FLD_GASUSED: gasUsed = toGas(fieldValue); return true;
+        case FLD_LOGS: {
+            char *p = (char *)fieldValue.c_str();
+            while (p && *p) {
+                CLogEntry item;
+                uint32_t nFields = 0;
+                p = item.parseJson(p, nFields);
+                if (nFields)
+                    logs[logs.getCount()] = item;
             }
-            if ( fieldName % "logsBloom" ) { logsBloom = toBloom(fieldValue); return true; }
-            break;
+            return true;
+        }
+        case FLD_LOGSBLOOM: logsBloom = toBloom(fieldValue); return true;
+        case FLD_ISERROR: isError = toBool(fieldValue); return true;
         default:
             break;
     }
     return false;
 }
 
+//---------------------------------------------------------------------------------------------------
+bool CNewReceipt::parseTape(CJsonTape& tape, uint32_t node) {
+    if (!tape.isObject(node))
+        return false;
+
+    // Objects are parsed in place from the tape. Anything else goes to setValueByName
+    for (uint32_t key = tape.firstMember(node) ; key != JSON_NOTOKEN ; key = tape.nextMember(node, key)) {
+        uint32_t val = key + 1;
+        string_view_q name = tape.getView(key);
+        switch (newreceiptFieldTable.find(name.data(), name.length())) {
+            case FLD_LOGS:
+                if (tape.isArrayOf(val, JSON_OBJECT)) {
+                    for (uint32_t item = tape.firstItem(val) ; item != JSON_NOTOKEN ; item = tape.nextItem(val, item)) {
+                        if (tape.firstMember(item) != JSON_NOTOKEN)
+                            logs[logs.getCount()].parseTape(tape, item);
+                    }
+                    continue;
+                }
+                break;
+            default:
+                break;
+        }
+        setValueFromTape(tape, key);
+    }
+    finishParse();
+    return true;
+}
+
 //---------------------------------------------------------------------------------------------------
 void CNewReceipt::finishParse() {
     // EXISTING_CODE
@@ -217,30 +253,23 @@ SFString CNewReceipt::getValueByName(const SFString& fieldName) const {
         return ret;
 
     // Return field values
-    switch (tolower(fieldName[0])) {
-        case 'c':
-            if ( fieldName % "contractAddress" ) return fromAddress(contractAddress);
-            break;
-        case 'g':
-            if ( fieldName % "gasUsed" ) return fromGas(gasUsed);
-            break;
-        case 'i':
-            if ( fieldName % "isError" ) return asString(isError);
-            break;
-        case 'l':
-            if ( fieldName % "logs" || fieldName % "logsCnt" ) {
-                uint32_t cnt = logs.getCount();
-                if (fieldName.endsWith("Cnt"))
-                    return asStringU(cnt);
-                if (!cnt) return "";
-                SFString retS;
-                for (uint32_t i = 0 ; i < cnt ; i++) {
-                    retS += logs[i].Format();
-                    retS += ((i < cnt - 1) ? ",\n" : "\n");
-                }
-                return retS;
+    switch (newreceiptFieldTable.find(fieldName)) {
+        case FLD_CONTRACTADDRESS: return fromAddress(contractAddress);
+        case FLD_GASUSED: return fromGas(gasUsed);
+        case FLD_LOGS: {
+            uint32_t cnt = logs.getCount();
+            if (!cnt) return "";
+            SFString retS;
+            for (uint32_t i = 0 ; i < cnt ; i++) {
+                retS += logs[i].Format();
+                retS += ((i < cnt - 1) ? ",\n" : "\n");
             }
-            if ( fieldName % "logsBloom" ) return bloom2Bytes(logsBloom);
+            return retS;
+        }
+        case FLD_LOGSCNT: return asStringU(logs.getCount());
+        case FLD_LOGSBLOOM: return bloom2Bytes(logsBloom);
+        case FLD_ISERROR: return asString(isError);
+        default:
             break;
     }
 
@@ -44,6 +44,7 @@ public:
 
     DECLARE_NODE(CNewReceipt);
 
+    bool parseTape(CJsonTape& tape, uint32_t node) override;
     const CBaseNode *getObjectAt(const SFString& fieldName, uint32_t index) const override;
 
     // EXISTING_CODE
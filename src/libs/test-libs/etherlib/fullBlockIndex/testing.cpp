@@ -0,0 +1,135 @@
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include <set>
+#include "etherlib.h"
+
+#define INDEX_FILE "./fullBlockIndex_test.bin"
+#define N_BLOCKS   200000
+
+//--------------------------------------------------------------
+// A small deterministic generator so the gold file never changes
+static uint64_t nextRand(uint64_t& seed) {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (seed >> 33);
+}
+
+//--------------------------------------------------------------
+// The non-empty blocks the index should hold
+static std::set<blknum_t> expected;
+
+//--------------------------------------------------------------
+bool writeIndex(void) {
+    SFArchive file(WRITING_ARCHIVE);
+    if (!file.Lock(INDEX_FILE, binaryWriteCreate, LOCK_WAIT))
+        return false;
+    for (std::set<blknum_t>::const_iterator it = expected.begin() ; it != expected.end() ; it++) {
+        blknum_t bn = *it;
+        file.Write(&bn, sizeof(blknum_t), 1);
+    }
+    file.Release();
+    return true;
+}
+
+//--------------------------------------------------------------
+SFString showNext(const CFullBlockIndex& index, blknum_t bn) {
+    blknum_t next = 0;
+    return (index.nextNonEmpty(bn, next) ? asStringU(next) : "none");
+}
+
+//--------------------------------------------------------------
+int main(int argc, const char *argv[]) {
+
+    etherlib_init();
+
+    CDefaultOptions options;
+    options.minArgs = 0;
+    if (!options.prepareArguments(argc, argv))
+        return 0;
+
+    removeFile(INDEX_FILE);
+
+    // Mostly sparse, with a dense stretch and two long empty runs (like the early chain)
+    uint64_t seed = 42;
+    for (blknum_t bn = 46147 ; bn < N_BLOCKS ; bn++) {
+        if (bn >= 100000 && bn < 150000)
+            continue;
+        if (bn >= 180000 && bn < 181000) {
+            expected.insert(bn);
+            continue;
+        }
+        if (nextRand(seed) % 10 == 0)
+            expected.insert(bn);
+    }
+    expected.insert(46147);  // the first non-empty block on mainnet
+    expected.insert(N_BLOCKS + 50000);
+
+    CFullBlockIndex index;
+    cout << "open before built: " << (index.open(INDEX_FILE, LOCK_NOWAIT) ? "true" : "false") << "\n";
+
+    if (!writeIndex()) {
+        cout << "Could not write the index\n";
+        return 0;
+    }
+    if (!index.open(INDEX_FILE)) {
+        cout << "Could not open the index: " << index.LockFailure() << "\n";
+        return 0;
+    }
+    cout << "nBlocks: " << index.nBlocks() << " expected: " << expected.size() << "\n";
+    cout << "lastBlock: " << index.lastBlock() << "\n";
+
+    // Every block, whether it's in the index or not, both found by lookup and by nextNonEmpty
+    uint64_t nContained = 0, nLookups = 0, nNexts = 0, nChecked = 0;
+    for (blknum_t bn = 0 ; bn <= N_BLOCKS + 50001 ; bn++) {
+        bool isFull = (expected.find(bn) != expected.end());
+        nContained += isFull;
+        nLookups += (index.contains(bn) == isFull);
+
+        std::set<blknum_t>::const_iterator it = expected.lower_bound(bn);
+        blknum_t next = 0;
+        bool found = index.nextNonEmpty(bn, next);
+        nNexts += (it == expected.end() ? !found : (found && next == *it));
+        nChecked++;
+    }
+    cout << "lookups matched: " << nLookups << " of " << nChecked << " (" << nContained << " non-empty)\n";
+    cout << "nextNonEmpty matched: " << nNexts << " of " << nChecked << "\n";
+
+    cout << "before the first block: " << showNext(index, 0) << "\n";
+    cout << "first block: " << showNext(index, 46147) << " contains: " << (index.contains(46147) ? "true" : "false") << "\n";
+    cout << "inside the empty run: " << showNext(index, 125000) << "\n";
+    cout << "dense stretch: " << showNext(index, 180500) << "\n";
+    cout << "inside the last empty run: " << showNext(index, N_BLOCKS + 1) << "\n";
+    cout << "last block: " << showNext(index, N_BLOCKS + 50000) << "\n";
+    cout << "after the last block: " << showNext(index, N_BLOCKS + 50001) << "\n";
+
+    uint64_t first, last;
+    index.rangeOf(100000, 150000, first, last);
+    cout << "range in the empty run: " << (last - first) << "\n";
+    index.rangeOf(180000, 181000, first, last);
+    cout << "range in the dense stretch: " << (last - first) << " from: " << index[first] << "\n";
+    index.close();
+
+    // An empty index is a valid index with nothing in it
+    expected.clear();
+    writeIndex();
+    CFullBlockIndex empty;
+    bool opened = empty.open(INDEX_FILE);
+    blknum_t next = 0;
+    cout << "empty index: opened: " << (opened ? "true" : "false")
+            << " nBlocks: " << empty.nBlocks()
+            << " contains: " << (empty.contains(0) ? "true" : "false")
+            << " next: " << (empty.nextNonEmpty(0, next) ? "true" : "false") << "\n";
+    empty.close();
+
+    removeFile(INDEX_FILE);
+    return 0;
+}
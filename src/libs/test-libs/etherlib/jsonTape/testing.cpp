@@ -0,0 +1,215 @@
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include "etherlib.h"
+#include "options.h"
+
+//------------------------------------------------------------------------
+class CThisTest : public testing::Test {
+public:
+    CThisTest(void) : Test() {}
+    virtual void SetUp() {
+    }
+    virtual void TearDown() {
+    }
+};
+
+//------------------------------------------------------------------------
+void showTape(const SFString& json) {
+    CJsonTape tape;
+    bool ok = tape.tokenize(json);
+    cout << "tokenized: " << (ok ? "true" : "false") << " consumed: " << tape.consumed() << "\n";
+    const char *types[] = { "", "object", "array", "string", "primitive" };
+    for (uint32_t i = 0 ; ok && i < tape.getCount() ; i++) {
+        const CJsonToken& token = tape[i];
+        SFString view(tape.getView(i));
+        cout << "  " << i << ": " << padRight(types[token.type], 10) << token.start << "-" << token.end
+                << " next: " << token.next << (token.type >= JSON_STRING ? " [" + view + "]" : SFString("")) << "\n";
+    }
+}
+
+//------------------------------------------------------------------------
+TEST_F(CThisTest, TestTokens) {
+
+    cerr << "Running " << testName << "\n";
+
+    // Structural characters and escaped quotes inside of strings, and trailing text we never read
+    SFString json = "{\"a\": \"x\\\"y\", \"b\":[1, 2.5e3, true, null, {\"c\":\"}]{,:\"}],\n"
+                    "    \"d\" : {}, \"e\":\"back\\\\\"} and then some";
+    showTape(json);
+
+    // A string long enough to cross blocks, with an escaped quote straddling the boundary
+    SFString longStr = "{\"long\":\"" + SFString('x', 54) + "\\\"" + SFString('y', 70) + "\",\"n\":12345}";
+    ASSERT_EQ("Quote escaped at 63", longStr[63], '\\');
+    showTape(longStr);
+
+    // A backslash run that ends exactly at the boundary escapes nothing past it
+    SFString evenRun = "{\"k\":\"" + SFString('x', 56) + "\\\\\"," + SFString(' ', 10) + "\"m\":[[],[]]}";
+    ASSERT_EQ("Run ends at 63", evenRun.substr(62, 3), SFString("\\\\\""));
+    showTape(evenRun);
+
+    // A number split across blocks is one token
+    SFString split = "[" + SFString(' ', 60) + "123456789]";
+    showTape(split);
+
+    CJsonTape tape;
+    ASSERT_FALSE("Mismatched brackets", tape.tokenize("{\"a\":[1,2}"));
+    ASSERT_FALSE("Unterminated string", tape.tokenize("{\"a\":\"open}"));
+    ASSERT_FALSE("Unterminated object", tape.tokenize("{\"a\":{}"));
+    ASSERT_FALSE("Close without open",  tape.tokenize("]"));
+    ASSERT_FALSE("Empty text",          tape.tokenize(""));
+
+    ASSERT_TRUE ("Tokenize",            tape.tokenize(json));
+    ASSERT_EQ   ("Find d",              tape.findMember(0, "d"), (uint32_t)13);
+    ASSERT_EQ   ("Find e",              SFString(tape.getView(tape.findMember(0, "e"))), SFString("back\\\\"));
+    ASSERT_EQ   ("No member",           tape.findMember(0, "c"), JSON_NOTOKEN);
+    ASSERT_EQ   ("Not an object",       tape.findMember(3, "a"), JSON_NOTOKEN);
+
+    return true;
+}}
+
+//------------------------------------------------------------------------
+TEST_F(CThisTest, TestParse) {
+
+    cerr << "Running " << testName << "\n";
+
+    // Every block field comes out the same as it did through cleanUpJson and the old parser,
+    // including the receipts and logs, which are parsed from the cleaned text handed to the field
+    SFString contents = asciiFileToString("./tests/blocks.json");
+    SFString oldJson = contents, newJson = contents;
+    CBlock oldBlock, newBlock;
+    oldBlock.parseJson(cleanUpJson((char*)(const char*)oldJson));
+    newBlock.parseJson((char*)(const char*)newJson);
+    uint32_t nLogs = 0;
+    for (uint32_t i = 0 ; i < newBlock.transactions.getCount() ; i++)
+        nLogs += newBlock.transactions[i].receipt.logs.getCount();
+    cout << "transactions: " << newBlock.transactions.getCount() << " logs: " << nLogs << "\n";
+    ASSERT_TRUE("Parsed something", newBlock.transactions.getCount() > 0 && nLogs > 0);
+    ASSERT_EQ  ("Blocks are the same", oldBlock.Format(), newBlock.Format());
+
+    // An array of objects is walked one object at a time, just as before
+    SFString traces = asciiFileToString("./tests/traces.json");
+    oldJson = traces;
+    newJson = traces;
+    CTraceArray oldTraces, newTraces;
+    char *p = cleanUpJson((char*)(const char*)oldJson);
+    while (p && *p) {
+        CTrace trace;
+        uint32_t nFields = 0;
+        p = trace.parseJson(p, nFields);
+        if (nFields)
+            oldTraces[oldTraces.getCount()] = trace;
+    }
+    p = (char*)(const char*)newJson;
+    while (p && *p) {
+        CTrace trace;
+        uint32_t nFields = 0;
+        p = trace.parseJson(p, nFields);
+        if (nFields)
+            newTraces[newTraces.getCount()] = trace;
+    }
+    cout << "traces: " << newTraces.getCount() << "\n";
+    ASSERT_EQ("Trace count", oldTraces.getCount(), newTraces.getCount());
+    for (uint32_t i = 0 ; i < newTraces.getCount() ; i++)
+        ASSERT_EQ("Traces are the same", oldTraces[i].Format(), newTraces[i].Format());
+
+    // Strings are now taken as they are (the old parser dropped spaces and every quote)
+    SFString reply = "{ \"jsonrpc\": \"2.0\", \"id\": \"7\", \"result\": \"a \\\"quoted\\\" value, {not} an object\" }";
+    CRPCResult generic;
+    generic.parseJson((char*)(const char*)reply);
+    cout << "id: " << generic.id << " result: " << generic.result << "\n";
+    ASSERT_EQ("String result", generic.result, SFString("a \\\"quoted\\\" value, {not} an object"));
+
+    // Reading one member of a reply straight into an object
+    SFString response = "{\"jsonrpc\":\"2.0\",\"id\":1,\"result\":{\"blockNumber\":\"0x3d\",\"status\":\"0x1\",\"logs\":[]}}";
+    CJsonTape tape;
+    CReceipt receipt;
+    ASSERT_TRUE("Tokenize response", tape.tokenize(response));
+    ASSERT_TRUE("Parse result", receipt.parseTape(tape, tape.findMember(0, "result")));
+    ASSERT_FALSE("Parse missing", receipt.parseTape(tape, tape.findMember(0, "error")));
+    cout << "receipt status: " << receipt.status << " logs: " << receipt.logs.getCount() << "\n";
+
+    return true;
+}}
+
+//------------------------------------------------------------------------
+void testSpeed(void) {
+
+    etherlib_init();
+
+    SFString contents = asciiFileToString("./tests/blocks.json");
+    if (contents.empty()) {
+        cerr << "Could not read ./tests/blocks.json. Quitting...\n";
+        return;
+    }
+
+    // The old parser writes into its input, so each run gets its own copy (for both, to be fair)
+    const uint64_t nRuns = 50;
+    SFString oldFormat, newFormat;
+    double start = qbNow();
+    for (uint64_t i = 0 ; i < nRuns ; i++) {
+        SFString json = contents;
+        CBlock block;
+        block.parseJson(cleanUpJson((char*)(const char*)json));
+        if (i == 0)
+            oldFormat = block.Format();
+    }
+    double oldTime = qbNow() - start;
+
+    start = qbNow();
+    for (uint64_t i = 0 ; i < nRuns ; i++) {
+        SFString json = contents;
+        CBlock block;
+        block.parseJson((char*)(const char*)json);
+        if (i == 0)
+            newFormat = block.Format();
+    }
+    double newTime = qbNow() - start;
+
+    // Timings vary from machine to machine, so they are not part of the test's output
+    if (!isTestMode()) {
+        cerr << "cleanUpJson and parse: " << (oldTime / nRuns * 1000.) << " ms per block\n";
+        cerr << "tokenize and parse:    " << (newTime / nRuns * 1000.) << " ms per block\n";
+    }
+    cout << "blocks parsed: " << nRuns << "\n";
+    cout << "bytes per block: " << contents.length() << "\n";
+    cout << "same results: " << (oldFormat == newFormat ? "true" : "false") << "\n";
+}
+
+//------------------------------------------------------------------------
+int main(int argc, const char *argv[]) {
+
+    etherlib_init();
+
+    COptions options;
+    options.minArgs = 0;
+    if (!options.prepareArguments(argc, argv))
+        return 0;
+
+    while (!options.commandList.empty()) {
+        SFString command = nextTokenClear(options.commandList, '\n');
+        if (!options.parseArguments(command))
+            return 0;
+
+        if (options.testNum == 0) {
+            LOAD_TEST(TestTokens);
+
+        } else if (options.testNum == 1) {
+            LOAD_TEST(TestParse);
+
+        } else if (options.testNum == 2) {
+            testSpeed();
+        }
+    }
+
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,216 @@
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include "etherlib.h"
+#include "options.h"
+
+#define BLOCK_FILE "./memArchive_block.bin"
+#define BLOOM_FILE "./memArchive_bloom.bin"
+#define OTHER_FILE "./memArchive_other.bin"
+#define N_TRANS    200
+
+//------------------------------------------------------------------------
+class CThisTest : public testing::Test {
+public:
+    CThisTest(void) : Test() {}
+    virtual void SetUp() {
+    }
+    virtual void TearDown() {
+    }
+};
+
+//------------------------------------------------------------------------
+SFString hexOf(uint64_t val, size_t width) {
+    return "0x" + padLeft(toLower(toHex(val).substr(2)), width * 2, '0');
+}
+
+//------------------------------------------------------------------------
+// A block about as busy as a busy mainnet block: every transaction has input and a couple of logs
+void makeBlock(CBlock& block) {
+    block.blockNumber = 4000000;
+    block.hash        = hexOf(0xb10c, 32);
+    block.parentHash  = hexOf(0xb10b, 32);
+    block.miner       = hexOf(0x1111, 20);
+    block.timestamp   = 1500000000;
+    block.gasLimit    = 8000000;
+    block.gasUsed     = 7999999;
+    block.difficulty  = 1234567890;
+    for (uint32_t t = 0 ; t < N_TRANS ; t++) {
+        CTransaction *trans = &block.transactions[t];
+        trans->hash             = hexOf(0x7000 + t, 32);
+        trans->blockHash        = block.hash;
+        trans->blockNumber      = block.blockNumber;
+        trans->transactionIndex = t;
+        trans->nonce            = t * 3;
+        trans->timestamp        = block.timestamp;
+        trans->from             = hexOf(0x2000 + t, 20);
+        trans->to               = hexOf(0x3000 + (t % 7), 20);
+        trans->value            = canonicalWei(asStringU(t) + "000000000000000");
+        trans->gas              = 90000;
+        trans->gasPrice         = 20000000000;
+        trans->input            = "0xa9059cbb" + hexOf(0x4000 + t, 32).substr(2) + hexOf(t, 32).substr(2);
+        trans->isError          = (t % 13 == 0);
+        trans->receipt.gasUsed  = 21000 + t;
+        for (uint32_t l = 0 ; l < 2 ; l++) {
+            CLogEntry *log = &trans->receipt.logs[l];
+            log->address  = trans->to;
+            log->data     = hexOf(t * 1000 + l, 32);
+            log->logIndex = t * 2 + l;
+            log->topics[0] = hex2BN(hexOf(0xddf2, 32));
+            log->topics[1] = hex2BN(hexOf(0x2000 + t, 32));
+        }
+    }
+}
+
+//------------------------------------------------------------------------
+// The way blocks were read before: a field at a time from a FILE
+bool readFromFile(CBlock& block, const SFString& fileName) {
+    SFArchive archive(READING_ARCHIVE);
+    if (!archive.Lock(fileName, binaryReadOnly, LOCK_NOWAIT))
+        return false;
+    block.Serialize(archive);
+    archive.Close();
+    return true;
+}
+
+//------------------------------------------------------------------------
+TEST_F(CThisTest, TestRead) {
+
+    CBlock block;
+    makeBlock(block);
+    removeFile(BLOCK_FILE);
+    ASSERT_TRUE("Block written", writeBlockToBinary(block, BLOCK_FILE));
+
+    CBlock fromFile, fromMemory;
+    ASSERT_TRUE("Read from file",   readFromFile(fromFile, BLOCK_FILE));
+    ASSERT_TRUE("Read from memory", readBlockFromBinary(fromMemory, BLOCK_FILE));
+    cout << "transactions: " << fromMemory.transactions.getCount() << " bytes: " << fileSize(BLOCK_FILE) << "\n";
+    ASSERT_EQ("Same as written", block.Format(), fromMemory.Format());
+    ASSERT_EQ("Same as from file", fromFile.Format(), fromMemory.Format());
+    ASSERT_EQ("Last log", fromMemory.transactions[N_TRANS-1].receipt.logs[1].data, block.transactions[N_TRANS-1].receipt.logs[1].data);
+
+    // An archive is reused from one file to the next
+    CBlock again;
+    ASSERT_TRUE("Read again", readBlockFromBinary(again, BLOCK_FILE));
+    ASSERT_EQ("Same again", block.Format(), again.Format());
+    CBlock missing;
+    ASSERT_FALSE("Missing file", readBlockFromBinary(missing, "./no_such_file.bin"));
+    removeFile(BLOCK_FILE);
+
+    SFBloomArray blooms;
+    for (uint32_t i = 0 ; i < 3 ; i++)
+        blooms[i] = makeBloom(hexOf(0x2000 + i, 20));
+    removeFile(BLOOM_FILE);
+    ASSERT_TRUE("Blooms written", writeBloomArray(blooms, BLOOM_FILE));
+    SFBloomArray readBack;
+    ASSERT_TRUE("Blooms read", readBloomArray(readBack, BLOOM_FILE));
+    ASSERT_EQ("Bloom count", readBack.getCount(), 3);
+    bool sameBlooms = true;
+    for (uint32_t i = 0 ; i < 3 ; i++)
+        sameBlooms = sameBlooms && (readBack[i] == blooms[i]);
+    ASSERT_TRUE("Same blooms", sameBlooms);
+    removeFile(BLOOM_FILE);
+
+    // Strings can be looked at where they lie, and the cursor moves like a file's would
+    SFArchive out(WRITING_ARCHIVE);
+    ASSERT_TRUE("Opened for writing", out.Lock(OTHER_FILE, binaryWriteCreate, LOCK_CREATE));
+    out << SFString("borrowed") << (uint64_t)42 << SFString("copied");
+    out.Close();
+
+    CMemArchive in;
+    ASSERT_TRUE("Opened in memory", in.open(OTHER_FILE));
+    ASSERT_TRUE("In memory", in.isInMemory());
+    string_view_q view;
+    ASSERT_TRUE("Got a view", in.readStringView(view));
+    ASSERT_EQ("View", SFString(view), SFString("borrowed"));
+    uint64_t num = 0;
+    SFString str;
+    in >> num >> str;
+    ASSERT_EQ("Number", num, 42);
+    ASSERT_EQ("String", str, SFString("copied"));
+    ASSERT_TRUE("At the end", in.Eof());
+    ASSERT_EQ("Position", (uint64_t)in.Tell(), fileSize(OTHER_FILE));
+    in.Seek(sizeof(unsigned long) + 8, SEEK_SET);
+    num = 0;
+    in >> num;
+    ASSERT_EQ("After seeking", num, 42);
+    in.close();
+    ASSERT_FALSE("Closed", in.isOpen());
+    removeFile(OTHER_FILE);
+
+    return true;
+}}
+
+//------------------------------------------------------------------------
+void testSpeed(void) {
+
+    CBlock block;
+    makeBlock(block);
+    removeFile(BLOCK_FILE);
+    writeBlockToBinary(block, BLOCK_FILE);
+
+    const uint64_t nRuns = 500;
+    SFString fileFormat, memFormat;
+    double start = qbNow();
+    for (uint64_t i = 0 ; i < nRuns ; i++) {
+        CBlock fromFile;
+        readFromFile(fromFile, BLOCK_FILE);
+        if (i == 0)
+            fileFormat = fromFile.Format();
+    }
+    double fileTime = qbNow() - start;
+
+    start = qbNow();
+    for (uint64_t i = 0 ; i < nRuns ; i++) {
+        CBlock fromMemory;
+        readBlockFromBinary(fromMemory, BLOCK_FILE);
+        if (i == 0)
+            memFormat = fromMemory.Format();
+    }
+    double memTime = qbNow() - start;
+    removeFile(BLOCK_FILE);
+
+    // Timings vary from machine to machine, so they are not part of the test's output
+    if (!isTestMode()) {
+        cerr << "SFArchive (FILE):  " << (fileTime / nRuns * 1000.) << " ms per block\n";
+        cerr << "CMemArchive:       " << (memTime / nRuns * 1000.) << " ms per block\n";
+    }
+    cout << "blocks read: " << nRuns << "\n";
+    cout << "transactions per block: " << N_TRANS << "\n";
+    cout << "same results: " << (fileFormat == memFormat ? "true" : "false") << "\n";
+}
+
+//------------------------------------------------------------------------
+int main(int argc, const char *argv[]) {
+
+    etherlib_init();
+
+    COptions options;
+    options.minArgs = 0;
+    if (!options.prepareArguments(argc, argv))
+        return 0;
+
+    while (!options.commandList.empty()) {
+        SFString command = nextTokenClear(options.commandList, '\n');
+        if (!options.parseArguments(command))
+            return 0;
+
+        if (options.testNum == 0) {
+            LOAD_TEST(TestRead);
+
+        } else if (options.testNum == 1) {
+            testSpeed();
+        }
+    }
+
+    return RUN_ALL_TESTS();
+}
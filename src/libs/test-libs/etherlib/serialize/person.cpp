@@ -23,6 +23,21 @@ IMPLEMENT_NODE(CPerson, CBaseNode);
 static SFString nextPersonChunk(const SFString& fieldIn, const void *dataPtr);
 static SFString nextPersonChunk_custom(const SFString& fieldIn, const void *dataPtr);
 
+//---------------------------------------------------------------------------
+// makeClass chose the seed so that no two of these names share a slot in the table
+enum {
+    FLD_NAME = 1,
+    FLD_AGE,
+    FLD_NEXT,
+};
+static const char *personFieldNames[] = {
+    "name", "age", "next",
+};
+static const uint8_t personFieldSlots[] = {
+    2, 0, 0, 0, 0, 0, 1, 3,
+};
+static const CFieldTable personFieldTable(personFieldNames, 3, personFieldSlots, 8, 0);
+
 //---------------------------------------------------------------------------
 void CPerson::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr) const {
     if (!m_showing)
@@ -33,12 +48,10 @@ void CPerson::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr)
         return;
     }
 
-    SFString fmt = fmtIn;
-    if (handleCustomFormat(ctx, fmt, dataPtr))
+    if (handleCustomFormat(ctx, fmtIn, dataPtr))
         return;
 
-    while (!fmt.empty())
-        ctx << getNextChunk(fmt, nextPersonChunk, this);
+    formatChunks(ctx, fmtIn, nextPersonChunk, this);
 }
 
 //---------------------------------------------------------------------------
@@ -57,24 +70,20 @@ bool CPerson::setValueByName(const SFString& fieldName, const SFString& fieldVal
     // EXISTING_CODE
     // EXISTING_CODE
 
-    switch (tolower(fieldName[0])) {
-        case 'a':
-            if ( fieldName % "age" ) { age = toLong32u(fieldValue); return true; }
-            break;
-        case 'n':
-            if ( fieldName % "name" ) { name = fieldValue; return true; }
-            if ( fieldName % "next" ) {
-                Clear();
-                next = new CPerson;
-                if (next) {
-                    char *p = cleanUpJson((char *)fieldValue.c_str());
-                    uint32_t nFields = 0;
-                    next->parseJson(p, nFields);
-                    return true;
-                }
-                return false;
+    switch (personFieldTable.find(fieldName)) {
+        case FLD_NAME: name = fieldValue; return true;
+        case FLD_AGE: age = toLong32u(fieldValue); return true;
+        case FLD_NEXT: {
+            Clear();
+            next = new CPerson;
+            if (next) {
+                char *p = cleanUpJson((char *)fieldValue.c_str());
+                uint32_t nFields = 0;
+                next->parseJson(p, nFields);
+                return true;
             }
-            break;
+            return false;
+        }
         default:
             break;
     }
@@ -201,17 +210,15 @@ SFString CPerson::getValueByName(const SFString& fieldName) const {
         return ret;
 
     // Return field values
-    switch (tolower(fieldName[0])) {
-        case 'a':
-            if ( fieldName % "age" ) return asStringU(age);
-            break;
-        case 'n':
-            if ( fieldName % "name" ) return name;
-            if ( fieldName % "next" ) {
-                if (next)
-                    return next->Format();
-                return "";
-            }
+    switch (personFieldTable.find(fieldName)) {
+        case FLD_NAME: return name;
+        case FLD_AGE: return asStringU(age);
+        case FLD_NEXT: {
+            if (next)
+                return next->Format();
+            return "";
+        }
+        default:
             break;
     }
 
@@ -48,6 +48,7 @@ extern const char* STR_TEST_DATA;
 void doTests(void) {
     SFString in;
     bool hasIn = false;
+    SFStringArray hexes, expected;
     SFString contents = STR_TEST_DATA;
     while (!contents.empty()) {
         SFString line = nextTokenClear(contents, '\n');
@@ -62,10 +63,19 @@ void doTests(void) {
                     << "hex:\t\t" << hex << "\n"
                     << "expected:\t" << line << "\n"
                     << "out:\t\t" << out << " " << (out == line ? greenCheck : redX) << "\n\n";
+                hexes[hexes.getCount()] = hex;
+                expected[expected.getCount()] = line;
                 hasIn = false;
             }
         }
     }
+
+    // The multi-buffer version should produce the same hashes all at once
+    SFStringArray outs;
+    keccak256Many(hexes, outs);
+    for (uint32_t i = 0 ; i < outs.getCount() ; i++)
+        cout << "many[" << i << "]:\t" << outs[i] << " " << (outs[i] == expected[i] ? greenCheck : redX) << "\n";
+    cout << "\n";
 }
 
 //--------------------------------------------------------------
@@ -91,4 +101,8 @@ const char* STR_TEST_DATA =
 "0x4d741b6f1eb29cb2a9b9911c82f56fa8d73b04959d3d9d222895df6c0b28aa15\n"
 "#\n"
 "The quick brown fox jumps over the lazy dog.\n"
-"0x578951e24efd62a3d63a86f7cd19aaa53c898fe287d2552133220370240b572d\n";
+"0x578951e24efd62a3d63a86f7cd19aaa53c898fe287d2552133220370240b572d\n"
+"#\n"
+"# longer than one block (136 bytes)\n"
+"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa\n"
+"0x96ea54061def936c4be90b518992fdc6f12f535068a256229aca54267b4d084d\n";
@@ -0,0 +1,173 @@
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include <algorithm>
+#include <vector>
+#include "etherlib.h"
+
+#define INDEX_FILE "./timestampIndex_test.bin"
+#define N_BLOCKS   100000
+#define N_QUERIES  20000
+
+//--------------------------------------------------------------
+// A small deterministic generator so the gold file never changes
+static uint64_t nextRand(uint64_t& seed) {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (seed >> 33);
+}
+
+//--------------------------------------------------------------
+// The timestamp the index should hold for every block (i.e. after out-of-order times are clamped)
+static std::vector<timestamp_t> expected;
+
+//--------------------------------------------------------------
+bool appendBlocks(blknum_t first, blknum_t last, uint64_t& seed) {
+    CTimestampIndexWriter writer;
+    if (!writer.open(INDEX_FILE))
+        return false;
+
+    for (blknum_t bn = first ; bn < last ; bn++) {
+        timestamp_t ts;
+        if (bn == 0)
+            ts = 0;  // like the real genesis block
+        else if (bn == 1)
+            ts = 1438269988;
+        else if (bn == 50000)
+            ts = expected[bn - 1] + 100000;  // a long stall
+        else if (bn == 60000)
+            ts = expected[bn - 1] - 30;  // out of order
+        else
+            ts = expected[bn - 1] + 1 + (timestamp_t)(nextRand(seed) % 40);
+        writer.append(bn, ts);
+        expected.push_back(max(ts, bn ? expected[bn - 1] : ts));
+    }
+    return writer.close();
+}
+
+//--------------------------------------------------------------
+void expectedBounds(timestamp_t ts, blknum_t& floor, blknum_t& ceil) {
+    uint64_t upper = (uint64_t)(std::upper_bound(expected.begin(), expected.end(), ts) - expected.begin());
+    floor = (upper > 0 ? upper - 1 : NOPOS);
+    if (floor != NOPOS && expected[floor] == ts)
+        ceil = floor;
+    else
+        ceil = (upper < expected.size() ? upper : NOPOS);
+}
+
+//--------------------------------------------------------------
+SFString show(blknum_t bn) {
+    return (bn == NOPOS ? "none" : asStringU(bn));
+}
+
+//--------------------------------------------------------------
+void report(const CTimestampIndex& index, const SFString& msg, timestamp_t ts) {
+    blknum_t floor, ceil;
+    bool inside = index.findBlock(ts, floor, ceil);
+    cout << msg << ": floor: " << show(floor) << " ceil: " << show(ceil) << " inside: " << (inside ? "true" : "false") << "\n";
+}
+
+//--------------------------------------------------------------
+int main(int argc, const char *argv[]) {
+
+    etherlib_init();
+
+    CDefaultOptions options;
+    options.minArgs = 0;
+    if (!options.prepareArguments(argc, argv))
+        return 0;
+
+    removeFile(INDEX_FILE);
+
+    // Build the index in two goes to make sure appending to an existing index works
+    uint64_t seed = 42;
+    appendBlocks(0, N_BLOCKS / 2 + 10, seed);
+    appendBlocks(N_BLOCKS / 2 + 10, N_BLOCKS, seed);
+
+    CTimestampIndexWriter badWriter;
+    badWriter.open(INDEX_FILE);
+    cout << "append with a gap: " << (badWriter.append(N_BLOCKS + 5, expected.back() + 10) ? "true" : "false") << "\n";
+    badWriter.close();
+
+    CTimestampIndex index;
+    if (!index.open(INDEX_FILE)) {
+        cout << "Could not open the index\n";
+        return 0;
+    }
+    cout << "nBlocks: " << index.nBlocks() << "\n";
+
+    uint64_t nMatched = 0;
+    for (blknum_t bn = 0 ; bn < index.nBlocks() ; bn++)
+        nMatched += (index.timestampAt(bn) == expected[bn]);
+    cout << "timestamps matched: " << nMatched << " of " << index.nBlocks() << "\n";
+
+    // Queries from before the first block to after the last one, in no particular order
+    timestamp_t lastTs = expected.back();
+    CBlockBoundsArray queries;
+    for (uint32_t i = 0 ; i < N_QUERIES ; i++)
+        queries[i] = CBlockBounds((timestamp_t)(nextRand(seed) % (uint64_t)(lastTs + 1000)));
+    for (uint32_t i = 0 ; i < 100 ; i++)  // and a good number of exact matches
+        queries[queries.getCount()] = CBlockBounds(expected[nextRand(seed) % N_BLOCKS]);
+
+    nMatched = 0;
+    for (uint32_t i = 0 ; i < queries.getCount() ; i++) {
+        blknum_t floor, ceil, expFloor, expCeil;
+        index.findBlock(queries[i].ts, floor, ceil);
+        expectedBounds(queries[i].ts, expFloor, expCeil);
+        nMatched += (floor == expFloor && ceil == expCeil);
+    }
+    cout << "findBlock matched: " << nMatched << " of " << queries.getCount() << "\n";
+
+    index.findBlocks(queries);
+    nMatched = 0;
+    for (uint32_t i = 0 ; i < queries.getCount() ; i++) {
+        blknum_t expFloor, expCeil;
+        expectedBounds(queries[i].ts, expFloor, expCeil);
+        nMatched += (queries[i].floor == expFloor && queries[i].ceil == expCeil);
+    }
+    cout << "findBlocks matched: " << nMatched << " of " << queries.getCount() << "\n";
+
+    report(index, "before genesis",        -1);
+    report(index, "genesis",               0);
+    report(index, "between 0 and 1",       1000);
+    report(index, "exactly block 1",       1438269988);
+    report(index, "during the stall",      expected[49999] + 50000);
+    report(index, "exactly block 50000",   expected[50000]);
+    report(index, "clamped block 60000",   expected[60000]);
+    report(index, "last block",            lastTs);
+    report(index, "after the last block",  lastTs + 1);
+
+    CBlockBoundsArray none;
+    index.findBlocks(none);
+    cout << "empty batch: " << none.getCount() << "\n";
+
+    index.close();
+    removeFile(INDEX_FILE);
+
+    // Blocks missing from the mini-block database get the time of the block after them
+    CTimestampIndexWriter gapWriter;
+    gapWriter.open(INDEX_FILE);
+    bool filled = gapWriter.appendThrough(3, 1000) && gapWriter.appendThrough(7, 2000);
+    cout << "gaps filled: " << (filled ? "true" : "false") << "\n";
+    cout << "going back: " << (gapWriter.appendThrough(5, 3000) ? "true" : "false") << "\n";
+    gapWriter.close();
+    CTimestampIndex gaps;
+    gaps.open(INDEX_FILE);
+    cout << "timestamps:";
+    for (blknum_t bn = 0 ; bn < gaps.nBlocks() ; bn++)
+        cout << " " << gaps.timestampAt(bn);
+    cout << "\n";
+    report(gaps, "between the blocks", 1500);
+    report(gaps, "exactly block 3", 1000);
+    gaps.close();
+    removeFile(INDEX_FILE);
+    return 0;
+}
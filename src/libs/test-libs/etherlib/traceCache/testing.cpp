@@ -0,0 +1,112 @@
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include "etherlib.h"
+
+#define TRACE_FILE "./traceCache_test.bin"
+#define BLOCK_NUM  4000000
+#define REWARD     ((uint32_t)-1)
+
+//--------------------------------------------------------------
+SFHash txHash(uint32_t tx) {
+    return "0x" + padLeft(asStringU(tx + 1), 64, '0');
+}
+
+//--------------------------------------------------------------
+// One trace as trace_block reports it. A position of REWARD makes a block reward.
+SFString traceJson(uint32_t tx, uint32_t sub) {
+    bool reward = (tx == REWARD);
+    SFString ret;
+    ret += "{\"action\":{\"callType\":\"call\",\"from\":\"0x2222222222222222222222222222222222222222\",";
+    ret += "\"to\":\"0x" + padLeft(asStringU(sub + 44), 40, '0') + "\",\"gas\":\"0x10\",\"input\":\"0x\",\"value\":\"0x" + asStringU(tx + 1) + "\"},";
+    ret += "\"blockHash\":\"0x" + SFString('a', 64) + "\",\"blockNumber\":" + asStringU(BLOCK_NUM) + ",";
+    ret += "\"result\":{\"gasUsed\":\"0x" + asStringU(sub + 1) + "\",\"output\":\"0x\"},\"subtraces\":0,";
+    ret += "\"traceAddress\":[" + (sub ? asStringU(sub - 1) : SFString("")) + "],";
+    ret += "\"transactionHash\":" + (reward ? SFString("null") : "\"" + txHash(tx) + "\"") + ",";
+    ret += "\"transactionPosition\":" + (reward ? SFString("null") : asStringU(tx)) + ",";
+    ret += "\"type\":\"" + SFString(reward ? "reward" : "call") + "\"}";
+    return ret;
+}
+
+//--------------------------------------------------------------
+// Transaction 'tx' has 'counts[tx]' traces. Transaction 2 is missing on purpose.
+SFString blockJson(const uint32_t *counts, uint32_t nTrans, bool reversed) {
+    SFString ret = "[";
+    for (uint32_t i = 0 ; i < nTrans ; i++) {
+        uint32_t tx = (reversed ? nTrans - i - 1 : i);
+        for (uint32_t sub = 0 ; sub < counts[tx] ; sub++)
+            ret += (ret == "[" ? "" : ",") + traceJson(tx, sub);
+    }
+    ret += "," + traceJson(REWARD, 0);
+    return ret + "]";
+}
+
+//--------------------------------------------------------------
+void report(const CBlockTraces& block) {
+    cout << "block: " << block.blockNumber << " transactions: " << block.nTransactions() << " traces: " << block.traces.getCount() << "\n";
+    for (uint32_t tx = 0 ; tx < block.nTransactions() ; tx++) {
+        CTraceArray traces;
+        block.getTraces(tx, traces);
+        cout << "\t" << tx << "\t" << (block.hashes[tx].empty() ? "none" : block.hashes[tx].substr(60)) << "\t" << block.getCount(tx);
+        for (uint32_t i = 0 ; i < traces.getCount() ; i++)
+            cout << "\t" << traces[i].transactionPosition << ":" << traces[i].traceAddress.getCount() << ":" << traces[i].action.to.toHex().substr(38);
+        cout << "\n";
+    }
+}
+
+//--------------------------------------------------------------
+int main(int argc, const char *argv[]) {
+
+    etherlib_init();
+
+    CDefaultOptions options;
+    options.minArgs = 0;
+    if (!options.prepareArguments(argc, argv))
+        return 0;
+
+    const uint32_t counts[] = { 1, 3, 0, 2, 4 };
+    uint32_t nTrans = sizeof(counts) / sizeof(uint32_t);
+
+    CBlockTraces block;
+    bool parsed = block.parseJson(BLOCK_NUM, blockJson(counts, nTrans, false));
+    cout << "parsed: " << (parsed ? "true" : "false") << "\n";
+    report(block);
+
+    CBlockTraces unordered;
+    parsed = unordered.parseJson(BLOCK_NUM, blockJson(counts, nTrans, true));
+    cout << "parsed out of order: " << (parsed ? "true" : "false") << "\n";
+
+    removeFile(TRACE_FILE);
+    cout << "written: " << (block.writeTo(TRACE_FILE) ? "true" : "false") << "\n";
+    CBlockTraces reread;
+    cout << "read: " << (reread.readFrom(TRACE_FILE) ? "true" : "false") << "\n";
+    report(reread);
+
+    bool same = (reread.blockHash == block.blockHash && reread.traces.getCount() == block.traces.getCount());
+    for (uint32_t i = 0 ; i < block.traces.getCount() && same ; i++)
+        same = (reread.traces[i].Format() == block.traces[i].Format());
+    cout << "same after reading: " << (same ? "true" : "false") << "\n";
+    removeFile(TRACE_FILE);
+
+    CTransaction trans;
+    trans.blockNumber = BLOCK_NUM;
+    trans.transactionIndex = 3;
+    trans.hash = txHash(3);
+    cout << "has 3: " << (reread.hasTransaction(trans) ? "true" : "false") << "\n";
+    trans.hash = txHash(4);
+    cout << "has 3 with 4's hash: " << (reread.hasTransaction(trans) ? "true" : "false") << "\n";
+    trans.transactionIndex = 5;
+    trans.hash = txHash(5);
+    cout << "has 5: " << (reread.hasTransaction(trans) ? "true" : "false") << "\n";
+
+    return 0;
+}
@@ -0,0 +1,105 @@
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include "utillib.h"
+
+#define N_BLOOMS 500
+
+//--------------------------------------------------------------
+uint64_t nextRandom(uint64_t& state) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+//--------------------------------------------------------------
+// Sparse blooms, like those of a single address, and dense ones, like a busy block's
+void makeBlooms(CBloom2048 *blooms) {
+    uint64_t state = 88172645463325252ULL;
+    for (uint32_t i = 0 ; i < N_BLOOMS ; i++) {
+        blooms[i] = CBloom2048();
+        if (i % 5 == 0)
+            continue;
+        uint32_t nBits = (i % 3 == 0 ? 3 : (uint32_t)(nextRandom(state) % 1500));
+        for (uint32_t b = 0 ; b < nBits ; b++)
+            blooms[i].setBit((uint32_t)nextRandom(state));
+    }
+    // a bloom that is all but one bit of the one before it, so it's a hit in that one
+    for (uint32_t i = 1 ; i < N_BLOOMS ; i += 7) {
+        blooms[i] = blooms[i - 1];
+        for (uint32_t w = 0 ; w < BLOOM_WORDS ; w++) {
+            if (blooms[i].words[w]) {
+                blooms[i].words[w] &= blooms[i].words[w] - 1;
+                break;
+            }
+        }
+    }
+}
+
+//--------------------------------------------------------------
+// Everything the kernels do, done one word at a time
+bool agrees(const CBloom2048& a, const CBloom2048& b) {
+    bool equal = true, contains = true, empty = true;
+    uint32_t bits = 0;
+    CBloom2048 joined;
+    for (uint32_t w = 0 ; w < BLOOM_WORDS ; w++) {
+        equal    = equal && (a.words[w] == b.words[w]);
+        contains = contains && !(b.words[w] & ~a.words[w]);
+        empty    = empty && !a.words[w];
+        bits    += (uint32_t)__builtin_popcountll(a.words[w]);
+        joined.words[w] = a.words[w] | b.words[w];
+    }
+    CBloom2048 result = a;
+    result |= b;
+    return (a == b) == equal && a.contains(b) == contains && a.isEmpty() == empty &&
+            a.bitsSet() == bits && !memcmp(result.words, joined.words, sizeof(joined.words));
+}
+
+//--------------------------------------------------------------
+int main(int argc, const char *argv[]) {
+
+    CDefaultOptions options;
+    options.minArgs = 0;
+    if (!options.prepareArguments(argc, argv))
+        return 0;
+
+    CBloom2048 *blooms = new CBloom2048[N_BLOOMS];
+    makeBlooms(blooms);
+
+    // Each kernel (or, where the processor doesn't have one, the best it does) gives the same
+    // answers as plain words for every pair of blooms
+    const char *names[] = { "", "words", "sse2", "avx2" };
+    for (uint32_t k = BLOOM_KERNEL_WORDS ; k <= BLOOM_KERNEL_AVX2 ; k++) {
+        setBloomKernel(k);
+        uint32_t nWrong = 0, nHits = 0;
+        for (uint32_t i = 0 ; i < N_BLOOMS ; i++) {
+            for (uint32_t j = 0 ; j < N_BLOOMS ; j++) {
+                if (!agrees(blooms[i], blooms[j]))
+                    nWrong++;
+                if (blooms[i].contains(blooms[j]))
+                    nHits++;
+            }
+        }
+        cout << names[k] << ": wrong: " << nWrong << " hits: " << nHits << "\n";
+    }
+
+    cout << "unknown kernel gets the best: " << (setBloomKernel(99) == setBloomKernel(BLOOM_KERNEL_BEST) ? "true" : "false") << "\n";
+    cout << "words always there: " << (setBloomKernel(BLOOM_KERNEL_WORDS) == BLOOM_KERNEL_WORDS ? "true" : "false") << "\n";
+    setBloomKernel(BLOOM_KERNEL_BEST);
+
+    // Converting to and from a big number keeps every bit
+    cout << "round trips: " << (CBloom2048(blooms[3].toUintBN()) == blooms[3] ? "true" : "false") << "\n";
+
+    delete [] blooms;
+    return 0;
+}
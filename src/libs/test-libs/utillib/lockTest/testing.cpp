@@ -0,0 +1,193 @@
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include <chrono>
+#include <thread>
+#include "utillib.h"
+
+#define LOCK_FILE  "./fullBlocks.bin"
+#define N_READERS  4
+#define N_WRITES   200
+#define N_BLOCKS   4096
+#define N_PIECES   8
+
+//--------------------------------------------------------------
+// The writer starts a generation only once every reader has read the last one, and each reader
+// reads once per generation, racing the writer for the lock. So every write meets every reader,
+// and no one ever waits for more than a handful of short reads or one write.
+class CStress {
+public:
+    std::atomic<bool>     done;
+    std::atomic<uint64_t> started;
+    std::atomic<uint64_t> seen[N_READERS];
+    std::atomic<uint32_t> nReads;
+    std::atomic<uint32_t> nTorn;
+    std::atomic<uint32_t> nFailed;
+    uint32_t              readsBy[N_READERS];
+    CStress(void) : done(false), started(0), nReads(0), nTorn(0), nFailed(0) {
+        for (uint32_t i = 0 ; i < N_READERS ; i++)
+            seen[i] = 0;
+        memset(readsBy, 0, sizeof(readsBy));
+    }
+    void waitForReaders(uint64_t gen) {
+        for (uint32_t i = 0 ; i < N_READERS ; i++)
+            while (seen[i] < gen)
+                std::this_thread::yield();
+    }
+};
+
+//--------------------------------------------------------------
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+//--------------------------------------------------------------
+// Every write replaces the file with N_BLOCKS copies of one value, a piece at a time
+bool writeGeneration(uint64_t gen) {
+    CBinFile file;
+    if (!file.Lock(LOCK_FILE, binaryWriteCreate, LOCK_WAIT))
+        return false;
+    uint64_t piece[N_BLOCKS / N_PIECES];
+    for (uint32_t i = 0 ; i < N_BLOCKS / N_PIECES ; i++)
+        piece[i] = gen;
+    for (uint32_t p = 0 ; p < N_PIECES ; p++) {
+        file.Write(piece, sizeof(uint64_t), N_BLOCKS / N_PIECES);
+        file.flush();
+    }
+    file.Release();
+    return true;
+}
+
+//--------------------------------------------------------------
+void writer(CStress *stress) {
+    for (uint64_t gen = 1 ; gen <= N_WRITES ; gen++) {
+        stress->waitForReaders(gen - 1);
+        stress->started = gen;
+        if (!writeGeneration(gen))
+            stress->nFailed++;
+    }
+    stress->waitForReaders(N_WRITES);
+    stress->done = true;
+}
+
+//--------------------------------------------------------------
+// A reader that waits on the lock should only ever see a whole generation
+void reader(CStress *stress, uint32_t id) {
+    uint64_t *values = new uint64_t[N_BLOCKS + 1];
+    uint64_t last = 0;
+    while (!stress->done) {
+        uint64_t gen = stress->started;
+        if (gen == last) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        CBinFile file;
+        if (!file.Lock(LOCK_FILE, binaryReadOnly, LOCK_WAIT) || !file.ownsLock()) {
+            stress->nFailed++;
+        } else {
+            size_t nRead = fread(values, sizeof(uint64_t), N_BLOCKS + 1, file.m_fp);
+            bool whole = (nRead == N_BLOCKS);
+            for (size_t i = 1 ; i < nRead && whole ; i++)
+                whole = (values[i] == values[0]);
+            if (!whole)
+                stress->nTorn++;
+            stress->nReads++;
+            stress->readsBy[id]++;
+        }
+        file.Release();
+        last = gen;
+        stress->seen[id] = gen;
+    }
+    delete [] values;
+}
+
+//--------------------------------------------------------------
+// Removes the legacy lock file a little while after it's told to, and notes when it did
+void removeLegacyLock(std::atomic<bool> *go, std::chrono::steady_clock::time_point *removedAt) {
+    while (!*go)
+        std::this_thread::yield();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    *removedAt = std::chrono::steady_clock::now();
+    removeFile(LOCK_FILE ".lck");
+}
+
+//--------------------------------------------------------------
+int main(int argc, const char *argv[]) {
+
+    CDefaultOptions options;
+    options.minArgs = 0;
+    if (!options.prepareArguments(argc, argv))
+        return 0;
+
+    removeFile(LOCK_FILE);
+    removeFile(LOCK_FILE ".lck");
+    writeGeneration(0);
+
+    // Many readers and one writer
+    CStress stress;
+    std::thread w(writer, &stress);
+    std::thread r[N_READERS];
+    for (uint32_t i = 0 ; i < N_READERS ; i++)
+        r[i] = std::thread(reader, &stress, i);
+    w.join();
+    for (uint32_t i = 0 ; i < N_READERS ; i++)
+        r[i].join();
+
+    bool allRead = true;
+    for (uint32_t i = 0 ; i < N_READERS ; i++)
+        allRead = allRead && stress.readsBy[i] == N_WRITES;
+    cout << "readers: " << N_READERS << " writes: " << N_WRITES << "\n";
+    cout << "every reader read: " << (allRead ? "true" : "false") << "\n";
+    cout << "torn reads: " << stress.nTorn << "\n";
+    cout << "failed locks: " << stress.nFailed << "\n";
+    cout << "no lock file: " << (fileExists(LOCK_FILE ".lck") ? "false" : "true") << "\n";
+    if (verbose)
+        cout << "reads: " << stress.nReads << "\n";
+
+    // Readers share the file...
+    CBinFile reader1, reader2;
+    reader1.Lock(LOCK_FILE, binaryReadOnly, LOCK_WAIT);
+    reader2.Lock(LOCK_FILE, binaryReadOnly, LOCK_WAIT);
+    cout << "readers share: " << (reader1.ownsLock() && reader2.ownsLock() ? "true" : "false") << "\n";
+    cout << "locked while reading: " << (isFileLocked(LOCK_FILE) ? "true" : "false") << "\n";
+    reader1.Release();
+    reader2.Release();
+
+    // ...a writer does not, and a second writer gives up after a while
+    CBinFile writer1, writer2;
+    writer1.Lock(LOCK_FILE, binaryReadWrite, LOCK_WAIT);
+    cout << "locked while writing: " << (isFileLocked(LOCK_FILE) ? "true" : "false") << "\n";
+    auto start = std::chrono::steady_clock::now();
+    bool second = writer2.Lock(LOCK_FILE, binaryReadWrite, LOCK_WAIT);
+    double waited = secondsSince(start);
+    cout << "second writer: " << (second ? "true" : "false") << "\n";
+    // It waits the full three seconds. The upper bound only catches a wait that never ends
+    cout << "gave up in time: " << (waited >= 3. && waited < 60. ? "true" : "false") << "\n";
+    writer1.Release();
+    cout << "unlocked: " << (isFileLocked(LOCK_FILE) ? "false" : "true") << "\n";
+
+    // Lock files left by older versions are still waited on
+    stringToAsciiFile(LOCK_FILE ".lck", "legacy\n");
+    cout << "locked by lock file: " << (isFileLocked(LOCK_FILE) ? "true" : "false") << "\n";
+    std::atomic<bool> go(false);
+    std::chrono::steady_clock::time_point removedAt;
+    std::thread cleaner(removeLegacyLock, &go, &removedAt);
+    go = true;
+    bool afterLegacy = writeGeneration(1);
+    auto writtenAt = std::chrono::steady_clock::now();
+    cleaner.join();
+    cout << "waited for lock file: " << (afterLegacy && removedAt <= writtenAt ? "true" : "false") << "\n";
+
+    removeFile(LOCK_FILE);
+    return 0;
+}
@@ -17,6 +17,26 @@
 // Changing this between qstring and SFString helps migrating away from quickBlocks code
 #define TEST_STR SFString
 
+//------------------------------------------------------------------------
+// Every trip to the heap is counted so that mode 4 can report what parsing a block costs
+static uint64_t nAllocs = 0;
+void *operator new(size_t size) {
+    nAllocs++;
+    void *p = malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+void operator delete(void *p) noexcept {
+    free(p);
+}
+void operator delete[](void *p) noexcept {
+    free(p);
+}
+
 //------------------------------------------------------------------------
 class CThisTest : public testing::Test {
 public:
@@ -78,6 +98,51 @@ TEST_F(CThisTest, TestCompare) {
     return true;
 }}
 
+//------------------------------------------------------------------------
+TEST_F(CThisTest, TestStorage) {
+
+    cerr << "Running " << testName << "\n";
+
+    TEST_STR shortStr = "0x5208";                          // held inline
+    TEST_STR longStr  = "0x5a0b54d5dc17e0aadc383d2db43b0a0d3e029c4c";  // held on the heap
+    TEST_STR grown    = shortStr;
+    for (int i = 0 ; i < 10 ; i++)
+        grown += grown;                                   // appending to itself
+    TEST_STR moved    = std::move(longStr);
+
+    TEST_STR list = "a  b    c";
+    list.ReplaceAll("  ", " ");                          // collapses, as it always has
+    TEST_STR line = "first,second,,third";
+    TEST_STR first = nextTokenClear(line, ',');
+
+    string_view_q view(moved);
+    string_view_q rest = view;
+    string_view_q prefix = nextToken(rest, 'b');
+
+    cout << "grown: " << grown.length() << " " << grown.substr(0, 12) << "\n";
+    cout << "list: " << list << "\n";
+    cout << "line: " << line << "\n";
+    cout << "prefix: " << TEST_STR(prefix) << "\n";
+
+    ASSERT_EQ   ("Grown length",            grown.length(), (size_t)(6 << 10));
+    ASSERT_TRUE ("Grown contents",          grown.endsWith("52080x5208"));
+    ASSERT_EQ   ("Moved from is empty",     longStr.length(), (size_t)0);
+    ASSERT_EQ   ("Moved to",                moved.length(), (size_t)42);
+    ASSERT_EQ   ("Collapsed",               list, TEST_STR("a b c"));
+    ASSERT_EQ   ("First token",             first, TEST_STR("first"));
+    ASSERT_EQ   ("Rest of line",            line, TEST_STR("second,,third"));
+    ASSERT_EQ   ("Second token",            nextTokenClear(line, ','), TEST_STR("second"));
+    ASSERT_EQ   ("Empty token",             nextTokenClear(line, ','), TEST_STR(""));
+    ASSERT_EQ   ("View find",               view.find("dc17"), (size_t)10);
+    ASSERT_TRUE ("View prefix",             prefix == "0x5a0");
+    ASSERT_TRUE ("View rest",               rest.startsWith("54d5") && rest.endsWith('c'));
+    ASSERT_EQ   ("Hex from a view",         hex2Long(view.substr(0, 8)), (uint64_t)0x5a0b54);
+    ASSERT_TRUE ("Starts with",             moved.startsWith("0x") && moved.startsWith('0') && !moved.startsWith("0X"));
+    ASSERT_FALSE("Empty starts with",       TEST_STR().startsWith(""));
+
+    return true;
+}}
+
 //------------------------------------------------------------------------
 void testCStr(void) {
 
@@ -89,6 +154,34 @@ void testCStr(void) {
     }
 }
 
+//------------------------------------------------------------------------
+void testAllocs(void) {
+
+    etherlib_init();
+
+    SFString contents = asciiFileToString("./tests/blocks.json");
+    if (contents.empty()) {
+        cerr << "Could not read ./tests/blocks.json. Quitting...\n";
+        return;
+    }
+
+    const uint64_t nRuns = 10;
+    uint64_t nTrans = 0;
+    uint64_t start = nAllocs;
+    for (uint64_t i = 0 ; i < nRuns ; i++) {
+        // The parser writes into its input, so each run gets its own copy (one allocation)
+        SFString json = contents;
+        CBlock block;
+        block.parseJson(cleanUpJson((char*)(const char*)json));
+        nTrans += block.transactions.getCount();
+    }
+    uint64_t nUsed = nAllocs - start;
+
+    cout << "blocks parsed: "          << nRuns           << "\n";
+    cout << "transactions per block: " << nTrans / nRuns  << "\n";
+    cout << "allocations per block: "  << nUsed  / nRuns  << "\n";
+}
+
 #include "options.h"
 //------------------------------------------------------------------------
 int main(int argc, const char *argv[]) {
@@ -111,6 +204,12 @@ int main(int argc, const char *argv[]) {
 
         } else if (options.testNum == 2) {
             testCStr();
+
+        } else if (options.testNum == 3) {
+            LOAD_TEST(TestStorage);
+
+        } else if (options.testNum == 4) {
+            testAllocs();
         }
     }
 
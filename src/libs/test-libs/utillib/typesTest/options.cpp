@@ -14,7 +14,7 @@
 
 //---------------------------------------------------------------------------------------------------
 CParams params[] = {
-    CParams("~mode", "a number between 0 and 2 inclusive"),
+    CParams("~mode", "a number between 0 and 3 inclusive"),
     CParams("",      "Test 'c' library strings against quickBlocks strings.\n"),
 };
 uint32_t nParams = sizeof(params) / sizeof(CParams);
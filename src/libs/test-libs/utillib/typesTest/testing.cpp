@@ -50,6 +50,223 @@ TEST_F(CThisTest, Test01) {
     return true;
 }}
 
+//------------------------------------------------------------------------
+TEST_F(CThisTest, Test02) {
+
+    cerr << "Running " << testName << "\n";
+
+    SFString addrStr = "0x5a0b54d5dc17e0aadc383d2db43b0a0d3e029c4c";
+    CAddress20 addr(addrStr);
+    CAddress20 upper(toUpper(addrStr).Substitute("0X", "0x"));
+    CAddress20 zero("0x0");
+    CAddress20 bad("0xnot-an-address");
+    CAddress20 tooLong("0x1234567890123456789012345678901234567890ab");
+    CHash32    hash("0xd4e56740f876aef8c010b86a40d5f56745a118d0906a34e69aec8c0db1cb8fa3");
+
+    cout << "addr: "  << addr << "\n";
+    cout << "zero: "  << zero << "\n";
+    cout << "hash: "  << hash << "\n";
+    cout << "sizes: " << sizeof(CAddress20) << " " << sizeof(CHash32) << "\n";
+
+    ASSERT_EQ("Round trip",            addr.toHex(), addrStr);
+    ASSERT_EQ("Upper case",            addr, upper);
+    ASSERT_TRUE("Short is padded",     zero.isZero());
+    ASSERT_FALSE("Bad hex",            bad.fromHex("0xnot-an-address"));
+    ASSERT_TRUE("Bad hex is zero",     bad.isZero());
+    ASSERT_FALSE("Too long",           tooLong.fromHex("0x1234567890123456789012345678901234567890ab"));
+    ASSERT_TRUE("Ordering",            zero < addr);
+    ASSERT_NOT_EQ("Hashing",           std::hash<CAddress20>()(zero), std::hash<CAddress20>()(addr));
+
+    // The binary form is the same as the string it stands for
+    SFString fileName = "./typesTest.bin";
+    SFArchive out(WRITING_ARCHIVE);
+    if (out.Lock(fileName, binaryWriteCreate, LOCK_NOWAIT)) {
+        out << addr << hash << addrStr;
+        out.Release();
+    }
+    SFString asString;
+    CAddress20 addrFromString;
+    CHash32 hashIn;
+    SFArchive in(READING_ARCHIVE);
+    if (in.Lock(fileName, binaryReadOnly, LOCK_NOWAIT)) {
+        in >> asString >> hashIn >> addrFromString;
+        in.Release();
+    }
+    removeFile(fileName);
+
+    ASSERT_EQ("Reads as a string",     asString, addrStr);
+    ASSERT_EQ("Reads as a hash",       hashIn, hash);
+    ASSERT_EQ("String reads as bytes", addrFromString, addr);
+
+    return true;
+}}
+
+//------------------------------------------------------------------------
+TEST_F(CThisTest, Test03) {
+
+    cerr << "Running " << testName << "\n";
+
+    SFStringArray strs;
+    for (uint32_t i = 0 ; i < 1000 ; i++)
+        strs.addValue("item_" + asStringU(i));
+    uint32_t afterAdds = strs.getSize();
+
+    SFStringArray sparse;
+    sparse[5] = "five";                                   // operator[] still grows the array
+    sparse.emplace_back('x', 3);
+
+    SFStringArray moved = std::move(strs);
+    moved.shrink_to_fit();
+
+    SFUintArray nums;
+    nums.reserve(10);
+    uint32_t reserved = nums.getSize();
+    for (uint32_t i = 0 ; i < 10 ; i++)
+        nums.emplace_back(i * i);
+    uint64_t sum = 0;
+    for (auto n : nums)
+        sum += n;
+
+    SFStringArray copied = moved;
+    SFStringArray& alias = copied;
+    copied = alias;
+    cout << "sizes: " << afterAdds << " " << moved.getSize() << " " << reserved << " " << nums.getSize() << "\n";
+    cout << "sparse: " << sparse.getCount() << " [" << sparse[0] << "] " << sparse[5] << " " << sparse[6] << "\n";
+    cout << "sum: " << sum << "\n";
+
+    ASSERT_EQ   ("Count after adds",       moved.getCount(), (uint32_t)1000);
+    ASSERT_EQ   ("Last value",             moved[999], SFString("item_999"));
+    ASSERT_TRUE ("Geometric growth",       afterAdds >= 1000 && afterAdds < 2000);
+    ASSERT_EQ   ("Shrunk",                 moved.getSize(), (uint32_t)1000);
+    ASSERT_EQ   ("Moved from",             strs.getCount(), (uint32_t)0);
+    ASSERT_EQ   ("Sparse count",           sparse.getCount(), (uint32_t)7);
+    ASSERT_TRUE ("Sparse default",         sparse[0].empty());
+    ASSERT_EQ   ("Reserved",               reserved, (uint32_t)10);
+    ASSERT_EQ   ("Range for",              sum, (uint64_t)285);
+    ASSERT_EQ   ("Self assignment",        copied.getCount(), (uint32_t)1000);
+    ASSERT_EQ   ("Copied",                 copied[500], moved[500]);
+
+    return true;
+}}
+
+//------------------------------------------------------------------------
+TEST_F(CThisTest, Test04) {
+
+    cerr << "Running " << testName << "\n";
+
+    SFStringArray names;
+    names.addValue("gasLimit");
+    names.addValue("gasUsed");
+    names.addValue("hash");
+    names.addValue("transactions");
+    names.addValue("transactionsCnt");
+    uint32_t seed = 0;
+    SFUintArray slots;
+    ASSERT_TRUE("Built", CFieldTable::build(names, seed, slots));
+
+    const char *strs[] = { "gasLimit", "gasUsed", "hash", "transactions", "transactionsCnt" };
+    uint8_t bytes[256];
+    for (uint32_t i = 0 ; i < slots.getCount() ; i++)
+        bytes[i] = (uint8_t)slots[i];
+    CFieldTable table(strs, names.getCount(), bytes, slots.getCount(), seed);
+    for (uint32_t i = 0 ; i < names.getCount() ; i++)
+        ASSERT_EQ("Finds " + names[i], table.find(names[i]), i + 1);
+    cout << "slots: " << slots.getCount() << "\n";
+
+    ASSERT_EQ   ("Ignores case",           table.find("GASUSED"), (uint32_t)2);
+    ASSERT_EQ   ("Prefix",                 table.find("gas"), (uint32_t)NO_FIELD);
+    ASSERT_EQ   ("Longer",                 table.find("hashes"), (uint32_t)NO_FIELD);
+    ASSERT_EQ   ("Empty",                  table.find(""), (uint32_t)NO_FIELD);
+
+    SFStringArray dups;
+    dups.addValue("hash");
+    dups.addValue("HASH");
+    ASSERT_FALSE("Duplicates",             CFieldTable::build(dups, seed, slots));
+
+    // The generated classes dispatch through their own tables
+    CBlock block;
+    block.setValueByName("GASLIMIT", "0x10");
+    block.setValueByName("blockNumber", "61");
+    cout << "gasLimit: " << block.gasLimit << " blockNumber: " << block.blockNumber << "\n";
+    ASSERT_EQ   ("Set ignores case",       block.getValueByName("gaslimit"), SFString("16"));
+    ASSERT_EQ   ("Array count",            block.getValueByName("transactionsCnt"), SFString("0"));
+    ASSERT_EQ   ("Custom field",           block.getValueByName("number"), SFString("61"));
+
+    // The runtime class's index follows renames
+    CBlock::registerClass();
+    CRuntimeClass *pClass = GETRUNTIME_CLASS(CBlock);
+    ASSERT_TRUE ("Find field",             pClass->FindField("gasUsed") != NULL);
+    ASSERT_TRUE ("Find is exact",          pClass->FindField("GasUsed") == NULL);
+    RENAME_FIELD(CBlock, "gasUsed", "used");
+    ASSERT_TRUE ("Old name gone",          pClass->FindField("gasUsed") == NULL);
+    ASSERT_TRUE ("New name found",         pClass->FindField("used") != NULL);
+    RENAME_FIELD(CBlock, "used", "gasUsed");
+    HIDE_FIELD(CBlock, "gasUsed");
+    ASSERT_TRUE ("Hidden",                 pClass->isFieldHidden("gasUsed"));
+    UNHIDE_FIELD(CBlock, "gasUsed");
+
+    return true;
+}}
+
+//------------------------------------------------------------------------
+SFString oldFormat(const CBlock& block, const SFString& fmtIn) {
+    CStringExportContext ctx;
+    SFString fmt = fmtIn;
+    while (!fmt.empty())
+        ctx << getNextChunk(fmt, nextBlockChunk, &block);
+    return ctx.str;
+}
+
+//------------------------------------------------------------------------
+TEST_F(CThisTest, Test05) {
+
+    cerr << "Running " << testName << "\n";
+
+    CBlock block;
+    block.blockNumber = 61;
+    block.hash = "0x123456789abcdef" + SFString('0', 49);
+    block.gasUsed = 21000;
+    block.finalized = true;
+
+    // Each display string is shown twice so the second time comes from the cache
+    const char *fmts[] = {
+        "no fields at all",
+        "[{BLOCKNUMBER}]\t[{HASH}]",
+        "text [before {blockNumber} and] after",
+        "[{p:HASH}]: [{hash}]",
+        "[{w:8:hash}]|[{r:8:gasUsed}]|[{w:3:blockNumber}]",
+        "[{b:finalized}final][{b:gasLimit}limited][{gasLimit}]",
+        "[]|[no field]|[{}]|[{missing}]",
+        "`%,[{gasUsed}]%",
+        "unclosed [token {hash}",
+    };
+    for (uint32_t i = 0 ; i < sizeof(fmts) / sizeof(char*) ; i++) {
+        for (uint32_t j = 0 ; j < 2 ; j++) {
+            CStringExportContext ctx;
+            formatChunks(ctx, fmts[i], nextBlockChunk, &block);
+            ASSERT_EQ("Same as getNextChunk", ctx.str, oldFormat(block, fmts[i]));
+            if (j == 0)
+                cout << "[" << fmts[i] << "] => [" << ctx.str << "]\n";
+        }
+    }
+
+    // Nested display strings (the transactions are shown from inside of the block's)
+    CBlock::registerClass();
+    CTransaction::registerClass();
+    CReceipt::registerClass();
+    CLogEntry::registerClass();
+    CTransaction trans;
+    trans.hash = "0xabc";
+    block.transactions[0] = trans;
+    block.transactions[1] = trans;
+    SFString fmt = "[{blockNumber}]: [{transactions}]";
+    SFString nested = block.Format(fmt);
+    cout << "nested: " << nested.length() << " bytes\n";
+    ASSERT_EQ("Nested", nested, oldFormat(block, fmt));
+
+    return true;
+}}
+
 #include "options.h"
 //------------------------------------------------------------------------
 int main(int argc, const char *argv[]) {
@@ -65,6 +282,20 @@ int main(int argc, const char *argv[]) {
             return 0;
     }
 
-    LOAD_TEST(Test01);
+    if (options.testNum == 2) {
+        LOAD_TEST(Test02);
+
+    } else if (options.testNum == 3) {
+        LOAD_TEST(Test03);
+
+    } else if (options.testNum == 4) {
+        LOAD_TEST(Test04);
+
+    } else if (options.testNum == 5) {
+        LOAD_TEST(Test05);
+
+    } else {
+        LOAD_TEST(Test01);
+    }
     return RUN_ALL_TESTS();
 }
@@ -0,0 +1,99 @@
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include "utillib.h"
+
+#define N_ITEMS 2000
+
+//--------------------------------------------------------------
+class CCounts {
+public:
+    std::atomic<uint32_t> visits[N_ITEMS];
+    std::atomic<uint32_t> total;
+    CWorkPool            *pool;
+    uint64_t              cancelAt;
+    CCounts(void) : pool(NULL), cancelAt(N_ITEMS) { Clear(); }
+    void Clear(void) {
+        for (uint32_t i = 0 ; i < N_ITEMS ; i++)
+            visits[i] = 0;
+        total = 0;
+    }
+    bool allOnce(uint64_t nItems) const {
+        for (uint64_t i = 0 ; i < nItems ; i++)
+            if (visits[i] != 1)
+                return false;
+        return true;
+    }
+};
+
+//--------------------------------------------------------------
+void countItem(uint64_t item, void *data) {
+    CCounts *counts = reinterpret_cast<CCounts*>(data);
+    // make some items much slower than others so the threads have to steal
+    if ((item % 97) == 0)
+        usleep(2000);
+    counts->visits[item]++;
+    counts->total++;
+    if (item == counts->cancelAt)
+        counts->pool->cancel();
+}
+
+//--------------------------------------------------------------
+int main(int argc, const char *argv[]) {
+
+    CDefaultOptions options;
+    options.minArgs = 0;
+    if (!options.prepareArguments(argc, argv))
+        return 0;
+
+    uint32_t threads[] = { 1, 2, 3, 8 };
+    uint64_t chunks[]  = { 1, 7, 64, 5000 };
+    for (uint32_t t = 0 ; t < sizeof(threads) / sizeof(uint32_t) ; t++) {
+        CWorkPool pool(threads[t]);
+        for (uint32_t c = 0 ; c < sizeof(chunks) / sizeof(uint64_t) ; c++) {
+            // the same pool runs one job after another
+            CCounts counts;
+            pool.start(N_ITEMS, countItem, &counts, chunks[c]);
+            pool.wait();
+            cout << "threads: " << pool.nThreads() << " chunk: " << chunks[c] << " visited: " << counts.total
+                    << " each once: " << (counts.allOnce(N_ITEMS) ? "true" : "false") << "\n";
+        }
+    }
+
+    CWorkPool pool(4);
+    {
+        CCounts counts;
+        pool.start(0, countItem, &counts);
+        pool.wait();
+        cout << "empty job visited: " << counts.total << "\n";
+    }
+
+    {
+        // with one thread the items run in order, so we know exactly where it stops
+        CWorkPool single(1);
+        CCounts counts;
+        counts.pool = &single;
+        counts.cancelAt = 10;
+        single.start(N_ITEMS, countItem, &counts, 4);
+        single.wait();
+        cout << "cancelled at item 10 visited: " << counts.total << " each once: " << (counts.allOnce(counts.total) ? "true" : "false") << "\n";
+
+        // a cancelled job does not leak into the next one
+        counts.Clear();
+        counts.cancelAt = N_ITEMS;
+        single.start(N_ITEMS, countItem, &counts, 4);
+        single.wait();
+        cout << "after cancel visited: " << counts.total << " each once: " << (counts.allOnce(N_ITEMS) ? "true" : "false") << "\n";
+    }
+
+    return 0;
+}
@@ -25,6 +25,23 @@ IMPLEMENT_NODE(CAccountName, CBaseNode);
 static SFString nextAccountnameChunk(const SFString& fieldIn, const void *dataPtr);
 static SFString nextAccountnameChunk_custom(const SFString& fieldIn, const void *dataPtr);
 
+//---------------------------------------------------------------------------
+// makeClass chose the seed so that no two of these names share a slot in the table
+enum {
+    FLD_SYMBOL = 1,
+    FLD_NAME,
+    FLD_ADDR,
+    FLD_SOURCE,
+    FLD_DESCRIPTION,
+};
+static const char *accountnameFieldNames[] = {
+    "symbol", "name", "addr", "source", "description",
+};
+static const uint8_t accountnameFieldSlots[] = {
+    0, 1, 5, 0, 0, 4, 2, 0, 0, 0, 0, 0, 3, 0, 0, 0,
+};
+static const CFieldTable accountnameFieldTable(accountnameFieldNames, 5, accountnameFieldSlots, 16, 0);
+
 //---------------------------------------------------------------------------
 void CAccountName::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr) const {
     if (!m_showing)
@@ -35,12 +52,10 @@ void CAccountName::Format(CExportContext& ctx, const SFString& fmtIn, void *data
         return;
     }
 
-    SFString fmt = fmtIn;
-    if (handleCustomFormat(ctx, fmt, dataPtr))
+    if (handleCustomFormat(ctx, fmtIn, dataPtr))
         return;
 
-    while (!fmt.empty())
-        ctx << getNextChunk(fmt, nextAccountnameChunk, this);
+    formatChunks(ctx, fmtIn, nextAccountnameChunk, this);
 }
 
 //---------------------------------------------------------------------------
@@ -59,20 +74,12 @@ bool CAccountName::setValueByName(const SFString& fieldName, const SFString& fie
     // EXISTING_CODE
     // EXISTING_CODE
 
-    switch (tolower(fieldName[0])) {
-        case 'a':
-            if ( fieldName % "addr" ) { addr = fieldValue; return true; }
-            break;
-        case 'd':
-            if ( fieldName % "description" ) { description = fieldValue; return true; }
-            break;
-        case 'n':
-            if ( fieldName % "name" ) { name = fieldValue; return true; }
-            break;
-        case 's':
-            if ( fieldName % "symbol" ) { symbol = fieldValue; return true; }
-            if ( fieldName % "source" ) { source = fieldValue; return true; }
-            break;
+    switch (accountnameFieldTable.find(fieldName)) {
+        case FLD_SYMBOL: symbol = fieldValue; return true;
+        case FLD_NAME: name = fieldValue; return true;
+        case FLD_ADDR: addr = fieldValue; return true;
+        case FLD_SOURCE: source = fieldValue; return true;
+        case FLD_DESCRIPTION: description = fieldValue; return true;
         default:
             break;
     }
@@ -195,19 +202,13 @@ SFString CAccountName::getValueByName(const SFString& fieldName) const {
         return ret;
 
     // Return field values
-    switch (tolower(fieldName[0])) {
-        case 'a':
-            if ( fieldName % "addr" ) return addr;
-            break;
-        case 'd':
-            if ( fieldName % "description" ) return description;
-            break;
-        case 'n':
-            if ( fieldName % "name" ) return name;
-            break;
-        case 's':
-            if ( fieldName % "symbol" ) return symbol;
-            if ( fieldName % "source" ) return source;
+    switch (accountnameFieldTable.find(fieldName)) {
+        case FLD_SYMBOL: return symbol;
+        case FLD_NAME: return name;
+        case FLD_ADDR: return addr;
+        case FLD_SOURCE: return source;
+        case FLD_DESCRIPTION: return description;
+        default:
             break;
     }
 
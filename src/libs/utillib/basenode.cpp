@@ -17,6 +17,7 @@
 #include "exportcontext.h"
 #include "conversions.h"
 #include "version.h"
+#include "jsontape.h"
 
 namespace qblocks {
 
@@ -159,6 +160,62 @@ namespace qblocks {
         return parseJson(s, nFields);
     }
 
+    //--------------------------------------------------------------------------------
+    // Copies [from, to) of the tape's text without white space or quotes, as cleanUpJson does
+    static SFString cleanCopy(const CJsonTape& tape, uint32_t from, uint32_t to) {
+        static thread_local SFString scratch;
+        scratch.reserve(to - from + 1);
+        char *out = (char *)scratch.c_str();
+        const char *text = tape.getText();
+
+        size_t n = 0;
+        for (uint32_t pos = from ; pos < to ; pos++) {
+            char ch = text[pos];
+            if (!isWhiteSpace(ch) && ch != '\"')
+                out[n++] = ch;
+        }
+        return SFString(string_view_q(out, n));
+    }
+
+    //--------------------------------------------------------------------------------
+    bool CBaseNode::setValueFromTape(const CJsonTape& tape, uint32_t key) {
+        uint32_t val = key + 1;
+        SFString fieldName(tape.getView(key));
+        switch (tape[val].type) {
+            // The old parser passed objects with their braces and arrays without brackets
+            case JSON_OBJECT:
+                return this->setValueByName(fieldName, cleanCopy(tape, tape[val].start, tape[val].end));
+            case JSON_ARRAY:
+                return this->setValueByName(fieldName, cleanCopy(tape, tape[val].start + 1, tape[val].end - 1));
+            default:
+                break;
+        }
+        return this->setValueByName(fieldName, SFString(tape.getView(val)));
+    }
+
+    //--------------------------------------------------------------------------------
+    bool CBaseNode::parseTape(CJsonTape& tape, uint32_t node) {
+        if (!tape.isObject(node))
+            return false;
+        for (uint32_t key = tape.firstMember(node) ; key != JSON_NOTOKEN ; key = tape.nextMember(node, key))
+            setValueFromTape(tape, key);
+        finishParse();
+        return true;
+    }
+
+    //--------------------------------------------------------------------------------
+    // JSON that hasn't been through cleanUpJson has quotes around its field names
+    static char *startOfRawJson(char *s) {
+        while (*s && (isWhiteSpace(*s) || *s == '[' || *s == ','))
+            s++;
+        if (*s != '{')
+            return NULL;
+        char *t = s + 1;
+        while (isWhiteSpace(*t))
+            t++;
+        return (*t == '\"' || *t == '}') ? s : NULL;
+    }
+
 //#define DEBUG_PARSER
 #ifdef DEBUG_PARSER
     SFString tbs;
@@ -166,6 +223,34 @@ namespace qblocks {
 
     //--------------------------------------------------------------------------------
     char *CBaseNode::parseJson(char *s, uint32_t& nFields) {
+        if (!s)
+            return NULL;
+
+        // Raw JSON (straight from the node, say) is tokenized and parsed from the tape. We only
+        // use the old parser below if it won't tokenize
+        char *raw = startOfRawJson(s);
+        if (raw) {
+            CJsonTape tape;
+            if (tape.tokenize(raw, strlen(raw))) {
+                parseTape(tape, 0);
+                for (uint32_t key = tape.firstMember(0) ; key != JSON_NOTOKEN ; key = tape.nextMember(0, key))
+                    nFields++;
+                char *ret = raw + tape.consumed();
+                while (isWhiteSpace(*ret))
+                    ret++;
+                if (*ret == ',')
+                    ret++;
+                while (isWhiteSpace(*ret))
+                    ret++;
+                if (*ret == ']')
+                    ret++;
+                while (isWhiteSpace(*ret))
+                    ret++;
+                return *ret ? ret : NULL;
+            }
+            s = cleanUpJson(s);
+        }
+
 #ifdef DEBUG_PARSER
         SFString ss = s;
         SFString tt('-',25);
@@ -543,21 +628,41 @@ namespace qblocks {
     }
 
     //---------------------------------------------------------------------------------------------
-    SFString getNextChunk(SFString& fmtOut, NEXTCHUNKFUNC func, const void *data) {
-        SFString chunk = fmtOut;
+    // One piece of a display string: either plain text (in 'pre') or a token, which is a field
+    // with the text that shows around it if the field has a value
+    class CFormatChunk {
+    public:
+        SFString pre;
+        SFString fieldName;
+        SFString post;
+        SFString promptName;
+        uint32_t maxWidth;
+        bool     isBool;
+        bool     isPrompt;
+        bool     rightJust;
+        CFormatChunk(void) : maxWidth(0xdeadbeef), isBool(false), isPrompt(false), rightJust(false) { }
+    };
+    typedef SFArrayBase<CFormatChunk> CFormatChunkArray;
+
+    //---------------------------------------------------------------------------------------------
+    // Pulls the next chunk off of the front of the display string. Nothing here depends on the
+    // object being displayed, which is why we can do it once per display string
+    static void parseNextChunk(SFString& fmtOut, CFormatChunk& chunk) {
+        SFString whole = fmtOut;
         if (!fmtOut.Contains("[")) {
             // There are no more tokens.  Return the last chunk and empty out the format
+            chunk.pre = whole;
             fmtOut = EMPTY;
-            return chunk;
+            return;
         }
 
         if (!fmtOut.startsWith('[')) {
             // We've encountered plain text outside of a token. There is more to process so grab
             // the next chunk and then prepare the remaining chunk by prepending the token.
             // The next time through we will hit the token.
-            chunk  = nextTokenClear(fmtOut, '[', false);
+            chunk.pre = nextTokenClear(fmtOut, '[', false);
             fmtOut = "[" + fmtOut;
-            return chunk;
+            return;
         }
 
         // We've hit a token, toss the start token, look for a field and toss the last token
@@ -565,92 +670,186 @@ namespace qblocks {
         // of squigglies).  Save text inside the start token and outside the field in pre and post
         ASSERT(fmtOut.startsWith('['));
 
-        SFString pre, fieldName, post;
+        SFString fieldName;
         nextTokenClear(fmtOut, '[', false);  // toss the start token
-        if (chunk.Contains("{")) {
+        if (whole.Contains("{")) {
             // we've encountered a field
-            pre       = nextTokenClear(fmtOut, '{', false);
-            fieldName = nextTokenClear(fmtOut, '}', false);
-            post      = nextTokenClear(fmtOut, ']', false);
+            chunk.pre  = nextTokenClear(fmtOut, '{', false);
+            fieldName  = nextTokenClear(fmtOut, '}', false);
+            chunk.post = nextTokenClear(fmtOut, ']', false);
         } else {
             // we've encountered a token with no field inside of it.  Just pull off
-            // the entire contents into post.  It will be returned just below.
-            post = nextTokenClear(fmtOut, ']', false);
+            // the entire contents into post.
+            chunk.post = nextTokenClear(fmtOut, ']', false);
         }
 
         // Either no squigglies were found or an empty pair of squigglies were found.  In either
-        // case return surrounding text (text inside the token and outside the squiggles)
+        // case we show the surrounding text (text inside the token and outside the squiggles)
         if (fieldName.empty())
-            return pre + post;
+            return;
 
         // We have a field so lets process it.
         ASSERT(fieldName.length() >= 2);
-        bool isPrompt = false;
 
         // The fieldname may contain b: in which case the field is a bool. Display only 'true' values
         // (in other words, false is same as empty)
-        bool isBool = false;
         if (fieldName.ContainsI("b:")) {
-            isBool = true;
+            chunk.isBool = true;
             fieldName.ReplaceI("b:", EMPTY);
         }
 
         // The fieldname may contain p: or w:width: or both.  If it contains either it
         // must contain them at the beginning of the string (before the fieldName).  Anything
         // left after the last ':' is considered the fieldName
-        SFString promptName = fieldName;
+        chunk.promptName = fieldName;
         if (fieldName.ContainsI("p:")) {
-            isPrompt = true;
+            chunk.isPrompt = true;
             fieldName.ReplaceI("p:", EMPTY);
-            promptName = fieldName;
+            chunk.promptName = fieldName;
         }
 
-        uint32_t maxWidth = 0xdeadbeef;
-        bool rightJust = false;
         if (fieldName.ContainsI("w:")) {
             ASSERT(fieldName.substr(0,2) % "w:");  // must be first modifier in the string
             fieldName.ReplaceI("w:", EMPTY);   // get rid of the 'w:'
-            maxWidth = toLong32u(fieldName);   // grab the width
+            chunk.maxWidth = toLong32u(fieldName);   // grab the width
             nextTokenClear(fieldName, ':');    // skip to the start of the fieldname
         } else if (fieldName.ContainsI("r:")) {
             ASSERT(fieldName.substr(0,2) % "r:");  // must be first modifier in the string
             fieldName.ReplaceI("r:", EMPTY);   // get rid of the 'w:'
-            maxWidth = toLong32u(fieldName);   // grab the width
+            chunk.maxWidth = toLong32u(fieldName);   // grab the width
             nextTokenClear(fieldName, ':');    // skip to the start of the fieldname
-            rightJust = true;
+            chunk.rightJust = true;
         }
+        chunk.fieldName = fieldName;
+    }
 
-        //--------------------------------------------------------------------
+    //--------------------------------------------------------------------
 #define truncPad(str, size)  (size == 0xdeadbeef ? str : padRight(str.substr(0,size), size))
 #define truncPadR(str, size) (size == 0xdeadbeef ? str : padLeft (str.substr(0,size), size))
 
+    //---------------------------------------------------------------------------------------------
+    // The text that goes between the chunk's 'pre' and 'post'. Returns false if the whole chunk
+    // shows nothing (that is, if the field has no value)
+    static bool getChunkValue(const CFormatChunk& chunk, NEXTCHUNKFUNC func, const void *data, SFString& value) {
+        if (chunk.fieldName.empty()) {
+            value = EMPTY;
+            return true;
+        }
+
         // Get the value of the field.  If the value of the field is empty we return empty for the entire token.
-        SFString fieldValue = (func)(fieldName, data);
-        if (isBool && fieldValue == "0")
-            fieldValue = "";
-        if (!isPrompt && fieldValue.empty())
-            return EMPTY;
-        if (isBool) // we know it's true, so we want to only show the pre and post
-            fieldValue = "";
-        if (rightJust) {
-            fieldValue = truncPadR(fieldValue, maxWidth);  // pad or truncate
+        value = (func)(chunk.fieldName, data);
+        if (chunk.isBool && value == "0")
+            value = "";
+        if (!chunk.isPrompt && value.empty())
+            return false;
+
+        // We are working on a prompt, we show the field's name and not its value
+        if (chunk.isPrompt)
+            value = chunk.promptName;
+        else if (chunk.isBool) // we know it's true, so we want to only show the pre and post
+            value = "";
+
+        if (chunk.rightJust) {
+            value = truncPadR(value, chunk.maxWidth);  // pad or truncate
         } else {
-            fieldValue = truncPad(fieldValue, maxWidth);  // pad or truncate
+            value = truncPad(value, chunk.maxWidth);  // pad or truncate
+        }
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    SFString getNextChunk(SFString& fmtOut, NEXTCHUNKFUNC func, const void *data) {
+        CFormatChunk chunk;
+        parseNextChunk(fmtOut, chunk);
+        SFString value;
+        if (!getChunkValue(chunk, func, data, value))
+            return EMPTY;
+        return chunk.pre + value + chunk.post;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    // A display string split into its chunks
+    class CCompiledFormat {
+    public:
+        SFString          fmt;
+        CFormatChunkArray chunks;
+        explicit CCompiledFormat(const SFString& fmtIn) : fmt(fmtIn) {
+            SFString remains = fmtIn;
+            while (!remains.empty()) {
+                CFormatChunk& chunk = chunks.emplace_back();
+                parseNextChunk(remains, chunk);
+            }
+        }
+    };
+
+    //---------------------------------------------------------------------------------------------
+    // Each thread keeps the display strings it has seen. Nested calls (an array field formats its
+    // items while we are still using the outer format) hold pointers into the cache, so entries
+    // are never removed. Past the limit, new formats are compiled for the one call only.
+    static const uint32_t MAX_COMPILED_FORMATS = 256;
+    class CCompiledFormatCache {
+    public:
+        SFArrayBase<CCompiledFormat*> formats;
+        uint32_t last;
+        CCompiledFormatCache(void) : last(0) { }
+        ~CCompiledFormatCache(void) {
+            for (uint32_t i = 0 ; i < formats.getCount() ; i++)
+                delete formats[i];
+        }
+        const CCompiledFormat *find(const SFString& fmt) {
+            if (last < formats.getCount() && formats[last]->fmt == fmt)
+                return formats[last];
+            for (uint32_t i = 0 ; i < formats.getCount() ; i++) {
+                if (formats[i]->fmt == fmt) {
+                    last = i;
+                    return formats[i];
+                }
+            }
+            return NULL;
+        }
+    };
+    static thread_local CCompiledFormatCache theFormats;
+
+    //---------------------------------------------------------------------------------------------
+    // Text starting with '`%' or equal to '%' sets the context's number format, so that must still
+    // go through operator<< in one piece. Everything else goes straight to the output.
+    static void exportChunk(CExportContext& ctx, const SFString& pre, const SFString& value, const SFString& post) {
+        const SFString& first = !pre.empty() ? pre : (!value.empty() ? value : post);
+        if (first.startsWith('`') || first.startsWith('%')) {
+            ctx << (pre + value + post);
+            return;
         }
+        if (!pre.empty())
+            ctx.Output(pre);
+        if (!value.empty())
+            ctx.Output(value);
+        if (!post.empty())
+            ctx.Output(post);
+    }
+
+    //---------------------------------------------------------------------------------------------
+    static void exportFormat(CExportContext& ctx, const CCompiledFormat& compiled, NEXTCHUNKFUNC func, const void *data) {
+        SFString value;
+        for (uint32_t i = 0 ; i < compiled.chunks.getCount() ; i++) {
+            const CFormatChunk& chunk = compiled.chunks[i];
+            if (getChunkValue(chunk, func, data, value))
+                exportChunk(ctx, chunk.pre, value, chunk.post);
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    void formatChunks(CExportContext& ctx, const SFString& fmt, NEXTCHUNKFUNC func, const void *data) {
+        const CCompiledFormat *compiled = theFormats.find(fmt);
+        if (compiled) {
+            exportFormat(ctx, *compiled, func, data);
 
-        // The field is not hidden, the value of the field is not empty, we are not working
-        // on a prompt, so we toss back the token referencing the value of the field.
-        if (!isPrompt)
-            return pre + fieldValue + post;
+        } else if (theFormats.formats.getCount() < MAX_COMPILED_FORMATS) {
+            theFormats.last = theFormats.formats.getCount();
+            exportFormat(ctx, *theFormats.formats.emplace_back(new CCompiledFormat(fmt)), func, data);
 
-        // We are working on a prompt.  Pick up customizations if any
-        SFString prompt = promptName;
-        if (rightJust) {
-            prompt = truncPadR(prompt, maxWidth);  // pad or truncate
         } else {
-            prompt = truncPad(prompt, maxWidth);  // pad or truncate
+            exportFormat(ctx, CCompiledFormat(fmt), func, data);
         }
-        return pre + prompt + post;
     }
 
     //--------------------------------------------------------------------------------
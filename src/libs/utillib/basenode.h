@@ -18,6 +18,7 @@ namespace qblocks {
     //----------------------------------------------------------------------------
     class CExportContext;
     class SFArchive;
+    class CJsonTape;
 
     //----------------------------------------------------------------------------
     class CBaseNode {
@@ -36,6 +37,9 @@ namespace qblocks {
         virtual bool isKindOf(const CRuntimeClass* pClass) const;
         virtual char *parseJson(char *s, uint32_t& nFields);
         virtual char *parseJson(char *s);
+        // Fills the node from the object at 'node' on the tape. Generated classes with fields
+        // that are objects (or arrays of them) parse those straight from the tape as well.
+        virtual bool parseTape(CJsonTape& tape, uint32_t node);
         virtual char *parseCSV(char *s, uint32_t& nFields, const SFString *fields);
         virtual char *parseText(char *s, uint32_t& nFields, const SFString *fields);
         virtual SFString toJson1(void) const;
@@ -67,6 +71,8 @@ namespace qblocks {
     protected:
         void Init(void);
         void Copy(const CBaseNode& bn);
+        // Hands the member at 'key' to setValueByName, objects and arrays as cleaned up text
+        bool setValueFromTape(const CJsonTape& tape, uint32_t key);
     };
 
     //------------------------------------------------------------------
@@ -92,6 +98,9 @@ namespace qblocks {
 
     //--------------------------------------------------------------------------------------------------------------
     SFString getNextChunk(SFString& fmtOut, NEXTCHUNKFUNC func, const void *data);
+    // Same as calling getNextChunk until the display string is empty, but each display string
+    // is split into its chunks only the first time a thread sees it
+    void     formatChunks(CExportContext& ctx, const SFString& fmt, NEXTCHUNKFUNC func, const void *data);
     SFString fldNotFound(const SFString& str);
 
 }  // namespace qblocks
@@ -38,6 +38,8 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <unordered_set>
+#include <vector>
 
 //-------------------------------------------------------------------------
 using namespace std;  // NOLINT
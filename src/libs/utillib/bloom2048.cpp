@@ -0,0 +1,224 @@
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include "bloom2048.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define BLOOM_X86 1
+#endif
+
+namespace qblocks {
+
+    //-------------------------------------------------------------------------
+    // The kernels come in three flavors. SSE2 is part of every x86_64 so it's the baseline there.
+    // AVX2 kernels are compiled regardless of the build's -m flags and are picked at run time if the
+    // processor supports them. Everywhere else we use plain 64-bit words, which every processor
+    // can also be told to use (see setBloomKernel).
+    //-------------------------------------------------------------------------
+#ifdef BLOOM_X86
+    #define AVX2_TARGET __attribute__((target("avx2,popcnt")))
+
+    //-------------------------------------------------------------------------
+    AVX2_TARGET static void orAVX2(uint64_t *dst, const uint64_t *src) {
+        for (uint32_t i = 0 ; i < BLOOM_WORDS ; i += 4) {
+            __m256i a = _mm256_loadu_si256((const __m256i*)(dst + i));
+            __m256i b = _mm256_loadu_si256((const __m256i*)(src + i));
+            _mm256_storeu_si256((__m256i*)(dst + i), _mm256_or_si256(a, b));
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    // true if every bit in 'test' is also in 'filter'
+    AVX2_TARGET static bool containsAVX2(const uint64_t *filter, const uint64_t *test) {
+        __m256i miss = _mm256_setzero_si256();
+        for (uint32_t i = 0 ; i < BLOOM_WORDS ; i += 4) {
+            __m256i f = _mm256_loadu_si256((const __m256i*)(filter + i));
+            __m256i t = _mm256_loadu_si256((const __m256i*)(test + i));
+            miss = _mm256_or_si256(miss, _mm256_andnot_si256(f, t));
+        }
+        return _mm256_testz_si256(miss, miss);
+    }
+
+    //-------------------------------------------------------------------------
+    AVX2_TARGET static bool equalsAVX2(const uint64_t *a, const uint64_t *b) {
+        __m256i diff = _mm256_setzero_si256();
+        for (uint32_t i = 0 ; i < BLOOM_WORDS ; i += 4) {
+            __m256i x = _mm256_loadu_si256((const __m256i*)(a + i));
+            __m256i y = _mm256_loadu_si256((const __m256i*)(b + i));
+            diff = _mm256_or_si256(diff, _mm256_xor_si256(x, y));
+        }
+        return _mm256_testz_si256(diff, diff);
+    }
+
+    //-------------------------------------------------------------------------
+    AVX2_TARGET static uint32_t popcountAVX2(const uint64_t *w) {
+        uint64_t ret = 0;
+        for (uint32_t i = 0 ; i < BLOOM_WORDS ; i++)
+            ret += (uint64_t)_mm_popcnt_u64(w[i]);
+        return (uint32_t)ret;
+    }
+
+    //-------------------------------------------------------------------------
+    static void orSSE2(uint64_t *dst, const uint64_t *src) {
+        for (uint32_t i = 0 ; i < BLOOM_WORDS ; i += 2) {
+            __m128i a = _mm_loadu_si128((const __m128i*)(dst + i));
+            __m128i b = _mm_loadu_si128((const __m128i*)(src + i));
+            _mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(a, b));
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    static inline bool isZeroSSE2(__m128i v) {
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())) == 0xFFFF;
+    }
+
+    //-------------------------------------------------------------------------
+    static bool containsSSE2(const uint64_t *filter, const uint64_t *test) {
+        __m128i miss = _mm_setzero_si128();
+        for (uint32_t i = 0 ; i < BLOOM_WORDS ; i += 2) {
+            __m128i f = _mm_loadu_si128((const __m128i*)(filter + i));
+            __m128i t = _mm_loadu_si128((const __m128i*)(test + i));
+            miss = _mm_or_si128(miss, _mm_andnot_si128(f, t));
+        }
+        return isZeroSSE2(miss);
+    }
+
+    //-------------------------------------------------------------------------
+    static bool equalsSSE2(const uint64_t *a, const uint64_t *b) {
+        __m128i diff = _mm_setzero_si128();
+        for (uint32_t i = 0 ; i < BLOOM_WORDS ; i += 2) {
+            __m128i x = _mm_loadu_si128((const __m128i*)(a + i));
+            __m128i y = _mm_loadu_si128((const __m128i*)(b + i));
+            diff = _mm_or_si128(diff, _mm_xor_si128(x, y));
+        }
+        return isZeroSSE2(diff);
+    }
+
+#endif
+
+    //-------------------------------------------------------------------------
+    static void orWords(uint64_t *dst, const uint64_t *src) {
+        for (uint32_t i = 0 ; i < BLOOM_WORDS ; i++)
+            dst[i] |= src[i];
+    }
+
+    //-------------------------------------------------------------------------
+    static bool containsWords(const uint64_t *filter, const uint64_t *test) {
+        for (uint32_t i = 0 ; i < BLOOM_WORDS ; i++)
+            if (test[i] & ~filter[i])
+                return false;
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    static uint32_t popcountWords(const uint64_t *w) {
+        uint32_t ret = 0;
+        for (uint32_t i = 0 ; i < BLOOM_WORDS ; i++)
+            ret += (uint32_t)__builtin_popcountll(w[i]);
+        return ret;
+    }
+
+    //-------------------------------------------------------------------------
+    static uint32_t bestKernel(void) {
+#ifdef BLOOM_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt"))
+            return BLOOM_KERNEL_AVX2;
+        return BLOOM_KERNEL_SSE2;
+#else
+        return BLOOM_KERNEL_WORDS;
+#endif
+    }
+
+    //-------------------------------------------------------------------------
+    static uint32_t theKernel = BLOOM_KERNEL_BEST;
+    static inline uint32_t kernel(void) {
+        if (theKernel == BLOOM_KERNEL_BEST)
+            theKernel = bestKernel();
+        return theKernel;
+    }
+
+    //-------------------------------------------------------------------------
+    uint32_t setBloomKernel(uint32_t which) {
+        uint32_t best = bestKernel();
+        if (which == BLOOM_KERNEL_BEST || which > best)
+            which = best;
+        theKernel = which;
+        return theKernel;
+    }
+
+    //-------------------------------------------------------------------------
+    CBloom2048::CBloom2048(const SFUintBN& bn) {
+        memset(words, 0, sizeof(words));
+        for (uint32_t i = 0 ; i < bn.len && i < BLOOM_WORDS ; i++)
+            words[i] = bn.blk[i];
+    }
+
+    //-------------------------------------------------------------------------
+    SFUintBN CBloom2048::toUintBN(void) const {
+        unsigned int len = BLOOM_WORDS;
+        while (len > 0 && words[len - 1] == 0)
+            len--;
+        return SFUintBN(words, len);
+    }
+
+    //-------------------------------------------------------------------------
+    CBloom2048& CBloom2048::operator|=(const CBloom2048& b) {
+        switch (kernel()) {
+#ifdef BLOOM_X86
+            case BLOOM_KERNEL_AVX2: orAVX2(words, b.words); break;
+            case BLOOM_KERNEL_SSE2: orSSE2(words, b.words); break;
+#endif
+            default:                orWords(words, b.words); break;
+        }
+        return *this;
+    }
+
+    //-------------------------------------------------------------------------
+    bool CBloom2048::operator==(const CBloom2048& b) const {
+        switch (kernel()) {
+#ifdef BLOOM_X86
+            case BLOOM_KERNEL_AVX2: return equalsAVX2(words, b.words);
+            case BLOOM_KERNEL_SSE2: return equalsSSE2(words, b.words);
+#endif
+            default:                return !memcmp(words, b.words, sizeof(words));
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    bool CBloom2048::isEmpty(void) const {
+        static const CBloom2048 empty;
+        return operator==(empty);
+    }
+
+    //-------------------------------------------------------------------------
+    bool CBloom2048::contains(const CBloom2048& test) const {
+        switch (kernel()) {
+#ifdef BLOOM_X86
+            case BLOOM_KERNEL_AVX2: return containsAVX2(words, test.words);
+            case BLOOM_KERNEL_SSE2: return containsSSE2(words, test.words);
+#endif
+            default:                return containsWords(words, test.words);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    uint32_t CBloom2048::bitsSet(void) const {
+#ifdef BLOOM_X86
+        if (kernel() == BLOOM_KERNEL_AVX2)
+            return popcountAVX2(words);
+#endif
+        return popcountWords(words);
+    }
+
+}  // namespace qblocks
@@ -0,0 +1,63 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include "basetypes.h"
+#include "biglib.h"
+
+namespace qblocks {
+
+    //-------------------------------------------------------------------------
+    #define BLOOM_BITS  2048
+    #define BLOOM_WORDS (BLOOM_BITS / 64)
+
+    //-------------------------------------------------------------------------
+    // A fixed width, 2048-bit bloom filter. Bit 'n' of the bloom is bit (n % 64) of words[n / 64],
+    // which is the same layout SFUintBN uses, so converting between the two is a copy. Unlike
+    // SFUintBN, it never allocates and the bitwise operations below run on whole vector registers.
+    class CBloom2048 {
+    public:
+        alignas(16) uint64_t words[BLOOM_WORDS];  // 16 is all operator new promises in C++11
+
+        CBloom2048(void) { memset(words, 0, sizeof(words)); }
+        CBloom2048(const CBloom2048& b) { memcpy(words, b.words, sizeof(words)); }
+        CBloom2048(const SFUintBN& bn);
+        explicit CBloom2048(uint64_t val) { memset(words, 0, sizeof(words)); words[0] = val; }
+
+        CBloom2048& operator=(const CBloom2048& b) { memcpy(words, b.words, sizeof(words)); return *this; }
+        CBloom2048& operator=(uint64_t val) { memset(words, 0, sizeof(words)); words[0] = val; return *this; }
+
+        CBloom2048& operator|=(const CBloom2048& b);
+        CBloom2048  operator| (const CBloom2048& b) const { CBloom2048 ret(*this); ret |= b; return ret; }
+        bool        operator==(const CBloom2048& b) const;
+        bool        operator!=(const CBloom2048& b) const { return !operator==(b); }
+        bool        operator==(uint64_t val)        const { return operator==(CBloom2048(val)); }
+        bool        operator!=(uint64_t val)        const { return !operator==(val); }
+
+        void        setBit   (uint32_t bit) { words[(bit % BLOOM_BITS) / 64] |= (1ULL << (bit % 64)); }
+        bool        isEmpty  (void) const;
+        bool        contains (const CBloom2048& test) const;
+        uint32_t    bitsSet  (void) const;
+        SFUintBN    toUintBN (void) const;
+    };
+    typedef SFArrayBase<CBloom2048> CBloom2048Array;
+
+    //-------------------------------------------------------------------------
+    // The kernels the operations above run on. By default, the fastest one the processor has.
+    // Asking for one it doesn't have gets the best it does. Returns the kernel now in use.
+    #define BLOOM_KERNEL_BEST  0
+    #define BLOOM_KERNEL_WORDS 1
+    #define BLOOM_KERNEL_SSE2  2
+    #define BLOOM_KERNEL_AVX2  3
+    extern uint32_t setBloomKernel(uint32_t which);
+
+}  // namespace qblocks
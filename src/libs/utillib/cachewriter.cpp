@@ -0,0 +1,236 @@
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include <fcntl.h>
+#include <unistd.h>
+#include <chrono>
+
+#include "basetypes.h"
+#include "sfos.h"
+#include "cachewriter.h"
+
+namespace qblocks {
+
+    //-------------------------------------------------------------------------
+    CCacheWriter::CCacheWriter(uint32_t maxQueued, uint32_t syncEvery, uint32_t syncMs)
+        : m_maxQueued(max(maxQueued, 1U)), m_syncEvery(max(syncEvery, 1U)), m_syncMs(syncMs),
+          m_nQueued(0), m_nDone(0), m_nSyncs(0), m_nFailed(0), m_failedAtFlush(0), m_nFlushing(0),
+          m_stopping(false) {
+        m_thread = std::thread(&CCacheWriter::writerLoop, this);
+    }
+
+    //-------------------------------------------------------------------------
+    // Everything queued is written and synced before we go
+    CCacheWriter::~CCacheWriter(void) {
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_stopping = true;
+        }
+        m_wake.notify_one();
+        m_thread.join();
+    }
+
+    //-------------------------------------------------------------------------
+    // Takes the bytes (leaving 'bytes' empty) rather than copying them
+    void CCacheWriter::write(const SFString& fileName, std::vector<char>& bytes) {
+        std::unique_lock<std::mutex> lock(m_lock);
+        m_progress.wait(lock, [this] { return m_queue.size() < m_maxQueued; });
+        m_queue.push_back(CQueued());
+        m_queue.back().fileName = fileName.c_str();
+        m_queue.back().bytes.swap(bytes);
+        m_pending[m_queue.back().fileName]++;
+        m_nQueued++;
+        m_wake.notify_one();
+    }
+
+    //-------------------------------------------------------------------------
+    // Returns false if any write failed since the last flush
+    bool CCacheWriter::flush(void) {
+        std::unique_lock<std::mutex> lock(m_lock);
+        uint64_t target = m_nQueued;
+        m_nFlushing++;
+        m_wake.notify_one();
+        m_progress.wait(lock, [this, target] { return m_nDone >= target; });
+        m_nFlushing--;
+        bool ret = (m_nFailed == m_failedAtFlush);
+        m_failedAtFlush = m_nFailed;
+        return ret;
+    }
+
+    //-------------------------------------------------------------------------
+    void CCacheWriter::waitFor(const SFString& fileName) {
+        std::unique_lock<std::mutex> lock(m_lock);
+        if (m_pending.empty())
+            return;
+        std::string name = fileName.c_str();
+        if (m_pending.find(name) == m_pending.end())
+            return;
+        // Someone is waiting, so the writer should not hold the file back for the rest of a group
+        m_nFlushing++;
+        m_wake.notify_one();
+        m_progress.wait(lock, [this, &name] { return m_pending.find(name) == m_pending.end(); });
+        m_nFlushing--;
+    }
+
+    //-------------------------------------------------------------------------
+    uint64_t CCacheWriter::nWritten(void) {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return m_nDone - m_nFailed;
+    }
+
+    //-------------------------------------------------------------------------
+    uint64_t CCacheWriter::nSyncs(void) {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return m_nSyncs;
+    }
+
+    //-------------------------------------------------------------------------
+    uint64_t CCacheWriter::nFailed(void) {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return m_nFailed;
+    }
+
+    //-------------------------------------------------------------------------
+    void CCacheWriter::writerLoop(void) {
+        std::chrono::steady_clock::time_point firstUnsynced;
+        std::unique_lock<std::mutex> lock(m_lock);
+        while (true) {
+            // A group is synced when it's full, when it's old enough, or when someone is waiting
+            // on it and there's nothing more to add to it
+            bool due = !m_unsynced.empty() &&
+                        (m_unsynced.size() >= m_syncEvery ||
+                         (m_queue.empty() && (m_nFlushing || m_stopping)) ||
+                         std::chrono::steady_clock::now() >= firstUnsynced + std::chrono::milliseconds(m_syncMs));
+            if (due) {
+                lock.unlock();
+                syncAll();
+                lock.lock();
+                continue;
+            }
+
+            if (!m_queue.empty()) {
+                CQueued item = std::move(m_queue.front());
+                m_queue.pop_front();
+                m_progress.notify_all();
+                lock.unlock();
+
+                // The same file twice in one group would share a temp file
+                if (m_unsyncedNames.count(item.fileName))
+                    syncAll();
+                if (m_unsynced.empty())
+                    firstUnsynced = std::chrono::steady_clock::now();
+                bool ok = writeOne(item);
+
+                lock.lock();
+                if (!ok)
+                    m_nFailed++;
+                continue;
+            }
+
+            if (m_stopping)
+                break;
+            if (m_unsynced.empty())
+                m_wake.wait(lock);
+            else
+                m_wake.wait_until(lock, firstUnsynced + std::chrono::milliseconds(m_syncMs));
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    // Writes the temp file but leaves it open (and where it is) until the group is synced. A
+    // file that fails joins the group anyway, so it's accounted for in order.
+    bool CCacheWriter::writeOne(const CQueued& item) {
+        CUnsynced unsynced;
+        unsynced.fileName = item.fileName;
+        unsynced.fd = -1;
+        m_unsynced.push_back(unsynced);
+        m_unsyncedNames.insert(item.fileName);
+
+        size_t slash = item.fileName.rfind('/');
+        std::string folder = (slash == std::string::npos ? "." : item.fileName.substr(0, slash + 1));
+        if (!m_folders.count(folder)) {
+            if (!establishFolder(item.fileName.c_str())) {
+                cerr << "CCacheWriter: could not create folder " << folder << "\n";
+                return false;
+            }
+            m_folders.insert(folder);
+        }
+
+        std::string tmpName = item.fileName + ".tmp";
+        int fd = ::open(tmpName.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd == -1) {
+            cerr << "CCacheWriter: could not open " << tmpName << "\n";
+            return false;
+        }
+
+        size_t nWritten = 0;
+        while (nWritten < item.bytes.size()) {
+            ssize_t n = ::write(fd, item.bytes.data() + nWritten, item.bytes.size() - nWritten);
+            if (n <= 0) {
+                cerr << "CCacheWriter: could not write " << tmpName << "\n";
+                ::close(fd);
+                unlink(tmpName.c_str());
+                return false;
+            }
+            nWritten += (size_t)n;
+        }
+        m_unsynced.back().fd = fd;
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    // Syncs the group's files, renames them into place, then syncs the folders they're in (once
+    // each) so the renames last too
+    void CCacheWriter::syncAll(void) {
+        std::set<std::string> folders;
+        uint64_t nFailed = 0;
+        for (size_t i = 0 ; i < m_unsynced.size() ; i++) {
+            const CUnsynced& file = m_unsynced[i];
+            if (file.fd == -1)
+                continue;
+            std::string tmpName = file.fileName + ".tmp";
+            bool ok = (fsync(file.fd) == 0);
+            ::close(file.fd);
+            if (ok)
+                ok = (rename(tmpName.c_str(), file.fileName.c_str()) == 0);
+            if (!ok) {
+                cerr << "CCacheWriter: could not put " << file.fileName << " in place\n";
+                unlink(tmpName.c_str());
+                nFailed++;
+                continue;
+            }
+            size_t slash = file.fileName.rfind('/');
+            folders.insert(slash == std::string::npos ? "." : file.fileName.substr(0, slash + 1));
+        }
+        for (auto folder : folders) {
+            int fd = ::open(folder.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd != -1) {
+                fsync(fd);
+                ::close(fd);
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(m_lock);
+        for (size_t i = 0 ; i < m_unsynced.size() ; i++) {
+            auto it = m_pending.find(m_unsynced[i].fileName);
+            if (it != m_pending.end() && --it->second == 0)
+                m_pending.erase(it);
+        }
+        m_nDone += m_unsynced.size();
+        m_nFailed += nFailed;
+        m_nSyncs++;
+        m_unsynced.clear();
+        m_unsyncedNames.clear();
+        m_progress.notify_all();
+    }
+
+}  // namespace qblocks
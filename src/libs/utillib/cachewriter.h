@@ -0,0 +1,93 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "basetypes.h"
+
+namespace qblocks {
+
+    //-----------------------------------------------------------------------------------------
+    // Writes files behind the caller's back. write() queues the bytes of a file (for example a
+    // block serialized with a writing CMemArchive) and returns; a thread of its own writes them
+    // out. If the queue is full, write() waits, so a fast producer can't outrun the disc.
+    //
+    // Each file goes to 'name.tmp' first. The writer syncs them in groups (every 'syncEvery'
+    // files or 'syncMs' milliseconds, whichever comes first), then renames them into place and
+    // syncs their folders, so a file is either whole or not there at all, even after a crash.
+    // A folder is made the first time a file is written to it and not checked again.
+    //
+    // flush() is a barrier: it returns once everything queued before it is in place and synced.
+    // waitFor() returns once a given file is in place, so a reader sees what was just written.
+    //-----------------------------------------------------------------------------------------
+    class CCacheWriter {
+    public:
+        explicit CCacheWriter(uint32_t maxQueued = 256, uint32_t syncEvery = 100, uint32_t syncMs = 250);
+        ~CCacheWriter(void);
+
+        void     write   (const SFString& fileName, std::vector<char>& bytes);
+        bool     flush   (void);
+        void     waitFor (const SFString& fileName);
+
+        uint64_t nWritten(void);
+        uint64_t nSyncs  (void);
+        uint64_t nFailed (void);
+
+    private:
+        //---------------------------------------------------------------------
+        struct CQueued {
+            std::string       fileName;
+            std::vector<char> bytes;
+        };
+        struct CUnsynced {
+            std::string       fileName;
+            int               fd;
+        };
+
+        const uint32_t                  m_maxQueued;
+        const uint32_t                  m_syncEvery;
+        const uint32_t                  m_syncMs;
+        std::thread                     m_thread;
+        std::mutex                      m_lock;
+        std::condition_variable         m_wake;      // the writer waits for work
+        std::condition_variable         m_progress;  // callers wait for room, files, or syncs
+        std::deque<CQueued>             m_queue;
+        std::map<std::string, uint32_t> m_pending;   // queued or unsynced, by file name
+        uint64_t                        m_nQueued;
+        uint64_t                        m_nDone;
+        uint64_t                        m_nSyncs;
+        uint64_t                        m_nFailed;
+        uint64_t                        m_failedAtFlush;
+        uint32_t                        m_nFlushing;
+        bool                            m_stopping;
+
+        // Only the writer's thread touches these
+        std::vector<CUnsynced>          m_unsynced;
+        std::set<std::string>           m_unsyncedNames;
+        std::set<std::string>           m_folders;
+
+        void writerLoop(void);
+        bool writeOne  (const CQueued& item);
+        void syncAll   (void);
+
+        CCacheWriter(const CCacheWriter&);
+        CCacheWriter& operator=(const CCacheWriter&);
+    };
+
+}  // namespace qblocks
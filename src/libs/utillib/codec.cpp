@@ -0,0 +1,232 @@
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include "codec.h"
+
+namespace qblocks {
+
+    //-------------------------------------------------------------------------
+    #define MIN_MATCH     4
+    #define LAST_LITERALS 5             // the last bytes are always literals...
+    #define MATCH_LIMIT   12            // ...and no match starts this close to the end
+    #define MAX_OFFSET    65535
+    #define HASH_BITS     14
+    #define MAX_RAW_SIZE  (1UL << 30)   // more than any block, so a larger size means a bad file
+
+    //-------------------------------------------------------------------------
+    static inline uint32_t read32(const uint8_t *p) {
+        uint32_t val;
+        memcpy(&val, p, sizeof(val));
+        return val;
+    }
+
+    //-------------------------------------------------------------------------
+    static inline uint32_t hash32(uint32_t val) {
+        return (val * 2654435761U) >> (32 - HASH_BITS);
+    }
+
+    //-------------------------------------------------------------------------
+    // Counts of 15 or more spill into bytes of 255 and a final byte of less
+    static inline void writeCount(std::vector<char>& out, size_t count) {
+        for ( ; count >= 255 ; count -= 255)
+            out.push_back((char)255);
+        out.push_back((char)count);
+    }
+
+    //-------------------------------------------------------------------------
+    static void writeSequence(std::vector<char>& out, const uint8_t *lits, size_t nLits, size_t offset, size_t matchLen) {
+        size_t m = (matchLen ? matchLen - MIN_MATCH : 0);
+        uint8_t token = (uint8_t)((min(nLits, (size_t)15) << 4) | min(m, (size_t)15));
+        out.push_back((char)token);
+        if (nLits >= 15)
+            writeCount(out, nLits - 15);
+        out.insert(out.end(), (const char *)lits, (const char *)lits + nLits);
+        if (!matchLen)
+            return;
+        out.push_back((char)(offset & 0xff));
+        out.push_back((char)(offset >> 8));
+        if (m >= 15)
+            writeCount(out, m - 15);
+    }
+
+    //-------------------------------------------------------------------------
+    void lzCompress(const char *srcIn, size_t srcLen, std::vector<char>& out) {
+        const uint8_t *src = (const uint8_t *)srcIn;
+
+        // Where each hashed four bytes were last seen (plus one, so zero is empty)
+        thread_local std::vector<uint32_t> table;
+        table.assign(1 << HASH_BITS, 0);
+
+        size_t anchor = 0, pos = 0;
+        if (srcLen > MATCH_LIMIT) {
+            size_t limit = srcLen - MATCH_LIMIT;
+            while (pos < limit) {
+                uint32_t seq = read32(src + pos);
+                uint32_t h = hash32(seq);
+                size_t cand = table[h];
+                table[h] = (uint32_t)(pos + 1);
+                if (cand && pos - (cand - 1) <= MAX_OFFSET && read32(src + cand - 1) == seq) {
+                    size_t ref = cand - 1;
+                    size_t len = MIN_MATCH;
+                    size_t maxLen = srcLen - LAST_LITERALS - pos;
+                    while (len < maxLen && src[ref + len] == src[pos + len])
+                        len++;
+                    writeSequence(out, src + anchor, pos - anchor, pos - ref, len);
+                    pos += len;
+                    anchor = pos;
+                    continue;
+                }
+                pos++;
+            }
+        }
+        writeSequence(out, src + anchor, srcLen - anchor, 0, 0);
+    }
+
+    //-------------------------------------------------------------------------
+    static inline bool readCount(const uint8_t *& ip, const uint8_t *end, size_t& count) {
+        uint8_t b;
+        do {
+            if (ip >= end)
+                return false;
+            b = *ip++;
+            count += b;
+        } while (b == 255);
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    bool lzDecompress(const char *srcIn, size_t srcLen, char *dstIn, size_t dstLen) {
+        const uint8_t *ip  = (const uint8_t *)srcIn;
+        const uint8_t *end = ip + srcLen;
+        uint8_t *dst = (uint8_t *)dstIn;
+        size_t op = 0;
+
+        while (ip < end) {
+            uint8_t token = *ip++;
+
+            size_t nLits = (token >> 4);
+            if (nLits == 15 && !readCount(ip, end, nLits))
+                return false;
+            if (nLits > (size_t)(end - ip) || nLits > dstLen - op)
+                return false;
+            memcpy(dst + op, ip, nLits);
+            ip += nLits;
+            op += nLits;
+
+            // The last sequence has literals only
+            if (ip == end)
+                break;
+
+            if (end - ip < 2)
+                return false;
+            size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+            ip += 2;
+            if (offset == 0 || offset > op)
+                return false;
+
+            size_t len = (token & 0xf);
+            if (len == 15 && !readCount(ip, end, len))
+                return false;
+            len += MIN_MATCH;
+            if (len > dstLen - op)
+                return false;
+
+            // A match may run into the bytes it is making (a repeated run), so only copy in one
+            // go when it can't
+            const uint8_t *ref = dst + op - offset;
+            if (offset >= len) {
+                memcpy(dst + op, ref, len);
+            } else {
+                for (size_t i = 0 ; i < len ; i++)
+                    dst[op + i] = ref[i];
+            }
+            op += len;
+        }
+        return (op == dstLen);
+    }
+
+    //-------------------------------------------------------------------------
+    bool hasCodecHeader(const char *data, size_t len) {
+        uint32_t magic = 0;
+        if (len < sizeof(CCodecHeader))
+            return false;
+        memcpy(&magic, data, sizeof(magic));
+        return (magic == CODEC_MAGIC);
+    }
+
+    //-------------------------------------------------------------------------
+    void encodeArchive(uint32_t flags, const std::vector<char>& raw, std::vector<char>& out) {
+        CCodecHeader header;
+        header.magic   = CODEC_MAGIC;
+        header.flags   = flags;
+        header.rawSize = raw.size();
+
+        out.clear();
+        out.reserve(sizeof(header) + raw.size());
+        out.insert(out.end(), (const char *)&header, (const char *)&header + sizeof(header));
+        if (flags & CODEC_LZ)
+            lzCompress(raw.data(), raw.size(), out);
+        else
+            out.insert(out.end(), raw.begin(), raw.end());
+    }
+
+    //-------------------------------------------------------------------------
+    bool decodeArchive(const char *data, size_t len, std::vector<char>& out) {
+        if (!hasCodecHeader(data, len))
+            return false;
+
+        CCodecHeader header;
+        memcpy(&header, data, sizeof(header));
+        if ((header.flags & ~CODEC_ALL) || header.rawSize > MAX_RAW_SIZE)
+            return false;
+
+        data += sizeof(header);
+        len  -= sizeof(header);
+        if (!(header.flags & CODEC_LZ)) {
+            if (len != header.rawSize)
+                return false;
+            out.assign(data, data + len);
+            return true;
+        }
+
+        out.resize((size_t)header.rawSize);
+        return lzDecompress(data, len, out.data(), out.size());
+    }
+
+    //-------------------------------------------------------------------------
+    bool parseCodec(const SFString& nameIn, uint32_t& flags) {
+        SFString name = nameIn;
+        flags = CODEC_NONE;
+        while (!name.empty()) {
+            SFString part = Strip(nextTokenClear(name, ','), ' ');
+            if (part == "hex")
+                flags |= CODEC_HEX;
+            else if (part == "lz")
+                flags |= CODEC_LZ;
+            else if (part != "none")
+                return false;
+        }
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    SFString codecName(uint32_t flags) {
+        switch (flags & CODEC_ALL) {
+            case CODEC_HEX: return "hex";
+            case CODEC_LZ:  return "lz";
+            case CODEC_ALL: return "hex,lz";
+            default:        break;
+        }
+        return "none";
+    }
+
+}  // namespace qblocks
@@ -0,0 +1,66 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include <vector>
+#include "basetypes.h"
+#include "sfstring.h"
+
+namespace qblocks {
+
+    //-----------------------------------------------------------------------------------------
+    // How a cache file's contents are encoded. A file written with a codec starts with a header
+    // naming it, so readers need no setting of their own and files of either kind may sit side by
+    // side. Files without the header are plain archives, as they always were (those start with a
+    // bool, so they can't be taken for the magic number):
+    //
+    //      magic ("QBCZ") | flags | size of the archive once decoded | the archive
+    //
+    // CODEC_HEX:  hex strings were written as the bytes they stand for (see SFArchive)
+    // CODEC_LZ:   the archive is compressed with lzCompress
+    //-----------------------------------------------------------------------------------------
+    #define CODEC_NONE   0
+    #define CODEC_HEX    (1<<0)
+    #define CODEC_LZ     (1<<1)
+    #define CODEC_ALL    (CODEC_HEX | CODEC_LZ)
+    #define CODEC_MAGIC  0x5a434251
+
+    class CCodecHeader {
+    public:
+        uint32_t magic;
+        uint32_t flags;
+        uint64_t rawSize;
+    };
+
+    //-----------------------------------------------------------------------------------------
+    // A small LZ77 compressor in the manner of LZ4's block format: each sequence is a token
+    // (literal count, match length), the literals, and a two byte offset back into what's
+    // already been decoded. It's made for speed of decoding rather than size. lzCompress appends
+    // to 'out'. lzDecompress checks every length and offset against both buffers and returns
+    // false unless the input decodes to exactly 'dstLen' bytes.
+    extern void lzCompress  (const char *src, size_t srcLen, std::vector<char>& out);
+    extern bool lzDecompress(const char *src, size_t srcLen, char *dst, size_t dstLen);
+
+    //-----------------------------------------------------------------------------------------
+    // 'raw' is an archive written with 'flags' (which must include CODEC_HEX if its hex strings
+    // were packed). encodeArchive puts the header in front of it, compressing it if asked to.
+    // decodeArchive does the reverse for anything hasCodecHeader says yes to.
+    extern void encodeArchive (uint32_t flags, const std::vector<char>& raw, std::vector<char>& out);
+    extern bool decodeArchive (const char *data, size_t len, std::vector<char>& out);
+    extern bool hasCodecHeader(const char *data, size_t len);
+
+    //-----------------------------------------------------------------------------------------
+    // Codecs by name ("none", "hex", "lz" or "hex,lz") as they appear in config files
+    extern bool     parseCodec(const SFString& name, uint32_t& flags);
+    extern SFString codecName (uint32_t flags);
+
+}  // namespace qblocks
@@ -71,6 +71,32 @@ namespace qblocks {
 #endif
     }
 
+    //------------------------------------------------------------------
+    SFString bloom2Bytes(const CBloom2048& bl) {
+        if (bl.isEmpty())
+            return "0x0";
+        char ret[2 + BLOOM_BITS / 4 + 1];
+        ret[0] = '0';
+        ret[1] = 'x';
+        char *p = ret + 2;
+        for (int32_t i = BLOOM_WORDS - 1 ; i >= 0 ; i--) {
+            snprintf(p, 17, "%016llx", (unsigned long long)bl.words[i]);
+            p += 16;
+        }
+        return ret;
+    }
+
+    //-------------------------------------------------------------------------
+    SFString bloom2Bits(const CBloom2048& b) {
+        if (b.isEmpty())
+            return "0000";  // same as the SFUintBN version, which expands "0x0"
+        char ret[BLOOM_BITS + 1];
+        for (uint32_t bit = 0 ; bit < BLOOM_BITS ; bit++)
+            ret[BLOOM_BITS - 1 - bit] = ((b.words[bit / 64] >> (bit % 64)) & 1) ? '1' : '0';
+        ret[BLOOM_BITS] = '\0';
+        return ret;
+    }
+
     //-------------------------------------------------------------------------
     SFString bloom2Bits(const SFBloom& b) {
         SFString ret = bloom2Bytes(b).Substitute("0x", "");
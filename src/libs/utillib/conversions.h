@@ -14,30 +14,31 @@
 #include "conversions_base.h"
 #include "sftime.h"
 #include "biglib.h"
+#include "bloom2048.h"
 
 namespace qblocks {
 
     //----------------------------------------------------------------------------
-    inline bool isNumeral(const SFString& test) {
-        for (int32_t i = 0 ; i < (int32_t)test.length() ; i++)
+    inline bool isNumeral(const string_view_q& test) {
+        for (size_t i = 0 ; i < test.length() ; i++)
             if (!isdigit(test[i]))
                 return false;
         return true;
     }
 
     //----------------------------------------------------------------------------
-    inline uint64_t hex2Long(const SFString& inHex) {
-        SFString hex = toLower(inHex.startsWith("0x")?inHex.substr(2):inHex);
-        hex.Reverse();
-        char *s = (char *)(const char*)hex;
-
-        uint64_t ret = 0, mult=1;
-        while (*s) {
-            int val = *s - '0';
-            if (*s >= 'a' && *s <= 'f')
-            val = *s - 'a' + 10;
-            ret += (mult * (uint64_t)val);
-            s++;mult*=16;
+    // Reads the digits in place, most significant first, rather than copying, lowering and
+    // reversing the string. Any non-hex characters are treated exactly as they always were.
+    inline uint64_t hex2Long(const string_view_q& inHex) {
+        string_view_q hex = (inHex.startsWith("0x") ? inHex.substr(2) : inHex);
+
+        uint64_t ret = 0;
+        for (size_t i = 0 ; i < hex.length() ; i++) {
+            char ch = (char)tolower(hex[i]);
+            int val = ch - '0';
+            if (ch >= 'a' && ch <= 'f')
+                val = ch - 'a' + 10;
+            ret = (ret * 16) + (uint64_t)val;
         }
 
         return ret;
@@ -233,7 +234,7 @@ namespace qblocks {
     typedef SFArrayBase<SFAddress> SFAddressArray;
 #define SFHash         SFString
 #define SFBloom        SFUintBN
-    typedef SFArrayBase<SFBloom> SFBloomArray;
+    typedef CBloom2048Array SFBloomArray;
 #define SFWei          SFUintBN
 #define SFGas          uint64_t
 #define blknum_t       uint64_t
@@ -249,12 +250,14 @@ namespace qblocks {
 #define addr2BN        toWei
 #define hex2BN         toWei
 
-#define fromAddress(a)  ((a).empty() ? "0x0" : (a))
-#define fromHash(a)     ((a).empty() ? "0x0" : (a))
 #define fromWei(a)      to_string((a)).c_str()
 #define fromTopic(a)    ("0x"+padLeft(toLower(SFString(to_hex((a)).c_str())),64,'0'))
 #define fromGas(a)      asStringU(a)
 
+    //-------------------------------------------------------------------------
+    inline SFString fromAddress(const SFString& addr) { return (addr.empty() ? "0x0" : addr); }
+    inline SFString fromHash   (const SFString& hash) { return (hash.empty() ? "0x0" : hash); }
+
     //-------------------------------------------------------------------------
     inline SFString toHex(const SFString& str) {
         if (str == "null")
@@ -271,6 +274,8 @@ namespace qblocks {
 
     extern SFString bloom2Bytes(const SFBloom& bl);
     extern SFString bloom2Bits(const SFBloom& b);
+    extern SFString bloom2Bytes(const CBloom2048& bl);
+    extern SFString bloom2Bits(const CBloom2048& b);
 
 #define fromUnsigned(a) asStringU((a))
 
@@ -338,6 +343,11 @@ namespace qblocks {
         return count;
     }
 
+    //-------------------------------------------------------------------------
+    inline uint32_t bitsTwiddled(const CBloom2048& n) {
+        return n.bitsSet();
+    }
+
 // NEW_CODE
     //-------------------------------------------------------------------------
     inline bool isUnsigned(const SFString& in) {
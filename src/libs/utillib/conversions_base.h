@@ -16,11 +16,11 @@ namespace qblocks {
 
     using timestamp_t = int64_t;
 #define isHex(cc) (isdigit(cc) || (cc) == 'x' || ((cc) >= 'a' && (cc) <= 'f') || ((cc) >= 'A' && (cc) <= 'F'))
-    inline bool isHexStr(const SFString& str) {
+    inline bool isHexStr(const string_view_q& str) {
         if (!str.startsWith("0x"))
             return false;
         for (size_t i = 2 ; i < str.length() ; i++)
-            if (!isHex(str[(int)i]))
+            if (!isHex(str[i]))
                 return false;
         return true;
     }
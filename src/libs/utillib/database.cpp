@@ -10,6 +10,14 @@
  * General Public License for more details. You should have received a copy of the GNU General
  * Public License along with this program. If not, see http://www.gnu.org/licenses/.
  *-------------------------------------------------------------------------------------------*/
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
 #include "basetypes.h"
 
 #include "database.h"
@@ -21,11 +29,14 @@
 namespace qblocks {
 
     #define maxSecondsLock 3
+    #define firstLockWait  .001
+    #define maxLockWait    .05
 
     #define LK_NO_CREATE_LOCK_FILE 1
     #define LK_FILE_NOT_EXIST      2
     #define LK_BAD_OPEN_MODE       3
     #define LK_NO_REMOVE_LOCK      4
+    #define LK_LOCK_TIMEOUT        5
 
     //----------------------------------------------------------------------
     extern SFString manageRemoveList(const SFString& filename="");
@@ -40,80 +51,221 @@ namespace qblocks {
     }
 
     //----------------------------------------------------------------------
-    bool CSharedResource::createLockFile(const SFString& lockfilename) {
-        if (!g_locking)
-            return true;
+    // Open file description locks belong to the descriptor rather than the process, so two
+    // threads (or two objects in one thread) exclude each other just as two processes do.
+    // Where they are not available, flock behaves the same way.
+#ifdef F_OFD_SETLK
+    static struct flock wholeFile(bool exclusive) {
+        struct flock fl;
+        memset(&fl, 0, sizeof(fl));
+        fl.l_type   = (short)(exclusive ? F_WRLCK : F_RDLCK);
+        fl.l_whence = SEEK_SET;
+        return fl;
+    }
+#endif
 
-        m_ownsLock = false;
-        FILE *fp = fopen((const char *)lockfilename, asciiWriteCreate);
-        if (fp) {
-            fprintf(fp, "%s\n", (const char *)m_lockingUser);
-            fclose(fp);
-            m_ownsLock = true;
-            manageRemoveList(lockfilename);
-            return m_ownsLock;
-        }
-        m_error = LK_NO_CREATE_LOCK_FILE;
-        m_errorMsg = "Could not create lock file: " + lockfilename;
-        return false;  // why could I not create the lock file?
+    //----------------------------------------------------------------------
+    static bool tryFileLock(int fd, bool exclusive) {
+#ifdef F_OFD_SETLK
+        struct flock fl = wholeFile(exclusive);
+        return fcntl(fd, F_OFD_SETLK, &fl) == 0;
+#else
+        return flock(fd, (exclusive ? LOCK_EX : LOCK_SH) | LOCK_NB) == 0;
+#endif
     }
 
     //----------------------------------------------------------------------
-    bool CSharedResource::createLock(bool createOnFail) {
-        if (!g_locking)
-            return true;
+    // Sleeps a little longer each time it's called. Returns false (without sleeping) once we've
+    // waited maxSecondsLock in total.
+    static bool backOff(double& waited, double& delay) {
+        if (waited >= maxSecondsLock)
+            return false;
+        qbSleep((float)delay);
+        waited += delay;
+        delay = min(delay * 2., maxLockWait);
+        return true;
+    }
 
-        SFString lockFilename = m_filename + ".lck";
+#if defined(F_OFD_SETLKW) && defined(SIGEV_THREAD_ID)
+    #ifndef sigev_notify_thread_id
+    #define sigev_notify_thread_id _sigev_un._tid
+    #endif
+    #define LOCK_SIGNAL      SIGRTMIN
+    #define LOCK_REPEAT_NSEC 10000000  // 10ms
 
-        int i = 0;
-        while (i < maxSecondsLock) {
-            if (!fileExists(lockFilename))
-                return createLockFile(lockFilename);
-            qbSleep(1.0);
-            i++;
-        }
+    //----------------------------------------------------------------------
+    static double monotonicNow(void) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (double)ts.tv_sec + (double)ts.tv_nsec / 1000000000.;
+    }
 
-        // Someone has had the lock for maxSecondsLock seconds -- if told to blow that lock away
-        if (createOnFail) {
-            // Release the old lock and create a new one
-            m_ownsLock = true;
-            Release();
-            return createLockFile(lockFilename);
+    //----------------------------------------------------------------------
+    // The signal does nothing but interrupt the wait. It is installed without SA_RESTART, so
+    // the wait returns EINTR instead of starting over. If the program already handles (or
+    // ignores) the signal we leave it alone, and waiters fall back to polling.
+    static void onLockTimer(int sig) { }
+    static bool installLockSignal(void) {
+        struct sigaction current;
+        if (sigaction(LOCK_SIGNAL, NULL, &current) != 0)
+            return false;
+        if ((current.sa_flags & SA_SIGINFO) || current.sa_handler != SIG_DFL)
+            return false;
+
+        struct sigaction sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_handler = onLockTimer;
+        sigemptyset(&sa.sa_mask);
+        return sigaction(LOCK_SIGNAL, &sa, NULL) == 0;
+    }
+
+    //----------------------------------------------------------------------
+    // Waits in the kernel (which queues us and wakes us when the lock is free) for up to
+    // 'seconds'. A timer aimed at this thread alone interrupts the wait when time is up. It
+    // keeps firing every 10ms after that, in case the first signal lands just before we wait.
+    // Returns false if we timed out or could not set up the timer, in which case 'timedOut'
+    // tells the two apart.
+    static bool waitFileLock(int fd, bool exclusive, double seconds, bool& timedOut) {
+        static bool haveSignal = installLockSignal();
+        timedOut = false;
+        if (!haveSignal)
+            return false;
+
+        struct sigevent sev;
+        memset(&sev, 0, sizeof(sev));
+        sev.sigev_notify           = SIGEV_THREAD_ID;
+        sev.sigev_signo            = LOCK_SIGNAL;
+        sev.sigev_notify_thread_id = (pid_t)syscall(SYS_gettid);
+        timer_t timer;
+        if (timer_create(CLOCK_MONOTONIC, &sev, &timer) != 0)
+            return false;
+
+        // The thread may have the signal blocked (worker threads often block everything)
+        sigset_t mask, prevMask;
+        sigemptyset(&mask);
+        sigaddset(&mask, LOCK_SIGNAL);
+        pthread_sigmask(SIG_UNBLOCK, &mask, &prevMask);
+
+        double start = monotonicNow();
+        struct itimerspec its;
+        memset(&its, 0, sizeof(its));
+        its.it_value.tv_sec     = (time_t)seconds;
+        its.it_value.tv_nsec    = (long)((seconds - (double)its.it_value.tv_sec) * 1000000000.);
+        its.it_interval.tv_nsec = LOCK_REPEAT_NSEC;
+        if (its.it_value.tv_sec == 0 && its.it_value.tv_nsec == 0)
+            its.it_value.tv_nsec = 1;
+        timer_settime(timer, 0, &its, NULL);
+
+        struct flock fl = wholeFile(exclusive);
+        bool locked = false;
+        while (!locked) {
+            locked = (fcntl(fd, F_OFD_SETLKW, &fl) == 0);
+            // Some other signal may have woken us early, so only the clock says when we're done
+            if (!locked && (errno != EINTR || monotonicNow() - start >= seconds))
+                break;
         }
+        timedOut = !locked && errno == EINTR;
 
-        return false;
+        timer_delete(timer);
+        pthread_sigmask(SIG_SETMASK, &prevMask, NULL);
+        return locked;
     }
+#endif
 
     //----------------------------------------------------------------------
-    bool CSharedResource::waitOnLock(bool deleteOnFail) const {
-        if (!g_locking)
+    // Takes the lock, waiting for at most what's left of maxSecondsLock
+    static bool takeFileLock(int fd, bool exclusive, double& waited, double& delay) {
+        if (tryFileLock(fd, exclusive))
+            return true;
+
+#if defined(F_OFD_SETLKW) && defined(SIGEV_THREAD_ID)
+        bool timedOut = false;
+        if (waitFileLock(fd, exclusive, max(0., maxSecondsLock - waited), timedOut))
             return true;
+        if (timedOut)
+            return false;
+#endif
+        // Without a way to wait in the kernel, we try again after a short sleep
+        while (!tryFileLock(fd, exclusive))
+            if (!backOff(waited, delay))
+                return false;
+        return true;
+    }
 
+    //----------------------------------------------------------------------
+    // Older versions locked a file by creating a '.lck' file next to it. We no longer create them,
+    // but until everything that writes the cache has been updated we wait for any we find.
+    bool CSharedResource::waitOnLegacyLock(double& waited, double& delay, bool deleteOnFail) {
         SFString lockFilename = m_filename + ".lck";
+        while (fileExists(lockFilename)) {
+            if (!backOff(waited, delay)) {
+                // Someone has had the lock for maxSecondsLock seconds -- if told to blow that lock away
+                if (deleteOnFail) {
+                    removeFile(lockFilename);
+                    cerr << "Lock cleared...\n";
+                    return true;
+                }
+                return false;
+            }
+        }
+        return true;
+    }
 
-        if (fileExists(lockFilename) && !isTestMode())
-            cerr << "Waiting for lock to clear\n";
+    //----------------------------------------------------------------------
+    bool CSharedResource::createLock(bool exclusive, bool deleteOnFail) {
+        if (!g_locking)
+            return true;
 
-        int i = 0;
-        while (i < maxSecondsLock) {
-            if (!fileExists(lockFilename))
-                return true;
-            qbSleep(1.0);
-            i++;
+        double waited = 0, delay = firstLockWait;
+        if (!waitOnLegacyLock(waited, delay, deleteOnFail)) {
+            m_error = LK_LOCK_TIMEOUT;
+            m_errorMsg = "Lock file was not released: " + m_filename + ".lck";
+            return false;
         }
 
-        // Someone has had the lock for maxSecondsLock seconds -- if told to blow that lock away
-        if (deleteOnFail) {
-            // Release the old lock and create a new one
-            bool owns = m_ownsLock;
-            ((CSharedResource*)this)->m_ownsLock = true;  // NOLINT
-            ((CSharedResource*)this)->Release();          // NOLINT
-            ((CSharedResource*)this)->m_ownsLock = owns;  // NOLINT
-            cerr << "Lock cleared...\n";
-            return true;
+        // We lock before fopen because opening for writing may truncate the file
+        int flags = (exclusive ? O_RDWR | O_CREAT : O_RDONLY);
+        m_lockFd = ::open((const char *)m_filename, flags | O_CLOEXEC, 0666);
+        if (m_lockFd == -1) {
+            m_error = LK_NO_CREATE_LOCK_FILE;
+            m_errorMsg = "Could not open file to lock: " + m_filename;
+            return false;
         }
 
-        return false;
+        if (!takeFileLock(m_lockFd, exclusive, waited, delay)) {
+            ::close(m_lockFd);
+            m_lockFd = -1;
+            m_error = LK_LOCK_TIMEOUT;
+            m_errorMsg = "Timed out waiting for lock: " + m_filename;
+            return false;
+        }
+
+        m_ownsLock = true;
+        return true;
+    }
+
+    //----------------------------------------------------------------------
+    bool CSharedResource::wasReplaced(void) const {
+        struct stat locked, named;
+        if (m_lockFd == -1 || fstat(m_lockFd, &locked) != 0)
+            return false;
+        if (stat((const char *)m_filename, &named) != 0)
+            return true;
+        return (locked.st_ino != named.st_ino || locked.st_dev != named.st_dev);
+    }
+
+    //----------------------------------------------------------------------
+    bool isFileLocked(const SFString& fileName) {
+        if (fileExists(fileName + ".lck"))
+            return true;
+
+        // Someone is writing if we can't get a shared lock
+        int fd = ::open((const char *)fileName, O_RDONLY | O_CLOEXEC);
+        if (fd == -1)
+            return false;
+        bool locked = !tryFileLock(fd, false);
+        ::close(fd);
+        return locked;
     }
 
     //----------------------------------------------------------------------
@@ -159,11 +311,11 @@ namespace qblocks {
         bool openIt = true;
         if (m_mode == binaryReadOnly || m_mode == asciiReadOnly) {
 
-            // Wait for lock to clear...
+            // Wait for writers to finish...
             if (lockType == LOCK_WAIT)
-                waitOnLock(true);
+                createLock(false, true);
 
-            // ... proceed even if it doesn't....
+            // ... proceed even if they don't....
             openIt = true;
 
         } else if (m_mode == binaryReadWrite || m_mode == binaryWriteCreate ||
@@ -171,11 +323,7 @@ namespace qblocks {
                    m_mode == asciiWriteCreate) {
 
             ASSERT(lockType == LOCK_CREATE || lockType == LOCK_WAIT);
-            openIt = createLock(lockType != LOCK_WAIT);
-            if (!openIt) {
-                m_error = LK_NO_CREATE_LOCK_FILE;
-                m_errorMsg = "Could not create lock file: " + m_filename + ".lck";
-            }
+            openIt = createLock(true, lockType != LOCK_WAIT);
 
         } else {
             m_error = LK_BAD_OPEN_MODE;
@@ -195,19 +343,10 @@ namespace qblocks {
     void CSharedResource::Release(void) {
         Close();
 
-        if (g_locking && m_ownsLock) {
-            SFString lockFilename = m_filename + ".lck";
-            bool ret = removeFile((const char *)lockFilename);
-            manageRemoveList("r:"+lockFilename);
-            if (ret != 0) {
-//              fprintf(stdout, "What happened?: %d: %s\n", ret, (const char *)(m_filename + ".lck"));
-                m_error = LK_NO_REMOVE_LOCK;
-                m_errorMsg = "Could not remove lock";
-            } else {
-//              fprintf(stdout, "Removed it: %s\n", (const char *)(m_filename + ".lck"));
-            }
-        }
-
+        // Closing the descriptor releases the lock
+        if (m_lockFd != -1)
+            ::close(m_lockFd);
+        m_lockFd = -1;
         m_ownsLock = false;
     }
 
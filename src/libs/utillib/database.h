@@ -32,11 +32,27 @@ namespace qblocks {
 
     #define LOCK_NOWAIT       1      // read only - do not even check for a lock
     #define LOCK_WAIT         2      // Wait for lock to release return true - if wait too long return false
-    #define LOCK_CREATE       3      // Wait for lock to release - if waiting longer than preset time destroy
-                                     // existing lock and create a new one
+    #define LOCK_CREATE       3      // Wait for lock to release - if waiting longer than preset time on a
+                                     // lock file left by an older version, destroy it and take the lock
+
+    // Note on LOCK_CREATE: when locks were '.lck' files, a writer that waited too long on one
+    // deleted it and went ahead, so LOCK_CREATE always got the file. Kernel locks can't be taken
+    // from a live process and are dropped when a process dies, so there is nothing stale to clear.
+    // Only '.lck' files left by older versions are still removed. If another process holds the
+    // lock for longer than the wait, a LOCK_CREATE writer now fails just as a LOCK_WAIT writer
+    // does, and callers must check Lock's return value.
 
     //------------------------------------------------------------------------
-    // A file that must be locked before being accessed (such as a datafile)
+    // A file that must be locked before being accessed (such as a datafile). Writers hold an
+    // exclusive lock and waiting readers a shared one. The locks are the kernel's advisory locks
+    // on the file itself, so they cost nothing when there's no contention and disappear with the
+    // process that held them. Waiters sleep in the kernel until the lock is free or a few seconds
+    // have passed.
+    //
+    // On Linux, a timer signal (SIGRTMIN) ends a wait that goes on too long. The first wait
+    // installs a handler for it, but only if the program hasn't installed its own. If it has,
+    // waiters poll instead. A program that wants SIGRTMIN for itself must install its handler
+    // before it locks any file.
     //------------------------------------------------------------------------
     class CSharedResource {
     private:
@@ -44,7 +60,7 @@ namespace qblocks {
         SFString m_errorMsg;
         size_t   m_error;
         bool     m_ownsLock;
-        SFString m_lockingUser;
+        int      m_lockFd;
         bool     m_isascii;
 
     protected:
@@ -57,7 +73,7 @@ namespace qblocks {
             m_fp       = NULL;
             m_error    = 0;
             m_ownsLock = false;
-            // m_lockingUser = "";
+            m_lockFd   = -1;
             // m_mode = "";
             // m_errorMsg = "";
             m_isascii  = false;
@@ -79,6 +95,16 @@ namespace qblocks {
             return (m_fp != NULL);
         }
 
+        // False if Lock gave up waiting (readers open the file anyway)
+        bool ownsLock(void) const {
+            return m_ownsLock;
+        }
+
+        // True if the file we locked has since been renamed over or removed. A writer that
+        // replaces a file by renaming a new one over it holds the lock on the old one while it
+        // does, so whoever was waiting for that lock must check this and, if so, lock again.
+        bool wasReplaced(void) const;
+
         long Tell(void) const;
         void Seek(long offset, int whence) const;
         bool Eof(void) const;
@@ -135,9 +161,8 @@ namespace qblocks {
         size_t Read(const char *val) const;
         size_t Write(const char *val) const;
 
-        bool waitOnLock(bool deleteOnFail) const;
-        bool createLockFile(const SFString& lockfilename);
-        bool createLock(bool createOnFail);
+        bool waitOnLegacyLock(double& waited, double& delay, bool deleteOnFail);
+        bool createLock(bool exclusive, bool deleteOnFail);
 
         CSharedResource(const CSharedResource& l);
         CSharedResource& operator=(const CSharedResource& l);
@@ -182,9 +207,8 @@ namespace qblocks {
         return contents;
     }
 
-    inline bool isFileLocked(const SFString& fileName) {
-        return fileExists(fileName + ".lck");
-    }
+    //----------------------------------------------------------------------
+    extern bool isFileLocked(const SFString& fileName);
 
     // Generic binary file
     class CBinFile : public CSharedResource {
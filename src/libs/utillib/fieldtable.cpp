@@ -0,0 +1,85 @@
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include "fieldtable.h"
+
+namespace qblocks {
+
+    //-------------------------------------------------------------------------
+    // FNV-1a on the lower case characters with a final mix so the low bits (which pick the
+    // slot) depend on every character. Generated tables depend on this, so if it changes
+    // every class must be re-generated.
+    uint32_t fieldHash(const char *name, size_t len, uint32_t seed) {
+        uint32_t h = 2166136261u ^ seed;
+        for (size_t i = 0 ; i < len ; i++) {
+            char ch = name[i];
+            if (ch >= 'A' && ch <= 'Z')
+                ch = (char)(ch + ('a' - 'A'));
+            h ^= (uint8_t)ch;
+            h *= 16777619u;
+        }
+        h ^= h >> 16;
+        h *= 0x85ebca6bu;
+        h ^= h >> 13;
+        return h;
+    }
+
+    //-------------------------------------------------------------------------
+    uint32_t CFieldTable::find(const char *name, size_t len) const {
+        uint32_t ord = m_slots[fieldHash(name, len, m_seed) & m_mask];
+        if (ord == NO_FIELD || ord > m_nNames)
+            return NO_FIELD;
+        const char *candidate = m_names[ord - 1];
+        if (strncasecmp(candidate, name, len) || candidate[len] != '\0')
+            return NO_FIELD;
+        return ord;
+    }
+
+    //-------------------------------------------------------------------------
+    bool CFieldTable::build(const SFStringArray& names, uint32_t& seed, SFUintArray& slots) {
+
+        uint32_t nNames = names.getCount();
+        if (nNames > 255)  // the generated slots are bytes
+            return false;
+        for (uint32_t i = 0 ; i < nNames ; i++)
+            for (uint32_t j = i + 1 ; j < nNames ; j++)
+                if (names[i] % names[j])
+                    return false;
+
+        // Start with twice as many slots as names and double until a seed keeps them apart
+        uint32_t nSlots = 2;
+        while (nSlots < nNames * 2)
+            nSlots <<= 1;
+
+        while (true) {
+            for (seed = 0 ; seed < 10000 ; seed++) {
+                slots.Clear();
+                slots.reserve(nSlots);
+                for (uint32_t i = 0 ; i < nSlots ; i++)
+                    slots.emplace_back(NO_FIELD);
+
+                bool collision = false;
+                for (uint32_t i = 0 ; i < nNames && !collision ; i++) {
+                    uint32_t slot = fieldHash(names[i].c_str(), names[i].length(), seed) & (nSlots - 1);
+                    if (slots[slot] != NO_FIELD)
+                        collision = true;
+                    else
+                        slots[slot] = i + 1;
+                }
+                if (!collision)
+                    return true;
+            }
+            nSlots <<= 1;
+        }
+    }
+
+}  // namespace qblocks
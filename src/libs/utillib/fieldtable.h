@@ -0,0 +1,52 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include "basetypes.h"
+#include "sfstring.h"
+
+namespace qblocks {
+
+    //-------------------------------------------------------------------------
+    #define NO_FIELD 0
+
+    //-------------------------------------------------------------------------
+    // Hashes a field name without regard to case
+    extern uint32_t fieldHash(const char *name, size_t len, uint32_t seed);
+
+    //-------------------------------------------------------------------------
+    // Maps a class's field names (ignoring case) to their ordinals, which start at one. makeClass
+    // finds a seed for which no two of the names hash to the same slot and writes the table into
+    // the generated code, so a lookup is one hash, one slot and one compare. Names not in the
+    // table return NO_FIELD.
+    class CFieldTable {
+    public:
+        // constexpr so the generated tables are ready before any other static initializer runs
+        constexpr CFieldTable(const char *const *names, uint32_t nNames, const uint8_t *slots, uint32_t nSlots,
+                              uint32_t seed)
+            : m_names(names), m_nNames(nNames), m_slots(slots), m_mask(nSlots - 1), m_seed(seed) { }
+
+        uint32_t find(const char *name, size_t len) const;
+        uint32_t find(const SFString& name) const { return find(name.c_str(), name.length()); }
+
+        // Used by makeClass to build the table. Returns false if there are duplicate names.
+        static bool build(const SFStringArray& names, uint32_t& seed, SFUintArray& slots);
+
+    private:
+        const char *const *m_names;
+        uint32_t           m_nNames;
+        const uint8_t     *m_slots;
+        uint32_t           m_mask;
+        uint32_t           m_seed;
+    };
+
+}  // namespace qblocks
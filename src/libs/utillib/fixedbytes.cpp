@@ -0,0 +1,96 @@
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include "fixedbytes.h"
+
+namespace qblocks {
+
+    //-------------------------------------------------------------------------
+    // The value of each hex digit, or 0xff for anything else
+    static const uint8_t *hexValues(void) {
+        static uint8_t values[256];
+        static bool been_here = false;
+        if (!been_here) {
+            memset(values, 0xff, sizeof(values));
+            for (int i = 0 ; i < 10 ; i++)
+                values['0' + i] = (uint8_t)i;
+            for (int i = 0 ; i < 6 ; i++) {
+                values['a' + i] = (uint8_t)(10 + i);
+                values['A' + i] = (uint8_t)(10 + i);
+            }
+            been_here = true;
+        }
+        return values;
+    }
+
+    //-------------------------------------------------------------------------
+    bool hexToBytes(const char *str, size_t len, uint8_t *out, size_t width) {
+        static const uint8_t *theHexValues = hexValues();  // C++11 makes this safe across threads
+        memset(out, 0, width);
+        if (len >= 2 && str[0] == '0' && (str[1] == 'x' || str[1] == 'X')) {
+            str += 2;
+            len -= 2;
+        }
+        if (len > width * 2)
+            return false;
+
+        // Digits fill the value from the right, so an odd digit out goes in the low half of the
+        // first byte we touch
+        uint8_t *dest = out + width - (len + 1) / 2;
+        if (len % 2) {
+            uint8_t lo = theHexValues[(uint8_t)*str++];
+            if (lo == 0xff) {
+                memset(out, 0, width);
+                return false;
+            }
+            *dest++ = lo;
+            len--;
+        }
+
+        for (size_t i = 0 ; i < len ; i += 2) {
+            uint8_t hi = theHexValues[(uint8_t)str[i]];
+            uint8_t lo = theHexValues[(uint8_t)str[i + 1]];
+            if (hi == 0xff || lo == 0xff) {
+                memset(out, 0, width);
+                return false;
+            }
+            *dest++ = (uint8_t)((hi << 4) | lo);
+        }
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    void bytesToHex(const uint8_t *in, size_t width, char *out) {
+        static const char *digits = "0123456789abcdef";
+        *out++ = '0';
+        *out++ = 'x';
+        for (size_t i = 0 ; i < width ; i++) {
+            *out++ = digits[in[i] >> 4];
+            *out++ = digits[in[i] & 0xf];
+        }
+        *out = '\0';
+    }
+
+    //-------------------------------------------------------------------------
+    // True if the string is exactly what bytesToHex would write for a 'width' byte value
+    bool isLowerHex(const char *str, size_t len, size_t width) {
+        if (len != 2 + width * 2 || str[0] != '0' || str[1] != 'x')
+            return false;
+        for (size_t i = 2 ; i < len ; i++) {
+            char c = str[i];
+            if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f')))
+                return false;
+        }
+        return true;
+    }
+
+}  // namespace qblocks
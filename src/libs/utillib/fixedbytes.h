@@ -0,0 +1,180 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include <functional>
+#include "basetypes.h"
+#include "sfstring.h"
+
+namespace qblocks {
+
+    //-------------------------------------------------------------------------
+    // Converts between hex strings and raw bytes. hexToBytes accepts an optional "0x" and either
+    // case, and left pads short values with zeros (so "0x0" is the zero address). It returns
+    // false (leaving 'out' zeroed) if the string has more than 'width' bytes or a non-hex digit.
+    // bytesToHex writes "0x", two lower case digits per byte and a terminating zero.
+    extern bool hexToBytes(const char *str, size_t len, uint8_t *out, size_t width);
+    extern void bytesToHex(const uint8_t *in, size_t width, char *out);
+    extern bool isLowerHex(const char *str, size_t len, size_t width);
+
+    //-------------------------------------------------------------------------
+    // A fixed width, binary address or hash. It holds its bytes inline, so copying, comparing
+    // and hashing never touch the heap, and it is trivially copyable so arrays of them may be
+    // moved about with memcpy. On disk it is written exactly like the hex string it stands for
+    // (see sfarchive.h).
+    template<size_t WIDTH>
+    class CFixedBytes {
+    public:
+        uint8_t bytes[WIDTH];
+
+        CFixedBytes(void) { memset(bytes, 0, WIDTH); }
+        explicit CFixedBytes(const SFString& hex) { fromHex(hex); }
+        explicit CFixedBytes(const uint8_t *in) { memcpy(bytes, in, WIDTH); }
+
+        bool     fromHex(const char *str, size_t len) { return hexToBytes(str, len, bytes, WIDTH); }
+        bool     fromHex(const SFString& str) { return fromHex((const char *)str, str.length()); }
+        void     toHex  (char *out) const { bytesToHex(bytes, WIDTH, out); }
+        SFString toHex  (void) const { char out[2 + WIDTH * 2 + 1]; toHex(out); return out; }
+
+        bool     isZero (void) const {
+            for (size_t i = 0 ; i < WIDTH ; i++)
+                if (bytes[i])
+                    return false;
+            return true;
+        }
+
+        int      compare(const CFixedBytes& b) const { return memcmp(bytes, b.bytes, WIDTH); }
+        bool     operator==(const CFixedBytes& b) const { return compare(b) == 0; }
+        bool     operator!=(const CFixedBytes& b) const { return compare(b) != 0; }
+        bool     operator< (const CFixedBytes& b) const { return compare(b) <  0; }
+        bool     operator<=(const CFixedBytes& b) const { return compare(b) <= 0; }
+        bool     operator> (const CFixedBytes& b) const { return compare(b) >  0; }
+        bool     operator>=(const CFixedBytes& b) const { return compare(b) >= 0; }
+
+        // Addresses and hashes are (mostly) keccak output, so the bytes are already well spread.
+        // We fold every word in anyway since some addresses (precompiles, for example) are
+        // nearly all zeros.
+        size_t   hashValue(void) const {
+            uint64_t h = WIDTH, w;
+            size_t i = 0;
+            for ( ; i + 8 <= WIDTH ; i += 8) {
+                memcpy(&w, bytes + i, 8);
+                h = (h ^ w) * 0x9E3779B97F4A7C15ULL;
+            }
+            if (i < WIDTH) {
+                w = 0;
+                memcpy(&w, bytes + i, WIDTH - i);
+                h = (h ^ w) * 0x9E3779B97F4A7C15ULL;
+            }
+            return (size_t)(h ^ (h >> 29));
+        }
+    };
+
+    typedef CFixedBytes<20> CAddress20;
+    typedef CFixedBytes<32> CHash32;
+
+    //-------------------------------------------------------------------------
+    // "", "0x" and "0x0" mean there is no value
+    inline bool isEmptyHex(const char *str, size_t len) {
+        return (len == 0 || (str[0] == '0' && (len == 2 || (len == 3 && str[2] == '0')) && str[1] == 'x'));
+    }
+
+    //-------------------------------------------------------------------------
+    // An address or hash field of the classes we read from the node. Where there is no address
+    // (the 'to' of a contract creation, for example) the node sends "" or "0x", and toAddress
+    // turns those into "0x0". None of them is the zero address, which is a real address, so
+    // these fields carry a flag instead. An empty field sorts before all others, shows as ""
+    // (fromAddress and fromHash show it as "0x0", as they always have) and is written to the
+    // cache as "". Anything that is not a hex value of the right size also reads as empty.
+    template<size_t WIDTH>
+    class CFieldBytes : public CFixedBytes<WIDTH> {
+    public:
+        CFieldBytes(void) : m_empty(true) { }
+        explicit CFieldBytes(const SFString& str) { fromField(str); }
+
+        CFieldBytes& operator=(const SFString& str) { fromField(str); return *this; }
+        CFieldBytes& operator=(const CFixedBytes<WIDTH>& b) {
+            CFixedBytes<WIDTH>::operator=(b);
+            m_empty = false;
+            return *this;
+        }
+
+        bool fromField(const char *str, size_t len) {
+            m_empty = (isEmptyHex(str, len) || !this->fromHex(str, len));
+            if (m_empty)
+                memset(this->bytes, 0, WIDTH);
+            return !m_empty;
+        }
+        bool     fromField(const SFString& str) { return fromField((const char *)str, str.length()); }
+        SFString asString (void) const { return (m_empty ? SFString() : this->toHex()); }
+
+        bool     empty    (void) const { return m_empty; }
+        void     setEmpty (void) { memset(this->bytes, 0, WIDTH); m_empty = true; }
+
+        int      compare(const CFieldBytes& b) const {
+            if (m_empty || b.m_empty)
+                return (int)b.m_empty - (int)m_empty;
+            return CFixedBytes<WIDTH>::compare(b);
+        }
+        bool     operator==(const CFieldBytes& b) const { return compare(b) == 0; }
+        bool     operator!=(const CFieldBytes& b) const { return compare(b) != 0; }
+        bool     operator< (const CFieldBytes& b) const { return compare(b) <  0; }
+        bool     operator> (const CFieldBytes& b) const { return compare(b) >  0; }
+
+        // An address as a user might type it, in either case and with or without zeros
+        bool     operator==(const SFString& str) const { return *this == CFieldBytes(str); }
+        bool     operator!=(const SFString& str) const { return !(*this == str); }
+
+    private:
+        bool m_empty;
+    };
+
+    typedef CFieldBytes<20> CAddressField;
+    typedef CFieldBytes<32> CHashField;
+
+    //-------------------------------------------------------------------------
+    template<size_t WIDTH>
+    inline SFString fromAddress(const CFieldBytes<WIDTH>& item) { return (item.empty() ? "0x0" : item.toHex()); }
+    template<size_t WIDTH>
+    inline SFString fromHash(const CFieldBytes<WIDTH>& item) { return (item.empty() ? "0x0" : item.toHex()); }
+
+    //-------------------------------------------------------------------------
+    template<size_t WIDTH>
+    inline ostream& operator<<(ostream& os, const CFixedBytes<WIDTH>& item) {
+        char out[2 + WIDTH * 2 + 1];
+        item.toHex(out);
+        os << out;
+        return os;
+    }
+
+    //-------------------------------------------------------------------------
+    template<size_t WIDTH>
+    inline ostream& operator<<(ostream& os, const CFieldBytes<WIDTH>& item) {
+        if (!item.empty())
+            os << (const CFixedBytes<WIDTH>&)item;
+        return os;
+    }
+
+}  // namespace qblocks
+
+namespace std {
+    //-------------------------------------------------------------------------
+    template<size_t WIDTH>
+    struct hash<qblocks::CFixedBytes<WIDTH>> {
+        size_t operator()(const qblocks::CFixedBytes<WIDTH>& item) const { return item.hashValue(); }
+    };
+
+    template<size_t WIDTH>
+    struct hash<qblocks::CFieldBytes<WIDTH>> {
+        size_t operator()(const qblocks::CFieldBytes<WIDTH>& item) const { return item.hashValue(); }
+    };
+}  // namespace std
@@ -0,0 +1,255 @@
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include "jsontape.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define JSON_X86 1
+#endif
+
+namespace qblocks {
+
+    //-------------------------------------------------------------------------
+    // For each of the 64 bytes of a block, one bit in each mask
+    class CBlockMasks {
+    public:
+        uint64_t quote;
+        uint64_t backslash;
+        uint64_t structural;
+        uint64_t space;
+    };
+
+#ifdef JSON_X86
+    //-------------------------------------------------------------------------
+    static inline __m128i isAny(__m128i v, char c1, char c2) {
+        return _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(c1)), _mm_cmpeq_epi8(v, _mm_set1_epi8(c2)));
+    }
+
+    //-------------------------------------------------------------------------
+    static void classify(const char *block, CBlockMasks& masks) {
+        masks.quote = masks.backslash = masks.structural = masks.space = 0;
+        for (int i = 0 ; i < 4 ; i++) {
+            __m128i v = _mm_loadu_si128((const __m128i*)(block + 16 * i));
+            __m128i structural = _mm_or_si128(_mm_or_si128(isAny(v, '{', '}'), isAny(v, '[', ']')), isAny(v, ':', ','));
+            __m128i space = _mm_or_si128(isAny(v, ' ', '\t'), isAny(v, '\n', '\r'));
+            int shift = 16 * i;
+            masks.quote      |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\"'))) << shift;
+            masks.backslash  |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))) << shift;
+            masks.structural |= (uint64_t)(uint16_t)_mm_movemask_epi8(structural) << shift;
+            masks.space      |= (uint64_t)(uint16_t)_mm_movemask_epi8(space) << shift;
+        }
+    }
+#else
+    //-------------------------------------------------------------------------
+    static void classify(const char *block, CBlockMasks& masks) {
+        masks.quote = masks.backslash = masks.structural = masks.space = 0;
+        for (int i = 0 ; i < 64 ; i++) {
+            uint64_t bit = (uint64_t)1 << i;
+            switch (block[i]) {
+                case '\"': masks.quote |= bit; break;
+                case '\\': masks.backslash |= bit; break;
+                case '{': case '}': case '[': case ']': case ':': case ',':
+                    masks.structural |= bit;
+                    break;
+                case ' ': case '\t': case '\n': case '\r':
+                    masks.space |= bit;
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+#endif
+
+    //-------------------------------------------------------------------------
+    // Each bit of the result is the xor of that bit and all of the bits below it, which turns
+    // a mask of quotes into a mask of what's between them (the opening quote included)
+    static inline uint64_t prefixXor(uint64_t x) {
+        x ^= x << 1;
+        x ^= x << 2;
+        x ^= x << 4;
+        x ^= x << 8;
+        x ^= x << 16;
+        x ^= x << 32;
+        return x;
+    }
+
+    //-------------------------------------------------------------------------
+    static inline bool endsPrimitive(char c) {
+        switch (c) {
+            case '{': case '}': case '[': case ']': case ':': case ',': case '\"':
+            case ' ': case '\t': case '\n': case '\r':
+                return true;
+            default:
+                break;
+        }
+        return false;
+    }
+
+    //-------------------------------------------------------------------------
+    uint32_t CJsonTape::addToken(jsontype_t type, uint32_t start) {
+        CJsonToken& token = m_tokens[m_nTokens];
+        token.type  = type;
+        token.start = start;
+        token.end   = start;
+        token.next  = m_nTokens + 1;
+        return m_nTokens++;
+    }
+
+    //-------------------------------------------------------------------------
+    bool CJsonTape::tokenize(const char *text, size_t len) {
+
+        m_text     = text;
+        m_len      = len;
+        m_nTokens  = 0;
+        m_consumed = 0;
+
+        uint32_t depth       = 0;
+        uint32_t openString  = JSON_NOTOKEN;
+        uint64_t prevEscape  = 0;  // the block ended in an unescaped backslash
+        uint64_t prevInStr   = 0;  // all ones if the block ended inside of a string
+        uint64_t prevScalar  = 0;  // the block ended in the middle of a number or literal
+
+        for (size_t blockStart = 0 ; blockStart < len ; blockStart += 64) {
+
+            // Stage one: find where every value starts and ends in this block
+            const char *block = text + blockStart;
+            char padded[64];
+            if (len - blockStart < 64) {
+                memset(padded, ' ', sizeof(padded));
+                memcpy(padded, block, len - blockStart);
+                block = padded;
+            }
+
+            CBlockMasks masks;
+            classify(block, masks);
+
+            // A backslash escapes the next character unless it is itself escaped. Backslashes
+            // are rare in what the node sends us, so we walk them one at a time
+            uint64_t escaped = 0;
+            if (masks.backslash || prevEscape) {
+                bool carry = prevEscape;
+                for (int i = 0 ; i < 64 ; i++) {
+                    uint64_t bit = (uint64_t)1 << i;
+                    if (carry) {
+                        escaped |= bit;
+                        carry = false;
+                    } else if (masks.backslash & bit) {
+                        carry = true;
+                    }
+                }
+                prevEscape = carry;
+            }
+
+            uint64_t quotes   = masks.quote & ~escaped;
+            uint64_t inString = prefixXor(quotes) ^ prevInStr;
+            prevInStr = (uint64_t)0 - (inString >> 63);
+
+            uint64_t scalar   = ~(masks.structural | masks.space | masks.quote | inString);
+            uint64_t primStart = scalar & ~((scalar << 1) | prevScalar);
+            prevScalar = scalar >> 63;
+
+            uint64_t events = (masks.structural & ~inString) | quotes | primStart;
+
+            // Stage two: build the tape from those positions
+            while (events) {
+                uint32_t bit = (uint32_t)__builtin_ctzll(events);
+                uint32_t pos = (uint32_t)(blockStart + bit);
+                events &= events - 1;
+
+                bool done = false;
+                switch (text[pos]) {
+                    case '{':
+                    case '[':
+                        m_stack[depth++] = addToken(text[pos] == '{' ? JSON_OBJECT : JSON_ARRAY, pos);
+                        break;
+
+                    case '}':
+                    case ']':
+                    {
+                        if (!depth)
+                            return false;
+                        CJsonToken& token = m_tokens[(uint32_t)m_stack[--depth]];
+                        if (token.type != (uint32_t)(text[pos] == '}' ? JSON_OBJECT : JSON_ARRAY))
+                            return false;
+                        token.end  = pos + 1;
+                        token.next = m_nTokens;
+                        done = (depth == 0);
+                        break;
+                    }
+
+                    case '\"':
+                        if (inString & ((uint64_t)1 << bit)) {
+                            openString = addToken(JSON_STRING, pos);
+                        } else {
+                            m_tokens[openString].end = pos + 1;
+                            openString = JSON_NOTOKEN;
+                            done = (depth == 0);
+                        }
+                        break;
+
+                    case ':':
+                    case ',':
+                        break;
+
+                    default:
+                    {
+                        uint32_t index = addToken(JSON_PRIMITIVE, pos);
+                        uint32_t end = pos;
+                        while (end < len && !endsPrimitive(text[end]))
+                            end++;
+                        m_tokens[index].end = end;
+                        done = (depth == 0);
+                        break;
+                    }
+                }
+
+                if (done) {
+                    m_consumed = m_tokens[0].end;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    //-------------------------------------------------------------------------
+    string_view_q CJsonTape::getView(uint32_t index) const {
+        const CJsonToken& token = m_tokens[index];
+        if (token.type == JSON_STRING)
+            return string_view_q(m_text + token.start + 1, token.end - token.start - 2);
+        return string_view_q(m_text + token.start, token.end - token.start);
+    }
+
+    //-------------------------------------------------------------------------
+    uint32_t CJsonTape::findMember(uint32_t obj, const string_view_q& name) const {
+        if (obj >= m_nTokens || m_tokens[obj].type != JSON_OBJECT)
+            return JSON_NOTOKEN;
+        uint32_t last = m_tokens[obj].next;
+        for (uint32_t key = obj + 1 ; key + 1 < last ; key = m_tokens[key + 1].next)
+            if (getView(key) == name)
+                return key + 1;
+        return JSON_NOTOKEN;
+    }
+
+    //-------------------------------------------------------------------------
+    bool CJsonTape::isArrayOf(uint32_t index, jsontype_t type) const {
+        if (index >= m_nTokens || m_tokens[index].type != JSON_ARRAY)
+            return false;
+        for (uint32_t item = firstItem(index) ; item != JSON_NOTOKEN ; item = nextItem(index, item))
+            if (m_tokens[item].type != (uint32_t)type)
+                return false;
+        return true;
+    }
+
+}  // namespace qblocks
@@ -0,0 +1,92 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include "basetypes.h"
+#include "sfstring.h"
+#include "list.h"
+
+namespace qblocks {
+
+    //-------------------------------------------------------------------------
+    typedef enum { JSON_OBJECT = 1, JSON_ARRAY, JSON_STRING, JSON_PRIMITIVE } jsontype_t;
+    #define JSON_NOTOKEN ((uint32_t)-1)
+
+    //-------------------------------------------------------------------------
+    // One value in the document. 'start' and 'end' are offsets into the text (strings include
+    // their quotes) and 'next' is the index of the first token past this value, so a value's
+    // children are the tokens in [index + 1, next).
+    class CJsonToken {
+    public:
+        uint32_t type;
+        uint32_t start;
+        uint32_t end;
+        uint32_t next;
+    };
+    typedef SFArrayBase<CJsonToken> CJsonTokenArray;
+
+    //-------------------------------------------------------------------------
+    // Splits a JSON document into a flat array of tokens in one pass and without copying the
+    // text. Stage one classifies 64 bytes at a time (with SSE2 if we have it) into masks of
+    // quotes and structural characters, from which it finds every character outside of a
+    // string that starts or ends a value. Stage two walks those positions to build the tape.
+    // Only the first value in the text is tokenized, so the rest of the text is never read.
+    // tokenize() returns false if the brackets do not match or the text ends too soon. It does
+    // not otherwise validate the document and it does not unescape strings.
+    class CJsonTape {
+    public:
+        CJsonTape(void) : m_text(NULL), m_len(0), m_nTokens(0), m_consumed(0) { }
+
+        bool              tokenize   (const char *text, size_t len);
+        bool              tokenize   (const SFString& text) { return tokenize(text.c_str(), text.length()); }
+
+        uint32_t          getCount   (void) const { return m_nTokens; }
+        const char       *getText    (void) const { return m_text; }
+        size_t            consumed   (void) const { return m_consumed; }
+        CJsonToken&       operator[] (uint32_t index) { return m_tokens[index]; }
+        const CJsonToken& operator[] (uint32_t index) const { return m_tokens[index]; }
+
+        // The value's text with the quotes removed from strings
+        string_view_q     getView    (uint32_t index) const;
+        // Index of 'name's value in the object at 'obj', or JSON_NOTOKEN
+        uint32_t          findMember (uint32_t obj, const string_view_q& name) const;
+
+        // Walk an object's members (by the index of their names, each followed by its value) or
+        // an array's items. Each returns JSON_NOTOKEN when there are no more.
+        uint32_t          firstMember(uint32_t obj) const { return firstItem(obj); }
+        uint32_t          nextMember (uint32_t obj, uint32_t key) const { return nextItem(obj, key + 1); }
+        uint32_t          firstItem  (uint32_t arr) const {
+            return (arr + 1 < m_tokens[arr].next ? arr + 1 : JSON_NOTOKEN);
+        }
+        uint32_t          nextItem   (uint32_t arr, uint32_t item) const {
+            uint32_t next = m_tokens[item].next;
+            return (next < m_tokens[arr].next ? next : JSON_NOTOKEN);
+        }
+
+        bool              isObject   (uint32_t index) const {
+            return (index < m_nTokens && m_tokens[index].type == JSON_OBJECT);
+        }
+        // True if 'index' is an array and each of its items is of 'type'
+        bool              isArrayOf  (uint32_t index, jsontype_t type) const;
+
+    private:
+        const char      *m_text;
+        size_t           m_len;
+        CJsonTokenArray  m_tokens;
+        uint32_t         m_nTokens;
+        SFUintArray      m_stack;
+        size_t           m_consumed;
+
+        uint32_t         addToken    (jsontype_t type, uint32_t start);
+    };
+
+}  // namespace qblocks
@@ -0,0 +1,264 @@
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include "keccak.h"
+
+namespace qblocks {
+
+    //-------------------------------------------------------------------------
+    // Keccak-256 has a 1088 bit rate (136 bytes) and a 512 bit capacity
+    #define KECCAK_RATE  136
+    #define KECCAK_LANES 4   // number of states we permute together in keccak256Many
+
+    //-------------------------------------------------------------------------
+    static const uint64_t roundConstants[24] = {
+        0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808aULL, 0x8000000080008000ULL,
+        0x000000000000808bULL, 0x0000000080000001ULL, 0x8000000080008081ULL, 0x8000000000008009ULL,
+        0x000000000000008aULL, 0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000aULL,
+        0x000000008000808bULL, 0x800000000000008bULL, 0x8000000000008089ULL, 0x8000000000008003ULL,
+        0x8000000000008002ULL, 0x8000000000000080ULL, 0x000000000000800aULL, 0x800000008000000aULL,
+        0x8000000080008081ULL, 0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL,
+    };
+
+    //-------------------------------------------------------------------------
+    static const uint32_t rotations[24] = {
+        1,  3,  6, 10, 15, 21, 28, 36, 45, 55,  2, 14, 27, 41, 56,  8, 25, 43, 62, 18, 39, 61, 20, 44,
+    };
+
+    //-------------------------------------------------------------------------
+    static const uint32_t piLanes[24] = {
+        10,  7, 11, 17, 18,  3,  5, 16,  8, 21, 24,  4, 15, 23, 19, 13, 12,  2, 20, 14, 22,  9,  6,  1,
+    };
+
+    //-------------------------------------------------------------------------
+    #define ROTL64(x, y) (((x) << (y)) | ((x) >> (64 - (y))))
+
+    //-------------------------------------------------------------------------
+    // The Keccak-f[1600] permutation applied to 'W' states at once. st[lane][w] holds lane 'lane'
+    // of state 'w', so every step below is the same operation on W adjacent words (which the
+    // compiler turns into vector instructions).
+    template<size_t W>
+    static void keccakF(uint64_t st[25][W]) {
+        uint64_t bc[5][W], t[W];
+        for (uint32_t round = 0 ; round < 24 ; round++) {
+            // Theta
+            for (uint32_t i = 0 ; i < 5 ; i++)
+                for (size_t w = 0 ; w < W ; w++)
+                    bc[i][w] = st[i][w] ^ st[i + 5][w] ^ st[i + 10][w] ^ st[i + 15][w] ^ st[i + 20][w];
+            for (uint32_t i = 0 ; i < 5 ; i++) {
+                for (size_t w = 0 ; w < W ; w++)
+                    t[w] = bc[(i + 4) % 5][w] ^ ROTL64(bc[(i + 1) % 5][w], 1);
+                for (uint32_t j = 0 ; j < 25 ; j += 5)
+                    for (size_t w = 0 ; w < W ; w++)
+                        st[j + i][w] ^= t[w];
+            }
+
+            // Rho and Pi
+            for (size_t w = 0 ; w < W ; w++)
+                t[w] = st[1][w];
+            for (uint32_t i = 0 ; i < 24 ; i++) {
+                uint32_t j = piLanes[i];
+                for (size_t w = 0 ; w < W ; w++) {
+                    uint64_t tmp = st[j][w];
+                    st[j][w] = ROTL64(t[w], rotations[i]);
+                    t[w] = tmp;
+                }
+            }
+
+            // Chi
+            for (uint32_t j = 0 ; j < 25 ; j += 5) {
+                for (uint32_t i = 0 ; i < 5 ; i++)
+                    for (size_t w = 0 ; w < W ; w++)
+                        bc[i][w] = st[j + i][w];
+                for (uint32_t i = 0 ; i < 5 ; i++)
+                    for (size_t w = 0 ; w < W ; w++)
+                        st[j + i][w] ^= (~bc[(i + 1) % 5][w]) & bc[(i + 2) % 5][w];
+            }
+
+            // Iota
+            for (size_t w = 0 ; w < W ; w++)
+                st[0][w] ^= roundConstants[round];
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    static inline uint64_t load64(const uint8_t *p) {
+        uint64_t ret = 0;
+        for (int i = 7 ; i >= 0 ; i--)
+            ret = (ret << 8) | p[i];
+        return ret;
+    }
+
+    //-------------------------------------------------------------------------
+    // Copies the 'n'th rate-sized block of the padded message into 'block'. Returns the number
+    // of blocks in the padded message.
+    static size_t paddedBlock(const uint8_t *in, size_t len, size_t n, uint8_t *block) {
+        size_t nBlocks = (len / KECCAK_RATE) + 1;
+        size_t start = n * KECCAK_RATE;
+        if (start + KECCAK_RATE <= len) {
+            memcpy(block, in + start, KECCAK_RATE);
+            return nBlocks;
+        }
+        size_t have = (start < len ? len - start : 0);
+        memset(block, 0, KECCAK_RATE);
+        if (have)
+            memcpy(block, in + start, have);
+        if (n == nBlocks - 1) {
+            block[have] |= 0x01;  // original Keccak padding (NIST SHA3 uses 0x06)
+            block[KECCAK_RATE - 1] |= 0x80;
+        }
+        return nBlocks;
+    }
+
+    //-------------------------------------------------------------------------
+    static void squeeze(const uint64_t st[4], uint8_t *out) {
+        for (uint32_t i = 0 ; i < 4 ; i++)
+            for (uint32_t b = 0 ; b < 8 ; b++)
+                out[i * 8 + b] = (uint8_t)(st[i] >> (8 * b));
+    }
+
+    //-------------------------------------------------------------------------
+    void keccak256(const uint8_t *in, size_t len, uint8_t *out) {
+        uint64_t st[25][1];
+        memset(st, 0, sizeof(st));
+
+        uint8_t block[KECCAK_RATE];
+        size_t nBlocks = 1;
+        for (size_t n = 0 ; n < nBlocks ; n++) {
+            nBlocks = paddedBlock(in, len, n, block);
+            for (uint32_t i = 0 ; i < KECCAK_RATE / 8 ; i++)
+                st[i][0] ^= load64(block + i * 8);
+            keccakF<1>(st);
+        }
+
+        uint64_t res[4] = { st[0][0], st[1][0], st[2][0], st[3][0] };
+        squeeze(res, out);
+    }
+
+    //-------------------------------------------------------------------------
+    void keccak256Many(const uint8_t * const *ins, const size_t *lens, uint8_t *outs, size_t n) {
+        for (size_t first = 0 ; first < n ; first += KECCAK_LANES) {
+            size_t cnt = min((size_t)KECCAK_LANES, n - first);
+
+            size_t nBlocks[KECCAK_LANES], maxBlocks = 0;
+            for (size_t w = 0 ; w < KECCAK_LANES ; w++) {
+                nBlocks[w] = (w < cnt ? (lens[first + w] / KECCAK_RATE) + 1 : 0);
+                maxBlocks = max(maxBlocks, nBlocks[w]);
+            }
+
+            uint64_t st[25][KECCAK_LANES];
+            memset(st, 0, sizeof(st));
+
+            uint8_t block[KECCAK_RATE];
+            for (size_t b = 0 ; b < maxBlocks ; b++) {
+                for (size_t w = 0 ; w < cnt ; w++) {
+                    if (b < nBlocks[w]) {
+                        paddedBlock(ins[first + w], lens[first + w], b, block);
+                        for (uint32_t i = 0 ; i < KECCAK_RATE / 8 ; i++)
+                            st[i][w] ^= load64(block + i * 8);
+                    }
+                }
+                keccakF<KECCAK_LANES>(st);
+
+                // States that just absorbed their last block are done. We pull their hash out now
+                // because the remaining rounds (needed by longer inputs) will scramble them.
+                for (size_t w = 0 ; w < cnt ; w++) {
+                    if (b == nBlocks[w] - 1) {
+                        uint64_t res[4] = { st[0][w], st[1][w], st[2][w], st[3][w] };
+                        squeeze(res, outs + (first + w) * KECCAK256_LEN);
+                    }
+                }
+            }
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    static inline uint8_t hexNibble(char c) {
+        if (c >= '0' && c <= '9') return (uint8_t)(c - '0');
+        if (c >= 'a' && c <= 'f') return (uint8_t)(c - 'a' + 10);
+        if (c >= 'A' && c <= 'F') return (uint8_t)(c - 'A' + 10);
+        return 0;
+    }
+
+    //-------------------------------------------------------------------------
+    static size_t hexToBytes(const SFString& hexIn, uint8_t *out) {
+        const char *s = (const char*)hexIn;
+        size_t len = hexIn.length();
+        if (len > 1 && s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) {
+            s += 2;
+            len -= 2;
+        }
+        size_t nBytes = len / 2;
+        for (size_t i = 0 ; i < nBytes ; i++)
+            out[i] = (uint8_t)((hexNibble(s[i * 2]) << 4) | hexNibble(s[i * 2 + 1]));
+        return nBytes;
+    }
+
+    //-------------------------------------------------------------------------
+    static SFString bytesToHex(const uint8_t *in, size_t len) {
+        static const char *digits = "0123456789abcdef";
+        char ret[2 + KECCAK256_LEN * 2 + 1];
+        ret[0] = '0';
+        ret[1] = 'x';
+        for (size_t i = 0 ; i < len ; i++) {
+            ret[2 + i * 2]     = digits[in[i] >> 4];
+            ret[2 + i * 2 + 1] = digits[in[i] & 0x0f];
+        }
+        ret[2 + len * 2] = '\0';
+        return ret;
+    }
+
+    //-------------------------------------------------------------------------
+    SFString keccak256(const SFString& hexIn) {
+        uint8_t *bytes = new uint8_t[hexIn.length() / 2 + 1];
+        size_t nBytes = hexToBytes(hexIn, bytes);
+        uint8_t out[KECCAK256_LEN];
+        keccak256(bytes, nBytes, out);
+        delete [] bytes;
+        return bytesToHex(out, KECCAK256_LEN);
+    }
+
+    //-------------------------------------------------------------------------
+    void keccak256Many(const SFStringArray& hexIn, SFStringArray& shaOut) {
+        shaOut.Clear();
+        uint32_t n = hexIn.getCount();
+        if (!n)
+            return;
+
+        // Decode every input into one buffer, then hash them all at once
+        size_t total = 0;
+        for (uint32_t i = 0 ; i < n ; i++)
+            total += hexIn[i].length() / 2 + 1;
+
+        uint8_t  *buffer = new uint8_t[total];
+        uint8_t **ins    = new uint8_t*[n];
+        size_t   *lens   = new size_t[n];
+        uint8_t  *outs   = new uint8_t[n * KECCAK256_LEN];
+
+        uint8_t *p = buffer;
+        for (uint32_t i = 0 ; i < n ; i++) {
+            ins[i] = p;
+            lens[i] = hexToBytes(hexIn[i], p);
+            p += hexIn[i].length() / 2 + 1;
+        }
+
+        keccak256Many(ins, lens, outs, n);
+        for (uint32_t i = 0 ; i < n ; i++)
+            shaOut[i] = bytesToHex(outs + i * KECCAK256_LEN, KECCAK256_LEN);
+
+        delete [] buffer;
+        delete [] ins;
+        delete [] lens;
+        delete [] outs;
+    }
+
+}  // namespace qblocks
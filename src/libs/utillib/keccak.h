@@ -0,0 +1,38 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include "basetypes.h"
+
+namespace qblocks {
+
+    //-------------------------------------------------------------------------
+    // Ethereum's sha3 (the original Keccak-256, not the NIST SHA3-256 padding). This is the
+    // same hash the node returns from web3_sha3, computed in process.
+    #define KECCAK256_LEN 32
+
+    //-------------------------------------------------------------------------
+    // Hashes 'len' bytes from 'in' into the 32 bytes at 'out'
+    extern void keccak256(const uint8_t *in, size_t len, uint8_t *out);
+
+    //-------------------------------------------------------------------------
+    // Hashes 'n' independent buffers. Buffers are hashed in groups whose Keccak states are
+    // interleaved lane-by-lane so the permutation of the whole group runs as vector operations.
+    // Use this in preference to calling keccak256 in a loop when you have many inputs.
+    extern void keccak256Many(const uint8_t * const *ins, const size_t *lens, uint8_t *outs, size_t n);
+
+    //-------------------------------------------------------------------------
+    // Hex string in (with or without leading '0x'), '0x' prefixed lower case hex string out
+    extern SFString keccak256(const SFString& hexIn);
+    extern void     keccak256Many(const SFStringArray& hexIn, SFStringArray& shaOut);
+
+}  // namespace qblocks
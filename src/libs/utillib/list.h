@@ -12,11 +12,13 @@
  * Public License along with this program. If not, see http://www.gnu.org/licenses/.
  *-------------------------------------------------------------------------------------------*/
 #include <algorithm>
+#include <utility>
 #include "basetypes.h"
 
 namespace qblocks {
 
     //----------------------------------------------------------------------
+    // The first allocation an array makes. After that it doubles each time it needs more room.
     #define ARRAY_CHUNK_SIZE 100
 
     //-------------------------------------------------------------------------
@@ -26,6 +28,8 @@ namespace qblocks {
     typedef bool (*APPLYFUNC)     (SFString& line, void *data);
 
     //----------------------------------------------------------------------
+    // Only the first getCount() slots hold values. The rest of the buffer is raw memory, so growing
+    // the array (or copying it) never default constructs items nobody asked for.
     template<class TYPE>
     class SFArrayBase {
     protected:
@@ -36,17 +40,30 @@ namespace qblocks {
     public:
         SFArrayBase(void);
         SFArrayBase(const SFArrayBase& copy);
+        SFArrayBase(SFArrayBase&& copy);
         ~SFArrayBase(void);
 
         SFArrayBase& operator=(const SFArrayBase& copy);
+        SFArrayBase& operator=(SFArrayBase&& copy);
 
         TYPE& operator[](uint32_t index);
         const TYPE& operator[](uint32_t index) const;
 
-        void addValue(TYPE val) { operator[](m_nValues) = val; }
+        void addValue(TYPE val) { operator[](m_nValues) = std::move(val); }
+        template<typename... ARGS>
+        TYPE& emplace_back(ARGS&&... args) {
+            CheckSize(m_nValues);
+            new (&m_Values[m_nValues]) TYPE(std::forward<ARGS>(args)...);
+            return m_Values[m_nValues++];
+        }
         uint32_t getCount(void) const { return m_nValues; }
         uint32_t getSize(void) const { return m_nSize; }
 
+        TYPE *begin(void) { return m_Values; }
+        TYPE *end(void) { return m_Values + m_nValues; }
+        const TYPE *begin(void) const { return m_Values; }
+        const TYPE *end(void) const { return m_Values + m_nValues; }
+
         void Sort(SORTINGFUNC func) { qsort(&m_Values[0], m_nValues, sizeof(TYPE), func); }
         TYPE *Find(const TYPE *key, SEARCHFUNC func) {
             // note: use the same function you would use to sort. Return <0, 0, or >0 if less, equal, greater
@@ -55,9 +72,12 @@ namespace qblocks {
 
         void Clear(void);
         void Grow(uint32_t sizeNeeded);
+        void reserve(uint32_t size);
+        void shrink_to_fit(void);
 
     private:
         void CheckSize(uint32_t sizeNeeded);
+        void Resize(uint32_t newSize);
         void Copy(const SFArrayBase& copy);
         void Init(uint32_t size, uint32_t count, TYPE *values);
     };
@@ -71,9 +91,17 @@ namespace qblocks {
     //----------------------------------------------------------------------
     template<class TYPE>
     inline SFArrayBase<TYPE>::SFArrayBase(const SFArrayBase<TYPE>& copy) {
+        Init(0, 0, NULL);
         Copy(copy);
     }
 
+    //----------------------------------------------------------------------
+    template<class TYPE>
+    inline SFArrayBase<TYPE>::SFArrayBase(SFArrayBase<TYPE>&& copy) {
+        Init(copy.m_nSize, copy.m_nValues, copy.m_Values);
+        copy.Init(0, 0, NULL);
+    }
+
     //----------------------------------------------------------------------
     template<class TYPE>
     inline SFArrayBase<TYPE>::~SFArrayBase(void) {
@@ -83,11 +111,24 @@ namespace qblocks {
     //----------------------------------------------------------------------
     template<class TYPE>
     inline SFArrayBase<TYPE>& SFArrayBase<TYPE>::operator=(const SFArrayBase<TYPE>& copy) {
+        if (this == &copy)
+            return *this;
         Clear();
         Copy(copy);
         return *this;
     }
 
+    //----------------------------------------------------------------------
+    template<class TYPE>
+    inline SFArrayBase<TYPE>& SFArrayBase<TYPE>::operator=(SFArrayBase<TYPE>&& copy) {
+        if (this == &copy)
+            return *this;
+        Clear();
+        Init(copy.m_nSize, copy.m_nValues, copy.m_Values);
+        copy.Init(0, 0, NULL);
+        return *this;
+    }
+
     //----------------------------------------------------------------------
     template<class TYPE>
     inline void SFArrayBase<TYPE>::Init(uint32_t size, uint32_t count, TYPE *values) {
@@ -99,18 +140,23 @@ namespace qblocks {
     //----------------------------------------------------------------------
     template<class TYPE>
     inline void SFArrayBase<TYPE>::Clear(void) {
+        for (uint32_t i = 0 ; i < m_nValues ; i++)
+            m_Values[i].~TYPE();
         if (m_Values)
-            delete [] m_Values;
+            ::operator delete(m_Values);
         Init(0, 0, NULL);
     }
 
     //----------------------------------------------------------------------
     template<class TYPE>
     inline void SFArrayBase<TYPE>::Copy(const SFArrayBase<TYPE>& copy) {
-        CheckSize(copy.getSize());
-        for (uint32_t i = 0 ; i < copy.getCount() ; i++)
-            m_Values[i] = copy.m_Values[i];
-        m_nValues = copy.getCount();
+        // Only as much room as the values need. Copying an empty array allocates nothing.
+        if (copy.getCount())
+            Resize(copy.getCount());
+        for (uint32_t i = 0 ; i < copy.getCount() ; i++) {
+            new (&m_Values[i]) TYPE(copy.m_Values[i]);
+            m_nValues = i + 1;
+        }
     }
 
     //----------------------------------------------------------------------
@@ -119,6 +165,22 @@ namespace qblocks {
         CheckSize(sizeNeeded);
     }
 
+    //----------------------------------------------------------------------
+    template<class TYPE>
+    inline void SFArrayBase<TYPE>::reserve(uint32_t size) {
+        if (size > m_nSize)
+            Resize(size);
+    }
+
+    //----------------------------------------------------------------------
+    template<class TYPE>
+    inline void SFArrayBase<TYPE>::shrink_to_fit(void) {
+        if (!m_nValues)
+            Clear();
+        else if (m_nValues < m_nSize)
+            Resize(m_nValues);
+    }
+
     //----------------------------------------------------------------------
     template<class TYPE>
     inline void SFArrayBase<TYPE>::CheckSize(uint32_t sizeNeeded) {
@@ -126,18 +188,22 @@ namespace qblocks {
             return;
 
         // The user is requesting access to an index that is past range. We need to grow the array.
-        uint32_t newSize = max(m_nSize + ARRAY_CHUNK_SIZE, sizeNeeded);
-        TYPE *newArray = new TYPE[newSize];
-        if (m_nValues) {
-            ASSERT(m_Values);
-            // If there are any values in the source copy them over
-            for (uint32_t i = 0 ; i < m_nValues ; i++)
-                newArray[i] = m_Values[i];
-            // Then clear out the old array
-            if (m_Values)
-                delete [] m_Values;
-            m_Values = NULL;
+        // Doubling keeps appending N items to O(N) moves in total.
+        Resize(max(max(m_nSize * 2, (uint32_t)ARRAY_CHUNK_SIZE), sizeNeeded + 1));
+    }
+
+    //----------------------------------------------------------------------
+    template<class TYPE>
+    inline void SFArrayBase<TYPE>::Resize(uint32_t newSize) {
+        ASSERT(newSize >= m_nValues);
+        TYPE *newArray = reinterpret_cast<TYPE*>(::operator new(sizeof(TYPE) * newSize));
+        // Move the values over. Types without a move constructor (most of the generated classes) are copied.
+        for (uint32_t i = 0 ; i < m_nValues ; i++) {
+            new (&newArray[i]) TYPE(std::move(m_Values[i]));
+            m_Values[i].~TYPE();
         }
+        if (m_Values)
+            ::operator delete(m_Values);
         Init(newSize, m_nValues, newArray);
     }
 
@@ -147,8 +213,8 @@ namespace qblocks {
         // This is the non-const version which means we may
         // have to grow the array
         CheckSize(index);
-        if (index >= m_nValues)
-            m_nValues = index+1;
+        while (m_nValues <= index)
+            new (&m_Values[m_nValues++]) TYPE();
         ASSERT(m_Values && index >= 0 && index <= m_nSize && index <= m_nValues);
         return m_Values[index];
     }
@@ -0,0 +1,129 @@
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "basetypes.h"
+#include "memarchive.h"
+
+namespace qblocks {
+
+    //-------------------------------------------------------------------------
+    // Below this, copying the file is cheaper than setting up (and tearing down) a mapping
+    #define MAX_SLURP (4 * 1024 * 1024)
+
+    //-------------------------------------------------------------------------
+    bool CMemArchive::open(const SFString& fileName) {
+        if (isWriting())
+            return false;
+        close();
+        setFilename(fileName);
+
+        int fd = ::open((const char *)fileName, O_RDONLY | O_CLOEXEC);
+        if (fd == -1)
+            return false;
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+            ::close(fd);
+            return false;
+        }
+
+        size_t size = (size_t)st.st_size;
+        if (size <= MAX_SLURP) {
+            m_buffer.resize(size);
+            size_t nRead = 0;
+            while (nRead < size) {
+                ssize_t n = ::read(fd, &m_buffer[nRead], size - nRead);
+                if (n <= 0)
+                    break;
+                nRead += (size_t)n;
+            }
+            ::close(fd);
+            // a file that shrank under us reads as if it ended early, just as it would with fread
+            return setContents(m_buffer.data(), nRead);
+        }
+        ::close(fd);
+
+        m_map = new CMemMapFile(fileName.c_str(), CMemMapFile::WholeFile, CMemMapFile::SequentialScan);
+        if (!m_map->isValid()) {
+            delete m_map;
+            m_map = NULL;
+            return false;
+        }
+        if (!setContents((const char *)m_map->getData(), (size_t)m_map->size())) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    // Reads 'length' bytes at 'offset' with one pread. The caller keeps the file open.
+    bool CMemArchive::open(int fd, uint64_t offset, uint64_t length) {
+        if (isWriting())
+            return false;
+        close();
+
+        m_buffer.resize((size_t)length);
+        size_t nRead = 0;
+        while (nRead < length) {
+            ssize_t n = pread(fd, &m_buffer[nRead], (size_t)length - nRead, (off_t)(offset + nRead));
+            if (n <= 0)
+                return false;
+            nRead += (size_t)n;
+        }
+        return setContents(m_buffer.data(), nRead);
+    }
+
+    //-------------------------------------------------------------------------
+    // Reads straight from 'data' unless it was written with a codec, in which case it's decoded
+    // into a buffer of its own (and anything mapped is no longer needed)
+    bool CMemArchive::setContents(const char *data, size_t size) {
+        if (!hasCodecHeader(data, size)) {
+            setMemory(data, size);
+            return true;
+        }
+        if (!decodeArchive(data, size, m_decoded))
+            return false;
+        if (m_map)
+            delete m_map;
+        m_map = NULL;
+        setMemory(m_decoded.data(), m_decoded.size());
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    void CMemArchive::close(void) {
+        if (isWriting())
+            return;
+        clearMemory();
+        if (m_map)
+            delete m_map;
+        m_map = NULL;
+    }
+
+    //-------------------------------------------------------------------------
+    void CMemArchive::takeBuffer(std::vector<char>& out) {
+        ASSERT(isWriting());
+        if (m_codec == CODEC_NONE) {
+            out.clear();
+            out.swap(m_buffer);
+        } else {
+            encodeArchive(m_codec, m_buffer, out);
+        }
+        setMemoryOut(&m_buffer);
+    }
+
+}  // namespace qblocks
@@ -0,0 +1,64 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include <vector>
+#include "sfarchive.h"
+#include "memmap.h"
+#include "codec.h"
+
+namespace qblocks {
+
+    //-----------------------------------------------------------------------------------------
+    // A reading archive that takes in the whole file at once and then decodes it from memory,
+    // so reading a block costs one read (or one mapping) instead of a call into the C library
+    // for every field. Small files are read into a buffer (which is kept for the next file);
+    // larger ones are mapped. Like reading with LOCK_NOWAIT, it does not wait on writers. It
+    // can also read part of a file that's already open (such as one block of a pack).
+    //
+    // A writing archive serializes into its buffer, which takeBuffer hands over (to be written
+    // out elsewhere, see CCacheWriter) leaving the archive empty and ready for the next item.
+    //
+    // Files written with a codec (see codec.h) are decoded when they're opened. A writing
+    // archive encodes with the codec set by setCodec, which applies from the next item on.
+    //-----------------------------------------------------------------------------------------
+    class CMemArchive : public SFArchive {
+    public:
+        explicit CMemArchive(bool isReading = READING_ARCHIVE) : SFArchive(isReading), m_map(NULL), m_codec(CODEC_NONE) {
+            if (!isReading)
+                setMemoryOut(&m_buffer);
+        }
+        ~CMemArchive(void) { close(); }
+
+        SFString getType(void) const override { return "CMemArchive"; }
+
+        bool open (const SFString& fileName);
+        bool open (int fd, uint64_t offset, uint64_t length);
+        void close(void);
+
+        void     takeBuffer(std::vector<char>& out);
+        void     setCodec  (uint32_t flags) { m_codec = flags; setPackHex(flags & CODEC_HEX); }
+        uint32_t getCodec  (void) const { return m_codec; }
+
+    private:
+        CMemMapFile      *m_map;
+        std::vector<char> m_buffer;
+        std::vector<char> m_decoded;
+        uint32_t          m_codec;
+
+        bool setContents(const char *data, size_t size);
+
+        CMemArchive(const CMemArchive&);
+        CMemArchive& operator=(const CMemArchive&);
+    };
+
+}  // namespace qblocks
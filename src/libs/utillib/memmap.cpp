@@ -63,7 +63,7 @@ bool CMemMapFile::open(const std::string& filename, size_t mappedBytes, CacheHin
 void CMemMapFile::close() {
     _filesize = 0;
     if (_mappedView) {
-        ::munmap(_mappedView, _filesize);
+        ::munmap(_mappedView, _mappedBytes);
         _mappedView = NULL;
     }
 
@@ -118,7 +118,12 @@ bool CMemMapFile::remap(uint64_t offset, size_t mappedBytes) {
     if (offset + mappedBytes > _filesize)
         mappedBytes = size_t(_filesize - offset);
 
-    _mappedView = ::mmap(NULL, mappedBytes, PROT_READ, MAP_SHARED, _file, (int64_t)offset);
+    int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+    if (_hint == Populate)
+        flags |= MAP_POPULATE;
+#endif
+    _mappedView = ::mmap(NULL, mappedBytes, PROT_READ, flags, _file, (int64_t)offset);
     if (_mappedView == MAP_FAILED) {
         _mappedBytes = 0;
         _mappedView  = NULL;
@@ -132,6 +137,7 @@ bool CMemMapFile::remap(uint64_t offset, size_t mappedBytes) {
         case Normal:         linuxHint = MADV_NORMAL;     break;
         case SequentialScan: linuxHint = MADV_SEQUENTIAL; break;
         case RandomAccess:   linuxHint = MADV_RANDOM;     break;
+        case Populate:       linuxHint = MADV_WILLNEED;   break;
         default: break;
     }
 
@@ -139,6 +145,18 @@ bool CMemMapFile::remap(uint64_t offset, size_t mappedBytes) {
     return true;
 }
 
+// Asks the kernel to start reading 'bytes' of the view from 'offset' (by default all of it) in
+// now, in the background, so that a later scan doesn't stop on every page
+void CMemMapFile::prefetch(size_t offset, size_t bytes) const {
+    if (!_mappedView || offset >= _mappedBytes)
+        return;
+    if (bytes == WholeFile || bytes > _mappedBytes - offset)
+        bytes = _mappedBytes - offset;
+    // madvise wants a page aligned start
+    size_t pageStart = offset - (offset % (size_t)getpagesize());
+    ::madvise((char*)_mappedView + pageStart, bytes + (offset - pageStart), MADV_WILLNEED);
+}
+
 int CMemMapFile::getpagesize() {
     return static_cast<int>(sysconf(_SC_PAGESIZE));
 }
@@ -21,7 +21,8 @@ public:
     enum CacheHint {
         Normal,          ///< good overall performance
         SequentialScan,  ///< read file only once with few seeks
-        RandomAccess     ///< jump around
+        RandomAccess,    ///< jump around
+        Populate         ///< read the whole file in up front so later accesses never wait on the disc
     };
 
     enum MapRange {
@@ -48,6 +49,7 @@ public:
     size_t   mappedSize(void) const;
 
     bool remap(uint64_t offset, size_t mappedBytes);
+    void prefetch(size_t offset = 0, size_t bytes = WholeFile) const;
 
 private:
     CMemMapFile(const CMemMapFile&);
@@ -63,3 +65,31 @@ private:
     void*       _mappedView;
 };
 
+//---------------------------------------------------------------------------------------------------
+// A typed, read-only view of an array of fixed size records that lives somewhere else (usually in a
+// memory mapped file). It does not own the memory, so it's only good as long as the mapping is.
+template<class TYPE>
+class CMemMapSpan {
+public:
+    CMemMapSpan(void) : m_items(NULL), m_count(0) { }
+    CMemMapSpan(const TYPE *items, uint64_t count) : m_items(items), m_count(count) { }
+
+    const TYPE& operator[](uint64_t index) const { return m_items[index]; }
+    const TYPE *begin     (void) const { return m_items; }
+    const TYPE *end       (void) const { return m_items + m_count; }
+    uint64_t    size      (void) const { return m_count; }
+    bool        empty     (void) const { return m_count == 0; }
+
+private:
+    const TYPE *m_items;
+    uint64_t    m_count;
+};
+
+//---------------------------------------------------------------------------------------------------
+// The mapped file viewed as an array of TYPE (any partial record at the end is ignored)
+template<class TYPE>
+inline CMemMapSpan<TYPE> asSpan(const CMemMapFile& file) {
+    if (!file.isValid())
+        return CMemMapSpan<TYPE>();
+    return CMemMapSpan<TYPE>(reinterpret_cast<const TYPE*>(file.getData()), file.mappedSize() / sizeof(TYPE));
+}
@@ -25,6 +25,20 @@ IMPLEMENT_NODE(CNameValue, CBaseNode);
 static SFString nextNamevalueChunk(const SFString& fieldIn, const void *dataPtr);
 static SFString nextNamevalueChunk_custom(const SFString& fieldIn, const void *dataPtr);
 
+//---------------------------------------------------------------------------
+// makeClass chose the seed so that no two of these names share a slot in the table
+enum {
+    FLD_NAME = 1,
+    FLD_VALUE,
+};
+static const char *namevalueFieldNames[] = {
+    "name", "value",
+};
+static const uint8_t namevalueFieldSlots[] = {
+    0, 2, 1, 0,
+};
+static const CFieldTable namevalueFieldTable(namevalueFieldNames, 2, namevalueFieldSlots, 4, 0);
+
 //---------------------------------------------------------------------------
 void CNameValue::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPtr) const {
     if (!m_showing)
@@ -35,12 +49,10 @@ void CNameValue::Format(CExportContext& ctx, const SFString& fmtIn, void *dataPt
         return;
     }
 
-    SFString fmt = fmtIn;
-    if (handleCustomFormat(ctx, fmt, dataPtr))
+    if (handleCustomFormat(ctx, fmtIn, dataPtr))
         return;
 
-    while (!fmt.empty())
-        ctx << getNextChunk(fmt, nextNamevalueChunk, this);
+    formatChunks(ctx, fmtIn, nextNamevalueChunk, this);
 }
 
 //---------------------------------------------------------------------------
@@ -59,13 +71,9 @@ bool CNameValue::setValueByName(const SFString& fieldName, const SFString& field
     // EXISTING_CODE
     // EXISTING_CODE
 
-    switch (tolower(fieldName[0])) {
-        case 'n':
-            if ( fieldName % "name" ) { name = fieldValue; return true; }
-            break;
-        case 'v':
-            if ( fieldName % "value" ) { value = fieldValue; return true; }
-            break;
+    switch (namevalueFieldTable.find(fieldName)) {
+        case FLD_NAME: name = fieldValue; return true;
+        case FLD_VALUE: value = fieldValue; return true;
         default:
             break;
     }
@@ -179,12 +187,10 @@ SFString CNameValue::getValueByName(const SFString& fieldName) const {
         return ret;
 
     // Return field values
-    switch (tolower(fieldName[0])) {
-        case 'n':
-            if ( fieldName % "name" ) return name;
-            break;
-        case 'v':
-            if ( fieldName % "value" ) return value;
+    switch (namevalueFieldTable.find(fieldName)) {
+        case FLD_NAME: return name;
+        case FLD_VALUE: return value;
+        default:
             break;
     }
 
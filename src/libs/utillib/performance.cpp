@@ -20,7 +20,7 @@ namespace qblocks {
         gettimeofday(&tv, 0);
         double secs = (double)tv.tv_sec;
         double usecs = (double)tv.tv_usec;
-        return (secs + (usecs / 100000.0));
+        return (secs + (usecs / 1000000.0));
     }
 
 }  // namespace qblocks
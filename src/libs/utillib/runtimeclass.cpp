@@ -49,6 +49,10 @@ namespace qblocks {
             delete m_FieldList;
             m_FieldList = NULL;
         }
+        if (m_FieldIndex)
+            delete [] m_FieldIndex;
+        m_FieldIndex = NULL;
+        m_IndexSize = 0;
     }
 
     //-------------------------------------------------------------------------
@@ -131,6 +135,64 @@ namespace qblocks {
             field->m_fieldType = dataType;
             field->m_fieldID = fieldID;
             m_FieldList->AddTail(field);
+            if ((m_FieldList->GetCount() * 2) > m_IndexSize)
+                indexFields();
+            else
+                indexField(field);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    // The index is an open addressed hash table at most half full, so FindField usually looks
+    // at one slot. Field names are case sensitive here (unlike in the generated tables).
+    void CRuntimeClass::indexField(CFieldData *field) {
+        uint32_t mask = m_IndexSize - 1;
+        uint32_t slot = fieldHash(field->m_fieldName.c_str(), field->m_fieldName.length(), 0) & mask;
+        while (m_FieldIndex[slot])
+            slot = (slot + 1) & mask;
+        m_FieldIndex[slot] = field;
+    }
+
+    //-------------------------------------------------------------------------
+    void CRuntimeClass::indexFields(void) {
+        if (m_FieldIndex)
+            delete [] m_FieldIndex;
+        m_FieldIndex = NULL;
+        m_IndexSize = 0;
+        if (!m_FieldList)
+            return;
+
+        m_IndexSize = 8;
+        while (m_IndexSize < m_FieldList->GetCount() * 4)
+            m_IndexSize <<= 1;
+        m_FieldIndex = new CFieldData*[m_IndexSize];
+        memset(m_FieldIndex, 0, sizeof(CFieldData*) * m_IndexSize);
+
+        LISTPOS p = m_FieldList->GetHeadPosition();
+        while (p)
+            indexField(m_FieldList->GetNext(p));
+    }
+
+    //-------------------------------------------------------------------------
+    CFieldData *CRuntimeClass::FindField(const SFString& fieldName) {
+        if (!m_FieldIndex)
+            return NULL;
+        uint32_t mask = m_IndexSize - 1;
+        uint32_t slot = fieldHash(fieldName.c_str(), fieldName.length(), 0) & mask;
+        while (m_FieldIndex[slot]) {
+            if (m_FieldIndex[slot]->m_fieldName == fieldName)
+                return m_FieldIndex[slot];
+            slot = (slot + 1) & mask;
+        }
+        return NULL;
+    }
+
+    //-------------------------------------------------------------------------
+    void CRuntimeClass::renameField(const SFString& oldName, const SFString& newName) {
+        CFieldData *field = FindField(oldName);
+        if (field) {
+            field->setName(newName);
+            indexFields();
         }
     }
 
@@ -145,6 +207,8 @@ namespace qblocks {
         pClass->m_ObjectSize    = size;
         pClass->m_BaseClass     = pBase;
         pClass->m_FieldList     = NULL;
+        pClass->m_FieldIndex    = NULL;
+        pClass->m_IndexSize     = 0;
         pClass->m_CreateFunc    = createFunc;
     }
 }  // namespace qblocks
@@ -12,6 +12,7 @@
  * Public License along with this program. If not, see http://www.gnu.org/licenses/.
  *-------------------------------------------------------------------------------------------*/
 #include "fielddata.h"
+#include "fieldtable.h"
 
 namespace qblocks {
 
@@ -34,6 +35,8 @@ namespace qblocks {
         PFNV m_CreateFunc;
         CRuntimeClass *m_BaseClass;
         CFieldList *m_FieldList;
+        CFieldData **m_FieldIndex;
+        uint32_t m_IndexSize;
 
     public:
         virtual ~CRuntimeClass(void);
@@ -48,6 +51,7 @@ namespace qblocks {
         void hideAllFields(void);
         void showAllFields(void);
         void sortFieldList(void);
+        void renameField(const SFString& oldName, const SFString& newName);
 
         CBaseNode *CreateObject(void) {
             if (m_CreateFunc)
@@ -55,23 +59,17 @@ namespace qblocks {
             return NULL;
         }
 
-        virtual CFieldData *FindField(const SFString& fieldName) {
-            if (m_FieldList) {
-                LISTPOS pos = m_FieldList->GetHeadPosition();
-                while (pos) {
-                    CFieldData *field = m_FieldList->GetNext(pos);
-                    if (field->m_fieldName == fieldName)
-                        return field;
-                }
-            }
-            return NULL;
-        }
+        virtual CFieldData *FindField(const SFString& fieldName);
         bool isFieldHidden(const SFString& fieldName) {
             CFieldData *f = FindField(fieldName);
             if (f)
                 return f->isHidden();
             return false;
         }
+
+    private:
+        void indexField(CFieldData *field);
+        void indexFields(void);
     };
 
     //------------------------------------------------------------
@@ -125,7 +123,7 @@ CFieldData *f = GETRUNTIME_CLASS(CLASS_NAME)->FindField(FIELD_NAME); if (f) { f-
 
     //------------------------------------------------------------
 #define RENAME_FIELD(CLASS_NAME, OLD_NAME, NEW_NAME) {\
-CFieldData *f = GETRUNTIME_CLASS(CLASS_NAME)->FindField(OLD_NAME); if (f) { f->setName(NEW_NAME); }\
+GETRUNTIME_CLASS(CLASS_NAME)->renameField(OLD_NAME, NEW_NAME);\
 }
 
     //------------------------------------------------------------
@@ -18,58 +18,67 @@ namespace qblocks {
 
     ///////////////////////////////////////////////////////////////////
     SFArchive& SFArchive::operator<<(bool b) {
-        Write(b);
+        writeValue(b);
         return *this;
     }
 
     SFArchive& SFArchive::operator<<(char c) {
-        Write(c);
+        writeValue(c);
         return *this;
     }
 
     SFArchive& SFArchive::operator<<(int dw) {
-        Write(dw);
+        writeValue(dw);
         return *this;
     }
 
     SFArchive& SFArchive::operator<<(unsigned int dw) {
-        Write(dw);
+        writeValue(dw);
         return *this;
     }
 
     SFArchive& SFArchive::operator<<(int64_t dw) {
-        Write(dw);
+        writeValue(dw);
         return *this;
     }
 
     SFArchive& SFArchive::operator<<(uint64_t dw) {
-        Write(dw);
+        writeValue(dw);
         return *this;
     }
 
     SFArchive& SFArchive::operator<<(float f) {
-        Write(f);
+        writeValue(f);
         return *this;
     }
 
     SFArchive& SFArchive::operator<<(double f) {
-        Write(f);
+        writeValue(f);
         return *this;
     }
 
     SFArchive& SFArchive::operator<<(const char *str) {
-        SFString s = str;
-        Write(s);
-        return *this;
+        return operator<<(SFString(str));
     }
 
     SFArchive& SFArchive::operator<<(const SFString& str) {
-        Write(str);
+        unsigned long len = str.length();
+        if (isPackingHex() && len >= 2 && !(len % 2) && isLowerHex(str.c_str(), len, (len - 2) / 2)) {
+            // the digits go straight into the buffer, already checked by isLowerHex
+            size_t width = (len - 2) / 2;
+            unsigned long packed = (width | PACKED_HEX_BIT);
+            writeValue(packed);
+            if (width)
+                hexToBytes(str.c_str(), len, (uint8_t *)reserveMemory(width), width);
+            return *this;
+        }
+        writeValue(len);
+        Write(str.c_str(), sizeof(char), len);
         return *this;
     }
 
     SFArchive& SFArchive::operator<<(const SFTime& tm) {
-        Write(tm);
+        writeValue(tm.m_nSeconds);
         return *this;
     }
 
@@ -97,6 +106,28 @@ namespace qblocks {
         return archive;
     }
 
+    //----------------------------------------------------------------------
+    // Blooms are stored exactly as the SFUintBN they used to be (capacity, len, len words) so
+    // existing bloom files read as is. We trim the high zero words just as SFUintBN does.
+    SFArchive& operator<<(SFArchive& archive, const CBloom2048& bloom) {
+        unsigned int len = BLOOM_WORDS;
+        while (len > 0 && bloom.words[len - 1] == 0)
+            len--;
+        archive << len;
+        archive << len;
+        for (unsigned int i = 0 ; i < len ; i++)
+            archive << bloom.words[i];
+        return archive;
+    }
+
+    SFArchive& operator<<(SFArchive& archive, const CBloom2048Array& array) {
+        uint64_t count = array.getCount();
+        archive << count;
+        for (uint32_t i = 0 ; i < array.getCount() ; i++)
+            archive << array[i];
+        return archive;
+    }
+
     SFArchive& SFArchive::operator<<(const SFUintBN& bn) {
         *this << bn.capacity;
         *this << bn.len;
@@ -111,54 +142,145 @@ namespace qblocks {
         return *this;
     }
 
+    ///////////////////////////////////////////////////////////////////
+    void SFArchive::readMemory(void *buff, size_t len) {
+        // Like fread, a short read copies what there is
+        size_t avail = m_memSize - m_memPos;
+        if (len > avail)
+            len = avail;
+        memcpy(buff, m_memData + m_memPos, len);
+        m_memPos += len;
+    }
+
+    void SFArchive::writeMemory(const void *buff, size_t len) {
+        // Writes over what's there (after a Seek) and grows the buffer past the end
+        if (m_memPos + len > m_memOut->size())
+            m_memOut->resize(m_memPos + len);
+        if (len)
+            memcpy(&(*m_memOut)[m_memPos], buff, len);
+        m_memPos += len;
+    }
+
+    char *SFArchive::reserveMemory(size_t len) {
+        // Room for 'len' bytes at the cursor, for the caller to fill in
+        if (m_memPos + len > m_memOut->size())
+            m_memOut->resize(m_memPos + len);
+        char *ret = &(*m_memOut)[m_memPos];
+        m_memPos += len;
+        return ret;
+    }
+
+    size_t SFArchive::Write(const void *buff, size_t size, size_t cnt) {
+        if (!m_memOut)
+            return CSharedResource::Write(buff, size, cnt);
+        writeMemory(buff, size * cnt);
+        return cnt;
+    }
+
+    size_t SFArchive::Read(void *buff, size_t size, size_t cnt) {
+        if (!m_inMemory)
+            return CSharedResource::Read(buff, size, cnt);
+        size_t start = m_memPos;
+        readMemory(buff, size * cnt);
+        return (size ? (m_memPos - start) / size : 0);
+    }
+
+    void SFArchive::Seek(long offset, int whence) {
+        if (!m_inMemory) {
+            CSharedResource::Seek(offset, whence);
+            return;
+        }
+        long size = (long)(m_memOut ? m_memOut->size() : m_memSize);
+        long base = (whence == SEEK_SET ? 0 : whence == SEEK_CUR ? (long)m_memPos : size);
+        m_memPos = (size_t)max(0L, min(base + offset, size));
+    }
+
+    long SFArchive::Tell(void) const {
+        return (m_inMemory ? (long)m_memPos : CSharedResource::Tell());
+    }
+
+    bool SFArchive::Eof(void) const {
+        if (m_memOut)
+            return m_memPos >= m_memOut->size();
+        return (m_inMemory ? m_memPos >= m_memSize : CSharedResource::Eof());
+    }
+
+    bool SFArchive::readRawView(string_view_q& str, bool& packed) {
+        if (!m_inMemory)
+            return false;
+        unsigned long len = 0;
+        readValue(len);
+        packed = (len & PACKED_HEX_BIT);
+        len = min(len & ~PACKED_HEX_BIT, (unsigned long)(m_memSize - m_memPos));
+        str = string_view_q(m_memData + m_memPos, len);
+        m_memPos += len;
+        return true;
+    }
+
+    bool SFArchive::readStringView(string_view_q& str) {
+        bool packed = false;
+        if (!readRawView(str, packed))
+            return false;
+        if (packed) {
+            m_hexView.resize(2 + str.length() * 2 + 1);
+            bytesToHex((const uint8_t *)str.data(), str.length(), &m_hexView[0]);
+            str = string_view_q(m_hexView.data(), 2 + str.length() * 2);
+        }
+        return true;
+    }
+
     ///////////////////////////////////////////////////////////////////
     SFArchive& SFArchive::operator>>(bool& b) {
-        Read(b);
+        readValue(b);
         return *this;
     }
 
     SFArchive& SFArchive::operator>>(char& c) {
-        Read(c);
+        readValue(c);
         return *this;
     }
 
     SFArchive& SFArchive::operator>>(int& dw) {
-        Read(dw);
+        readValue(dw);
         return *this;
     }
 
     SFArchive& SFArchive::operator>>(unsigned int& dw) {
-        Read(dw);
+        readValue(dw);
         return *this;
     }
 
     SFArchive& SFArchive::operator>>(int64_t& dw) {
-        Read(dw);
+        readValue(dw);
         return *this;
     }
 
     SFArchive& SFArchive::operator>>(uint64_t& dw) {
-        Read(dw);
+        readValue(dw);
         return *this;
     }
 
     SFArchive& SFArchive::operator>>(float& f) {
-        Read(f);
+        readValue(f);
         return *this;
     }
 
     SFArchive& SFArchive::operator>>(double& f) {
-        Read(f);
+        readValue(f);
         return *this;
     }
 
     SFArchive& SFArchive::operator>>(SFString& str) {
-        Read(str);
+        string_view_q view;
+        if (readStringView(view))
+            str = SFString(view.data(), 0, view.length());  // stops at a NUL, as Read does
+        else
+            CSharedResource::Read(str);
         return *this;
     }
 
     SFArchive& SFArchive::operator>>(SFTime& tm) {
-        Read(tm);
+        readValue(tm.m_nSeconds);
         return *this;
     }
 
@@ -186,6 +308,29 @@ namespace qblocks {
         return archive;
     }
 
+    //----------------------------------------------------------------------
+    SFArchive& operator>>(SFArchive& archive, CBloom2048& bloom) {
+        unsigned int capacity, len;
+        archive >> capacity;
+        archive >> len;
+        bloom = 0;
+        for (unsigned int i = 0 ; i < len ; i++) {
+            uint64_t word;
+            archive >> word;
+            if (i < BLOOM_WORDS)
+                bloom.words[i] = word;
+        }
+        return archive;
+    }
+
+    SFArchive& operator>>(SFArchive& archive, CBloom2048Array& array) {
+        uint64_t count;
+        archive >> count;
+        for (uint32_t i = 0 ; i < count ; i++)
+            archive >> array[i];
+        return archive;
+    }
+
     SFArchive& SFArchive::operator>>(SFUintBN& bn) {
         // Note: I experimented with writing out
         // the blk in one Read/Write but it was
@@ -206,6 +351,63 @@ namespace qblocks {
         return *this;
     }
 
+    //----------------------------------------------------------------------
+    // Same layout as Write(const SFString&): the length followed by the characters
+    void writeFixedBytes(SFArchive& archive, const uint8_t *bytes, size_t width) {
+        if (archive.isPackingHex()) {
+            unsigned long len = (width | PACKED_HEX_BIT);
+            archive.Write(&len, sizeof(unsigned long), 1);
+            archive.Write(bytes, sizeof(uint8_t), width);
+            return;
+        }
+
+        char hex[2 + 32 * 2 + 1];
+        ASSERT(width <= 32);
+        bytesToHex(bytes, width, hex);
+        unsigned long len = 2 + width * 2;
+        archive.Write(&len, sizeof(unsigned long), 1);
+        archive.Write(hex, sizeof(char), len);
+    }
+
+    //----------------------------------------------------------------------
+    // Parses the string straight from the archive, without making an SFString. Anything that
+    // isn't a hex value of at most 'width' bytes (which older files may hold) reads as zero.
+    // Returns false for those and for the strings that stand for no value ("", "0x" and "0x0").
+    bool readFixedBytes(SFArchive& archive, uint8_t *bytes, size_t width) {
+        string_view_q view;
+        bool packed = false;
+        if (archive.readRawView(view, packed)) {
+            // packed bytes are a value like any other, so a short one fills from the right
+            memset(bytes, 0, width);
+            if (packed) {
+                if (view.length() > width)
+                    return false;
+                memcpy(bytes + width - view.length(), view.data(), view.length());
+                return (view.length() > 0);
+            } else if (view.length() <= 2 + 32 * 2) {
+                return hexToBytes(view.data(), view.length(), bytes, width) && !isEmptyHex(view.data(), view.length());
+            }
+            return false;
+        }
+
+        unsigned long len = 0;
+        archive.Read(&len, sizeof(unsigned long), 1);
+
+        char hex[2 + 32 * 2];
+        if (len <= sizeof(hex)) {
+            archive.Read(hex, sizeof(char), len);
+            return hexToBytes(hex, len, bytes, width) && !isEmptyHex(hex, len);
+        }
+
+        memset(bytes, 0, width);
+        while (len) {
+            size_t n = min((size_t)len, sizeof(hex));
+            archive.Read(hex, sizeof(char), n);
+            len -= n;
+        }
+        return false;
+    }
+
     //----------------------------------------------------------------------
     uint64_t appendToAsciiFile(const SFString& fileName, const SFString& addContents) {
         SFArchive asciiCache(WRITING_ARCHIVE);
@@ -11,9 +11,11 @@
  * General Public License for more details. You should have received a copy of the GNU General
  * Public License along with this program. If not, see http://www.gnu.org/licenses/.
  *-------------------------------------------------------------------------------------------*/
+#include <vector>
 #include "exportcontext.h"
 #include "database.h"
 #include "conversions.h"
+#include "fixedbytes.h"
 #include "version.h"
 
 namespace qblocks {
@@ -21,6 +23,9 @@ namespace qblocks {
     #define READING_ARCHIVE true
     #define WRITING_ARCHIVE false
 
+    // A string whose length has this bit set holds the bytes of a hex string (see setPackHex)
+    #define PACKED_HEX_BIT ((unsigned long)1 << (sizeof(unsigned long) * 8 - 1))
+
     class CBaseNode;
     typedef bool (*VISITARCHIVEFUNC)(CBaseNode& node, void *data);
 
@@ -35,6 +40,29 @@ namespace qblocks {
             timestamp_t  m_lastWritten;
         };
 
+    protected:
+        // Set only while reading from (or writing to) memory (see CMemArchive)
+        bool               m_inMemory;
+        const char        *m_memData;
+        size_t             m_memSize;
+        size_t             m_memPos;
+        std::vector<char> *m_memOut;
+        bool               m_packHex;
+        std::string        m_hexView;
+
+        void setMemory(const char *data, size_t size) {
+            m_inMemory = true;
+            m_memData  = data;
+            m_memSize  = size;
+            m_memPos   = 0;
+        }
+        void setMemoryOut(std::vector<char> *out) {
+            setMemory(NULL, 0);
+            m_memOut = out;
+            m_memOut->clear();
+        }
+        void clearMemory(void) { setMemory(NULL, 0); m_inMemory = false; m_memOut = NULL; }
+
     public:
         SFArchiveHeader  m_header;
         bool             m_isReading;
@@ -44,6 +72,9 @@ namespace qblocks {
         SFArchive(bool isReading) : CSharedResource() {
             m_isReading        = isReading;
             m_header.m_version = getVersionNum();
+            m_memOut           = NULL;
+            m_packHex          = false;
+            clearMemory();
             //writeMsgFunc     = NULL;
             //readMsgFunc      = NULL;
         }
@@ -58,6 +89,34 @@ namespace qblocks {
             return m_isReading;
         }
 
+        bool isInMemory(void) const {
+            return m_inMemory;
+        }
+
+        // These read from (or write to) memory if that's where the archive is and the file if not
+        size_t Read  (void *buff, size_t size, size_t cnt);
+        size_t Write (const void *buff, size_t size, size_t cnt);
+        void   Seek  (long offset, int whence);
+        long   Tell  (void) const;
+        bool   Eof   (void) const;
+        bool   isOpen(void) const { return m_inMemory || CSharedResource::isOpen(); }
+
+        // In memory only: points 'str' at the next string without copying it. It's good for as
+        // long as the archive is open (or, for a packed hex string, until the next one is read).
+        bool readStringView(string_view_q& str);
+
+        // In memory only: like readStringView, but a packed hex string comes back as its bytes
+        // (and 'packed' says so)
+        bool readRawView(string_view_q& str, bool& packed);
+
+        // When writing to memory, lower case hex strings of whole bytes ("0x" then an even number
+        // of digits) may be written as the bytes they stand for, with PACKED_HEX_BIT set in the
+        // length. That halves the size of every hash, address and input. Only archives that note
+        // it in the file (see codec.h) should do so, since older readers can't read them. Reading
+        // from memory always accepts them.
+        void setPackHex(bool pack) { m_packHex = pack; }
+        bool isPackingHex(void) const { return m_packHex && m_memOut; }
+
         void writeHeader(void) {
             Seek(0, SEEK_SET);
             m_header.m_lastWritten = toTimestamp(Now());
@@ -101,13 +160,77 @@ namespace qblocks {
         SFArchive& operator>>(SFTime& tm);
         SFArchive& operator>>(SFUintBN& bn);
         SFArchive& operator>>(SFIntBN& bn);
+
+    private:
+        void readMemory (void *buff, size_t len);
+        void writeMemory(const void *buff, size_t len);
+        char *reserveMemory(size_t len);
+
+        template<class TYPE>
+        void readValue(TYPE& val) {
+            if (m_inMemory)
+                readMemory(&val, sizeof(TYPE));
+            else
+                CSharedResource::Read(&val, sizeof(TYPE), 1);
+        }
+
+        template<class TYPE>
+        void writeValue(const TYPE& val) {
+            if (m_memOut)
+                writeMemory(&val, sizeof(TYPE));
+            else
+                CSharedResource::Write(&val, sizeof(TYPE), 1);
+        }
     };
 
     extern SFArchive& operator<<(SFArchive& archive, const SFStringArray& array);
     extern SFArchive& operator<<(SFArchive& archive, const SFBigUintArray& array);
     extern SFArchive& operator<<(SFArchive& archive, const SFUintArray& array);
+    extern SFArchive& operator<<(SFArchive& archive, const CBloom2048& bloom);
+    extern SFArchive& operator<<(SFArchive& archive, const CBloom2048Array& array);
 
     extern SFArchive& operator>>(SFArchive& archive, SFStringArray& array);
     extern SFArchive& operator>>(SFArchive& archive, SFBigUintArray& array);
     extern SFArchive& operator>>(SFArchive& archive, SFUintArray& array);
+    extern SFArchive& operator>>(SFArchive& archive, CBloom2048& bloom);
+    extern SFArchive& operator>>(SFArchive& archive, CBloom2048Array& array);
+
+    //-----------------------------------------------------------------------------------------
+    // Addresses and hashes are written as the hex string they stand for, so a field may change
+    // between SFString and CFixedBytes without changing the files it is stored in
+    extern void writeFixedBytes(SFArchive& archive, const uint8_t *bytes, size_t width);
+    extern bool readFixedBytes (SFArchive& archive, uint8_t *bytes, size_t width);
+
+    template<size_t WIDTH>
+    inline SFArchive& operator<<(SFArchive& archive, const CFixedBytes<WIDTH>& item) {
+        writeFixedBytes(archive, item.bytes, WIDTH);
+        return archive;
+    }
+
+    template<size_t WIDTH>
+    inline SFArchive& operator>>(SFArchive& archive, CFixedBytes<WIDTH>& item) {
+        readFixedBytes(archive, item.bytes, WIDTH);
+        return archive;
+    }
+
+    //-----------------------------------------------------------------------------------------
+    // An empty field is written as "", and anything that reads as no value is empty
+    template<size_t WIDTH>
+    inline SFArchive& operator<<(SFArchive& archive, const CFieldBytes<WIDTH>& item) {
+        if (item.empty())
+            archive << SFString();
+        else
+            writeFixedBytes(archive, item.bytes, WIDTH);
+        return archive;
+    }
+
+    template<size_t WIDTH>
+    inline SFArchive& operator>>(SFArchive& archive, CFieldBytes<WIDTH>& item) {
+        CFixedBytes<WIDTH> bytes;
+        if (readFixedBytes(archive, bytes.bytes, WIDTH))
+            item = bytes;
+        else
+            item.setEmpty();
+        return archive;
+    }
 }  // namespace qblocks
@@ -16,40 +16,48 @@
 
 namespace qblocks {
 
-    //---------------------------------------------------------------------------------------
-    extern char nullString[];
-
 #ifndef NATIVE
 #if 1
     //---------------------------------------------------------------------------------------
     string_q::string_q()
     {
         init();
-        reserve(0);
     }
 
     //---------------------------------------------------------------------------------------
+    // Copies up to the terminator, as it always has, in case someone has written into the
+    // buffer directly without going through the string
     string_q::string_q(const string_q& str)
     {
         init();
-        *this = str.m_Values;
+        assign(str.c_str(), strlen(str.c_str()));
+    }
+
+    //---------------------------------------------------------------------------------------
+    string_q::string_q(string_q&& str)
+    {
+        m_nValues  = str.m_nValues;
+        m_buffSize = str.m_buffSize;
+        memcpy(m_inlineValues, str.m_inlineValues, SSO_SIZE);  // the heap pointer, if there is one
+        str.init();
     }
 
     //---------------------------------------------------------------------------------------
     string_q::string_q(const char *str, size_t start, size_t len)
     {
         init();
+        if (!str)
+            return;
 
-        size_t strLen = (str ? strlen(str) : 0);
-        len = ((long)len >= 0 ? strLen : len);
-        if (str && (strLen > start))
-        {
-            reserve(len);
-            memcpy(m_Values, &str[start], len);
-        }
+        // only look as far as we were asked to
+        if ((int64_t)len < 0)
+            len = NOPOS;
+        size_t strLen = (len == NOPOS ? strlen(str) : strnlen(str, start + len));
+        if (strLen <= start)
+            return;
 
-        m_nValues     = len;
-        m_Values[len] = '\0';
+        size_t avail = strLen - start;
+        assign(&str[start], (len == NOPOS || len > avail) ? avail : len);
     }
 
     //---------------------------------------------------------------------------------------
@@ -60,28 +68,47 @@ namespace qblocks {
         if (((long)len) > 0)
         {
             reserve(len);
-            memset(m_Values, ch, len);
-            m_nValues     = len;
-            m_Values[len] = '\0';
+            memset(buffer(), ch, len);
+            m_nValues        = len;
+            buffer()[len] = '\0';
         }
     }
 
     //---------------------------------------------------------------------------------------
     string_q::~string_q()
     {
-        if (m_Values)
-            if (m_Values != nullString)
-                delete [] m_Values;
-        m_Values  = NULL;
+        if (!isInline())
+            delete [] m_heapValues;
         m_nValues = 0;
     }
 #endif
 
+    //---------------------------------------------------------------------------------------
+    const string_q& string_q::operator=(const string_q& str)
+    {
+        if (this != &str)
+            assign(str.c_str(), str.length());
+        return *this;
+    }
+
+    //---------------------------------------------------------------------------------------
+    const string_q& string_q::operator=(string_q&& str)
+    {
+        if (this != &str)
+        {
+            clear();
+            m_nValues  = str.m_nValues;
+            m_buffSize = str.m_buffSize;
+            memcpy(m_inlineValues, str.m_inlineValues, SSO_SIZE);
+            str.init();
+        }
+        return *this;
+    }
+
     //---------------------------------------------------------------------------------------
     const char *string_q::c_str(void) const
     {
-        ASSERT(m_Values);
-        return m_Values;
+        return buffer();
     }
 
     //--------------------------------------------------------------------
@@ -97,32 +124,76 @@ namespace qblocks {
     }
 
     //---------------------------------------------------------------------------------------
+    // Note that, unlike std::string, this empties the string. Callers depend on that.
     void string_q::reserve(size_t newSize)
     {
-        if (newSize <= m_buffSize && m_buffSize)
+        if (newSize <= m_buffSize)
         {
             // do not release the memory, just empty the existing string
             m_nValues   = 0;
-            m_Values[0] = '\0';
+            buffer()[0] = '\0';
             return;
         }
 
         // clear current buffer and deallocate
         clear();
-        if (newSize == NOPOS || newSize == 0)
+        if (newSize == NOPOS)
             return;
 
-        // make sure we are not dropping memory
-        ASSERT(m_Values == nullString);
-
 #define GROW_SIZE 16
-        m_Values      = new char[newSize+GROW_SIZE+1];
-        m_Values[0]   = '\0';
-        m_nValues     = 0;
-        m_buffSize    = newSize + GROW_SIZE;
+        m_heapValues    = new char[newSize+GROW_SIZE+1];
+        m_heapValues[0] = '\0';
+        m_nValues       = 0;
+        m_buffSize      = newSize + GROW_SIZE;
         return;
     }
 
+    //---------------------------------------------------------------------------------------
+    // Replaces the contents. 'str' may point into this string's own buffer.
+    void string_q::assign(const char *str, size_t len)
+    {
+        if (len > m_buffSize)
+        {
+            char *newValues = new char[len+GROW_SIZE+1];
+            memcpy(newValues, str, len);
+            clear();
+            m_heapValues = newValues;
+            m_buffSize   = len + GROW_SIZE;
+        } else
+        {
+            memmove(buffer(), str, len);
+        }
+        m_nValues     = len;
+        buffer()[len] = '\0';
+    }
+
+    //---------------------------------------------------------------------------------------
+    // Appends in place, at least doubling the buffer when it has to grow. 'str' may point into
+    // this string's own buffer, so it is copied before the old buffer goes away.
+    void string_q::append(const char *str, size_t len)
+    {
+        if (!len)
+            return;
+
+        size_t newLen = m_nValues + len;
+        if (newLen > m_buffSize)
+        {
+            size_t newSize = max(newLen + GROW_SIZE, m_buffSize * 2);
+            char *newValues = new char[newSize+1];
+            memcpy(newValues, buffer(), m_nValues);
+            memcpy(newValues + m_nValues, str, len);
+            if (!isInline())
+                delete [] m_heapValues;
+            m_heapValues = newValues;
+            m_buffSize   = newSize;
+        } else
+        {
+            memcpy(buffer() + m_nValues, str, len);
+        }
+        m_nValues        = newLen;
+        buffer()[newLen] = '\0';
+    }
+
 #ifdef NEW_CODE
     //---------------------------------------------------------------------------------------
     void string_q::resize(size_t newSize, char c) {
@@ -132,14 +203,9 @@ namespace qblocks {
             return;
         }
 
-        // Note: normally we wouldn't be able to use realloc with a 'new' allocated memory,
-        // but because these are just characters, it's okay
-        m_Values = (char*)realloc(m_Values, newSize);
-        if (m_Values) {
-            m_buffSize = newSize;
-        } else {
-            m_buffSize = 0;
-        }
+        SFString copy(buffer(), 0, m_nValues);
+        reserve(newSize);
+        append(copy.c_str(), copy.length());
         return;
     }
 #endif
@@ -147,32 +213,29 @@ namespace qblocks {
     //---------------------------------------------------------------------------------------
     void string_q::clear(void)
     {
-        if (m_Values)
-            if (m_Values != nullString)
-                delete [] m_Values;
-        m_Values  = NULL;
-        m_nValues = 0;
+        if (!isInline())
+            delete [] m_heapValues;
         init();
     }
 
     //---------------------------------------------------------------------------------------
     void string_q::init()
     {
-        m_nValues     = 0;
-        m_buffSize    = 0;
-        m_Values      = nullString;
+        m_nValues         = 0;
+        m_buffSize        = SSO_SIZE - 1;
+        m_inlineValues[0] = '\0';
     }
 
     //---------------------------------------------------------------------------------------
     int string_q::compare(const char* str) const
     {
-        return strcmp(m_Values, str);
+        return strcmp(buffer(), str);
     }
 
     //---------------------------------------------------------------------------------------
     int string_q::compare(size_t pos, size_t len, const char* str) const
     {
-        SFString compared = m_Values;
+        SFString compared = buffer();
         SFString comparing = str;
         return compared.substr(pos,len).compare(comparing);
     }
@@ -180,7 +243,7 @@ namespace qblocks {
     //---------------------------------------------------------------------------------------
     int string_q::compare(size_t pos, size_t len, const char* str, size_t n) const
     {
-        SFString compared = m_Values;
+        SFString compared = buffer();
         SFString comparing = str;
         return compared.substr(pos,len).compare(comparing.substr(n));
     }
@@ -188,13 +251,13 @@ namespace qblocks {
     //---------------------------------------------------------------------------------------
     int string_q::compare(const string_q& str) const
     {
-        return strcmp(m_Values, str.c_str());
+        return strcmp(buffer(), str.c_str());
     }
 
     //---------------------------------------------------------------------------------------
     int string_q::compare(size_t pos, size_t len, const string_q& str) const
     {
-        SFString compared = m_Values;
+        SFString compared = buffer();
         SFString comparing = str.c_str();
         return compared.substr(pos,len).compare(comparing);
     }
@@ -202,33 +265,32 @@ namespace qblocks {
     //---------------------------------------------------------------------------------------
     int string_q::compare(size_t pos, size_t len, const string_q& str, size_t subpos, size_t sublen) const
     {
-        SFString compared = m_Values;
+        SFString compared = buffer();
         SFString comparing = str.c_str();
         return compared.substr(pos,len).compare(comparing.substr(subpos,sublen));
     }
     //---------------------------------------------------------------------------------------
     size_t string_q::find(const char *str, size_t pos) const
     {
-        char *f = strstr(m_Values, str);
+        const char *f = strstr(buffer(), str);
         if (f)
-            return size_t(f-m_Values);
+            return size_t(f-buffer());
         return NOPOS;
     }
 
     //---------------------------------------------------------------------------------------
     size_t string_q::find(char ch, size_t pos) const
     {
-        char *f = strchr(m_Values, ch);
+        const char *f = strchr(buffer(), ch);
         if (f)
-            return size_t(f-m_Values);
+            return size_t(f-buffer());
         return NOPOS;
     }
 
     //---------------------------------------------------------------------------------------
     size_t string_q::find(const string_q& str, size_t pos) const
     {
-        SFString s = str.m_Values;
-        return find((const char*)s,pos);
+        return find(str.c_str(), pos);
     }
 
     //---------------------------------------------------------------------------------------
@@ -242,7 +304,7 @@ namespace qblocks {
     {
         ASSERT(index >= 0);
         ASSERT(index < length());
-        return m_Values[index];
+        return buffer()[index];
     }
 
     //---------------------------------------------------------------------------------------
@@ -258,23 +320,21 @@ namespace qblocks {
             len = length() - first; // not past end
         if (first > length())
             len = 0;  // not longer than string
-        SFString ret = extract(first, len).c_str();
+        SFString ret;
+        if (len)
+        {
+            ret.reserve(len);
+            ret.append(buffer() + first, len);
+        }
         return ret;
     }
 
     //---------------------------------------------------------------------------------------
     string_q string_q::extract(size_t start, size_t len) const
     {
-        ASSERT((char*)(start+start+len) <= (char*)((int64_t)m_Values+strlen(m_Values)));
-
-        const char *strStart = m_Values;
-        strStart += start;
-
+        ASSERT(start + len <= length());
         string_q ret;
-        ret.reserve(len);
-        memcpy(ret.m_Values, strStart, len);
-        ret.m_nValues     = len;
-        ret.m_Values[len] = '\0';
+        ret.assign(buffer() + start, len);
         return ret;
     }
 
@@ -286,81 +346,80 @@ namespace qblocks {
 #endif
 
     //---------------------------------------------------------------------------------------
-    char nullString[2];
+    size_t string_view_q::find(const string_view_q& str, size_t pos) const
+    {
+        if (str.empty())
+            return (pos <= m_nValues ? pos : NOPOS);
+        while (pos + str.m_nValues <= m_nValues)
+        {
+            const char *f = (const char*)memchr(m_Values + pos, str.m_Values[0], m_nValues - pos - str.m_nValues + 1);
+            if (!f)
+                return NOPOS;
+            pos = size_t(f - m_Values);
+            if (!memcmp(f, str.m_Values, str.m_nValues))
+                return pos;
+            pos++;
+        }
+        return NOPOS;
+    }
 
     //---------------------------------------------------------------------------------------
-    SFString::SFString()
+    int string_view_q::compare(const string_view_q& str) const
     {
-        init();
-        reserve(0);
+        int ret = memcmp(m_Values, str.m_Values, min(m_nValues, str.m_nValues));
+        if (ret)
+            return ret;
+        return (m_nValues < str.m_nValues ? -1 : (m_nValues > str.m_nValues ? 1 : 0));
     }
 
     //---------------------------------------------------------------------------------------
-    SFString::SFString(const SFString& str)
+    SFString::SFString()
     {
-        init();
-        *this = str.m_Values;
     }
 
     //---------------------------------------------------------------------------------------
-    SFString::SFString(const char *str, size_t startIn, size_t lenIn)
+    SFString::SFString(const SFString& str) : string_q(str)
     {
-        init();
-
-        int64_t start = (int64_t)startIn;
-        int64_t len   = (int64_t)lenIn;
+    }
 
-        int64_t strLen = (str ? (int64_t)strlen(str) : 0);
-        len = ((len < 0) ? strLen : len);
-        ASSERT(!len || len <= (int64_t)(strlen(str)-start));
+    //---------------------------------------------------------------------------------------
+    SFString::SFString(SFString&& str) : string_q(std::move(str))
+    {
+    }
 
-        if (str && (strLen > start))
-        {
-            reserve((size_t)len);
-            memcpy(m_Values, &str[start], (size_t)len);
-        }
-        m_nValues     = (size_t)len;
-        m_Values[len] = '\0';
+    //---------------------------------------------------------------------------------------
+    SFString::SFString(const char *str, size_t start, size_t len) : string_q(str, start, len)
+    {
     }
 
     //---------------------------------------------------------------------------------------
-    SFString::SFString(char ch, size_t lenIn)
+    SFString::SFString(const string_view_q& str)
     {
-        init();
+        assign(str.data(), str.length());
+    }
 
-        int64_t len = (int64_t)lenIn;
-        len = max((int64_t)0, len);
-        if (len > 0)
-        {
-            reserve((size_t)len);
-            memset(m_Values, ch, (size_t)len);
-            m_nValues     = (size_t)len;
-            m_Values[len] = '\0';
-        }
+    //---------------------------------------------------------------------------------------
+    SFString::SFString(char ch, size_t len) : string_q(ch, len)
+    {
     }
 
     //---------------------------------------------------------------------------------------
     SFString::~SFString()
     {
-        if (m_Values)
-            if (m_Values != nullString)
-                delete [] m_Values;
-        m_Values  = NULL;
-        m_nValues = 0;
+        // the base class releases the buffer
     }
 
     //---------------------------------------------------------------------------------------
     const SFString& SFString::operator=(const SFString& str)
     {
-        if (m_Values == str.m_Values) // do not change this line
-            return *this;
-
-        size_t len = str.length();
-        reserve(len);
-        memcpy(m_Values, str.m_Values, len);
-        m_nValues     = len;
-        m_Values[len] = '\0';
+        string_q::operator=(str);
+        return *this;
+    }
 
+    //---------------------------------------------------------------------------------------
+    const SFString& SFString::operator=(SFString&& str)
+    {
+        string_q::operator=(std::move(str));
         return *this;
     }
 
@@ -372,17 +431,17 @@ namespace qblocks {
     {
         SFString me   = toLower(*this);
         SFString test = toLower(SFString(search));
-        char *f = strstr(me.m_Values, test.m_Values);
+        const char *f = strstr(me.c_str(), test.c_str());
         if (f)
-            return size_t(f-me.m_Values);
+            return size_t(f-me.c_str());
         return NOPOS;
     }
 
     //---------------------------------------------------------------------------------------
     size_t SFString::ReverseFind(char ch) const
     {
-        char *f = strrchr(m_Values, ch);
-        return (f ? size_t(f-m_Values) : NOPOS);
+        const char *f = strrchr(buffer(), ch);
+        return (f ? size_t(f-buffer()) : NOPOS);
     }
 
     //---------------------------------------------------------------------------------------
@@ -410,9 +469,9 @@ namespace qblocks {
     }
 
     //---------------------------------------------------------------------------------------
-    bool SFString::Contains(const SFString& search) const
+    bool SFString::Contains(const string_view_q& search) const
     {
-        return (find(search) != NOPOS);
+        return (string_view_q(*this).find(search) != NOPOS);
     }
 
     //---------------------------------------------------------------------------------------
@@ -447,9 +506,34 @@ namespace qblocks {
     {
         size_t i = find(what);
         if (i != NOPOS)
+            replaceAt(i, what.length(), with);
+    }
+
+    //---------------------------------------------------------------------------------------
+    // Swaps the 'len' characters at 'pos' for 'with' without building any temporaries
+    void SFString::replaceAt(size_t pos, size_t len, const SFString& withIn)
+    {
+        // 'with' may be this very string
+        SFString copy;
+        const SFString& with = (&withIn == this ? (copy = withIn) : withIn);
+
+        size_t tailLen = length() - pos - len;
+        size_t newLen  = length() - len + with.length();
+        if (newLen > m_buffSize)
         {
-            *this = substr(0,i) + with + substr(i + what.length());
+            SFString ret;
+            ret.reserve(newLen);
+            ret.append(buffer(), pos);
+            ret.append(with.c_str(), with.length());
+            ret.append(buffer() + pos + len, tailLen);
+            *this = std::move(ret);
+            return;
         }
+
+        char *s = buffer();
+        memmove(s + pos + with.length(), s + pos + len, tailLen + 1);
+        memcpy(s + pos, with.c_str(), with.length());
+        m_nValues = newLen;
     }
 
     //---------------------------------------------------------------------------------------
@@ -463,7 +547,7 @@ namespace qblocks {
     //---------------------------------------------------------------------------------------
     void SFString::ReplaceAll(char what, char with)
     {
-        char *s = m_Values;
+        char *s = buffer();
         while (*s)
         {
             if (*s == what)
@@ -486,11 +570,15 @@ namespace qblocks {
             return;
         }
 
+        // Each replacement may create a new match, but only one that starts at most
+        // what.length()-1 characters before it, so there is no need to search from the top
         size_t i = find(what);
         while (i != NOPOS)
         {
-            Replace(what, with);
-            i = find(what);
+            replaceAt(i, what.length(), with);
+            size_t from = (i >= what.length() ? i - what.length() + 1 : 0);
+            const char *f = strstr(buffer() + from, what.c_str());
+            i = (f ? size_t(f - buffer()) : NOPOS);
         }
     }
 
@@ -559,6 +647,7 @@ namespace qblocks {
     void SFString::Reverse()
     {
         char tmp;
+        char *m_Values = buffer();
         unsigned int i,j;
         unsigned int n = (unsigned int)m_nValues ;
 
@@ -573,7 +662,29 @@ namespace qblocks {
     //---------------------------------------------------------------------------------------
     int SFString::Icompare(const char *str) const
     {
-        return strcasecmp(m_Values, str);
+        return strcasecmp(buffer(), str);
+    }
+
+    //----------------------------------------------------------------------------------------
+    // The rest of the line is shifted down in place rather than copied into a new string
+    SFString nextTokenClear(SFString& line, char delim, bool doClear)
+    {
+        SFString ret;
+
+        size_t find = line.find(delim);
+        if (find!=NOPOS) {
+            ret.assign(line.c_str(), find);
+            char *s = line.buffer();
+            memmove(s, s + find + 1, line.length() - find);  // includes the terminator
+            line.m_nValues -= (find + 1);
+
+        } else if (!line.empty()) {
+            if (doClear)
+                ret = std::move(line);  // leaves the line empty
+            else
+                ret = line;
+        }
+        return ret;
     }
 
     //----------------------------------------------------------------------------------------
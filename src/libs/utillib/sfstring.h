@@ -29,17 +29,28 @@ namespace qblocks {
         const string_q& operator=(long);
 
     protected:
-        char  *m_Values;
+        // Short strings (field names, numbers, flags) are stored inside the object and never touch
+        // the heap. m_buffSize is the usable capacity in either case. Nothing here points back into
+        // the object itself, so arrays of strings may still be moved about with qsort and memcpy.
+#define SSO_SIZE 24
         size_t m_nValues;
         size_t m_buffSize;
+        union {
+            char *m_heapValues;
+            char  m_inlineValues[SSO_SIZE];
+        };
 
     public:
         string_q(void);
         string_q(const string_q& str);
+        string_q(string_q&& str);
         string_q(char ch, size_t reps=1);
         string_q(const char *str, size_t start=0, size_t len=NOPOS);
         ~string_q(void);
 
+        const string_q& operator=(const string_q& str);
+        const string_q& operator=(string_q&& str);
+
         void     clear    (void);
         size_t   length   (void) const;
         int      compare  (const char* s) const;
@@ -91,17 +102,22 @@ namespace qblocks {
 
         //----------------------------------------------------------------------------------------------------
         friend ostream& operator<<(ostream &os, const string_q& x) {
-            os << x.m_Values;
+            os << x.c_str();
             return os;
         }
 
     protected:
         void    init      (void);
+        bool    isInline  (void) const { return m_buffSize < SSO_SIZE; }
+        char   *buffer    (void)       { return isInline() ? m_inlineValues : m_heapValues; }
+        const char *buffer(void) const { return isInline() ? m_inlineValues : m_heapValues; }
+        void    assign    (const char *str, size_t len);
+        void    append    (const char *str, size_t len);
     };
 
     //--------------------------------------------------------------------
     inline bool operator==(const string_q& str1, const string_q& str2) {
-        return str1.compare(str2.m_Values) == 0;
+        return str1.compare(str2.c_str()) == 0;
     }
 
     //--------------------------------------------------------------------
@@ -116,7 +132,7 @@ namespace qblocks {
 
     //--------------------------------------------------------------------
     inline bool operator!=(const string_q& str1, const string_q& str2) {
-        return str1.compare(str2.m_Values) != 0;
+        return str1.compare(str2.c_str()) != 0;
     }
 
     //--------------------------------------------------------------------
@@ -131,7 +147,7 @@ namespace qblocks {
 
     //--------------------------------------------------------------------
     inline bool operator<(const string_q& str1, const string_q& str2) {
-        return str1.compare(str2.m_Values) < 0;
+        return str1.compare(str2.c_str()) < 0;
     }
 
     //--------------------------------------------------------------------
@@ -146,7 +162,7 @@ namespace qblocks {
 
     //--------------------------------------------------------------------
     inline bool operator>(const string_q& str1, const string_q& str2) {
-        return str1.compare(str2.m_Values) > 0;
+        return str1.compare(str2.c_str()) > 0;
     }
 
     //--------------------------------------------------------------------
@@ -161,7 +177,7 @@ namespace qblocks {
 
     //--------------------------------------------------------------------
     inline bool operator<=(const string_q& str1, const string_q& str2) {
-        return str1.compare(str2.m_Values) <= 0;
+        return str1.compare(str2.c_str()) <= 0;
     }
 
     //--------------------------------------------------------------------
@@ -176,7 +192,7 @@ namespace qblocks {
 
     //--------------------------------------------------------------------
     inline bool operator>=(const string_q& str1, const string_q& str2) {
-        return str1.compare(str2.m_Values) >= 0;
+        return str1.compare(str2.c_str()) >= 0;
     }
 
     //--------------------------------------------------------------------
@@ -219,6 +235,65 @@ namespace qblocks {
 #define string_q std::string
 #endif
 
+    //--------------------------------------------------------------------
+    // A read-only window onto characters owned by someone else (a string, a literal, a memory
+    // mapped file). Making one never allocates, so helpers that only look at their input take
+    // one of these. The characters need not be zero terminated and the view must not outlive
+    // whatever owns them.
+    class string_view_q {
+    protected:
+        const char *m_Values;
+        size_t      m_nValues;
+
+    public:
+        string_view_q(void) : m_Values(""), m_nValues(0) { }
+        string_view_q(const char *str) : m_Values(str ? str : ""), m_nValues(str ? strlen(str) : 0) { }
+        string_view_q(const char *str, size_t len) : m_Values(str), m_nValues(len) { }
+        string_view_q(const string_q& str) : m_Values(str.c_str()), m_nValues(str.length()) { }
+
+        const char   *data      (void) const { return m_Values; }
+        size_t        length    (void) const { return m_nValues; }
+        bool          empty     (void) const { return m_nValues == 0; }
+        char          operator[](size_t index) const { return m_Values[index]; }
+
+        size_t        find      (char ch, size_t pos=0) const;
+        size_t        find      (const string_view_q& str, size_t pos=0) const;
+        string_view_q substr    (size_t first, size_t len=NOPOS) const;
+        int           compare   (const string_view_q& str) const;
+
+        bool          startsWith(char ch) const { return m_nValues && m_Values[0] == ch; }
+        bool          startsWith(const string_view_q& str) const {
+            return str.m_nValues <= m_nValues && !memcmp(m_Values, str.m_Values, str.m_nValues);
+        }
+        bool          endsWith  (char ch) const { return m_nValues && m_Values[m_nValues - 1] == ch; }
+        bool          endsWith  (const string_view_q& str) const {
+            return str.m_nValues <= m_nValues &&
+                        !memcmp(m_Values + m_nValues - str.m_nValues, str.m_Values, str.m_nValues);
+        }
+
+        friend bool operator==(const string_view_q& v1, const string_view_q& v2) {
+            return v1.m_nValues == v2.m_nValues && !memcmp(v1.m_Values, v2.m_Values, v1.m_nValues);
+        }
+        friend bool operator!=(const string_view_q& v1, const string_view_q& v2) { return !(v1 == v2); }
+    };
+
+    //--------------------------------------------------------------------
+    inline size_t string_view_q::find(char ch, size_t pos) const {
+        if (pos >= m_nValues)
+            return NOPOS;
+        const char *f = (const char*)memchr(m_Values + pos, ch, m_nValues - pos);
+        return (f ? size_t(f - m_Values) : NOPOS);
+    }
+
+    //--------------------------------------------------------------------
+    inline string_view_q string_view_q::substr(size_t first, size_t len) const {
+        if (first > m_nValues)
+            first = m_nValues;
+        if (len > m_nValues - first)
+            len = m_nValues - first;
+        return string_view_q(m_Values + first, len);
+    }
+
     //--------------------------------------------------------------------
     class SFString : public string_q {
         SFString  (long) {};
@@ -227,12 +302,15 @@ namespace qblocks {
     public:
         SFString  (void);
         SFString  (const SFString& str);
+        SFString  (SFString&& str);
         SFString  (char ch, size_t reps=1);
         SFString  (const char *str, size_t start=0, size_t len=NOPOS);
+        explicit  SFString(const string_view_q& str);
 
         ~SFString (void);
 
         const SFString& operator=     (const SFString& str);
+        const SFString& operator=     (SFString&& str);
 
         const SFString& operator+=    (const SFString& str);
         const SFString& operator+=    (char ch);
@@ -243,6 +321,11 @@ namespace qblocks {
         SFString        substr        (size_t first, size_t len) const;
         SFString        substr        (size_t first) const;
 
+    protected:
+        void            replaceAt     (size_t pos, size_t len, const SFString& with);
+
+    public:
+
         void            Reverse       (void);
         int             Icompare      (const char *str) const;
 
@@ -252,7 +335,7 @@ namespace qblocks {
         size_t   findExactI      (const SFString& search, char sep, const SFString& replaceables=CHR_VALID_NAME) const;
 
         bool     Contains        (char search) const;
-        bool     Contains        (const SFString& search) const;
+        bool     Contains        (const string_view_q& search) const;
         bool     ContainsI       (const SFString& search) const;
         bool     ContainsAll     (const SFString& search) const;
         bool     ContainsAny     (const SFString& search) const;
@@ -270,11 +353,14 @@ namespace qblocks {
         void     ReplaceAny      (const SFString& list, const SFString& with);
         void     ReplaceReverse  (const SFString& what, const SFString& with);
 
-        bool     startsWith      (const SFString& str) const;
-        bool     endsWith        (const SFString& str) const;
+        bool     startsWith      (char ch) const;
+        bool     startsWith      (const string_view_q& str) const;
+        bool     endsWith        (char ch) const;
+        bool     endsWith        (const string_view_q& str) const;
 
         friend SFString operator+(const SFString& str1, const SFString& str2);
         friend SFString operator+(const SFString& str1, const char *str2);
+        friend SFString nextTokenClear(SFString& line, char delim, bool doClear);
     };
 
     //--------------------------------------------------------------------
@@ -289,65 +375,87 @@ namespace qblocks {
 
     //--------------------------------------------------------------------
     inline SFString::operator const char *() const {
-        return m_Values;
+        return buffer();
     }
 
     //---------------------------------------------------------------------------------------
     inline SFString operator+(const SFString& str1, const SFString& str2) {
-        size_t newLen = str1.length() + str2.length();
         SFString ret;
-        ret.reserve(newLen);
-        memcpy(ret.m_Values, str1.m_Values, str1.length());
-        memcpy(ret.m_Values+str1.length(), str2.m_Values, str2.length());
-        ret.m_nValues = newLen;
-        ret.m_Values[newLen] = '\0';
+        ret.reserve(str1.length() + str2.length());
+        ret.append(str1.c_str(), str1.length());
+        ret.append(str2.c_str(), str2.length());
         return ret;
     }
 
     //---------------------------------------------------------------------------------------
+    // Appends in place. The buffer grows geometrically, so building a string a piece at a time
+    // (as the curl callback and the exporters do) is no longer quadratic.
     inline const SFString& SFString::operator+=(const SFString& add) {
-        if (add.length())
-            *this = (*this + add);
+        append(add.c_str(), add.length());
         return *this;
     }
 
     //--------------------------------------------------------------------
     inline const SFString& SFString::operator+=(const char *str) {
-        return operator+=(SFString(str));
+        if (str)
+            append(str, strlen(str));
+        return *this;
     }
 
     //--------------------------------------------------------------------
     inline const SFString& SFString::operator+=(char ch) {
-        return operator+=(SFString(ch));
+        append(&ch, 1);
+        return *this;
     }
 
     //--------------------------------------------------------------------
     inline SFString operator+(const SFString& str1, const char *str2) {
-        return operator+(str1, SFString(str2));
+        size_t len2 = (str2 ? strlen(str2) : 0);
+        SFString ret;
+        ret.reserve(str1.length() + len2);
+        ret.append(str1.c_str(), str1.length());
+        ret.append(str2, len2);
+        return ret;
     }
 
     //--------------------------------------------------------------------
     inline SFString operator+(const char *str1, const SFString& str2) {
-        return operator+(SFString(str1), str2);
+        SFString ret(str1);
+        ret += str2;
+        return ret;
     }
 
     //--------------------------------------------------------------------
     inline SFString operator+(const SFString& str,  char ch) {
-        return operator+(str, SFString(ch));
+        SFString ret;
+        ret.reserve(str.length() + 1);
+        ret += str;
+        ret += ch;
+        return ret;
     }
 
     //--------------------------------------------------------------------
-    inline bool SFString::endsWith(const SFString& str) const {
+    inline bool SFString::endsWith(char ch) const {
+        return !empty() && buffer()[length()-1] == ch;
+    }
+
+    //--------------------------------------------------------------------
+    inline bool SFString::endsWith(const string_view_q& str) const {
         if (empty())
             return false;
-        return (substr(length()-str.length(),str.length()) == str);
+        return string_view_q(*this).endsWith(str);
     }
 
     //--------------------------------------------------------------------
-    inline bool SFString::startsWith(const SFString& str) const {
+    inline bool SFString::startsWith(char ch) const {
+        return !empty() && buffer()[0] == ch;
+    }
+
+    //--------------------------------------------------------------------
+    inline bool SFString::startsWith(const string_view_q& str) const {
         if (empty())
             return false;
-        return (substr(0,str.length()) == str);
+        return string_view_q(*this).startsWith(str);
     }
 
     //--------------------------------------------------------------------
@@ -389,19 +497,19 @@ namespace qblocks {
 
     //--------------------------------------------------------------------
     extern SFString nextTokenClearReverse(SFString& str, char token);
-    inline SFString nextTokenClear(SFString& line, char delim, bool doClear=true) {
-        SFString ret;
+    extern SFString nextTokenClear(SFString& line, char delim, bool doClear=true);
 
+    //--------------------------------------------------------------------
+    // Same as nextTokenClear, but for views. Neither the token nor the rest of the line is copied.
+    inline string_view_q nextToken(string_view_q& line, char delim) {
         size_t find = line.find(delim);
-        if (find!=NOPOS) {
-            ret  = line.substr(0,find);
-            line = line.substr(find+1);
-
-        } else if (!line.empty()) {
-            ret  = line;
-            if (doClear)
-                line = "";
+        if (find == NOPOS) {
+            string_view_q ret = line;
+            line = string_view_q();
+            return ret;
         }
+        string_view_q ret = line.substr(0, find);
+        line = line.substr(find + 1);
         return ret;
     }
 
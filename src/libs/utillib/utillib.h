@@ -34,5 +34,12 @@
 #include "namevalue.h"
 #include "accountname.h"
 #include "memmap.h"
+#include "codec.h"
+#include "memarchive.h"
+#include "cachewriter.h"
+#include "keccak.h"
+#include "fixedbytes.h"
+#include "workpool.h"
+#include "jsontape.h"
 
 using namespace qblocks;  // NOLINT
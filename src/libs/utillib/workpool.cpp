@@ -0,0 +1,151 @@
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include "workpool.h"
+
+namespace qblocks {
+
+    //-------------------------------------------------------------------------
+    CWorkPool::CWorkPool(uint32_t nThreads)
+        : m_queues(NULL), m_generation(0), m_nBusy(0), m_stopping(false), m_cancelled(false),
+          m_func(NULL), m_data(NULL) {
+
+        if (nThreads == 0)
+            nThreads = std::thread::hardware_concurrency();
+        if (nThreads == 0)
+            nThreads = 1;
+
+        m_queues = new CWorkQueue[nThreads];
+        for (uint32_t i = 0 ; i < nThreads ; i++)
+            m_threads.push_back(std::thread(&CWorkPool::workerLoop, this, i));
+    }
+
+    //-------------------------------------------------------------------------
+    CWorkPool::~CWorkPool(void) {
+        cancel();
+        wait();
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_stopping = true;
+        }
+        m_wake.notify_all();
+        for (size_t i = 0 ; i < m_threads.size() ; i++)
+            m_threads[i].join();
+        delete [] m_queues;
+    }
+
+    //-------------------------------------------------------------------------
+    void CWorkPool::start(uint64_t nItems, WORKFUNC func, void *data, uint64_t chunkSize) {
+        // One job at a time
+        wait();
+
+        if (!func || !nItems)
+            return;
+        if (!chunkSize)
+            chunkSize = 1;
+
+        uint32_t n = nThreads();
+        uint32_t which = 0;
+        for (uint64_t first = 0 ; first < nItems ; first += chunkSize) {
+            uint64_t last = min(nItems, first + chunkSize);
+            std::lock_guard<std::mutex> guard(m_queues[which].lock);
+            m_queues[which].chunks.push_back(std::make_pair(first, last));
+            which = (which + 1) % n;
+        }
+
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_func  = func;
+            m_data  = data;
+            m_nBusy = n;
+            m_cancelled = false;
+            m_generation++;
+        }
+        m_wake.notify_all();
+    }
+
+    //-------------------------------------------------------------------------
+    void CWorkPool::wait(void) {
+        std::unique_lock<std::mutex> guard(m_lock);
+        m_done.wait(guard, [this] { return m_nBusy == 0; });
+    }
+
+    //-------------------------------------------------------------------------
+    // Items already running finish, but no new ones are started. Call wait() to know when
+    // the workers are done.
+    void CWorkPool::cancel(void) {
+        m_cancelled = true;
+    }
+
+    //-------------------------------------------------------------------------
+    bool CWorkPool::nextChunk(uint32_t which, uint64_t& first, uint64_t& last) {
+        {
+            CWorkQueue& mine = m_queues[which];
+            std::lock_guard<std::mutex> guard(mine.lock);
+            if (!mine.chunks.empty()) {
+                first = mine.chunks.front().first;
+                last  = mine.chunks.front().second;
+                mine.chunks.pop_front();
+                return true;
+            }
+        }
+
+        // Our own queue is empty, so steal from the others
+        uint32_t n = nThreads();
+        for (uint32_t i = 1 ; i < n ; i++) {
+            CWorkQueue& victim = m_queues[(which + i) % n];
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (!victim.chunks.empty()) {
+                first = victim.chunks.back().first;
+                last  = victim.chunks.back().second;
+                victim.chunks.pop_back();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //-------------------------------------------------------------------------
+    void CWorkPool::workerLoop(uint32_t which) {
+        uint64_t generation = 0;
+        while (true) {
+            WORKFUNC func;
+            void *data;
+            {
+                std::unique_lock<std::mutex> guard(m_lock);
+                m_wake.wait(guard, [this, generation] { return m_stopping || m_generation != generation; });
+                if (m_stopping)
+                    return;
+                generation = m_generation;
+                func = m_func;
+                data = m_data;
+            }
+
+            // No chunks are added while a job is running, so once every queue is empty we're done
+            uint64_t first, last;
+            while (!m_cancelled && nextChunk(which, first, last))
+                for (uint64_t item = first ; item < last && !m_cancelled ; item++)
+                    (*func)(item, data);
+
+            if (m_cancelled) {
+                // drop whatever is left in our queue so the next job starts clean
+                std::lock_guard<std::mutex> guard(m_queues[which].lock);
+                m_queues[which].chunks.clear();
+            }
+
+            std::lock_guard<std::mutex> guard(m_lock);
+            if (--m_nBusy == 0)
+                m_done.notify_all();
+        }
+    }
+
+}  // namespace qblocks
@@ -0,0 +1,73 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "basetypes.h"
+
+namespace qblocks {
+
+    //-------------------------------------------------------------------------
+    // Called on one of the pool's threads for each item of a job
+    typedef void (*WORKFUNC)(uint64_t item, void *data);
+
+    //-------------------------------------------------------------------------
+    // A fixed set of worker threads that run 'func' on every item in [0, nItems). The items are
+    // split into chunks which are dealt out evenly to each thread's queue. A thread works through
+    // its own queue from the front and, when it runs dry, steals chunks from the back of the
+    // other threads' queues, so slow items on one thread don't leave the others idle.
+    //
+    // start() returns right away so the caller can consume results as they're produced. wait()
+    // blocks until every item is done (or the job is cancelled).
+    class CWorkPool {
+    public:
+        explicit CWorkPool(uint32_t nThreads = 0);  // zero means one per core
+        ~CWorkPool(void);
+
+        void     start   (uint64_t nItems, WORKFUNC func, void *data, uint64_t chunkSize = 1);
+        void     wait    (void);
+        void     cancel  (void);
+
+        uint32_t nThreads(void) const { return (uint32_t)m_threads.size(); }
+
+    private:
+        //---------------------------------------------------------------------
+        struct CWorkQueue {
+            std::mutex                                   lock;
+            std::deque< std::pair<uint64_t, uint64_t> >  chunks;  // [first, last) item ranges
+        };
+
+        std::vector<std::thread>  m_threads;
+        CWorkQueue               *m_queues;
+        std::mutex                m_lock;
+        std::condition_variable   m_wake;
+        std::condition_variable   m_done;
+        uint64_t                  m_generation;
+        uint32_t                  m_nBusy;
+        bool                      m_stopping;
+        std::atomic<bool>         m_cancelled;
+        WORKFUNC                  m_func;
+        void                     *m_data;
+
+        void workerLoop(uint32_t which);
+        bool nextChunk (uint32_t which, uint64_t& first, uint64_t& last);
+
+        CWorkPool(const CWorkPool&);
+        CWorkPool& operator=(const CWorkPool&);
+    };
+
+}  // namespace qblocks
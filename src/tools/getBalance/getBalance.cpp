@@ -39,6 +39,18 @@ int main(int argc, const char *argv[]) {
         // For each address
         while (!options.addrs.empty()) {
             options.state.curAddr = nextTokenClear(options.addrs, '|');
+
+            // Ask the node for all of this account's balances at once. We report them in order below
+            options.state.blocks.Clear();
+            SFString list = options.getBlockNumList();
+            while (!list.empty()) {
+                blknum_t bn = toLongU(nextTokenClear(list, '|'));
+                if (bn <= options.state.latestBlock)
+                    options.state.blocks[options.state.blocks.getCount()] = bn;
+            }
+            getBalances(options.state.bals, options.state.curAddr, options.state.blocks);
+            options.state.curBal = 0;
+
             options.blocks.forEveryBlockNumber(visitBlock, &options);
         }
 
@@ -71,7 +83,12 @@ bool visitBlock(uint64_t blockNum, void *data) {
         return usage("Block " + asStringU(blockNum) + " is later than the last valid block " + late + ". Quitting...");
     }
 
-    SFUintBN bal = getBalance(options->state.curAddr, blockNum, false);
+    SFUintBN bal;
+    CState *state = &options->state;
+    if (state->curBal < state->blocks.getCount() && state->blocks[state->curBal] == blockNum)
+        bal = state->bals[state->curBal++];
+    else
+        bal = getBalance(options->state.curAddr, blockNum, false);
     options->state.totalVal += bal;
     SFString sBal = to_string(bal).c_str();
     if (expContext().asEther) {
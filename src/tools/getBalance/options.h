@@ -21,7 +21,10 @@ public:
     SFUintBN totalVal;
     SFUintBN lastBal;
     SFAddress curAddr;
-    CState(void) { needsNewline = true; latestBlock = getLatestBlockFromClient(); totalVal = 0; lastBal = 0; }
+    SFUintArray blocks;
+    SFBigUintArray bals;
+    uint32_t curBal;
+    CState(void) { needsNewline = true; latestBlock = getLatestBlockFromClient(); totalVal = 0; lastBal = 0; curBal = 0; }
 };
 
 //-----------------------------------------------------------------------------
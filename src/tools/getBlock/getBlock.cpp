@@ -66,6 +66,10 @@ int main(int argc, const char * argv[]) {
         }
     }
 
+    // Blocks written with --force go to the cache in the background
+    if (!flushCacheWrites())
+        cerr << "Some blocks could not be written to the cache.\n";
+
     return 0;
 }
 
@@ -91,7 +95,7 @@ SFString doOneBlock(uint64_t num, const COptions& opt) {
                 gold.parseJson((char*)(const char*)result);
                 SFString fileName = getBinaryFilename(num);
                 gold.finalized = isBlockFinal(gold.timestamp, latest.timestamp);
-                writeBlockToBinary(gold, fileName);
+                queueBlockToBinary(gold, fileName);
             }
         }
 
@@ -100,7 +104,8 @@ SFString doOneBlock(uint64_t num, const COptions& opt) {
         if (opt.isCache) {
 
             // --source::cache mode doesn't include timestamp in transactions
-            readBlockFromBinary(gold, fileName);
+            if (!opt.columns || !readBlockFromColumns(gold, num, opt.columns))
+                readBlockFromBinary(gold, fileName);
             for (uint32_t t = 0 ; t < gold.transactions.getCount() ; t++)
                 gold.transactions[t].timestamp = gold.timestamp;
 
@@ -110,7 +115,7 @@ SFString doOneBlock(uint64_t num, const COptions& opt) {
 
         if (opt.force) { // turn this on to force a write of the block to the disc
             gold.finalized = isBlockFinal(gold.timestamp, latest.timestamp);
-            writeBlockToBinary(gold, fileName);
+            queueBlockToBinary(gold, fileName);
         }
 
         if (!opt.silent) {
@@ -54,18 +54,8 @@ bool COptions::parseArguments(SFString& command) {
             expContext().spcs = 4;
             expContext().hexNums = true;
             expContext().quoteNums = true;
-            CRuntimeClass *pClass = GETRUNTIME_CLASS(CBlock);
-            if (pClass) {
-                CFieldData *pField = pClass->FindField("blockNumber");
-                if (pField)
-                    pField->setName("number");
-            }
-            pClass = GETRUNTIME_CLASS(CBlock);
-            if (pClass) {
-                CFieldData *pField = pClass->FindField("hash");
-                if (pField)
-                    pField->setName("blockHash");
-            }
+            RENAME_FIELD(CBlock, "blockNumber", "number");
+            RENAME_FIELD(CBlock, "hash", "blockHash");
             GETRUNTIME_CLASS(CBlock)->sortFieldList();
             GETRUNTIME_CLASS(CTransaction)->sortFieldList();
             GETRUNTIME_CLASS(CReceipt)->sortFieldList();
@@ -187,13 +177,8 @@ bool COptions::parseArguments(SFString& command) {
         HIDE_FIELD(CTransaction, "cumulativeGasUsed");
         HIDE_FIELD(CTransaction, "gasUsed");
         HIDE_FIELD(CTransaction, "timestamp");
-        CRuntimeClass *pClass = GETRUNTIME_CLASS(CBlock);
-        if (pClass) {
-            CFieldData *pField = pClass->FindField("blockNumber");
-            if (pField)
-                pField->setName("number");
-            pClass->sortFieldList();
-        }
+        RENAME_FIELD(CBlock, "blockNumber", "number");
+        GETRUNTIME_CLASS(CBlock)->sortFieldList();
     }
 
     if (hashes && !isRaw)
@@ -203,6 +188,13 @@ bool COptions::parseArguments(SFString& command) {
         return usage("You must specify at least one block.");
 
     format = getGlobalConfig()->getDisplayStr(false, "");
+
+    // The columnar cache is much quicker to read, but only if it has every field we're going to
+    // show (a custom format may show anything). We never use it with --force since that would
+    // write the partial block back out.
+    if (!isCache || force || !format.empty() || !getVisibleColumns(columns))
+        columns = 0;
+
     if (format.Contains("{PRICE:CLOSE}")) {
 //        priceBlocks = true;
     }
@@ -223,6 +215,7 @@ void COptions::Init(void) {
     force       = false;
     normalize   = false;
     isCache     = false;
+    columns     = 0;
     quiet       = 0; // quiet has levels
     format      = "";
     priceBlocks = false;
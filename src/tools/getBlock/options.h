@@ -19,6 +19,7 @@ public:
     bool isCheck;
     bool isRaw;
     bool isCache;
+    uint64_t columns;
     bool hashes;
     bool traces;
     bool force;
@@ -82,21 +82,22 @@ bool CBloomBlock::setValueByName(SFString const& fieldName, SFString const& fiel
     if (fieldName == "logsBloom"   ) { logsBloom    = fieldValue; return true; }
     if (fieldName == "number"      ) { number       = toUnsigned(fieldValue); return true; }
     if (fieldName == "transactions") {
+        SFStringArray params;
         char *p = cleanUpJson((char*)fieldValue.c_str());
         while (p && *p) {
             CBloomTrans item;
             uint32_t nFields = 0;
             p = item.parseJson(p, nFields);
             if (nFields) {
-                SFString result;
-                queryRawReceipt(result, item.hash);
-                CRPCResult generic;
-                char *r = cleanUpJson((char*)(const char*)result);
-                generic.parseJson(r);
-                item.receipt.parseJson(cleanUpJson((char*)generic.result.c_str()));
+                params[transactions.getCount()] = "[\"" + fixHash(item.hash) + "\"]";
                 transactions[transactions.getCount()] = item;
             }
         }
+        // pick up all of the receipts in as few round trips as possible
+        SFStringArray results;
+        callRPCBatch("eth_getTransactionReceipt", params, results);
+        for (uint32_t i = 0 ; i < results.getCount() ; i++)
+            transactions[i].receipt.parseJson((char*)results[i].c_str());
         return true;
     }
     return true;
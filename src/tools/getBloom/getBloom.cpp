@@ -122,8 +122,10 @@ SFString doOneBloom(uint64_t num, const COptions& opt) {
 
     } else {
 
+        // Prefer the bloom index, fall back to the per-block file for blocks not yet indexed
         SFBloomArray blooms;
-        readBloomArray(blooms, getBinaryFilename(num).Substitute("/blocks/", "/blooms/"));
+        if (!getBloomIndex()->getBlooms(num, blooms))
+            readBloomArray(blooms, getBinaryFilename(num).Substitute("/blocks/", "/blooms/"));
         ostringstream os;
         os << "\n" << SFString('-',90) << " " << num << SFString('-',90) << "\n";
         for (uint32_t i = 0 ; i < blooms.getCount(); i++) {
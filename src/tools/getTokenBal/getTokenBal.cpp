@@ -17,6 +17,7 @@
 void reportByToken(COptions& options);
 void reportByAccount(COptions& options);
 extern SFUintBN getTokenInfo(const SFString& value,  const SFAddress& token, const SFAddress& holder, blknum_t blockNum);
+extern void getTokenBalances(SFBigUintArray& bals, const SFAddress& token, const SFAddress& holder, const SFString& blockList);
 //--------------------------------------------------------------
 int main(int argc, const char *argv[]) {
 
@@ -64,11 +65,13 @@ void reportByToken(COptions& options) {
         while (!holders.empty()) {
             SFAddress holder = nextTokenClear(holders, '|');
 
-            // For each block
+            // For each block (we ask the node for all of them at once)
             SFString blocks = options.getBlockNumList();
-            while (!blocks.empty()) {
+            SFBigUintArray bals;
+            getTokenBalances(bals, token, holder, blocks);
+            for (uint32_t i = 0 ; !blocks.empty() ; i++) {
                 blknum_t blockNum = toLongU(nextTokenClear(blocks, '|'));
-                SFUintBN bal = getTokenInfo("balance", token, holder, blockNum);
+                SFUintBN bal = bals[i];
                 totalVal += bal;
                 SFString sBal = to_string(bal).c_str();
                 if (expContext().asEther) {
@@ -142,11 +145,13 @@ void reportByAccount(COptions& options) {
         while (!tokens.empty()) {
             SFAddress token = nextTokenClear(tokens, '|');
 
-            // For each block
+            // For each block (we ask the node for all of them at once)
             SFString blocks = options.getBlockNumList();
-            while (!blocks.empty()) {
+            SFBigUintArray bals;
+            getTokenBalances(bals, token, holder, blocks);
+            for (uint32_t i = 0 ; !blocks.empty() ; i++) {
                 blknum_t blockNum = toLongU(nextTokenClear(blocks, '|'));
-                SFUintBN bal = getTokenInfo("balance", token, holder, blockNum);
+                SFUintBN bal = bals[i];
                 totalVal += bal;
                 SFString sBal = to_string(bal).c_str();
                 if (expContext().asEther) {
@@ -201,11 +206,7 @@ void reportByAccount(COptions& options) {
 }
 
 //-------------------------------------------------------------------------
-SFUintBN getTokenInfo(const SFString& value, const SFAddress& token, const SFAddress& holder, blknum_t blockNum) {
-
-    ASSERT(isAddress(token));
-    ASSERT(isAddress(holder));
-
+static SFString getTokenBalanceCmd(const SFAddress& token, const SFAddress& holder, blknum_t blockNum) {
     SFString t = "0x" + padLeft(token.substr(2), 40, '0');  // address to send the command to
     SFString h =        padLeft(holder.substr(2), 64, '0'); // encoded data for the transaction
 
@@ -214,7 +215,33 @@ SFUintBN getTokenInfo(const SFString& value, const SFAddress& token, const SFAdd
     cmd.Replace("[TOKEN]",  t);
     cmd.Replace("[HOLDER]", h);
     cmd.Replace("[BLOCK]",  toHex(blockNum));
+    return cmd;
+}
+
+//-------------------------------------------------------------------------
+SFUintBN getTokenInfo(const SFString& value, const SFAddress& token, const SFAddress& holder, blknum_t blockNum) {
+
+    ASSERT(isAddress(token));
+    ASSERT(isAddress(holder));
+
+    return toWei(callRPC("eth_call", getTokenBalanceCmd(token, holder, blockNum), false));
+}
+
+//-------------------------------------------------------------------------
+void getTokenBalances(SFBigUintArray& bals, const SFAddress& token, const SFAddress& holder, const SFString& blockList) {
+
+    ASSERT(isAddress(token));
+    ASSERT(isAddress(holder));
+
+    SFStringArray cmds;
+    SFString blocks = blockList;
+    while (!blocks.empty())
+        cmds[cmds.getCount()] = getTokenBalanceCmd(token, holder, toLongU(nextTokenClear(blocks, '|')));
 
-    return toWei(callRPC("eth_call", cmd, false));
+    SFStringArray results;
+    callRPCMany("eth_call", cmds, results);
+    bals.Clear();
+    for (uint32_t i = 0 ; i < results.getCount() ; i++)
+        bals[i] = toWei(results[i]);
 }
 
@@ -37,12 +37,11 @@ int main(int argc, const char *argv[]) {
 bool visitTransaction(CTransaction& trans, void *data) {
     const COptions *opt = (const COptions*)data;
 
-    bool badHash = !isHash(trans.hash);
-    bool isBlock = trans.hash.Contains("block");
-    trans.hash = trans.hash.Substitute("-block_not_found","").Substitute("-trans_not_found","");
+    bool badHash = !trans.notFound.empty();
+    bool isBlock = trans.notFoundBlock;
     if (opt->isRaw) {
         if (badHash) {
-            cerr << "{\"jsonrpc\":\"2.0\",\"result\":{\"hash\":\"" << trans.hash.Substitute(" ","") << "\",\"result\":\"";
+            cerr << "{\"jsonrpc\":\"2.0\",\"result\":{\"hash\":\"" << trans.notFound.Substitute(" ","") << "\",\"result\":\"";
             cerr << (isBlock ? "block " : "");
             cerr << "hash not found\"},\"id\":-1}" << "\n";
             return true;
@@ -56,12 +55,12 @@ bool visitTransaction(CTransaction& trans, void *data) {
     }
 
     if (badHash) {
-        cerr << cRed << "Warning:" << cOff << " The " << (isBlock ? "block " : "") << "hash " << cYellow << trans.hash << cOff << " was not found.\n";
+        cerr << cRed << "Warning:" << cOff << " The " << (isBlock ? "block " : "") << "hash " << cYellow << trans.notFound << cOff << " was not found.\n";
         return true;
     }
 
     CTraceArray traces;
-    getTraces(traces, trans.getValueByName("hash"));
+    getTraces(traces, trans);
 
     cout << "[";
     for (uint32_t i = 0 ; i < traces.getCount() ; i++) {
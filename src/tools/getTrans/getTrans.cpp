@@ -44,12 +44,11 @@ bool visitTransaction(CTransaction& trans, void *data) {
     COptions *opt = (COptions*)data;
     opt->nVisited++;
 
-    bool badHash = !isHash(trans.hash);
-    bool isBlock = trans.hash.Contains("block");
-    trans.hash = trans.hash.Substitute("-block_not_found","").Substitute("-trans_not_found","");
+    bool badHash = !trans.notFound.empty();
+    bool isBlock = trans.notFoundBlock;
     if (opt->isRaw) {
         if (badHash) {
-            cerr << "{\"jsonrpc\":\"2.0\",\"result\":{\"hash\":\"" << trans.hash.Substitute(" ","") << "\",\"result\":\"";
+            cerr << "{\"jsonrpc\":\"2.0\",\"result\":{\"hash\":\"" << trans.notFound.Substitute(" ","") << "\",\"result\":\"";
             cerr << (isBlock ? "block " : "");
             cerr << "hash not found\"},\"id\":-1}" << "\n";
             return true;
@@ -63,7 +62,7 @@ bool visitTransaction(CTransaction& trans, void *data) {
     }
 
     if (badHash) {
-        cerr << cRed << "Warning:" << cOff << " The " << (isBlock ? "block " : "") << "hash " << cYellow << trans.hash << cOff << " was not found.\n";
+        cerr << cRed << "Warning:" << cOff << " The " << (isBlock ? "block " : "") << "hash " << cYellow << trans.notFound << cOff << " was not found.\n";
         return true;
     }
 
@@ -77,9 +76,9 @@ bool visitTransaction(CTransaction& trans, void *data) {
     }
 
     if (opt->incTrace) {
-        uint64_t nTr = getTraceCount(trans.hash);
+        uint64_t nTr = getTraceCount(trans);
         CTraceArray traces;
-        getTraces(traces, trans.hash);
+        getTraces(traces, trans);
         if (traces.getCount()) {
             uint32_t dTs = 0;
             cout << "[";
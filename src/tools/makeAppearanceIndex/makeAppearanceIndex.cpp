@@ -0,0 +1,67 @@
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include "etherlib.h"
+#include "options.h"
+
+extern bool showAppearance(blknum_t bn, blknum_t tx, void *data);
+//--------------------------------------------------------------
+int main(int argc, const char *argv[]) {
+
+    etherlib_init();
+
+    // Parse command line, allowing for command files
+    COptions options;
+    if (!options.prepareArguments(argc, argv))
+        return 0;
+
+    // There's only one thing to do, so there's no need to loop over the command list
+    {
+        SFString command = nextTokenClear(options.commandList, '\n');
+        if (!options.parseArguments(command))
+            return 0;
+
+        if (!options.addrs.empty()) {
+            while (!options.addrs.empty()) {
+                SFAddress addr = toLower(nextTokenClear(options.addrs, '|'));
+                cout << addr << "\n";
+                forEveryAppearance(addr, 0, NOPOS, showAppearance, NULL);
+            }
+            return 0;
+        }
+
+        // Each segment of the index is one second-level folder of the block cache
+        SFUintArray chunks;
+        listCacheChunks(chunks);
+
+        uint64_t nSegments = 0, nBlocks = 0;
+        for (uint32_t i = 0 ; i < chunks.getCount() && !shouldQuit() ; i++) {
+            uint64_t n = 0;
+            if (buildAppearanceChunk(chunks[i], options.flags, options.rebuild, n)) {
+                nSegments++;
+                nBlocks += n;
+                if (!isTestMode())
+                    cerr << "\twrote segment " << chunks[i] << " (" << n << " new blocks)\r";
+            }
+        }
+
+        cout << "Indexed " << cYellow << nBlocks << cOff << " blocks in "
+                << cYellow << nSegments << cOff << " segments.\n";
+    }
+    return 0;
+}
+
+//--------------------------------------------------------------
+bool showAppearance(blknum_t bn, blknum_t tx, void *data) {
+    cout << "\t" << bn << "\t" << (tx == NOPOS ? SFString("block") : asStringU(tx)) << "\n";
+    return true;
+}
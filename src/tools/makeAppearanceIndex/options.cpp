@@ -0,0 +1,94 @@
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include "options.h"
+
+//---------------------------------------------------------------------------------------------------
+CParams params[] = {
+    CParams("~!address_list", "if present, list the indexed appearances of these addresses instead of freshening the index"),
+    CParams("-rebuild",       "rebuild every segment of the index, not just the blocks added since it was last freshened"),
+    CParams("-noTraces",      "do not ask the node for traces (faster, but misses addresses that only appear in traces)"),
+    CParams("",               "Builds (or freshens) the address appearance index from the block files in the cache.\n"),
+};
+uint32_t nParams = sizeof(params) / sizeof(CParams);
+
+//---------------------------------------------------------------------------------------------------
+bool COptions::parseArguments(SFString& command) {
+
+    if (!standardOptions(command))
+        return false;
+
+    Init();
+    while (!command.empty()) {
+
+        SFString arg = nextTokenClear(command, ' ');
+        if (arg == "-r" || arg == "--rebuild") {
+            rebuild = true;
+
+        } else if (arg == "-n" || arg == "--noTraces") {
+            flags &= ~APPEAR_TRACES;
+
+        } else if (arg.startsWith('-')) {  // do not collapse
+
+            if (!builtInCmd(arg)) {
+                return usage("Invalid option: " + arg);
+            }
+
+        } else {
+
+            if (!isAddress(arg))
+                return usage(arg + " does not appear to be a valid Ethereum address. Quitting...");
+            addrs += arg + "|";
+
+        }
+    }
+
+    if (!addrs.empty() && rebuild)
+        return usage("Choose either to list appearances or to rebuild the index, not both.");
+
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------------
+void COptions::Init(void) {
+    paramsPtr = params;
+    nParamsRef = nParams;
+    pOptions = this;
+
+    rebuild = false;
+    flags = APPEAR_TRACES;
+    addrs = "";
+    minArgs = 0;
+}
+
+//---------------------------------------------------------------------------------------------------
+COptions::COptions(void) {
+    Init();
+}
+
+//--------------------------------------------------------------------------------
+COptions::~COptions(void) {
+}
+
+//--------------------------------------------------------------------------------
+SFString COptions::postProcess(const SFString& which, const SFString& str) const {
+    if (which == "notes" && (verbose || COptions::isReadme)) {
+        SFString ret;
+        ret += "The index is written to [{$BLOCK_CACHE/appearances/}], one segment for every 100,000 blocks. "
+                "Freshening reads only the blocks past the last one indexed in each segment.\n";
+        ret += "Blocks added to the cache below a segment's last indexed block are picked up only with [{--rebuild}].\n";
+        ret += "Each line of a listing is the block number and the transaction index (or [{block}] if the address "
+                "appears in the block itself, as its miner, for example).\n";
+        return ret;
+    }
+    return str;
+}
@@ -0,0 +1,86 @@
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include "etherlib.h"
+#include "options.h"
+
+extern bool collectBloomFile(const SFString& path, void *data);
+extern int  sortBlockNums(const void *v1, const void *v2);
+//--------------------------------------------------------------
+int main(int argc, const char *argv[]) {
+
+    etherlib_init();
+
+    // Parse command line, allowing for command files
+    COptions options;
+    if (!options.prepareArguments(argc, argv))
+        return 0;
+
+    // There's only one thing to do, so there's no need to loop over the command list
+    {
+        SFString command = nextTokenClear(options.commandList, '\n');
+        if (!options.parseArguments(command))
+            return 0;
+
+        if (options.rebuild && fileExists(bloomIndex))
+            removeFile(bloomIndex);
+
+        // Bloom files are written in block order, but we don't depend on the order we find them
+        SFUintArray blocks;
+        forEveryBloomFile(collectBloomFile, &blocks, 0, (uint64_t)-1);
+        blocks.Sort(sortBlockNums);
+
+        CBloomIndexWriter writer;
+        if (!writer.open(bloomIndex))
+            return 0;
+
+        uint64_t nBlocks = 0, nBlooms = 0;
+        for (uint32_t i = 0 ; i < blocks.getCount() ; i++) {
+            blknum_t bn = blocks[i];
+            if (!writer.isEmpty() && bn <= writer.lastBlock())
+                continue;  // already indexed
+
+            SFBloomArray blooms;
+            readBloomArray(blooms, getBinaryFilename(bn).Substitute("/blocks/", "/blooms/"));
+            if (writer.append(bn, blooms) && blooms.getCount()) {
+                nBlocks++;
+                nBlooms += blooms.getCount();
+                if (!(nBlocks % 10000) && !isTestMode())
+                    cerr << "\tindexed " << nBlocks << " blocks (" << bn << ")\r";
+            }
+        }
+        writer.close();
+
+        cout << "Indexed " << cYellow << nBlocks << cOff << " blocks containing "
+                << cYellow << nBlooms << cOff << " blooms. Last block: " << writer.lastBlock() << "\n";
+    }
+    return 0;
+}
+
+//--------------------------------------------------------------
+bool collectBloomFile(const SFString& path, void *data) {
+    if (path.endsWith("/")) {
+        forAllFiles(path + "*", collectBloomFile, data);
+
+    } else if (path.endsWith(".bin")) {
+        SFUintArray *blocks = (SFUintArray*)data;
+        blocks->addValue(bnFromPath(path));
+    }
+    return true;
+}
+
+//--------------------------------------------------------------
+int sortBlockNums(const void *v1, const void *v2) {
+    blknum_t b1 = *(blknum_t*)v1;
+    blknum_t b2 = *(blknum_t*)v2;
+    return (b1 < b2 ? -1 : (b1 > b2 ? 1 : 0));
+}
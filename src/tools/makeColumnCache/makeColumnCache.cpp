@@ -0,0 +1,56 @@
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include "etherlib.h"
+#include "options.h"
+
+//--------------------------------------------------------------
+int main(int argc, const char *argv[]) {
+
+    etherlib_init();
+
+    // Parse command line, allowing for command files
+    COptions options;
+    if (!options.prepareArguments(argc, argv))
+        return 0;
+
+    // There's only one thing to do, so there's no need to loop over the command list
+    {
+        SFString command = nextTokenClear(options.commandList, '\n');
+        if (!options.parseArguments(command))
+            return 0;
+
+        // Each chunk of the columnar cache is one second-level folder of the block cache
+        SFUintArray chunks;
+        listCacheChunks(chunks);
+
+        uint64_t nChunks = 0, nBlocks = 0;
+        for (uint32_t i = 0 ; i < chunks.getCount() && !shouldQuit() ; i++) {
+            uint64_t chunk = chunks[i];
+            bool isLast = (i == chunks.getCount() - 1);
+            if (!options.rebuild && !isLast && fileExists(getColumnFilename(chunk * COLUMN_CHUNK_SIZE)))
+                continue;  // already built
+
+            uint64_t n = 0;
+            if (buildColumnChunk(chunk, n)) {
+                nChunks++;
+                nBlocks += n;
+                if (!isTestMode())
+                    cerr << "\twrote chunk " << chunk << " (" << n << " blocks)\r";
+            }
+        }
+
+        cout << "Wrote " << cYellow << nChunks << cOff << " chunks containing "
+                << cYellow << nBlocks << cOff << " blocks.\n";
+    }
+    return 0;
+}
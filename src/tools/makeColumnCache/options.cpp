@@ -0,0 +1,81 @@
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include "options.h"
+
+//---------------------------------------------------------------------------------------------------
+CParams params[] = {
+    CParams("-rebuild", "rebuild every chunk of the columnar cache, not just the new ones"),
+    CParams("",         "Builds (or extends) the columnar block cache from the block files in the cache.\n"),
+};
+uint32_t nParams = sizeof(params) / sizeof(CParams);
+
+//---------------------------------------------------------------------------------------------------
+bool COptions::parseArguments(SFString& command) {
+
+    if (!standardOptions(command))
+        return false;
+
+    Init();
+    while (!command.empty()) {
+
+        SFString arg = nextTokenClear(command, ' ');
+        if (arg == "-r" || arg == "--rebuild") {
+            rebuild = true;
+
+        } else if (arg.startsWith('-')) {  // do not collapse
+
+            if (!builtInCmd(arg)) {
+                return usage("Invalid option: " + arg);
+            }
+
+        } else {
+
+            return usage("Invalid option: " + arg);
+
+        }
+    }
+
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------------
+void COptions::Init(void) {
+    paramsPtr = params;
+    nParamsRef = nParams;
+    pOptions = this;
+
+    rebuild = false;
+    minArgs = 0;
+}
+
+//---------------------------------------------------------------------------------------------------
+COptions::COptions(void) {
+    Init();
+}
+
+//--------------------------------------------------------------------------------
+COptions::~COptions(void) {
+}
+
+//--------------------------------------------------------------------------------
+SFString COptions::postProcess(const SFString& which, const SFString& str) const {
+    if (which == "notes" && (verbose || COptions::isReadme)) {
+        SFString ret;
+        ret += "Chunks are written to [{$BLOCK_CACHE/columns/}], one for every 100,000 blocks. "
+                "Existing chunks are skipped (except the last one, which may have grown).\n";
+        ret += "[{getBlock --source:cache}] reads from the columnar cache when it has every field being displayed.\n";
+        ret += "A block written to the cache after its chunk was built is read from its own file until the chunk is rebuilt.\n";
+        return ret;
+    }
+    return str;
+}
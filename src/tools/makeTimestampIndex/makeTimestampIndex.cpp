@@ -0,0 +1,49 @@
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include "etherlib.h"
+#include "options.h"
+
+//--------------------------------------------------------------
+int main(int argc, const char *argv[]) {
+
+    etherlib_init();
+
+    // Parse command line, allowing for command files
+    COptions options;
+    if (!options.prepareArguments(argc, argv))
+        return 0;
+
+    // There's only one thing to do, so there's no need to loop over the command list
+    {
+        SFString command = nextTokenClear(options.commandList, '\n');
+        if (!options.parseArguments(command))
+            return 0;
+
+        if (!fileExists(miniBlockCache)) {
+            cerr << "The timestamp index is built from the miniBlock database, which was not found at " << miniBlockCache << ".\n";
+            return 0;
+        }
+
+        if (options.rebuild && fileExists(timestampIndex))
+            removeFile(timestampIndex);
+
+        uint64_t nAdded = 0;
+        if (updateTimestampIndex(nAdded)) {
+            const CTimestampIndex *index = getTimestampIndex();
+            cout << "Indexed " << cYellow << nAdded << cOff << " blocks. Blocks in the index: " << index->nBlocks() << "\n";
+        }
+    }
+
+    clearInMemoryCache();
+    return 0;
+}
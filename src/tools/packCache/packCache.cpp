@@ -0,0 +1,72 @@
+/*-------------------------------------------------------------------------------------------
+ * QuickBlocks - Decentralized, useful, and detailed data from Ethereum blockchains
+ * Copyright (c) 2018 Great Hill Corporation (http://quickblocks.io)
+ *
+ * This program is free software: you may redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version. This program is
+ * distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details. You should have received a copy of the GNU General
+ * Public License along with this program. If not, see http://www.gnu.org/licenses/.
+ *-------------------------------------------------------------------------------------------*/
+#include "etherlib.h"
+#include "options.h"
+
+//--------------------------------------------------------------
+class CPackJob {
+public:
+    const SFUintArray     *groups;
+    bool                   keep;
+    std::atomic<uint64_t>  nBlocks;
+    std::atomic<uint64_t>  nPacks;
+    std::atomic<uint64_t>  nFailed;
+    CPackJob(const SFUintArray *g, bool k) : groups(g), keep(k), nBlocks(0), nPacks(0), nFailed(0) { }
+};
+
+//--------------------------------------------------------------
+// Runs on one of the pool's threads. Each pack is its own item, so no two threads write the same one.
+void packOne(uint64_t item, void *data) {
+    CPackJob *job = reinterpret_cast<CPackJob*>(data);
+    uint32_t nPacked = 0;
+    if (!packBlocks((*job->groups)[(uint32_t)item], job->keep, nPacked)) {
+        job->nFailed++;
+        return;
+    }
+    if (nPacked) {
+        job->nBlocks += nPacked;
+        job->nPacks++;
+    }
+}
+
+//--------------------------------------------------------------
+int main(int argc, const char *argv[]) {
+
+    etherlib_init();
+
+    // Parse command line, allowing for command files
+    COptions options;
+    if (!options.prepareArguments(argc, argv))
+        return 0;
+
+    // There's only one thing to do, so there's no need to loop over the command list
+    {
+        SFString command = nextTokenClear(options.commandList, '\n');
+        if (!options.parseArguments(command))
+            return 0;
+
+        SFUintArray groups;
+        listPackGroups(groups);
+
+        CPackJob job(&groups, options.keep);
+        CWorkPool pool;
+        pool.start(groups.getCount(), packOne, &job);
+        pool.wait();
+
+        cout << "Packed " << cYellow << job.nBlocks << cOff << " blocks into "
+                << cYellow << job.nPacks << cOff << " packs.\n";
+        if (job.nFailed)
+            cerr << job.nFailed << " packs could not be written.\n";
+    }
+    return 0;
+}
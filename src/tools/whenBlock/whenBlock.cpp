@@ -14,8 +14,7 @@
 #include "options.h"
 
 //---------------------------------------------------------------
-extern bool lookupDate(CBlock& block, const SFTime& date);
-extern void unloadCache(void);
+extern bool lookupDates(CBlockBoundsArray& dates);
 
 //---------------------------------------------------------------
 int main(int argc, const char *argv[]) {
@@ -32,6 +31,17 @@ int main(int argc, const char *argv[]) {
         if (!options.parseArguments(command))
             return 0;
 
+        // All of the dates are looked up together in a single pass over the timestamp index
+        CBlockBoundsArray dates;
+        for (uint32_t i = 0 ; i < options.requests.getCount() ; i++ )
+            if (options.requests[i].startsWith("date:"))
+                dates[dates.getCount()] = CBlockBounds((timestamp_t)toUnsigned(options.requests[i].substr(5)));
+        if (dates.getCount() && fileExists(timestampIndex) && !lookupDates(dates)) {
+            clearInMemoryCache();
+            return 0;
+        }
+
+        uint32_t nDates = 0;
         for (uint32_t i = 0 ; i < options.requests.getCount() ; i++ ) {
 
             SFString value = options.requests[i];
@@ -56,18 +66,16 @@ int main(int argc, const char *argv[]) {
                 queryBlock(block, value, false, false);
 
             } else if (mode == "date") {
-                if (!fileExists(miniBlockCache)) {
-                    cout << "Looking up blocks by date is not supported without a miniBlock ";
-                    cout << "database, which is an advanced feature.\n";
+                if (!fileExists(timestampIndex)) {
+                    cout << "Looking up blocks by date is not supported without a timestamp index. ";
+                    cout << "Build one from a miniBlock database (an advanced feature) with makeTimestampIndex.\n";
 
                 } else {
-                    SFTime date = dateFromTimeStamp((timestamp_t)toUnsigned(value));
-                    bool found = lookupDate(block, date);
-                    if (!found) {
-                        unloadCache();
-                        return 0;
-                    }
+                    // the last block at or before the date (or the first block if the date is earlier)
+                    const CBlockBounds& bounds = dates[nDates];
+                    queryBlock(block, asStringU(bounds.floor == NOPOS ? 0 : bounds.floor), false, false);
                 }
+                nDates++;
             }
 
             // special case for the zero block
@@ -84,88 +92,18 @@ int main(int argc, const char *argv[]) {
         }
     }
 
-    unloadCache();
+    clearInMemoryCache();
     return 0;
 }
 
 //---------------------------------------------------------------
-static CMiniBlock *blocks = NULL;
-static uint64_t nBlocks = 0;
-static uint64_t below = ULONG_MAX;
-static uint64_t above = 0;
-#define tD(a) dateFromTimeStamp(a)
-
-//---------------------------------------------------------------
-int findFunc(const void *v1, const void *v2) {
-    const CMiniBlock *m1 = (const CMiniBlock *)v1;
-    const CMiniBlock *m2 = (const CMiniBlock *)v2;
-    below = (m1->timestamp > m2->timestamp ? m2->blockNumber : below);
-    above = (m1->timestamp < m2->timestamp ? m2->blockNumber : above);
-    return static_cast<int>(m1->timestamp - m2->timestamp);
-}
-
-//---------------------------------------------------------------
-class CBlockFinder {
-public:
-    timestamp_t ts;
-    uint64_t found;
-    explicit CBlockFinder(timestamp_t t) : ts(t), found(0) { }
-};
-
-//---------------------------------------------------------------
-bool lookCloser(CBlock& block, void *data) {
-
-    CBlockFinder *bf = reinterpret_cast<CBlockFinder*>(data);
-    if (block.timestamp <= bf->ts) {
-        bf->found = block.blockNumber;
-        return true;
-    }
-    return false;
-}
-
-//---------------------------------------------------------------
-bool lookupDate(CBlock& block, const SFTime& date) {
-    if (!blocks) {
-        nBlocks = fileSize(miniBlockCache) / sizeof(CMiniBlock);
-        blocks = new CMiniBlock[nBlocks];
-        if (!blocks)
-            return usage("Could not allocate memory for the blocks (size needed: " + asStringU(nBlocks) + ").\n");
-        bzero(blocks, sizeof(CMiniBlock)*(nBlocks));
-        if (verbose)
-            cerr << "Allocated room for " << nBlocks << " miniBlocks.\n";
-
-        // Next, we try to open the mini-block database (caller will cleanup)
-        FILE *fpBlocks = fopen(miniBlockCache.c_str(), binaryReadOnly);
-        if (!fpBlocks)
-            return usage("Could not open the mini-block database: " + miniBlockCache + ".\n");
-
-        // Read the entire mini-block database into memory in one chunk
-        size_t nRead = fread(blocks, sizeof(CMiniBlock), nBlocks, fpBlocks);
-        if (nRead != nBlocks)
-            return usage("Error encountered reading mini-blocks database.\n Quitting...");
-        if (verbose)
-            cerr << "Read " << nRead << " miniBlocks into memory.\n";
-    }
-
-    CMiniBlock mini;
-    mini.timestamp = toTimestamp(date);
-    CMiniBlock *found = reinterpret_cast<CMiniBlock*>(bsearch(&mini, blocks, nBlocks, sizeof(CMiniBlock), findFunc));
-    if (found) {
-        queryBlock(block, asStringU(found->blockNumber), false, false);
-        return true;
-    }
-
-    //  cout << mini.timestamp << " is somewhere between " << below << " and " << above << "\n";
-    CBlockFinder finder(mini.timestamp);
-    forEveryBlockOnDisc(lookCloser, &finder, below, above-below);
-    queryBlock(block, asStringU(finder.found), false, false);
+bool lookupDates(CBlockBoundsArray& dates) {
+    // The index is only read here. makeTimestampIndex builds it and keeps it up to date, so a
+    // date after the last indexed block finds that block.
+    const CTimestampIndex *index = getTimestampIndex();
+    if (!index->isValid())
+        return usage("Could not open the timestamp index: " + timestampIndex + ".\n");
+
+    index->findBlocks(dates);
     return true;
 }
-
-//---------------------------------------------------------------
-void unloadCache(void) {
-    if (blocks) {
-        delete [] blocks;
-        blocks = NULL;
-    }
-}
@@ -39,6 +39,10 @@ int main(int argc, const char *argv[]) {
             blknum_t bn = toLongU(nextTokenClear(list, '|'));
             CFilename fileName(getBinaryFilename(bn).Substitute("/blocks/", "/"+options.mode+"s/"));
             bool exists = fileExists(fileName.getFullPath());
+            if (!exists && options.mode == "block" && isBlockInPack(bn)) {
+                fileName = CFilename(getPackFilename(bn));
+                exists = true;
+            }
 
             SFString path = (verbose ? fileName.getFullPath() : fileName.relativePath(blockCachePath("").Substitute("/blocks/", "/"+options.mode+"s/")));
             SFString vers = getVersionFromClient();